@@ -14,76 +14,16 @@
 #include <memory>
 #include <functional>
 #include <algorithm>
+#include <numeric>
+#include <iomanip>
+#include "../multithreading/sharded_counter.h"
+#include "thread_pool.h"
+#include "future.h"
+#include "task_graph.h"
+#include "../performance-benchmarking/benchmark_harness.h"
 
 namespace advanced_concurrency_demo {
-    // 1. 线程池实现
-    class ThreadPool {
-    private:
-        std::vector<std::thread> workers;
-        // 任务数组，每个任务是一个std::function对象
-        std::queue<std::function<void()>> tasks;
-        std::mutex queue_mutex;
-        std::condition_variable condition;
-        bool stop;
-
-    public:
-        ThreadPool(size_t threads) : stop(false) {
-            for(size_t i = 0; i < threads; ++i) {
-                workers.emplace_back([this] {
-                    for(;;) {
-                        std::function<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(this->queue_mutex);
-                            // 条件变量，没有任务以及没有退出信号会阻塞住
-                            this->condition.wait(lock, [this]{ return this->stop || !this->tasks.empty(); });
-                            // 如果是退出信号
-                            if(this->stop && this->tasks.empty()) return;
-                            // 获取一个任务
-                            task = std::move(this->tasks.front());
-                            this->tasks.pop();
-                        }
-                        // 无锁环境下执行任务
-                        task();
-                    }
-                });
-            }
-        }
-
-        template<class F, class... Args>
-        auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
-            // 这个类型萃取，获取返回值类型
-            using return_type = std::invoke_result_t<F, Args...>;
-
-            // 定义一个封装任务，使用了完美转发
-            auto task = std::make_shared<std::packaged_task<return_type()>>(
-                std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-            );
-
-            // 获取任务的future对象
-            std::future<return_type> res = task->get_future();
-            // 任务入队
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                if(stop) throw std::runtime_error("enqueue on stopped ThreadPool");
-                tasks.emplace([task](){ (*task)(); });
-            }
-            // 唤醒一个等待的线程执行
-            condition.notify_one();
-            // 返回future对象
-            return res;
-        }
-
-        ~ThreadPool() {
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                // 设置为退出信号
-                stop = true;
-            }
-            condition.notify_all();
-            // 等待所有workers退出
-            for(std::thread &worker: workers) worker.join();
-        }
-    };
+    // 1. 线程池实现见 thread_pool.h
 
     void thread_pool_demo() {
         std::cout << "\n=== 线程池演示 ===" << std::endl;
@@ -213,6 +153,36 @@ namespace advanced_concurrency_demo {
         }
     }
 
+    // 并发哈希表的线程扩展性：读多写少的混合负载在不同线程数下的吞吐量
+    void concurrent_hash_map_scaling_benchmark(size_t max_threads = 8) {
+        std::cout << "\n=== 并发哈希表扩展性基准测试 ===" << std::endl;
+        using namespace performance_benchmarking_demo;
+
+        BenchmarkOptions options;
+        options.samples = 10;
+        options.min_sample_time = std::chrono::milliseconds(5);
+        BenchmarkRunner runner(options);
+
+        const int keys = 4096;
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            ConcurrentHashMap<int, int> map;
+            for (int k = 0; k < keys; ++k) map.insert(k, k);
+            // 每个线程有自己的游标，避免线程之间共享可写状态
+            std::vector<unsigned> cursors(threads * 16);
+            auto stats = runner.run_threads("hash map 95% find", threads, [&](size_t t) {
+                unsigned& cursor = cursors[t * 16];
+                cursor = cursor * 1664525u + 1013904223u;
+                int key = static_cast<int>(cursor % keys);
+                if (cursor % 100 < 5) {
+                    map.insert(key + keys, key);
+                    return key;
+                }
+                return map.find(key).second;
+            });
+            print_threaded_stats(std::cout, stats);
+        }
+    }
+
     // 4. 原子操作高级用法
     void atomic_operations_demo() {
         std::cout << "\n=== 原子操作高级用法演示 ===" << std::endl;
@@ -242,6 +212,23 @@ namespace advanced_concurrency_demo {
         }
         
         std::cout << "多线程增加后的计数器值: " << counter.load() << std::endl;
+
+        // 热点计数器改用分片计数器，避免所有线程争抢同一缓存行
+        multithreading_demo::ShardedCounter sharded_counter;
+        threads.clear();
+        for(int i = 0; i < 4; ++i) {
+            threads.emplace_back([&sharded_counter]() {
+                for(int j = 0; j < 1000; ++j) {
+                    sharded_counter.add(1);
+                }
+            });
+        }
+
+        for(auto& t : threads) {
+            t.join();
+        }
+
+        std::cout << "分片计数器汇总值: " << sharded_counter.value() << std::endl;
         
         // CAS操作
         std::atomic<int> cas_value{10};
@@ -297,6 +284,329 @@ namespace advanced_concurrency_demo {
         std::cout << "异步任务结果: " << future1.get() << " " << future2.get() << " " << future3.get() << std::endl;
     }
 
+    // 5.1 Future continuation与非阻塞组合
+    void future_continuation_demo() {
+        std::cout << "\n=== Future continuation与when_all/when_any演示 ===" << std::endl;
+        ThreadPool pool(4);
+
+        // then()链式调用，continuation投递到线程池执行，不阻塞任何线程
+        auto chained = async(pool, [] { return 6; })
+            .then(pool, [](int x) { return x * 7; })
+            .then(pool, [](int x) { return "结果: " + std::to_string(x); });
+        std::cout << "链式continuation " << chained.get() << std::endl;
+
+        // when_all：扇出多个任务，全部完成后扇入汇总
+        std::vector<Future<int>> parts;
+        for (int i = 1; i <= 4; ++i) {
+            parts.push_back(async(pool, [i] { return i * i; }));
+        }
+        auto total = when_all(std::move(parts)).then(pool, [](std::vector<int> values) {
+            return std::accumulate(values.begin(), values.end(), 0);
+        });
+        std::cout << "when_all求平方和: " << total.get() << std::endl;
+
+        // when_any：取最先完成的结果
+        std::vector<Future<int>> racers;
+        racers.push_back(async(pool, [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return 1;
+        }));
+        racers.push_back(async(pool, [] { return 2; }));
+        auto first = when_any(std::move(racers)).get();
+        std::cout << "when_any最先完成的任务: " << first.index << ", 值: " << first.value << std::endl;
+
+        // 异常沿着continuation链传播
+        auto failed = async(pool, []() -> int { throw std::runtime_error("任务失败"); })
+            .then([](int x) { return x + 1; });
+        try {
+            failed.get();
+        } catch (const std::exception& e) {
+            std::cout << "捕获传播的异常: " << e.what() << std::endl;
+        }
+    }
+
+    // 扇出/扇入DAG基准测试：每个DAG有width个叶子任务和一个汇总任务
+    // 阻塞版本的汇总任务在线程池线程里调用std::future::get()，等待期间占用线程
+    void future_fan_in_benchmark(int dags = 200, int width = 32) {
+        std::cout << "\n=== 扇出/扇入DAG基准测试 ===" << std::endl;
+        const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        ThreadPool pool(threads);
+
+        auto leaf_work = [](int seed) {
+            long sum = 0;
+            for (int i = 0; i < 2000; ++i) {
+                sum += (seed * 31 + i) % 7;
+            }
+            return sum;
+        };
+
+        // 阻塞版本：std::future + 在池线程中get()
+        std::atomic<int> blocked_waits{0};
+        std::atomic<int> max_blocked{0};
+        auto begin = std::chrono::steady_clock::now();
+        {
+            std::vector<std::future<long>> roots;
+            roots.reserve(dags);
+            for (int d = 0; d < dags; ++d) {
+                auto leaves = std::make_shared<std::vector<std::future<long>>>();
+                for (int i = 0; i < width; ++i) {
+                    leaves->push_back(pool.enqueue(leaf_work, d * width + i));
+                }
+                roots.push_back(pool.enqueue([leaves, &blocked_waits, &max_blocked] {
+                    int now = blocked_waits.fetch_add(1) + 1;
+                    int seen = max_blocked.load();
+                    while (now > seen && !max_blocked.compare_exchange_weak(seen, now)) {}
+                    long sum = 0;
+                    for (auto& f : *leaves) {
+                        sum += f.get();
+                    }
+                    blocked_waits.fetch_sub(1);
+                    return sum;
+                }));
+            }
+            for (auto& r : roots) {
+                r.get();
+            }
+        }
+        double blocking_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        // 非阻塞版本：Future + when_all + then
+        begin = std::chrono::steady_clock::now();
+        {
+            std::vector<Future<long>> roots;
+            roots.reserve(dags);
+            for (int d = 0; d < dags; ++d) {
+                std::vector<Future<long>> leaves;
+                leaves.reserve(width);
+                for (int i = 0; i < width; ++i) {
+                    leaves.push_back(async(pool, leaf_work, d * width + i));
+                }
+                roots.push_back(when_all(std::move(leaves)).then(pool, [](std::vector<long> values) {
+                    return std::accumulate(values.begin(), values.end(), 0L);
+                }));
+            }
+            for (auto& r : roots) {
+                r.get();
+            }
+        }
+        double continuation_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::cout << "DAG数: " << dags << ", 每个DAG叶子数: " << width << ", 线程数: " << threads << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "std::future阻塞扇入: " << dags / blocking_seconds << " DAG/秒"
+                  << " (最多同时阻塞的池线程: " << max_blocked.load() << ")" << std::endl;
+        std::cout << "Future continuation扇入: " << dags / continuation_seconds << " DAG/秒"
+                  << " (池线程从不阻塞)" << std::endl;
+    }
+
+    // 5.2 任务图(DAG)执行器
+    void task_graph_demo() {
+        std::cout << "\n=== 任务图(DAG)执行器演示 ===" << std::endl;
+        ThreadPool pool(4);
+        TaskGraphExecutor executor(pool);
+
+        auto sleep_ms = [](int ms) {
+            return [ms] { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+        };
+
+        // load -> (parse, validate) -> transform -> store
+        TaskGraph graph;
+        auto load = graph.add_node("load", sleep_ms(10));
+        auto parse = graph.add_node("parse", sleep_ms(30), {load});
+        auto validate = graph.add_node("validate", sleep_ms(5), {load});
+        auto transform = graph.add_node("transform", sleep_ms(10), {parse, validate});
+        graph.add_node("store", sleep_ms(5), {transform});
+
+        for (int run = 1; run <= 2; ++run) {
+            TaskGraphReport report = executor.run(graph);
+            std::cout << "第" << run << "次执行: 总耗时 " << std::fixed << std::setprecision(1)
+                      << report.wall_seconds * 1e3 << " ms, 关键路径 "
+                      << report.critical_path_seconds * 1e3 << " ms, 并行度 "
+                      << std::setprecision(2) << report.parallelism() << std::endl;
+            std::cout << "  关键路径: ";
+            for (size_t i = 0; i < report.critical_path.size(); ++i) {
+                std::cout << (i ? " -> " : "") << graph.name(report.critical_path[i]);
+            }
+            std::cout << std::endl;
+        }
+
+        // 环检测
+        TaskGraph cyclic;
+        auto a = cyclic.add_node("a", [] {});
+        auto b = cyclic.add_node("b", [] {}, {a});
+        cyclic.add_dependency(b, a);
+        try {
+            executor.run(cyclic);
+        } catch (const std::logic_error& e) {
+            std::cout << "检测到环: " << e.what() << std::endl;
+        }
+    }
+
+    // 宽图和深图的吞吐量基准测试(重复执行同一个图)
+    void task_graph_benchmark(int runs = 50) {
+        std::cout << "\n=== 任务图吞吐量基准测试 ===" << std::endl;
+        const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        ThreadPool pool(threads);
+        TaskGraphExecutor executor(pool);
+        std::atomic<long> sink{0};
+        auto work = [&sink] {
+            long sum = 0;
+            for (int i = 0; i < 200; ++i) sum += i ^ (sum >> 3);
+            sink.fetch_add(sum, std::memory_order_relaxed);
+        };
+
+        auto measure = [&](const std::string& label, TaskGraph& graph) {
+            executor.run(graph);  // 预热并完成prepare
+            double critical = 0.0;
+            auto begin = std::chrono::steady_clock::now();
+            for (int r = 0; r < runs; ++r) {
+                critical += executor.run(graph).critical_path_seconds;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cout << std::left << std::setw(28) << label << std::right << std::fixed
+                      << std::setprecision(0) << std::setw(12) << graph.size() * runs / seconds << " 节点/秒"
+                      << std::setprecision(1) << "  平均关键路径 " << critical / runs * 1e6 << " us" << std::endl;
+        };
+
+        // 宽图：source -> 4096个并行节点 -> sink
+        TaskGraph wide;
+        auto source = wide.add_node("source", work);
+        auto sink_node = wide.add_node("sink", work);
+        for (int i = 0; i < 4096; ++i) {
+            auto middle = wide.add_node("w" + std::to_string(i), work, {source});
+            wide.add_dependency(middle, sink_node);
+        }
+        measure("宽图 (1 -> 4096 -> 1)", wide);
+
+        // 深图：4096个节点的链
+        TaskGraph deep;
+        TaskGraph::NodeId previous = deep.add_node("d0", work);
+        for (int i = 1; i < 4096; ++i) {
+            previous = deep.add_node("d" + std::to_string(i), work, {previous});
+        }
+        measure("深图 (4096节点链)", deep);
+
+        // 分层图：64层，每层64个节点，每个节点依赖上一层的两个节点
+        TaskGraph layered;
+        std::vector<TaskGraph::NodeId> layer;
+        for (int i = 0; i < 64; ++i) layer.push_back(layered.add_node("l0_" + std::to_string(i), work));
+        for (int l = 1; l < 64; ++l) {
+            std::vector<TaskGraph::NodeId> next;
+            for (int i = 0; i < 64; ++i) {
+                next.push_back(layered.add_node("l" + std::to_string(l) + "_" + std::to_string(i), work,
+                                                {layer[i], layer[(i + 1) % 64]}));
+            }
+            layer = std::move(next);
+        }
+        measure("分层图 (64层 x 64)", layered);
+    }
+
+    // 5.3 线程池任务的协作式取消与超时
+    void cancellation_demo() {
+        std::cout << "\n=== 线程池任务取消与超时演示 ===" << std::endl;
+        ThreadPool pool(1);
+
+        // 运行中的任务通过stop_token协作式退出
+        auto long_running = pool.enqueue_cancellable([](std::stop_token token) {
+            int rounds = 0;
+            while (!token.stop_requested()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ++rounds;
+            }
+            return rounds;
+        });
+
+        // 排队中的任务被取消时，捕获的资源立即释放
+        auto payload = std::make_shared<std::vector<int>>(1000000, 1);
+        auto queued = pool.enqueue_cancellable([payload](std::stop_token) { return payload->size(); });
+        std::cout << "取消前payload引用计数: " << payload.use_count() << std::endl;
+        std::cout << "取消排队任务: " << (queued.cancel() ? "成功" : "已开始") << std::endl;
+        std::cout << "取消后payload引用计数: " << payload.use_count() << std::endl;
+        try {
+            queued.get();
+        } catch (const TaskCancelled& e) {
+            std::cout << "排队任务结果: " << e.what() << std::endl;
+        }
+
+        // 带超时的任务：排队超过截止时间直接丢弃
+        auto timed = pool.enqueue_with_timeout(std::chrono::milliseconds(20), [](std::stop_token) { return 1; });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        long_running.cancel();
+        std::cout << "运行中的任务收到停止请求后退出，执行轮数: " << long_running.get() << std::endl;
+        try {
+            timed.get();
+        } catch (const TaskCancelled& e) {
+            std::cout << "超时任务结果: " << e.what() << " (timed_out=" << e.timed_out() << ")" << std::endl;
+        }
+
+        // 运行中的任务超时：看门狗请求停止
+        auto slow = pool.enqueue_with_timeout(std::chrono::milliseconds(30), [](std::stop_token token) {
+            auto begin = std::chrono::steady_clock::now();
+            while (!token.stop_requested()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        });
+        std::cout << "运行中任务在超时后停止，运行了约 " << std::fixed << std::setprecision(0)
+                  << slow.get() << " ms" << std::endl;
+    }
+
+    // 队列中积压大量任务时的关闭延迟：析构(执行完所有任务) vs shutdown_now(丢弃)
+    void shutdown_latency_benchmark(size_t queued_tasks = 1000000) {
+        std::cout << "\n=== 线程池关闭延迟基准测试 ===" << std::endl;
+        const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        std::atomic<long> sink{0};
+
+        // 先用阻塞任务占满所有工作线程，确保后续任务都停留在队列中
+        // 每个积压任务约1微秒的计算量
+        auto work = [&sink](size_t seed) {
+            long sum = 0;
+            for (int i = 0; i < 300; ++i) sum += (static_cast<long>(seed) ^ i) & 7;
+            sink.fetch_add(sum, std::memory_order_relaxed);
+        };
+
+        auto fill = [&](ThreadPool& pool, std::atomic<bool>& release) {
+            for (size_t i = 0; i < threads; ++i) {
+                pool.enqueue_cancellable([&release](std::stop_token token) {
+                    while (!release.load() && !token.stop_requested()) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
+                });
+            }
+            for (size_t i = 0; i < queued_tasks; ++i) {
+                pool.enqueue_cancellable([&work, i](std::stop_token) { work(i); });
+            }
+        };
+
+        double drain_ms = 0.0;
+        {
+            std::atomic<bool> release{false};
+            auto pool = std::make_unique<ThreadPool>(threads);
+            fill(*pool, release);
+            auto begin = std::chrono::steady_clock::now();
+            release.store(true);
+            pool.reset();  // 析构函数执行完全部积压任务
+            drain_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        double shutdown_ms = 0.0;
+        size_t discarded = 0;
+        {
+            std::atomic<bool> release{false};
+            ThreadPool pool(threads);
+            fill(pool, release);
+            auto begin = std::chrono::steady_clock::now();
+            discarded = pool.shutdown_now();
+            shutdown_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        std::cout << "积压任务数: " << queued_tasks << ", 线程数: " << threads << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "析构函数(执行完所有积压任务): " << drain_ms << " ms" << std::endl;
+        std::cout << "shutdown_now(丢弃 " << discarded << " 个任务): " << shutdown_ms << " ms" << std::endl;
+    }
+
     // 6. 线程局部存储
     thread_local int thread_local_value = 0;
 
@@ -325,14 +635,100 @@ namespace advanced_concurrency_demo {
         }
     }
 
+    // 热路径追踪演示：线程池的排队等待和执行时间导出为Chrome trace
+    void tracing_demo() {
+        std::cout << "\n=== 线程池追踪演示 ===" << std::endl;
+#if TRACE_ENABLED
+        using performance_benchmarking_demo::Tracer;
+
+        // 单个事件的记录开销
+        const int events = 1000000;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < events; ++i) {
+            TRACE_SCOPE("overhead probe");
+        }
+        double ns_per_event = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / events;
+        std::cout << "每个作用域事件的记录开销: " << std::fixed << std::setprecision(1) << ns_per_event << " ns" << std::endl;
+        Tracer::instance().clear();
+
+        // 一个简单的三阶段流水线：每阶段的任务都提交到线程池
+        TRACE_THREAD_NAME("main");
+        {
+            ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+            std::atomic<long> sink{0};
+            auto stage = [&sink](int amount) {
+                long sum = 0;
+                for (int i = 0; i < amount; ++i) sum += i % 7;
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            };
+            for (int batch = 0; batch < 20; ++batch) {
+                TRACE_SCOPE("submit batch");
+                std::vector<std::future<void>> parsed;
+                for (int i = 0; i < 16; ++i) {
+                    parsed.push_back(pool.enqueue([&stage] { TRACE_SCOPE("parse"); stage(20000); }));
+                }
+                for (auto& f : parsed) f.get();
+                pool.enqueue([&stage] { TRACE_SCOPE("aggregate"); stage(100000); }).get();
+            }
+        }
+
+        const char* path = "thread_pool_trace.json";
+        size_t written = Tracer::instance().save_chrome_trace(path);
+        std::cout << "导出 " << written << " 个事件到 " << path << "(丢弃 "
+                  << Tracer::instance().dropped_events() << " 个)，可在 https://ui.perfetto.dev 中打开" << std::endl;
+#else
+        std::cout << "追踪未启用：使用 -DCPP_LEARNING_ENABLE_TRACING=ON 重新配置后，"
+                  << "线程池的queue_wait/run事件会导出为Chrome trace" << std::endl;
+#endif
+    }
+
+    // 任务延迟分布：突发提交时排队等待时间的长尾远大于执行时间本身
+    void thread_pool_latency_demo(int bursts = 50, int tasks_per_burst = 200) {
+        std::cout << "\n=== 线程池任务延迟分布 ===" << std::endl;
+        ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+        pool.set_latency_tracking(true);
+        std::atomic<long> sink{0};
+        for (int b = 0; b < bursts; ++b) {
+            std::vector<std::future<void>> done;
+            done.reserve(tasks_per_burst);
+            for (int i = 0; i < tasks_per_burst; ++i) {
+                done.push_back(pool.enqueue([&sink, i] {
+                    long sum = 0;
+                    for (int k = 0; k < 2000 + (i % 8) * 500; ++k) sum += k % 7;
+                    sink.fetch_add(sum, std::memory_order_relaxed);
+                }));
+            }
+            for (auto& f : done) f.get();
+        }
+        // future就绪时任务的执行时间可能还没记录，先等工作线程退出
+        pool.shutdown_now();
+
+        auto stats = pool.latency_stats();
+        std::cout << "排队等待: ";
+        stats.queue_wait.print(std::cout);
+        std::cout << "\n执行时间: ";
+        stats.run.print(std::cout);
+        std::cout << "\n排队等待的百分位分布(ns):" << std::endl;
+        stats.queue_wait.print_distribution(std::cout);
+    }
+
     // 运行所有演示
     void run_demo() {
         std::cout << "=== 高级并发编程演示 ===" << std::endl;
         thread_pool_demo();
         lock_free_stack_demo();
         concurrent_hash_map_demo();
+        concurrent_hash_map_scaling_benchmark();
         atomic_operations_demo();
         advanced_async_demo();
+        future_continuation_demo();
+        future_fan_in_benchmark();
+        task_graph_demo();
+        task_graph_benchmark();
+        cancellation_demo();
+        shutdown_latency_benchmark();
+        thread_pool_latency_demo();
+        tracing_demo();
         thread_local_storage_demo();
     }
 }
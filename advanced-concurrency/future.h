@@ -0,0 +1,481 @@
+#ifndef CPP_LEARNING_DEMO_FUTURE_H
+#define CPP_LEARNING_DEMO_FUTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "thread_pool.h"
+
+namespace advanced_concurrency_demo {
+    // 轻量级Future/Promise，支持continuation和非阻塞的when_all/when_any
+    //
+    // 与std::future不同，结果就绪时由完成方直接触发continuation，
+    // 组合多个Future不需要任何线程阻塞在get()上。
+    template<typename T> class Future;
+    template<typename T> class Promise;
+
+    namespace future_detail {
+        // void结果用std::monostate占位，统一存储方式
+        template<typename T>
+        using storage_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        template<typename T>
+        struct SharedState : std::enable_shared_from_this<SharedState<T>> {
+            std::mutex mutex;
+            std::condition_variable ready_cv;
+            std::optional<storage_t<T>> value;
+            std::exception_ptr error;
+            bool ready = false;
+            // 每个共享状态最多一个continuation(Future只能被消费一次)
+            std::function<void(std::shared_ptr<SharedState>)> continuation;
+
+            // 设置结果，取出continuation后在锁外执行
+            template<typename... Args>
+            void set_value(Args&&... args) {
+                decltype(continuation) next;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (ready) throw std::logic_error("promise already satisfied");
+                    value.emplace(std::forward<Args>(args)...);
+                    ready = true;
+                    next = std::move(continuation);
+                }
+                ready_cv.notify_all();
+                if (next) next(this->shared_from_this());
+            }
+
+            void set_exception(std::exception_ptr e) {
+                decltype(continuation) next;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (ready) throw std::logic_error("promise already satisfied");
+                    error = std::move(e);
+                    ready = true;
+                    next = std::move(continuation);
+                }
+                ready_cv.notify_all();
+                if (next) next(this->shared_from_this());
+            }
+
+            // 注册continuation；如果结果已就绪则立即在当前线程执行
+            template<typename F>
+            void on_ready(F&& f) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!ready) {
+                        continuation = std::forward<F>(f);
+                        return;
+                    }
+                }
+                f(this->shared_from_this());
+            }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready_cv.wait(lock, [this] { return ready; });
+            }
+
+            // 最后一个Promise在设置结果之前被销毁：以broken_promise结束，等待方和continuation不会永远挂起。
+            // 在析构函数中调用，continuation抛出的异常无法再传播，只能丢弃
+            void abandon() noexcept {
+                decltype(continuation) next;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (ready) return;
+                    error = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+                    ready = true;
+                    next = std::move(continuation);
+                }
+                ready_cv.notify_all();
+                if (next) {
+                    try {
+                        next(this->shared_from_this());
+                    } catch (...) {
+                    }
+                }
+            }
+        };
+
+        // Promise可以复制(continuation和on_drop各持有一份)，所有副本共享一个Owner；
+        // 最后一个副本销毁时Owner放弃还没有结果的共享状态
+        template<typename T>
+        struct PromiseOwner {
+            std::shared_ptr<SharedState<T>> state = std::make_shared<SharedState<T>>();
+
+            PromiseOwner() = default;
+            PromiseOwner(const PromiseOwner&) = delete;
+            PromiseOwner& operator=(const PromiseOwner&) = delete;
+
+            ~PromiseOwner() {
+                state->abandon();
+            }
+        };
+
+        [[noreturn]] inline void throw_no_state() {
+            throw std::future_error(std::future_errc::no_state);
+        }
+
+        // continuation的返回类型：T为void时f不接受参数
+        template<typename F, typename T>
+        struct then_result {
+            using type = std::invoke_result_t<F, T>;
+        };
+
+        template<typename F>
+        struct then_result<F, void> {
+            using type = std::invoke_result_t<F>;
+        };
+
+        template<typename F, typename T>
+        using then_result_t = typename then_result<F, T>::type;
+
+        // 调用f并把返回值或异常写入promise。只有f在try中：set_value会执行下游的continuation，
+        // 它们抛出的异常不能被当成f的异常再写一次已经完成的promise
+        template<typename R, typename F, typename... Args>
+        void fulfill(Promise<R>& promise, F& f, Args&&... args) {
+            if constexpr (std::is_void_v<R>) {
+                try {
+                    std::invoke(f, std::forward<Args>(args)...);
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                    return;
+                }
+                promise.set_value();
+            } else {
+                std::optional<R> result;
+                try {
+                    result.emplace(std::invoke(f, std::forward<Args>(args)...));
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                    return;
+                }
+                promise.set_value(std::move(*result));
+            }
+        }
+
+        // 线程池的shutdown_now()丢弃了计算这个promise的任务
+        template<typename R>
+        auto cancel_on_drop(Promise<R> promise) {
+            return [promise = std::move(promise)]() mutable {
+                promise.set_exception(std::make_exception_ptr(TaskCancelled(false)));
+            };
+        }
+
+        // 组合器(when_all/when_any)需要直接接管Future的共享状态
+        struct Access {
+            template<typename T>
+            static std::shared_ptr<SharedState<T>> take_state(Future<T>& future) {
+                if (!future.state_) throw_no_state();
+                return std::move(future.state_);
+            }
+        };
+    }
+
+    // 最后一个副本在设置结果之前销毁时，Future以std::future_error(broken_promise)结束
+    template<typename T>
+    class Promise {
+    private:
+        std::shared_ptr<future_detail::PromiseOwner<T>> owner_ =
+            std::make_shared<future_detail::PromiseOwner<T>>();
+
+        future_detail::SharedState<T>& state() const {
+            if (!owner_) future_detail::throw_no_state();
+            return *owner_->state;
+        }
+
+    public:
+        Future<T> get_future() {
+            state();
+            return Future<T>(owner_->state);
+        }
+
+        template<typename... Args>
+        void set_value(Args&&... args) {
+            state().set_value(std::forward<Args>(args)...);
+        }
+
+        void set_exception(std::exception_ptr e) {
+            state().set_exception(std::move(e));
+        }
+    };
+
+    template<typename T>
+    class Future {
+    private:
+        using State = future_detail::SharedState<T>;
+        std::shared_ptr<State> state_;
+
+        template<typename> friend class Promise;
+        friend struct future_detail::Access;
+
+        explicit Future(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+        // schedule决定continuation在哪里执行：内联或者投递到线程池。
+        // schedule(task, promise)无法调度task(例如线程池已停止)或者task被丢弃时，用promise报告异常
+        template<typename Schedule, typename F>
+        auto then_impl(Schedule schedule, F&& f) {
+            using R = future_detail::then_result_t<std::decay_t<F>, T>;
+            if (!state_) future_detail::throw_no_state();
+
+            Promise<R> promise;
+            Future<R> result = promise.get_future();
+            auto fn = std::make_shared<std::decay_t<F>>(std::forward<F>(f));
+            auto state = std::move(state_);
+
+            state->on_ready([promise, fn, schedule](std::shared_ptr<State> st) mutable {
+                schedule([promise, fn, st]() mutable {
+                    if (st->error) {
+                        promise.set_exception(st->error);
+                    } else if constexpr (std::is_void_v<T>) {
+                        future_detail::fulfill(promise, *fn);
+                    } else {
+                        future_detail::fulfill(promise, *fn, std::move(*st->value));
+                    }
+                }, promise);
+            });
+            return result;
+        }
+
+    public:
+        Future() = default;
+
+        bool valid() const {
+            return state_ != nullptr;
+        }
+
+        // 无效的Future(默认构造或者已被消费)上调用is_ready/wait/get/then抛出std::future_error(no_state)
+        bool is_ready() const {
+            if (!state_) future_detail::throw_no_state();
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            return state_->ready;
+        }
+
+        // 阻塞等待，仅用于和同步代码衔接(例如main线程取最终结果)
+        void wait() const {
+            if (!state_) future_detail::throw_no_state();
+            state_->wait();
+        }
+
+        T get() {
+            if (!state_) future_detail::throw_no_state();
+            state_->wait();
+            auto state = std::move(state_);
+            if (state->error) std::rethrow_exception(state->error);
+            if constexpr (!std::is_void_v<T>) {
+                return std::move(*state->value);
+            }
+        }
+
+        // continuation在完成结果的线程上内联执行，适合很轻的后续处理
+        template<typename F>
+        auto then(F&& f) {
+            return then_impl([](auto&& task, auto&) { task(); }, std::forward<F>(f));
+        }
+
+        // continuation投递到线程池执行，不占用完成结果的线程。
+        // 线程池已经停止(例如正在析构)时，返回的Future以post抛出的std::runtime_error结束；
+        // 排队中被shutdown_now()丢弃时以TaskCancelled结束
+        template<typename F>
+        auto then(ThreadPool& pool, F&& f) {
+            return then_impl([&pool](auto&& task, auto& promise) {
+                try {
+                    pool.post(std::move(task), future_detail::cancel_on_drop(promise));
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+            }, std::forward<F>(f));
+        }
+    };
+
+    template<typename T>
+    Future<std::decay_t<T>> make_ready_future(T&& value) {
+        Promise<std::decay_t<T>> promise;
+        promise.set_value(std::forward<T>(value));
+        return promise.get_future();
+    }
+
+    inline Future<void> make_ready_future() {
+        Promise<void> promise;
+        promise.set_value();
+        return promise.get_future();
+    }
+
+    // 在线程池上执行f，返回Future(与ThreadPool::enqueue相比不创建std::packaged_task)。
+    // 排队中被shutdown_now()丢弃时Future以TaskCancelled结束
+    template<typename F, typename... Args>
+    auto async(ThreadPool& pool, F&& f, Args&&... args) {
+        using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+        Promise<R> promise;
+        Future<R> result = promise.get_future();
+        auto task = std::make_shared<std::tuple<std::decay_t<F>, std::decay_t<Args>...>>(
+            std::forward<F>(f), std::forward<Args>(args)...);
+        pool.post([promise, task]() mutable {
+            std::apply([&](auto& fn, auto&... a) { future_detail::fulfill(promise, fn, a...); }, *task);
+        }, future_detail::cancel_on_drop(promise));
+        return result;
+    }
+
+    // 所有Future完成后得到结果数组(顺序与输入一致)；任何一个失败则整体以第一个异常失败
+    template<typename T>
+    Future<std::vector<T>> when_all(std::vector<Future<T>> futures) {
+        struct Context {
+            Promise<std::vector<T>> promise;
+            std::vector<std::optional<T>> results;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            explicit Context(size_t n) : results(n), remaining(n) {}
+        };
+
+        auto context = std::make_shared<Context>(futures.size());
+        Future<std::vector<T>> result = context->promise.get_future();
+        if (futures.empty()) {
+            context->promise.set_value();
+            return result;
+        }
+
+        for (size_t i = 0; i < futures.size(); ++i) {
+            auto state = future_detail::Access::take_state(futures[i]);
+            state->on_ready([context, i](std::shared_ptr<future_detail::SharedState<T>> st) {
+                if (st->error) {
+                    if (!context->failed.exchange(true)) {
+                        context->promise.set_exception(st->error);
+                    }
+                } else {
+                    context->results[i] = std::move(*st->value);
+                }
+                // 最后一个完成者负责汇总
+                if (context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                    !context->failed.load(std::memory_order_acquire)) {
+                    std::vector<T> values;
+                    values.reserve(context->results.size());
+                    for (auto& v : context->results) {
+                        values.push_back(std::move(*v));
+                    }
+                    context->promise.set_value(std::move(values));
+                }
+            });
+        }
+        return result;
+    }
+
+    inline Future<void> when_all(std::vector<Future<void>> futures) {
+        struct Context {
+            Promise<void> promise;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            explicit Context(size_t n) : remaining(n) {}
+        };
+
+        auto context = std::make_shared<Context>(futures.size());
+        Future<void> result = context->promise.get_future();
+        if (futures.empty()) {
+            context->promise.set_value();
+            return result;
+        }
+
+        for (auto& future : futures) {
+            auto state = future_detail::Access::take_state(future);
+            state->on_ready([context](std::shared_ptr<future_detail::SharedState<void>> st) {
+                if (st->error && !context->failed.exchange(true)) {
+                    context->promise.set_exception(st->error);
+                }
+                if (context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                    !context->failed.load(std::memory_order_acquire)) {
+                    context->promise.set_value();
+                }
+            });
+        }
+        return result;
+    }
+
+    // 不同类型的Future组合成tuple
+    template<typename... Ts>
+    Future<std::tuple<Ts...>> when_all_of(Future<Ts>... futures) {
+        static_assert(sizeof...(Ts) > 0, "when_all_of需要至少一个Future");
+        static_assert((!std::is_void_v<Ts> && ...), "when_all_of不支持Future<void>");
+
+        struct Context {
+            Promise<std::tuple<Ts...>> promise;
+            std::tuple<std::optional<Ts>...> results;
+            std::atomic<size_t> remaining{sizeof...(Ts)};
+            std::atomic<bool> failed{false};
+        };
+
+        auto context = std::make_shared<Context>();
+        Future<std::tuple<Ts...>> result = context->promise.get_future();
+
+        auto attach = [&context]<size_t I, typename U>(std::integral_constant<size_t, I>, Future<U>& future) {
+            auto state = future_detail::Access::take_state(future);
+            state->on_ready([context](std::shared_ptr<future_detail::SharedState<U>> st) {
+                if (st->error) {
+                    if (!context->failed.exchange(true)) {
+                        context->promise.set_exception(st->error);
+                    }
+                } else {
+                    std::get<I>(context->results) = std::move(*st->value);
+                }
+                if (context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                    !context->failed.load(std::memory_order_acquire)) {
+                    context->promise.set_value(std::apply([](auto&... v) {
+                        return std::tuple<Ts...>(std::move(*v)...);
+                    }, context->results));
+                }
+            });
+        };
+
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (attach(std::integral_constant<size_t, Is>{}, futures), ...);
+        }(std::index_sequence_for<Ts...>{});
+        return result;
+    }
+
+    // when_any的结果：第一个完成的Future的下标和值
+    template<typename T>
+    struct WhenAnyResult {
+        size_t index;
+        T value;
+    };
+
+    // 第一个完成的Future(成功或失败)决定结果；Future<void>只返回下标
+    template<typename T>
+    auto when_any(std::vector<Future<T>> futures) {
+        using result_type = std::conditional_t<std::is_void_v<T>, size_t, WhenAnyResult<T>>;
+        if (futures.empty()) throw std::invalid_argument("when_any on empty input");
+
+        struct Context {
+            Promise<result_type> promise;
+            std::atomic<bool> done{false};
+        };
+        auto context = std::make_shared<Context>();
+        Future<result_type> result = context->promise.get_future();
+
+        for (size_t i = 0; i < futures.size(); ++i) {
+            auto state = future_detail::Access::take_state(futures[i]);
+            state->on_ready([context, i](std::shared_ptr<future_detail::SharedState<T>> st) {
+                // 只有第一个完成者写入结果，其余结果被丢弃
+                if (context->done.exchange(true)) return;
+                if (st->error) {
+                    context->promise.set_exception(st->error);
+                } else if constexpr (std::is_void_v<T>) {
+                    context->promise.set_value(i);
+                } else {
+                    context->promise.set_value(result_type{i, std::move(*st->value)});
+                }
+            });
+        }
+        return result;
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_FUTURE_H
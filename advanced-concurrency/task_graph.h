@@ -0,0 +1,289 @@
+#ifndef CPP_LEARNING_DEMO_TASK_GRAPH_H
+#define CPP_LEARNING_DEMO_TASK_GRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+namespace advanced_concurrency_demo {
+    // 任务图(DAG)：节点声明依赖关系，执行器按入度把就绪节点派发到线程池
+    //
+    // 构建阶段可以任意添加节点和边；第一次执行(或修改后再次执行)时做拓扑排序、
+    // 检测环，并一次性分配所有运行期状态。之后重复执行同一个图不再分配内存。
+    class TaskGraph {
+    public:
+        using NodeId = size_t;
+
+        NodeId add_node(std::string name, std::function<void()> work) {
+            nodes_.push_back(Node{std::move(name), std::move(work), {}, 0});
+            prepared_ = false;
+            return nodes_.size() - 1;
+        }
+
+        NodeId add_node(std::string name, std::function<void()> work, std::initializer_list<NodeId> dependencies) {
+            NodeId id = add_node(std::move(name), std::move(work));
+            for (NodeId dependency : dependencies) {
+                add_dependency(dependency, id);
+            }
+            return id;
+        }
+
+        // after依赖before：before完成后after才能开始
+        void add_dependency(NodeId before, NodeId after) {
+            if (before >= nodes_.size() || after >= nodes_.size()) {
+                throw std::out_of_range("TaskGraph::add_dependency: unknown node");
+            }
+            nodes_[before].successors.push_back(after);
+            ++nodes_[after].in_degree;
+            prepared_ = false;
+        }
+
+        size_t size() const {
+            return nodes_.size();
+        }
+
+        const std::string& name(NodeId id) const {
+            return nodes_.at(id).name;
+        }
+
+        // 拓扑排序并检测环；有环时抛出std::logic_error
+        void prepare() {
+            if (prepared_) return;
+
+            const size_t n = nodes_.size();
+            topological_order_.clear();
+            topological_order_.reserve(n);
+            std::vector<size_t> degree(n);
+            for (size_t i = 0; i < n; ++i) {
+                degree[i] = nodes_[i].in_degree;
+                if (degree[i] == 0) topological_order_.push_back(i);
+            }
+            for (size_t head = 0; head < topological_order_.size(); ++head) {
+                for (NodeId next : nodes_[topological_order_[head]].successors) {
+                    if (--degree[next] == 0) topological_order_.push_back(next);
+                }
+            }
+            if (topological_order_.size() != n) {
+                // 剩余入度不为0的节点都在环上或依赖环
+                std::string members;
+                for (size_t i = 0; i < n && members.size() < 200; ++i) {
+                    if (degree[i] != 0) {
+                        members += (members.empty() ? "" : ", ") + nodes_[i].name;
+                    }
+                }
+                throw std::logic_error("TaskGraph contains a cycle involving: " + members);
+            }
+
+            roots_.clear();
+            for (size_t i = 0; i < n; ++i) {
+                if (nodes_[i].in_degree == 0) roots_.push_back(i);
+            }
+
+            // 运行期状态一次性分配，之后的每次执行只重置数值
+            pending_ = std::make_unique<std::atomic<size_t>[]>(n);
+            start_ns_.assign(n, 0);
+            end_ns_.assign(n, 0);
+            path_length_ns_.assign(n, 0);
+            path_parent_.assign(n, kNoParent);
+            prepared_ = true;
+        }
+
+    private:
+        friend class TaskGraphExecutor;
+
+        static constexpr NodeId kNoParent = static_cast<NodeId>(-1);
+
+        struct Node {
+            std::string name;
+            std::function<void()> work;
+            std::vector<NodeId> successors;
+            size_t in_degree;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<NodeId> topological_order_;
+        std::vector<NodeId> roots_;
+        bool prepared_ = false;
+
+        // 运行期状态(由执行器使用)
+        std::unique_ptr<std::atomic<size_t>[]> pending_;
+        std::vector<std::int64_t> start_ns_;
+        std::vector<std::int64_t> end_ns_;
+        std::vector<std::int64_t> path_length_ns_;
+        std::vector<NodeId> path_parent_;
+    };
+
+    // 一次执行的计时报告
+    struct TaskGraphReport {
+        double wall_seconds = 0.0;           // 从派发第一个节点到最后一个节点完成
+        double total_work_seconds = 0.0;     // 所有节点执行时间之和
+        double critical_path_seconds = 0.0;  // 按实际节点耗时计算的最长依赖链
+        std::vector<TaskGraph::NodeId> critical_path;
+
+        // 图本身允许的平均并行度上限
+        double parallelism() const {
+            return critical_path_seconds > 0 ? total_work_seconds / critical_path_seconds : 0.0;
+        }
+    };
+
+    class TaskGraphExecutor {
+    private:
+        ThreadPool& pool_;
+
+        // 一次执行的共享状态，run()返回前一直存活
+        struct RunState {
+            TaskGraph* graph;
+            std::chrono::steady_clock::time_point origin;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+            std::mutex done_mutex;
+            std::condition_variable done_cv;
+            bool done = false;
+        };
+
+        // 记为这次执行的错误，并在当前线程上完成节点id及其下游的记账(失败后节点体不再执行)
+        void abandon(RunState* state, TaskGraph::NodeId id, std::exception_ptr error) {
+            if (!state->failed.exchange(true)) {
+                state->error = std::move(error);
+            }
+            execute(state, id);
+        }
+
+        // 线程池已停止时post抛出异常，排队中的节点也可能被shutdown_now()丢弃：两种情况都由abandon
+        // 完成记账，remaining仍然归零，run()等所有已经投递的节点结束后才返回
+        void dispatch(RunState* state, TaskGraph::NodeId id) {
+            try {
+                pool_.post([this, state, id] { execute(state, id); }, [this, state, id] {
+                    abandon(state, id, std::make_exception_ptr(TaskCancelled(false)));
+                });
+            } catch (...) {
+                abandon(state, id, std::current_exception());
+            }
+        }
+
+        static std::int64_t elapsed_ns(const RunState* state) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - state->origin).count();
+        }
+
+        void execute(RunState* state, TaskGraph::NodeId id) {
+            TaskGraph& graph = *state->graph;
+            // 一条依赖链上的下一个就绪节点直接在当前线程继续执行，省去一次入队
+            while (id != TaskGraph::kNoParent) {
+                graph.start_ns_[id] = elapsed_ns(state);
+                if (!state->failed.load(std::memory_order_acquire)) {
+                    try {
+                        graph.nodes_[id].work();
+                    } catch (...) {
+                        if (!state->failed.exchange(true)) {
+                            state->error = std::current_exception();
+                        }
+                    }
+                }
+                graph.end_ns_[id] = elapsed_ns(state);
+
+                TaskGraph::NodeId next = TaskGraph::kNoParent;
+                for (TaskGraph::NodeId successor : graph.nodes_[id].successors) {
+                    if (graph.pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        if (next == TaskGraph::kNoParent) {
+                            next = successor;
+                        } else {
+                            dispatch(state, successor);
+                        }
+                    }
+                }
+
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(state->done_mutex);
+                    state->done = true;
+                    state->done_cv.notify_one();
+                }
+                id = next;
+            }
+        }
+
+        static TaskGraphReport build_report(TaskGraph& graph, std::int64_t wall_ns) {
+            TaskGraphReport report;
+            report.wall_seconds = wall_ns / 1e9;
+
+            // 沿拓扑序做最长路径动态规划
+            std::int64_t total_ns = 0;
+            TaskGraph::NodeId tail = TaskGraph::kNoParent;
+            std::int64_t longest = -1;
+            for (TaskGraph::NodeId id : graph.topological_order_) {
+                graph.path_length_ns_[id] = 0;
+                graph.path_parent_[id] = TaskGraph::kNoParent;
+            }
+            for (TaskGraph::NodeId id : graph.topological_order_) {
+                std::int64_t duration = graph.end_ns_[id] - graph.start_ns_[id];
+                total_ns += duration;
+                std::int64_t length = graph.path_length_ns_[id] + duration;
+                graph.path_length_ns_[id] = length;
+                if (length > longest) {
+                    longest = length;
+                    tail = id;
+                }
+                for (TaskGraph::NodeId successor : graph.nodes_[id].successors) {
+                    if (length >= graph.path_length_ns_[successor]) {
+                        graph.path_length_ns_[successor] = length;
+                        graph.path_parent_[successor] = id;
+                    }
+                }
+            }
+
+            report.total_work_seconds = total_ns / 1e9;
+            report.critical_path_seconds = longest > 0 ? longest / 1e9 : 0.0;
+            for (TaskGraph::NodeId id = tail; id != TaskGraph::kNoParent; id = graph.path_parent_[id]) {
+                report.critical_path.push_back(id);
+            }
+            std::reverse(report.critical_path.begin(), report.critical_path.end());
+            return report;
+        }
+
+    public:
+        explicit TaskGraphExecutor(ThreadPool& pool) : pool_(pool) {}
+
+        // 执行整个图并等待完成；任何节点抛出的第一个异常会在这里重新抛出，
+        // 失败之后尚未开始的节点不再执行
+        TaskGraphReport run(TaskGraph& graph) {
+            graph.prepare();
+            const size_t n = graph.size();
+            if (n == 0) return {};
+
+            for (size_t i = 0; i < n; ++i) {
+                graph.pending_[i].store(graph.nodes_[i].in_degree, std::memory_order_relaxed);
+            }
+
+            RunState state;
+            state.graph = &graph;
+            state.remaining.store(n, std::memory_order_relaxed);
+            state.origin = std::chrono::steady_clock::now();
+            for (TaskGraph::NodeId root : graph.roots_) {
+                dispatch(&state, root);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(state.done_mutex);
+                state.done_cv.wait(lock, [&state] { return state.done; });
+            }
+            std::int64_t wall_ns = elapsed_ns(&state);
+
+            if (state.error) std::rethrow_exception(state.error);
+            return build_report(graph, wall_ns);
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_TASK_GRAPH_H
@@ -0,0 +1,524 @@
+#ifndef CPP_LEARNING_DEMO_THREAD_POOL_H
+#define CPP_LEARNING_DEMO_THREAD_POOL_H
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+#include <future>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <chrono>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include "../performance-benchmarking/latency_histogram.h"
+#include "../performance-benchmarking/trace.h"
+
+namespace advanced_concurrency_demo {
+    // 任务被取消或超时后，TaskHandle的future中保存的异常
+    class TaskCancelled : public std::runtime_error {
+    private:
+        bool timed_out_;
+
+    public:
+        explicit TaskCancelled(bool timed_out)
+            : std::runtime_error(timed_out ? "task timed out" : "task cancelled"), timed_out_(timed_out) {}
+
+        bool timed_out() const {
+            return timed_out_;
+        }
+    };
+
+    class ThreadPool;
+
+    namespace thread_pool_detail {
+        class TaskControlBase;
+
+        // 超时表：按截止时间排序，控制块保存自己的迭代器以便提前摘除
+        using DeadlineMap = std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<TaskControlBase>>;
+
+        // 可取消任务的控制块：状态机保证"开始执行"和"取消"只有一个生效
+        class TaskControlBase {
+        protected:
+            friend class advanced_concurrency_demo::ThreadPool;
+
+            enum class State { Queued, Running, Finished, Cancelled };
+
+            std::mutex mutex_;
+            State state_ = State::Queued;
+            std::stop_source source_;
+
+            // 所属线程池，排队期间被取消时用它把任务从队列中摘除
+            ThreadPool* pool_ = nullptr;
+            // 是否登记过超时；提交前设置，之后只读
+            bool timed_ = false;
+            // 超时表中的位置，由watchdog_mutex保护
+            bool has_deadline_ = false;
+            DeadlineMap::iterator deadline_{};
+
+            // 在取消时调用：释放可调用对象及其捕获的资源，并让future以TaskCancelled结束
+            virtual void abandon(bool timed_out) = 0;
+            // 在工作线程上执行任务体
+            virtual void invoke(std::stop_token token) = 0;
+
+        public:
+            virtual ~TaskControlBase() = default;
+
+            // 排队中的任务立即从队列和超时表中移除(返回true)；运行中的任务只会收到停止请求
+            bool cancel(bool timed_out);
+
+            bool stop_requested() const {
+                return source_.stop_requested();
+            }
+
+            // pool_token是线程池的停止令牌，shutdown_now()时转发给正在运行的任务
+            void run(std::stop_token pool_token) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (state_ != State::Queued) return;
+                    state_ = State::Running;
+                }
+                {
+                    std::stop_callback forward(pool_token, [this] { source_.request_stop(); });
+                    invoke(source_.get_token());
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                state_ = State::Finished;
+            }
+        };
+
+        template<typename R, typename F>
+        class TaskControl : public TaskControlBase {
+        private:
+            std::promise<R> promise_;
+            std::optional<F> body_;
+
+            void abandon(bool timed_out) override {
+                // 异常对象只创建一次，批量丢弃任务时只增加引用计数
+                static const std::exception_ptr cancelled = std::make_exception_ptr(TaskCancelled(false));
+                static const std::exception_ptr expired = std::make_exception_ptr(TaskCancelled(true));
+                body_.reset();
+                promise_.set_exception(timed_out ? expired : cancelled);
+            }
+
+            void invoke(std::stop_token token) override {
+                try {
+                    if constexpr (std::is_void_v<R>) {
+                        (*body_)(token);
+                        promise_.set_value();
+                    } else {
+                        promise_.set_value((*body_)(token));
+                    }
+                } catch (...) {
+                    promise_.set_exception(std::current_exception());
+                }
+                body_.reset();
+            }
+
+        public:
+            explicit TaskControl(F body) : body_(std::move(body)) {}
+
+            std::future<R> get_future() {
+                return promise_.get_future();
+            }
+        };
+    }
+
+    // 可取消任务的句柄
+    template<typename R>
+    class TaskHandle {
+    private:
+        friend class ThreadPool;
+        std::shared_ptr<thread_pool_detail::TaskControlBase> control_;
+        std::future<R> future_;
+
+    public:
+        TaskHandle(std::shared_ptr<thread_pool_detail::TaskControlBase> control, std::future<R> future)
+            : control_(std::move(control)), future_(std::move(future)) {}
+
+        // 请求取消；任务尚未开始时立即释放其资源并返回true
+        bool cancel() {
+            return control_->cancel(false);
+        }
+
+        bool stop_requested() const {
+            return control_->stop_requested();
+        }
+
+        std::future<R>& future() {
+            return future_;
+        }
+
+        // 被取消或超时的任务抛出TaskCancelled
+        R get() {
+            return future_.get();
+        }
+    };
+
+    // 线程池实现
+    class ThreadPool {
+    private:
+        // 队列元素：普通任务只有fn(以及可选的on_drop)，可取消任务只有control
+        struct Job {
+            std::function<void()> fn;
+            std::shared_ptr<thread_pool_detail::TaskControlBase> control;
+            // shutdown_now()丢弃这个任务时调用，让等待结果的一方失败而不是永远等下去
+            std::function<void()> on_drop{};
+            // 开启延迟统计时记录入队时间，否则保持默认值
+            std::chrono::steady_clock::time_point enqueued_at{};
+#if TRACE_ENABLED
+            // 入队时间，用于记录排队等待时长
+            std::uint64_t enqueued = performance_benchmarking_demo::trace_ticks();
+#endif
+        };
+
+        friend class thread_pool_detail::TaskControlBase;
+
+        std::vector<std::thread> workers;
+        // 任务数组
+        std::deque<Job> tasks;
+        std::mutex queue_mutex;
+        std::condition_variable condition;
+        bool stop;
+        // shutdown_now()通过它向正在运行的可取消任务发出停止请求
+        std::stop_source pool_stop;
+
+        // 超时看门狗线程，首次提交带超时的任务时才启动
+        std::thread watchdog;
+        thread_pool_detail::DeadlineMap deadlines;
+        std::mutex watchdog_mutex;
+        std::condition_variable watchdog_cv;
+        bool watchdog_stop = false;
+
+        // 任务延迟统计，默认关闭；每个工作线程写自己的分片
+        std::atomic<bool> latency_tracking{false};
+        performance_benchmarking_demo::LatencyRecorder queue_wait_latency;
+        performance_benchmarking_demo::LatencyRecorder run_latency;
+
+        void stamp(Job& job) {
+            if (latency_tracking.load(std::memory_order_relaxed)) {
+                job.enqueued_at = std::chrono::steady_clock::now();
+            }
+        }
+
+        void watchdog_loop() {
+            std::unique_lock<std::mutex> lock(watchdog_mutex);
+            while (!watchdog_stop) {
+                if (deadlines.empty()) {
+                    watchdog_cv.wait(lock);
+                    continue;
+                }
+                auto when = deadlines.begin()->first;
+                if (watchdog_cv.wait_until(lock, when) == std::cv_status::no_timeout) {
+                    continue;  // 被唤醒：可能有更早的截止时间或者需要退出
+                }
+                auto now = std::chrono::steady_clock::now();
+                while (!deadlines.empty() && deadlines.begin()->first <= now) {
+                    auto control = deadlines.begin()->second.lock();
+                    deadlines.erase(deadlines.begin());
+                    if (control) {
+                        control->has_deadline_ = false;
+                        lock.unlock();
+                        control->cancel(true);
+                        lock.lock();
+                    }
+                }
+            }
+        }
+
+        void push_job(Job job) {
+            stamp(job);
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                if(stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+                tasks.push_back(std::move(job));
+            }
+            condition.notify_one();
+        }
+
+        // 由TaskControlBase::cancel()在持有控制块的锁时调用：工作线程取出任务后要先拿到这把锁才能结束它，
+        // 所以任务还在队列中时线程池不会析构。队列按提交顺序线性查找
+        void unlink(thread_pool_detail::TaskControlBase* control) {
+            Job removed;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                auto it = std::find_if(tasks.begin(), tasks.end(), [control](const Job& job) {
+                    return job.control.get() == control;
+                });
+                if (it != tasks.end()) {
+                    removed = std::move(*it);
+                    tasks.erase(it);
+                }
+            }
+            forget_deadline(control);
+        }
+
+        // 任务结束或被取消后删除它的超时登记，不必等到截止时间
+        void forget_deadline(thread_pool_detail::TaskControlBase* control) {
+            if (!control->timed_) return;
+            std::lock_guard<std::mutex> lock(watchdog_mutex);
+            if (control->has_deadline_) {
+                deadlines.erase(control->deadline_);
+                control->has_deadline_ = false;
+            }
+        }
+
+        template<class F, class... Args>
+        auto make_cancellable(F&& f, Args&&... args) {
+            using return_type = std::invoke_result_t<std::decay_t<F>&, std::stop_token, std::decay_t<Args>&...>;
+            auto body = [fn = std::forward<F>(f), ...bound = std::forward<Args>(args)](std::stop_token token) mutable {
+                return std::invoke(fn, token, bound...);
+            };
+            auto control = std::make_shared<thread_pool_detail::TaskControl<return_type, decltype(body)>>(std::move(body));
+            control->pool_ = this;
+            return TaskHandle<return_type>(control, control->get_future());
+        }
+
+        void stop_watchdog() {
+            {
+                std::lock_guard<std::mutex> lock(watchdog_mutex);
+                watchdog_stop = true;
+            }
+            watchdog_cv.notify_all();
+            if (watchdog.joinable()) watchdog.join();
+        }
+
+        // 跳过当前线程：shutdown_now()可能由工作线程上的任务调用，这个线程在任务返回后自行退出
+        void join_workers() {
+            const auto self = std::this_thread::get_id();
+            for(std::thread &worker: workers) {
+                if (worker.joinable() && worker.get_id() != self) worker.join();
+            }
+        }
+
+    public:
+        ThreadPool(size_t threads) : stop(false) {
+            for(size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this, i] {
+                    TRACE_THREAD_NAME("pool worker " + std::to_string(i));
+                    (void)i;
+                    for(;;) {
+                        Job job;
+                        {
+                            std::unique_lock<std::mutex> lock(this->queue_mutex);
+                            // 条件变量，没有任务以及没有退出信号会阻塞住
+                            this->condition.wait(lock, [this]{ return this->stop || !this->tasks.empty(); });
+                            // 如果是退出信号
+                            if(this->stop && this->tasks.empty()) return;
+                            // 获取一个任务
+                            job = std::move(this->tasks.front());
+                            this->tasks.pop_front();
+                        }
+                        // 从入队到被取出的时间记为queue_wait，执行时间记为run
+                        TRACE_COMPLETE("queue_wait", job.enqueued, performance_benchmarking_demo::trace_ticks());
+                        TRACE_SCOPE("run");
+                        const bool timed = job.enqueued_at != std::chrono::steady_clock::time_point{};
+                        std::chrono::steady_clock::time_point started;
+                        if (timed) {
+                            started = std::chrono::steady_clock::now();
+                            queue_wait_latency.record(started - job.enqueued_at);
+                        }
+                        // 无锁环境下执行任务；已取消的任务在run()里直接跳过
+                        if (job.control) {
+                            job.control->run(pool_stop.get_token());
+                            forget_deadline(job.control.get());
+                        } else {
+                            job.fn();
+                        }
+                        if (timed) run_latency.record(std::chrono::steady_clock::now() - started);
+                    }
+                });
+            }
+        }
+
+        template<class F, class... Args>
+        auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+            // 这个类型萃取，获取返回值类型
+            using return_type = std::invoke_result_t<F, Args...>;
+
+            // 定义一个封装任务，使用了完美转发
+            auto task = std::make_shared<std::packaged_task<return_type()>>(
+                std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+            );
+
+            // 获取任务的future对象
+            std::future<return_type> res = task->get_future();
+            // 任务入队并唤醒一个等待的线程执行
+            push_job(Job{[task](){ (*task)(); }, nullptr});
+            // 返回future对象
+            return res;
+        }
+
+        // 提交一个不需要返回值的任务，不创建packaged_task和future
+        // Future的continuation通过它调度，避免每个任务额外的共享状态分配
+        template<class F>
+        void post(F&& f) {
+            post(std::forward<F>(f), nullptr);
+        }
+
+        // on_drop在任务被shutdown_now()丢弃时代替f调用(在调用shutdown_now()的线程上，不能抛出异常)，
+        // 例如把对应的Promise设为TaskCancelled；没有on_drop的任务被静默丢弃
+        template<class F, class D>
+        void post(F&& f, D&& on_drop) {
+            Job job{std::forward<F>(f), nullptr, std::forward<D>(on_drop)};
+            stamp(job);
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                if(stop) throw std::runtime_error("post on stopped ThreadPool");
+                tasks.push_back(std::move(job));
+            }
+            condition.notify_one();
+        }
+
+        // 协程调度：co_await pool.schedule() 之后，协程的剩余部分在线程池的某个工作线程上继续
+        // 线程池已停止时在co_await处抛出std::runtime_error；排队期间被shutdown_now()丢弃时，
+        // 协程在调用shutdown_now()的线程上恢复，co_await处抛出TaskCancelled
+        struct ScheduleAwaiter {
+            ThreadPool& pool;
+            bool dropped = false;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                pool.post([h] { h.resume(); }, [this, h] {
+                    dropped = true;
+                    h.resume();
+                });
+            }
+
+            void await_resume() const {
+                if (dropped) throw TaskCancelled(false);
+            }
+        };
+
+        ScheduleAwaiter schedule() {
+            return ScheduleAwaiter{*this};
+        }
+
+        // 提交可取消任务：f的第一个参数是std::stop_token，运行中的任务需要自行检查它
+        template<class F, class... Args>
+        auto enqueue_cancellable(F&& f, Args&&... args) {
+            auto handle = make_cancellable(std::forward<F>(f), std::forward<Args>(args)...);
+            push_job(Job{nullptr, handle.control_});
+            return handle;
+        }
+
+        // 提交带超时的可取消任务：截止时间到达时仍在排队则直接丢弃，正在运行则请求停止
+        template<class Rep, class Period, class F, class... Args>
+        auto enqueue_with_timeout(std::chrono::duration<Rep, Period> timeout, F&& f, Args&&... args) {
+            auto handle = make_cancellable(std::forward<F>(f), std::forward<Args>(args)...);
+            auto* control = handle.control_.get();
+            control->timed_ = true;
+            // 先登记超时再入队，任务结束时一定能找到并删除这条登记
+            {
+                std::lock_guard<std::mutex> lock(watchdog_mutex);
+                if (!watchdog.joinable()) {
+                    watchdog = std::thread([this] { watchdog_loop(); });
+                }
+                control->deadline_ = deadlines.emplace(std::chrono::steady_clock::now() + timeout, handle.control_);
+                control->has_deadline_ = true;
+            }
+            watchdog_cv.notify_one();
+            try {
+                push_job(Job{nullptr, handle.control_});
+            } catch (...) {
+                forget_deadline(control);
+                throw;
+            }
+            return handle;
+        }
+
+        size_t size() const {
+            return workers.size();
+        }
+
+        // 开启后记录之后提交的每个任务的排队等待时间(入队到被取出)和执行时间
+        // 关闭时每次提交只多一次relaxed原子读
+        void set_latency_tracking(bool enabled) {
+            latency_tracking.store(enabled, std::memory_order_relaxed);
+        }
+
+        struct LatencyStats {
+            performance_benchmarking_demo::LatencyHistogram queue_wait;
+            performance_benchmarking_demo::LatencyHistogram run;
+        };
+
+        // 合并所有工作线程记录的延迟分布(纳秒)
+        LatencyStats latency_stats() const {
+            return LatencyStats{queue_wait_latency.snapshot(), run_latency.snapshot()};
+        }
+
+        // 清空延迟统计；应在没有任务执行时调用
+        void reset_latency_stats() {
+            queue_wait_latency.reset();
+            run_latency.reset();
+        }
+
+        // 立即关闭：丢弃所有排队任务，向正在运行的可取消任务发出停止请求，然后等待工作线程退出。
+        // 被丢弃的任务：可取消任务的future得到TaskCancelled，enqueue()的future得到broken_promise，
+        // post()提交的任务调用它的on_drop(async()和then(pool, ...)的Future得到TaskCancelled，
+        // 在schedule()处挂起的协程恢复并抛出TaskCancelled)，没有on_drop的任务直接销毁。
+        // 可以在工作线程上的任务里调用：当前工作线程不等待自己，任务返回后退出，由析构函数回收。
+        // 返回被丢弃的任务数(之前已取消的任务不在队列中，不计入)。
+        size_t shutdown_now() {
+            std::deque<Job> discarded;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                stop = true;
+                std::swap(discarded, tasks);
+            }
+            pool_stop.request_stop();
+            condition.notify_all();
+            // 先让工作线程尽快退出，再在当前线程完成被丢弃任务的清理
+            join_workers();
+            stop_watchdog();
+
+            size_t count = discarded.size();
+            while (!discarded.empty()) {
+                Job& job = discarded.front();
+                if (job.control) {
+                    job.control->cancel(false);
+                } else if (job.on_drop) {
+                    job.on_drop();
+                }
+                discarded.pop_front();
+            }
+            return count;
+        }
+
+        // 析构时仍然执行完队列中的所有任务；需要快速退出时先调用shutdown_now()
+        ~ThreadPool() {
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                // 设置为退出信号
+                stop = true;
+            }
+            condition.notify_all();
+            // 等待所有workers退出
+            join_workers();
+            stop_watchdog();
+        }
+    };
+
+    inline bool thread_pool_detail::TaskControlBase::cancel(bool timed_out) {
+        source_.request_stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ != State::Queued) return false;
+            state_ = State::Cancelled;
+            if (pool_) pool_->unlink(this);
+        }
+        abandon(timed_out);
+        return true;
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_THREAD_POOL_H
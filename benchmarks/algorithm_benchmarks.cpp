@@ -0,0 +1,60 @@
+// 算法性能比较：排序和查找在1K到1M元素规模下的表现
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    std::vector<int> shuffled(std::size_t n, unsigned seed) {
+        std::vector<int> data(n);
+        std::iota(data.begin(), data.end(), 0);
+        std::shuffle(data.begin(), data.end(), std::mt19937(seed));
+        return data;
+    }
+}
+
+// 每次迭代排序一份新的乱序数据，复制数据不计时
+BENCHMARK_CASE(algorithm_sort) {
+    for (std::size_t n : power_of_two_range(10, 20, 2)) {
+        const std::string size = std::to_string(n);
+        auto source = std::make_shared<std::vector<int>>();
+        auto setup = [source, n] {
+            if (source->empty()) *source = shuffled(n, 7);
+            return *source;
+        };
+        auto teardown = [](std::vector<int>&) {};
+
+        context.run_with_setup("algorithm/sort/" + size, setup,
+            [](std::vector<int>& data) { std::sort(data.begin(), data.end()); do_not_optimize(data.data()); },
+            teardown);
+        context.run_with_setup("algorithm/stable_sort/" + size, setup,
+            [](std::vector<int>& data) { std::stable_sort(data.begin(), data.end()); do_not_optimize(data.data()); },
+            teardown);
+    }
+}
+
+// 有序数据上的线性查找与二分查找
+BENCHMARK_CASE(algorithm_search) {
+    const auto sizes = power_of_two_range(10, 20, 2);
+
+    context.run_sweep("algorithm/find", sizes, [](std::size_t n) {
+        std::vector<int> data(n);
+        std::iota(data.begin(), data.end(), 0);
+        return [data = std::move(data), probes = shuffled(n, 11), i = std::size_t{0}]() mutable {
+            i = (i + 1) & (probes.size() - 1);
+            return *std::find(data.begin(), data.end(), probes[i]);
+        };
+    });
+
+    context.run_sweep("algorithm/lower_bound", sizes, [](std::size_t n) {
+        std::vector<int> data(n);
+        std::iota(data.begin(), data.end(), 0);
+        return [data = std::move(data), probes = shuffled(n, 11), i = std::size_t{0}]() mutable {
+            i = (i + 1) & (probes.size() - 1);
+            return *std::lower_bound(data.begin(), data.end(), probes[i]);
+        };
+    });
+}
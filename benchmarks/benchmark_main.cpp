@@ -0,0 +1,124 @@
+// 基准测试程序入口
+//
+// 用法: cpp_learning_benchmarks [选项]
+//   --list                只列出匹配的基准测试名
+//   --filter=REGEX        只运行名字匹配REGEX的基准测试(std::regex_search)
+//   --repetitions=N       每个基准测试重复N次，结果合并所有样本
+//   --cpu=K               单线程测量期间把测量线程固定到第K个CPU(仅Linux)；多线程基准测试不固定
+//   --samples=N           每次测量的样本数
+//   --min-time-ms=N       每个样本的最短时长
+//   --counters            同时读取硬件性能计数器
+//   --json=PATH           结果写入JSON
+//   --csv=PATH            结果写入CSV
+//   --baseline=PATH       与基线JSON比较，存在显著回归时退出码为1
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include "../performance-benchmarking/benchmark_registry.h"
+// 替换全局operator new/malloc以统计分配，整个程序只在这里包含一次
+#include "../performance-benchmarking/allocation_hooks.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    void print_usage(const char* program) {
+        std::cout << "usage: " << program
+                  << " [--list] [--filter=REGEX] [--repetitions=N] [--cpu=K] [--samples=N]"
+                     " [--min-time-ms=N] [--counters] [--json=PATH] [--csv=PATH] [--baseline=PATH]"
+                  << std::endl;
+    }
+
+    // 解析 --key=value 形式的参数，匹配时把值写入value
+    bool option_value(const std::string& arg, const std::string& key, std::string& value) {
+        std::string prefix = "--" + key + "=";
+        if (arg.rfind(prefix, 0) != 0) return false;
+        value = arg.substr(prefix.size());
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    std::string json_path, csv_path, baseline_path;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            std::string value;
+            if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--list") {
+                config.list_only = true;
+            } else if (arg == "--counters") {
+                config.options.perf_counters = true;
+            } else if (option_value(arg, "filter", value)) {
+                config.filter = std::regex(value);
+            } else if (option_value(arg, "repetitions", value)) {
+                config.repetitions = std::stoi(value);
+            } else if (option_value(arg, "cpu", value)) {
+                config.cpu = std::stoi(value);
+            } else if (option_value(arg, "samples", value)) {
+                config.options.samples = static_cast<size_t>(std::stoul(value));
+            } else if (option_value(arg, "min-time-ms", value)) {
+                config.options.min_sample_time = std::chrono::milliseconds(std::stoi(value));
+            } else if (option_value(arg, "json", value)) {
+                json_path = value;
+            } else if (option_value(arg, "csv", value)) {
+                csv_path = value;
+            } else if (option_value(arg, "baseline", value)) {
+                baseline_path = value;
+            } else {
+                std::cerr << "unknown option: " << arg << std::endl;
+                print_usage(argv[0]);
+                return 2;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "invalid option value: " << e.what() << std::endl;
+        return 2;
+    }
+
+    // 只在测量期间固定，主线程保持原来的亲和性，之后创建的线程不受影响；这里先确认该CPU可用
+    if (config.cpu >= 0 && !config.list_only) {
+        if (CpuPinScope(config.cpu).pinned()) {
+            std::cout << "pinning single-threaded measurements to CPU " << config.cpu << std::endl;
+        } else {
+            std::cerr << "warning: could not pin to CPU " << config.cpu << ", continuing unpinned" << std::endl;
+            config.cpu = -1;
+        }
+    }
+
+    BenchmarkReport report;
+    BenchmarkContext context(config, report);
+    for (const auto& entry : BenchmarkRegistry::instance().entries()) {
+        entry.function(context);
+    }
+
+    if (config.list_only) return 0;
+    if (context.selected_count() == 0) {
+        std::cerr << "no benchmark matched the filter" << std::endl;
+        return 2;
+    }
+
+    try {
+        if (!json_path.empty()) report.save(json_path);
+        if (!csv_path.empty()) {
+            std::ofstream csv(csv_path);
+            if (!csv) throw std::runtime_error("cannot open " + csv_path + " for writing");
+            report.write_csv(csv);
+        }
+        if (!baseline_path.empty()) {
+            std::cout << "\ncomparison against " << baseline_path << ":" << std::endl;
+            return print_comparison(std::cout, compare_reports(BenchmarkReport::load(baseline_path), report));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
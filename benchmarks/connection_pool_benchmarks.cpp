@@ -0,0 +1,46 @@
+// 连接池：同一个HTTP客户端对回环地址上的服务器逐个发送GET请求，测量每个请求的延迟
+//
+// pooled复用连接池中的长连接；unpooled的连接池不保留空闲连接(max_idle_per_host = 0)，
+// 每个请求都要建立新连接，请求带"Connection: close"，由服务器先关闭连接(TIME_WAIT留在服务器一侧，
+// 客户端的临时端口不会被耗尽)。两者之差就是每个请求的握手和连接建立开销；
+// 回环地址上没有网络往返时间，真实网络中的差距还要再加上至少一个RTT。
+#include <memory>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../network/connection_pool.h"
+#include "../network/http_client.h"
+#include "../network/http_server.h"
+
+using namespace performance_benchmarking_demo;
+
+#if defined(__linux__)
+namespace {
+    void hello_handler(const network_demo::HTTPRequest&, network_demo::HTTPResponse& response) {
+        response.set_body("Hello, World!");
+    }
+
+    // 每项测量自己的服务器和客户端，只在这项测量被选中时创建
+    struct HttpGetFixture {
+        network_demo::HTTPServer server;
+        std::unique_ptr<network_demo::HTTPClient> client;
+        std::string url;
+
+        explicit HttpGetFixture(bool pooled) : server(network_demo::HTTPServerOptions{}, hello_handler) {
+            server.start();
+            url = "http://127.0.0.1:" + std::to_string(server.port()) + "/hello";
+            network_demo::ConnectionPoolOptions options;
+            if (!pooled) options.max_idle_per_host = 0;
+            client = std::make_unique<network_demo::HTTPClient>(std::make_shared<network_demo::ConnectionPool>(options));
+        }
+    };
+}
+
+BENCHMARK_CASE(connection_pool_latency) {
+    const std::vector<std::string> modes = {"pooled", "unpooled"};
+    context.run_sweep("connection_pool/http_get", modes, [](const std::string& mode) {
+        auto fixture = std::make_shared<HttpGetFixture>(mode == "pooled");
+        return [fixture] { do_not_optimize(fixture->client->get(fixture->url).status); };
+    });
+}
+#endif
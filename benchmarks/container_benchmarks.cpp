@@ -0,0 +1,93 @@
+// 容器性能比较：插入、遍历和查找在1K到1M元素规模下的表现
+#include <deque>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+
+using namespace performance_benchmarking_demo;
+
+BENCHMARK_CASE(container_push_back) {
+    const auto sizes = power_of_two_range(10, 20, 2);
+
+    context.run_sweep("container/vector_push_back", sizes, [](std::size_t n) {
+        return [n] {
+            std::vector<int> v;
+            for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+            do_not_optimize(v.data());
+        };
+    });
+
+    context.run_sweep("container/vector_reserve_push_back", sizes, [](std::size_t n) {
+        return [n] {
+            std::vector<int> v;
+            v.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+            do_not_optimize(v.data());
+        };
+    });
+
+    context.run_sweep("container/deque_push_back", sizes, [](std::size_t n) {
+        return [n] {
+            std::deque<int> d;
+            for (std::size_t i = 0; i < n; ++i) d.push_back(static_cast<int>(i));
+            do_not_optimize(d.back());
+        };
+    });
+
+    context.run_sweep("container/list_push_back", sizes, [](std::size_t n) {
+        return [n] {
+            std::list<int> l;
+            for (std::size_t i = 0; i < n; ++i) l.push_back(static_cast<int>(i));
+            do_not_optimize(l.back());
+        };
+    });
+}
+
+// 遍历：连续内存与链表节点在数据超出缓存后差距明显
+BENCHMARK_CASE(container_traversal) {
+    const auto sizes = power_of_two_range(10, 20, 2);
+
+    context.run_sweep("container/vector_sum", sizes, [](std::size_t n) {
+        std::vector<int> v(n, 1);
+        return [v = std::move(v)] { return std::accumulate(v.begin(), v.end(), 0L); };
+    });
+
+    context.run_sweep("container/list_sum", sizes, [](std::size_t n) {
+        std::list<int> l(n, 1);
+        return [l = std::move(l)] { return std::accumulate(l.begin(), l.end(), 0L); };
+    });
+}
+
+// 随机键查找：有序树与哈希表
+BENCHMARK_CASE(container_lookup) {
+    const auto sizes = power_of_two_range(10, 20, 2);
+
+    auto make_keys = [](std::size_t n) {
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        return keys;
+    };
+
+    context.run_sweep("container/map_find", sizes, [&](std::size_t n) {
+        std::map<int, int> map;
+        for (int k : make_keys(n)) map.emplace(k, k);
+        return [map = std::move(map), keys = make_keys(n), i = std::size_t{0}]() mutable {
+            i = (i + 1) & (keys.size() - 1);
+            return map.find(keys[i])->second;
+        };
+    });
+
+    context.run_sweep("container/unordered_map_find", sizes, [&](std::size_t n) {
+        std::unordered_map<int, int> map;
+        for (int k : make_keys(n)) map.emplace(k, k);
+        return [map = std::move(map), keys = make_keys(n), i = std::size_t{0}]() mutable {
+            i = (i + 1) & (keys.size() - 1);
+            return map.find(keys[i])->second;
+        };
+    });
+}
@@ -0,0 +1,275 @@
+// 协程帧分配：默认operator new vs 线程局部帧池 vs 调用方提供的内存池
+//
+// 每次迭代创建一批短生命周期的Generator(range)，逐个遍历后销毁。
+// 扫描参数是每个Generator产出的元素个数：元素少时帧分配占主要开销，
+// 元素多时三种来源都趋向于纯粹的迭代吞吐量。
+//
+// Generator<std::string>迭代：旧实现每个元素复制两次(yield_value按值接收再赋值、operator*按值返回)，
+// 现在按地址产出。扫描参数是字符串长度：短字符串在SSO缓冲区内，长字符串每次复制都要分配。
+//
+// 深树遍历：逐层转发(for ... co_yield)时每个元素要经过它上面的每一层生成器，总开销O(节点数×深度)；
+// elements_of嵌套产出时消费者直接恢复最内层，每个元素O(1)。扫描参数是树的深度。
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../meta-programming/coroutines/coroutines_demo.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    constexpr int kGeneratorsPerBatch = 256;
+
+    // 调用方提供的内存池：一段预先分配的缓冲区，按max_align_t对齐顺序分配
+    // (memory-arena中的实现在其他编译单元里已经与演示函数一起定义，这里用一个最小版本)
+    class BatchArena {
+    private:
+        std::vector<std::max_align_t> buffer_;
+        std::size_t offset_ = 0;
+
+    public:
+        explicit BatchArena(std::size_t bytes) : buffer_(bytes / sizeof(std::max_align_t)) {}
+
+        void* allocate(std::size_t size) {
+            std::size_t slots = (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            if (offset_ + slots > buffer_.size()) throw std::bad_alloc();
+            void* ptr = buffer_.data() + offset_;
+            offset_ += slots;
+            return ptr;
+        }
+
+        void reset() {
+            offset_ = 0;
+        }
+    };
+
+    // 改为按地址产出之前的Generator实现，作为对照
+    template<typename T>
+    class CopyingGenerator {
+    public:
+        struct promise_type {
+            T current_value;
+
+            std::suspend_always yield_value(T value) {
+                current_value = value;
+                return {};
+            }
+
+            std::suspend_always initial_suspend() { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void unhandled_exception() { std::terminate(); }
+            void return_void() {}
+
+            CopyingGenerator get_return_object() {
+                return CopyingGenerator{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        explicit CopyingGenerator(handle_type h) : coro(h) {}
+        ~CopyingGenerator() { coro.destroy(); }
+        CopyingGenerator(const CopyingGenerator&) = delete;
+        CopyingGenerator& operator=(const CopyingGenerator&) = delete;
+
+        class Iterator {
+            handle_type coro;
+        public:
+            explicit Iterator(handle_type h) : coro(h) {}
+            Iterator& operator++() {
+                coro.resume();
+                return *this;
+            }
+            bool operator!=(const Iterator& other) const {
+                return coro != other.coro && !coro.done();
+            }
+            T operator*() const {
+                return coro.promise().current_value;
+            }
+        };
+
+        Iterator begin() {
+            coro.resume();
+            return Iterator{coro};
+        }
+
+        Iterator end() {
+            return Iterator{nullptr};
+        }
+
+    private:
+        handle_type coro;
+    };
+
+    constexpr std::size_t kStringsPerGenerator = 256;
+
+    std::vector<std::string> make_strings(std::size_t length) {
+        std::vector<std::string> strings;
+        for (std::size_t i = 0; i < kStringsPerGenerator; ++i) {
+            strings.emplace_back(length, static_cast<char>('a' + i % 26));
+        }
+        return strings;
+    }
+
+    CopyingGenerator<std::string> copying_strings(const std::vector<std::string>& strings) {
+        for (const auto& s : strings) co_yield s;
+    }
+
+    coroutines_base::Generator<std::string> owned_strings(const std::vector<std::string>& strings) {
+        // 生成器自己构造元素(例如逐行解析)，按地址交给消费者
+        std::string current;
+        for (const auto& s : strings) {
+            current.assign(s);
+            co_yield current;
+        }
+    }
+
+    coroutines_base::Generator<const std::string&> borrowed_strings(const std::vector<std::string>& strings) {
+        for (const auto& s : strings) co_yield s;
+    }
+
+    // 毛毛虫形的深树：一条深度为depth的主干，每个主干节点再挂一个叶子
+    struct TreeNode {
+        int value;
+        std::vector<std::unique_ptr<TreeNode>> children;
+    };
+
+    std::unique_ptr<TreeNode> make_deep_tree(std::size_t depth) {
+        auto root = std::make_unique<TreeNode>(TreeNode{0, {}});
+        TreeNode* spine = root.get();
+        for (std::size_t i = 1; i < depth; ++i) {
+            spine->children.push_back(std::make_unique<TreeNode>(TreeNode{static_cast<int>(i), {}}));
+            spine->children.push_back(std::make_unique<TreeNode>(TreeNode{-static_cast<int>(i), {}}));
+            spine = spine->children.front().get();
+        }
+        return root;
+    }
+
+    coroutines_base::Generator<int> walk_flat(const TreeNode& node) {
+        co_yield node.value;
+        for (const auto& child : node.children) {
+            for (int value : walk_flat(*child)) co_yield value;
+        }
+    }
+
+    coroutines_base::Generator<int> walk_nested(const TreeNode& node) {
+        co_yield node.value;
+        for (const auto& child : node.children) co_yield coroutines_base::elements_of(walk_nested(*child));
+    }
+
+    void walk_recursive(const TreeNode& node, long& sum) {
+        sum += node.value;
+        for (const auto& child : node.children) walk_recursive(*child, sum);
+    }
+
+    long iterate_batch(int length) {
+        long sum = 0;
+        for (int g = 0; g < kGeneratorsPerBatch; ++g) {
+            for (int value : coroutines_demo::range(0, length)) sum += value;
+        }
+        return sum;
+    }
+}
+
+BENCHMARK_CASE(coroutine_frame_allocation) {
+    const std::vector<std::size_t> lengths = {1, 16, 256};
+
+    context.run_sweep("coroutine/generator/heap", lengths, [](std::size_t length) {
+        return [length] {
+            coroutines_base::FrameHeapScope heap;
+            do_not_optimize(iterate_batch(static_cast<int>(length)));
+        };
+    });
+
+    context.run_sweep("coroutine/generator/frame_pool", lengths, [](std::size_t length) {
+        return [length] { do_not_optimize(iterate_batch(static_cast<int>(length))); };
+    });
+
+    // 一批Generator的帧都从arena分配，批结束后一次reset
+    context.run_sweep("coroutine/generator/arena", lengths, [](std::size_t length) {
+        auto arena = std::make_shared<BatchArena>(256 * 1024);
+        return [length, arena] {
+            {
+                coroutines_base::FrameArenaScope scope(*arena);
+                do_not_optimize(iterate_batch(static_cast<int>(length)));
+            }
+            arena->reset();
+        };
+    });
+
+    // 对照：同样的迭代次数不经过协程
+    context.run_sweep("coroutine/plain_loop", lengths, [](std::size_t length) {
+        return [length] {
+            long sum = 0;
+            for (int g = 0; g < kGeneratorsPerBatch; ++g) {
+                for (int value = 0; value < static_cast<int>(length); ++value) {
+                    do_not_optimize(value);
+                    sum += value;
+                }
+            }
+            do_not_optimize(sum);
+        };
+    });
+}
+
+BENCHMARK_CASE(generator_string_iteration) {
+    const std::vector<std::size_t> lengths = {8, 64, 1024};
+
+    context.run_sweep("generator/string/copying", lengths, [](std::size_t length) {
+        return [strings = make_strings(length)] {
+            std::size_t total = 0;
+            for (std::string s : copying_strings(strings)) total += s.size();
+            do_not_optimize(total);
+        };
+    });
+
+    // 元素在生成器中构造一次(assign复用容量)，消费者按引用读取
+    context.run_sweep("generator/string/by_address", lengths, [](std::size_t length) {
+        return [strings = make_strings(length)] {
+            std::size_t total = 0;
+            for (const std::string& s : owned_strings(strings)) total += s.size();
+            do_not_optimize(total);
+        };
+    });
+
+    // 直接产出容器中元素的引用
+    context.run_sweep("generator/string/by_reference", lengths, [](std::size_t length) {
+        return [strings = make_strings(length)] {
+            std::size_t total = 0;
+            for (const std::string& s : borrowed_strings(strings)) total += s.size();
+            do_not_optimize(total);
+        };
+    });
+}
+
+BENCHMARK_CASE(generator_nested_traversal) {
+    const std::vector<std::size_t> depths = {16, 256, 2048};
+
+    context.run_sweep("generator/tree/flat", depths, [](std::size_t depth) {
+        return [tree = std::shared_ptr<TreeNode>(make_deep_tree(depth))] {
+            long sum = 0;
+            for (int value : walk_flat(*tree)) sum += value;
+            do_not_optimize(sum);
+        };
+    });
+
+    context.run_sweep("generator/tree/nested", depths, [](std::size_t depth) {
+        return [tree = std::shared_ptr<TreeNode>(make_deep_tree(depth))] {
+            long sum = 0;
+            for (int value : walk_nested(*tree)) sum += value;
+            do_not_optimize(sum);
+        };
+    });
+
+    // 对照：普通递归函数
+    context.run_sweep("generator/tree/recursive_function", depths, [](std::size_t depth) {
+        return [tree = std::shared_ptr<TreeNode>(make_deep_tree(depth))] {
+            long sum = 0;
+            walk_recursive(*tree, sum);
+            do_not_optimize(sum);
+        };
+    });
+}
@@ -0,0 +1,196 @@
+// 文件读取吞吐量：阻塞的std::ifstream/pread vs Reactor上的io_uring
+//
+// 每次迭代完整读取一个16MB的临时文件(已在页缓存中)，每次迭代的时间对应
+// 16MB / 时间 的吞吐量。扫描参数是每次读取的块大小：4KB时系统调用开销占主要部分，
+// io_uring把一轮事件循环中排队的所有读请求合并为一次io_uring_enter。
+// 内核不支持io_uring时只运行阻塞读取和Reactor的pread回退路径。
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../network/io_reactor.h"
+
+using namespace performance_benchmarking_demo;
+
+#if defined(__linux__)
+namespace {
+    constexpr std::size_t kFileSize = 16 << 20;
+    constexpr int kQueueDepth = 16;
+
+    // 进程内共享的测试文件，程序退出时删除
+    class BenchmarkFile {
+    private:
+        std::string path_;
+
+    public:
+        BenchmarkFile() {
+            char name[] = "/tmp/cpp_learning_file_io_XXXXXX";
+            int fd = ::mkstemp(name);
+            if (fd < 0) throw std::runtime_error("mkstemp failed");
+            path_ = name;
+            std::vector<char> block(1 << 20);
+            for (std::size_t i = 0; i < block.size(); ++i) block[i] = static_cast<char>(i * 31);
+            for (std::size_t written = 0; written < kFileSize; written += block.size()) {
+                if (::write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+                    ::close(fd);
+                    throw std::runtime_error("cannot write benchmark file");
+                }
+            }
+            ::close(fd);
+        }
+
+        ~BenchmarkFile() {
+            std::remove(path_.c_str());
+        }
+
+        const std::string& path() const {
+            return path_;
+        }
+
+        static const BenchmarkFile& instance() {
+            static BenchmarkFile file;
+            return file;
+        }
+    };
+
+    // 打开的文件描述符，随基准测试体一起释放
+    struct OpenFile {
+        int fd;
+
+        explicit OpenFile(const std::string& path) : fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+            if (fd < 0) throw std::runtime_error("cannot open " + path);
+        }
+
+        ~OpenFile() {
+            ::close(fd);
+        }
+    };
+
+    using network_demo::Reactor;
+    using coroutines_base::Task;
+
+    // kQueueDepth个协程各自领取下一个块，同时保持kQueueDepth个读请求在途
+    Task<std::size_t> read_file(Reactor& reactor, int fd, std::vector<char>& buffers, std::size_t chunk) {
+        std::uint64_t next_offset = 0;
+        std::size_t total = 0;
+        auto worker = [](Reactor& r, int file, char* buffer, std::size_t size, std::uint64_t& next,
+                         std::size_t& bytes) -> Task<void> {
+            while (next < kFileSize) {
+                std::uint64_t offset = next;
+                next += size;
+                bytes += co_await network_demo::async_read_at(r, file, buffer, size, offset);
+            }
+        };
+        std::vector<Task<void>> workers;
+        for (int i = 0; i < kQueueDepth; ++i) {
+            workers.push_back(worker(reactor, fd, buffers.data() + i * chunk, chunk, next_offset, total));
+        }
+        co_await coroutines_base::when_all(std::move(workers));
+        co_return total;
+    }
+
+    // 同上，但使用注册文件(下标0)和每个协程一个注册缓冲区
+    Task<std::size_t> read_file_fixed(Reactor& reactor, std::size_t chunk) {
+        std::uint64_t next_offset = 0;
+        std::size_t total = 0;
+        auto worker = [](Reactor& r, unsigned buffer, std::size_t size, std::uint64_t& next,
+                         std::size_t& bytes) -> Task<void> {
+            while (next < kFileSize) {
+                std::uint64_t offset = next;
+                next += size;
+                bytes += co_await network_demo::async_read_fixed(r, 0, buffer, size, offset);
+            }
+        };
+        std::vector<Task<void>> workers;
+        for (int i = 0; i < kQueueDepth; ++i) {
+            workers.push_back(worker(reactor, static_cast<unsigned>(i), chunk, next_offset, total));
+        }
+        co_await coroutines_base::when_all(std::move(workers));
+        co_return total;
+    }
+
+    // Reactor及其使用的文件和缓冲区；Reactor最先析构，之后才释放注册给它的缓冲区
+    struct ReactorReader {
+        OpenFile file;
+        std::vector<char> buffers;
+        std::unique_ptr<Reactor> reactor;
+
+        ReactorReader(bool use_io_uring, std::size_t chunk)
+            : file(BenchmarkFile::instance().path()), buffers(kQueueDepth * chunk) {
+            network_demo::ReactorOptions options;
+            options.use_io_uring = use_io_uring;
+            reactor = std::make_unique<Reactor>(options);
+        }
+    };
+}
+
+BENCHMARK_CASE(file_read_throughput) {
+    // 测试文件在第一个被选中的基准测试中才创建
+    const std::vector<std::size_t> chunks = {4096, 65536};
+
+    // 与filesystem_demo相同的文件流接口，按块读取
+    context.run_sweep("file_read/ifstream", chunks, [](std::size_t chunk) {
+        return [&path = BenchmarkFile::instance().path(), chunk, buffer = std::vector<char>(chunk)]() mutable {
+            std::ifstream in(path, std::ios::binary);
+            std::size_t total = 0;
+            while (in.read(buffer.data(), static_cast<std::streamsize>(chunk)) || in.gcount() > 0) {
+                total += static_cast<std::size_t>(in.gcount());
+            }
+            do_not_optimize(total);
+        };
+    });
+
+    context.run_sweep("file_read/pread", chunks, [](std::size_t chunk) {
+        auto file = std::make_shared<OpenFile>(BenchmarkFile::instance().path());
+        return [file, chunk, buffer = std::vector<char>(chunk)]() mutable {
+            std::size_t total = 0;
+            for (std::uint64_t offset = 0; offset < kFileSize; offset += chunk) {
+                ssize_t n = ::pread(file->fd, buffer.data(), chunk, static_cast<off_t>(offset));
+                if (n <= 0) break;
+                total += static_cast<std::size_t>(n);
+            }
+            do_not_optimize(total);
+        };
+    });
+
+    // 同样的协程代码，没有io_uring时每个请求同步调用pread
+    context.run_sweep("file_read/reactor_fallback", chunks, [](std::size_t chunk) {
+        auto reader = std::make_shared<ReactorReader>(false, chunk);
+        return [reader, chunk] {
+            do_not_optimize(reader->reactor->run_until_complete(
+                read_file(*reader->reactor, reader->file.fd, reader->buffers, chunk)));
+        };
+    });
+
+    if (!Reactor().uses_io_uring()) {
+        if (context.selected("file_read/io_uring")) {
+            context.out() << "file_read/io_uring: io_uring is not available, skipped" << std::endl;
+        }
+        return;
+    }
+
+    context.run_sweep("file_read/io_uring", chunks, [](std::size_t chunk) {
+        auto reader = std::make_shared<ReactorReader>(true, chunk);
+        return [reader, chunk] {
+            do_not_optimize(reader->reactor->run_until_complete(
+                read_file(*reader->reactor, reader->file.fd, reader->buffers, chunk)));
+        };
+    });
+
+    context.run_sweep("file_read/io_uring_fixed", chunks, [](std::size_t chunk) {
+        auto reader = std::make_shared<ReactorReader>(true, chunk);
+        std::vector<iovec> buffers;
+        for (int i = 0; i < kQueueDepth; ++i) buffers.push_back(iovec{reader->buffers.data() + i * chunk, chunk});
+        reader->reactor->register_files({reader->file.fd});
+        reader->reactor->register_buffers(std::move(buffers));
+        return [reader, chunk] {
+            do_not_optimize(reader->reactor->run_until_complete(read_file_fixed(*reader->reactor, chunk)));
+        };
+    });
+}
+#endif
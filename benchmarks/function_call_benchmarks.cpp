@@ -0,0 +1,57 @@
+// 可调用对象的调用开销：在1M元素上逐个调用，比较函数指针、仿函数、lambda和std::function
+//
+// 函数指针和std::function经过do_not_optimize，编译器无法在编译期确定调用目标，
+// 与它们在真实代码中(作为回调存储、跨编译单元传递)的情况一致。
+#include <functional>
+#include <numeric>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../function-comparison/function_comparison_demo.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    constexpr std::size_t kElements = 1 << 20;
+
+    template<typename Func>
+    long long apply_all(const std::vector<int>& data, Func& func) {
+        long long sum = 0;
+        for (std::size_t i = 0; i + 1 < data.size(); i += 2) {
+            sum += func(data[i], data[i + 1]);
+        }
+        return sum;
+    }
+}
+
+BENCHMARK_CASE(function_call_overhead) {
+    auto data = std::make_shared<std::vector<int>>();
+    auto input = [data]() -> const std::vector<int>& {
+        if (data->empty()) {
+            data->resize(kElements);
+            std::iota(data->begin(), data->end(), 0);
+        }
+        return *data;
+    };
+
+    context.run("call/function_pointer", [&input] {
+        int (*func)(int, int) = function_comparison_demo::add;
+        do_not_optimize(func);
+        return apply_all(input(), func);
+    });
+
+    context.run("call/functor", [&input] {
+        function_comparison_demo::AddFunctor functor;
+        return apply_all(input(), functor);
+    });
+
+    context.run("call/lambda", [&input] {
+        auto lambda = [](int a, int b) { return a + b; };
+        return apply_all(input(), lambda);
+    });
+
+    context.run("call/std_function", [&input] {
+        std::function<int(int, int)> func = function_comparison_demo::add;
+        do_not_optimize(func);
+        return apply_all(input(), func);
+    });
+}
@@ -0,0 +1,83 @@
+// HTTP/1.1服务器的每秒请求数：1、64、1024个并发长连接
+//
+// 负载生成器在回环地址上保持N个连接，每个连接同一时刻只有一个请求在途(闭环)，
+// 发送固定的GET请求，按固定的响应长度分帧。服务器的处理函数返回固定的短文本(零拷贝的静态消息体)。
+// 吞吐量基准每次迭代完成kRequestsPerIteration个请求；延迟基准输出每秒请求数和延迟分布。
+// 负载生成器和服务器在同一进程中运行，线程数超过CPU核数时两者互相抢占。
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../network/http_server.h"
+#include "../network/load_generator.h"
+
+using namespace performance_benchmarking_demo;
+
+#if defined(__linux__)
+namespace {
+    constexpr std::uint64_t kRequestsPerIteration = 4096;
+    constexpr std::uint64_t kLatencyRequests = 50000;
+    constexpr std::string_view kRequest = "GET /plaintext HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: load\r\n\r\n";
+    constexpr std::string_view kBody = "Hello, World!";
+
+    void plaintext_handler(const network_demo::HTTPRequest&, network_demo::HTTPResponse& response) {
+        response.add_header("Content-Type", "text/plain");
+        response.set_body(kBody);
+    }
+
+    // 处理函数的响应序列化后的长度，负载生成器据此分帧
+    std::size_t plaintext_response_size() {
+        network_demo::HTTPResponse response;
+        plaintext_handler(network_demo::HTTPRequest{}, response);
+        iovec iov[3];
+        int count = response.serialize(iov, false);
+        std::size_t size = 0;
+        for (int i = 0; i < count; ++i) size += iov[i].iov_len;
+        return size;
+    }
+
+    // 服务器和连接到它的负载生成器；负载生成器先析构，连接在服务器停止前关闭
+    struct HttpServerFixture {
+        network_demo::HTTPServer server;
+        std::unique_ptr<network_demo::LoadGenerator> generator;
+
+        explicit HttpServerFixture(std::size_t connections)
+            : server(network_demo::HTTPServerOptions{}, plaintext_handler) {
+            server.start();
+            network_demo::LoadGeneratorOptions load;
+            load.port = server.port();
+            load.connections = connections;
+            load.request = std::string(kRequest);
+            load.response_size = plaintext_response_size();
+            generator = std::make_unique<network_demo::LoadGenerator>(load);
+        }
+    };
+
+    void print_load(std::ostream& out, const std::string& name, const network_demo::LoadReport& report) {
+        out << std::left << std::setw(40) << name << std::right << ' ' << std::fixed << std::setprecision(0)
+            << report.requests_per_second() << " req/s  ";
+        report.latency.print(out);
+        out << std::defaultfloat << std::endl;
+    }
+}
+
+BENCHMARK_CASE(http_server_requests) {
+    // 负载生成器和服务器都是多线程的，--cpu不固定这些测量
+    auto unpinned = context.unpinned();
+    const std::vector<std::size_t> connections = {1, 64, 1024};
+
+    context.run_sweep("http_server/plaintext_requests/connections", connections, [](std::size_t count) {
+        auto fixture = std::make_shared<HttpServerFixture>(count);
+        return [fixture] { do_not_optimize(fixture->generator->run(kRequestsPerIteration).requests); };
+    });
+
+    for (std::size_t count : connections) {
+        std::string name = "http_server/plaintext_latency/connections:" + std::to_string(count);
+        if (context.selected(name)) {
+            HttpServerFixture fixture(count);
+            print_load(context.out(), name, fixture.generator->run(kLatencyRequests));
+        }
+    }
+}
+#endif
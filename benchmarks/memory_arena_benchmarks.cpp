@@ -0,0 +1,67 @@
+// 内存池与malloc/new的分配性能比较
+//
+// 每次迭代分配一批64字节的对象并全部释放(内存池通过reset释放)，
+// 批大小从1K到64K个对象，对应请求级或帧级的临时对象数量。
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../memory-arena/memory_arena.h"
+#include "../memory-arena/improved_memory_arena.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    constexpr std::size_t kObjectSize = 64;
+
+    struct Payload {
+        char bytes[kObjectSize];
+    };
+}
+
+BENCHMARK_CASE(arena_batch_allocation) {
+    const auto batch_sizes = power_of_two_range(10, 16, 2);
+
+    context.run_sweep("alloc/malloc_free", batch_sizes, [](std::size_t n) {
+        return [n, ptrs = std::vector<void*>(n)]() mutable {
+            for (std::size_t i = 0; i < n; ++i) {
+                ptrs[i] = std::malloc(kObjectSize);
+                do_not_optimize(ptrs[i]);
+            }
+            for (std::size_t i = 0; i < n; ++i) std::free(ptrs[i]);
+        };
+    });
+
+    context.run_sweep("alloc/new_delete", batch_sizes, [](std::size_t n) {
+        return [n, ptrs = std::vector<Payload*>(n)]() mutable {
+            for (std::size_t i = 0; i < n; ++i) {
+                ptrs[i] = new Payload;
+                do_not_optimize(ptrs[i]);
+            }
+            for (std::size_t i = 0; i < n; ++i) delete ptrs[i];
+        };
+    });
+
+    // MemoryArena::reset()会清零整个内存池，这部分开销也计入结果
+    context.run_sweep("alloc/memory_arena", batch_sizes, [](std::size_t n) {
+        auto arena = std::make_shared<memory_arena_demo::MemoryArena>(n * kObjectSize);
+        return [n, arena] {
+            for (std::size_t i = 0; i < n; ++i) {
+                void* p = arena->allocate(kObjectSize);
+                do_not_optimize(p);
+            }
+            arena->reset();
+        };
+    });
+
+    context.run_sweep("alloc/improved_memory_arena", batch_sizes, [](std::size_t n) {
+        auto arena = std::make_shared<improved_memory_arena_demo::ImprovedMemoryArena>(64 * 1024);
+        return [n, arena] {
+            for (std::size_t i = 0; i < n; ++i) {
+                void* p = arena->allocate(kObjectSize);
+                do_not_optimize(p);
+            }
+            arena->reset();
+        };
+    });
+}
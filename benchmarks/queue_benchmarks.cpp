@@ -0,0 +1,164 @@
+// 队列和线程池的延迟分布
+//
+// 吞吐量相同的两个队列，尾延迟可能相差几个数量级。这里记录每个元素从入队到被取出的
+// 时间，用延迟直方图报告p50/p99/p99.9，而不是只给出一个平均值。
+// 生产者全速写入，延迟中包含元素在队列中排队的时间。
+//
+// 生产者/消费者吞吐量：两个线程通过ThreadSafeQueue传递元素，对比两个协程在线程池上
+// 通过有界Channel传递元素(队列空/满时挂起协程而不是阻塞线程)。扫描参数是Channel的容量；
+// single_thread让两个协程在同一个线程上交替运行，只剩下挂起/恢复的开销。
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../performance-benchmarking/latency_histogram.h"
+#include "../multithreading/thread_safe_queue.h"
+#include "../memory-order/memory_order_demo.h"
+#include "../advanced-concurrency/thread_pool.h"
+#include "../meta-programming/coroutines/async_primitives.h"
+#include "../meta-programming/coroutines/coroutines_base.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    constexpr int kMessages = 200000;
+
+    std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void print_latency(std::ostream& out, const std::string& name, const LatencyHistogram& histogram) {
+        out << std::left << std::setw(32) << name << std::right << ' ';
+        histogram.print(out);
+        out << std::endl;
+    }
+
+    // 队列里传递元素下标，发送时间由生产者在入队前写入send_ns，
+    // 入队/出队本身的同步保证消费者读到的是写入后的值
+    template<typename Push, typename Pop>
+    LatencyHistogram measure_queue(Push push, Pop pop) {
+        std::vector<std::uint64_t> send_ns(kMessages);
+        LatencyHistogram histogram;
+        std::thread consumer([&] {
+            for (int received = 0; received < kMessages; ++received) {
+                int index = pop();
+                histogram.record(now_ns() - send_ns[index]);
+            }
+        });
+        for (int i = 0; i < kMessages; ++i) {
+            send_ns[i] = now_ns();
+            push(i);
+        }
+        consumer.join();
+        return histogram;
+    }
+
+    constexpr int kTransfers = 100000;
+
+    using coroutines_base::Channel;
+    using coroutines_base::Task;
+
+    // pool为空时在调用方线程上运行
+    Task<void> channel_producer(advanced_concurrency_demo::ThreadPool* pool, Channel<int>& channel) {
+        if (pool) co_await pool->schedule();
+        for (int i = 0; i < kTransfers; ++i) co_await channel.send(i);
+        channel.close();
+    }
+
+    Task<void> channel_consumer(advanced_concurrency_demo::ThreadPool* pool, Channel<int>& channel, long& sum) {
+        if (pool) co_await pool->schedule();
+        while (auto value = co_await channel.recv()) sum += *value;
+    }
+
+    long transfer_through_channel(advanced_concurrency_demo::ThreadPool* pool, std::size_t capacity) {
+        Channel<int> channel(capacity);
+        long sum = 0;
+        std::vector<Task<void>> tasks;
+        tasks.push_back(channel_consumer(pool, channel, sum));
+        tasks.push_back(channel_producer(pool, channel));
+        coroutines_base::sync_wait(coroutines_base::when_all(std::move(tasks)));
+        return sum;
+    }
+}
+
+BENCHMARK_CASE(queue_latency) {
+    if (context.selected("queue/thread_safe_queue/latency")) {
+        multithreading_demo::ThreadSafeQueue queue;
+        auto histogram = measure_queue([&](int i) { queue.push(i); }, [&] { return queue.pop(); });
+        print_latency(context.out(), "queue/thread_safe_queue/latency", histogram);
+    }
+
+    if (context.selected("queue/lock_free_spsc/latency")) {
+        memory_order_demo::LockFreeSPSCQueue<int> queue;
+        auto histogram = measure_queue(
+            [&](int i) {
+                while (!queue.push(i)) std::this_thread::yield();
+            },
+            [&] {
+                int value;
+                while (!queue.pop(value)) std::this_thread::yield();
+                return value;
+            });
+        print_latency(context.out(), "queue/lock_free_spsc/latency", histogram);
+    }
+}
+
+// 线程池：排队等待时间和执行时间分开统计
+BENCHMARK_CASE(thread_pool_latency) {
+    if (!context.selected("thread_pool/task_latency")) return;
+
+    advanced_concurrency_demo::ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    pool.set_latency_tracking(true);
+    std::mutex mutex;
+    std::condition_variable finished;
+    int remaining = kMessages;
+    for (int i = 0; i < kMessages; ++i) {
+        pool.post([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) finished.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return remaining == 0; });
+    }
+    // 等工作线程退出，最后一个任务的执行时间也已记录
+    pool.shutdown_now();
+
+    auto stats = pool.latency_stats();
+    print_latency(context.out(), "thread_pool/task_latency/queue_wait", stats.queue_wait);
+    print_latency(context.out(), "thread_pool/task_latency/run", stats.run);
+}
+
+BENCHMARK_CASE(producer_consumer_throughput) {
+    // 测量体创建生产者/消费者线程，--cpu不固定这些测量
+    auto unpinned = context.unpinned();
+    // 每次迭代创建生产者和消费者两个线程，两边都包含线程启动的开销
+    context.run("producer_consumer/thread_safe_queue", [] {
+        multithreading_demo::ThreadSafeQueue queue;
+        long sum = 0;
+        std::thread consumer([&] {
+            for (int i = 0; i < kTransfers; ++i) sum += queue.pop();
+        });
+        for (int i = 0; i < kTransfers; ++i) queue.push(i);
+        consumer.join();
+        do_not_optimize(sum);
+    });
+
+    const std::vector<std::size_t> capacities = {1, 64, 1024};
+
+    context.run_sweep("producer_consumer/channel", capacities, [](std::size_t capacity) {
+        return [capacity] {
+            advanced_concurrency_demo::ThreadPool pool(2);
+            do_not_optimize(transfer_through_channel(&pool, capacity));
+        };
+    });
+
+    context.run_sweep("producer_consumer/channel_single_thread", capacities, [](std::size_t capacity) {
+        return [capacity] { do_not_optimize(transfer_through_channel(nullptr, capacity)); };
+    });
+}
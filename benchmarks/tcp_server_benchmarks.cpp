@@ -0,0 +1,131 @@
+// TCP回显服务器的吞吐量和延迟：回调式TCPServer vs 协程Reactor
+//
+// 负载生成器在回环地址上保持kConnections个连接，每个连接同一时刻只有一个请求在途(闭环)。
+// 吞吐量基准每次迭代完成kRequestsPerIteration次往返；扫描参数是服务器的事件循环线程数。
+// 延迟基准用延迟直方图报告往返时间的分布和每秒请求数。
+// 负载生成器和服务器在同一进程中运行，线程数超过CPU核数时两者互相抢占。
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../network/tcp_server.h"
+#include "../network/load_generator.h"
+
+using namespace performance_benchmarking_demo;
+
+#if defined(__linux__)
+namespace {
+    constexpr std::size_t kConnections = 16;
+    constexpr std::uint64_t kRequestsPerIteration = 1000;
+    constexpr std::uint64_t kLatencyRequests = 50000;
+
+    using network_demo::AsyncFd;
+    using network_demo::Task;
+
+    network_demo::TCPServerCallbacks echo_callbacks() {
+        network_demo::TCPServerCallbacks callbacks;
+        callbacks.on_message = [](network_demo::TCPConnection& connection, network_demo::ByteBuffer& input) {
+            connection.send(input.data(), input.size());
+            input.consume(input.size());
+        };
+        return callbacks;
+    }
+
+    Task<void> reactor_echo_session(AsyncFd connection) {
+        char buffer[16 * 1024];
+        for (;;) {
+            std::size_t n = co_await network_demo::async_read(connection, buffer, sizeof(buffer));
+            if (n == 0) co_return;
+            co_await network_demo::async_write_all(connection, buffer, n);
+        }
+    }
+
+    Task<void> reactor_accept_loop(AsyncFd listener) {
+        for (;;) {
+            AsyncFd connection = co_await network_demo::async_accept(listener);
+            listener.reactor().spawn(reactor_echo_session(std::move(connection)));
+        }
+    }
+
+    // 服务器和连接到它的负载生成器；负载生成器先析构，连接在服务器停止前关闭
+    struct CallbackServerFixture {
+        network_demo::TCPServer server;
+        std::unique_ptr<network_demo::LoadGenerator> generator;
+
+        explicit CallbackServerFixture(std::size_t threads)
+            : server(network_demo::TCPServerOptions{.threads = threads}, echo_callbacks()) {
+            server.start();
+            generator = std::make_unique<network_demo::LoadGenerator>(
+                network_demo::LoadGeneratorOptions{.port = server.port(), .connections = kConnections});
+        }
+    };
+
+    struct ReactorServerFixture {
+        std::unique_ptr<network_demo::ReactorThreads> server;
+        std::unique_ptr<network_demo::LoadGenerator> generator;
+
+        explicit ReactorServerFixture(std::size_t threads) {
+            // 先用端口0确定一个可用端口，再让每个Reactor以SO_REUSEPORT监听它
+            std::uint16_t port;
+            {
+                network_demo::Reactor probe;
+                network_demo::ListenOptions options;
+                options.reuse_port = true;
+                port = network_demo::local_port(network_demo::tcp_listen(probe, options));
+            }
+            server = std::make_unique<network_demo::ReactorThreads>(
+                threads, [port](network_demo::Reactor& reactor, std::size_t) {
+                    network_demo::ListenOptions options;
+                    options.port = port;
+                    options.reuse_port = true;
+                    reactor.spawn(reactor_accept_loop(network_demo::tcp_listen(reactor, options)));
+                });
+            generator = std::make_unique<network_demo::LoadGenerator>(
+                network_demo::LoadGeneratorOptions{.port = port, .connections = kConnections});
+        }
+
+        ~ReactorServerFixture() {
+            generator.reset();
+            server->stop();
+        }
+    };
+
+    void print_load(std::ostream& out, const std::string& name, const network_demo::LoadReport& report) {
+        out << std::left << std::setw(40) << name << std::right << ' ' << std::fixed << std::setprecision(0)
+            << report.requests_per_second() << " req/s  ";
+        report.latency.print(out);
+        out << std::defaultfloat << std::endl;
+    }
+}
+
+BENCHMARK_CASE(tcp_server_echo) {
+    // 负载生成器和服务器都是多线程的，--cpu不固定这些测量
+    auto unpinned = context.unpinned();
+    const std::vector<std::size_t> threads = {1, 2};
+
+    context.run_sweep("tcp_server/echo_round_trips/threads", threads, [](std::size_t count) {
+        auto fixture = std::make_shared<CallbackServerFixture>(count);
+        return [fixture] { do_not_optimize(fixture->generator->run(kRequestsPerIteration).requests); };
+    });
+
+    // 对照：同样的回显逻辑写成Reactor上的协程
+    context.run_sweep("tcp_server/reactor_echo_round_trips/threads", threads, [](std::size_t count) {
+        auto fixture = std::make_shared<ReactorServerFixture>(count);
+        return [fixture] { do_not_optimize(fixture->generator->run(kRequestsPerIteration).requests); };
+    });
+
+    for (std::size_t count : threads) {
+        std::string name = "tcp_server/echo_latency/threads:" + std::to_string(count);
+        if (context.selected(name)) {
+            CallbackServerFixture fixture(count);
+            print_load(context.out(), name, fixture.generator->run(kLatencyRequests));
+        }
+        name = "tcp_server/reactor_echo_latency/threads:" + std::to_string(count);
+        if (context.selected(name)) {
+            ReactorServerFixture fixture(count);
+            print_load(context.out(), name, fixture.generator->run(kLatencyRequests));
+        }
+    }
+}
+#endif
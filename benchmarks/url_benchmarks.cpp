@@ -0,0 +1,133 @@
+// URL解析：原来基于substr复制的URL::parse vs 零分配的URLView
+//
+// 语料是按固定种子生成的10万个URL，长度从十几字节到两百多字节，混合了端口、用户信息、IPv6主机、
+// 长查询串和片段。每次迭代解析整个语料；allocs/iter显示每种做法的堆分配次数。
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../network/network_demo.h"
+#include "../network/url_parser.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    constexpr std::size_t kCorpusSize = 100000;
+
+    // 替换之前的URL::parse：多次substr复制，显式端口留在host中，查询和片段并入path
+    struct LegacyURL {
+        std::string protocol;
+        std::string host;
+        int port;
+        std::string path;
+
+        static LegacyURL parse(const std::string& url_str) {
+            LegacyURL url;
+            if (url_str.substr(0, 7) == "http://") {
+                url.protocol = "http";
+                std::string remaining = url_str.substr(7);
+                size_t path_pos = remaining.find('/');
+                if (path_pos != std::string::npos) {
+                    url.host = remaining.substr(0, path_pos);
+                    url.path = remaining.substr(path_pos);
+                } else {
+                    url.host = remaining;
+                    url.path = "/";
+                }
+                url.port = 80;
+            } else if (url_str.substr(0, 8) == "https://") {
+                url.protocol = "https";
+                std::string remaining = url_str.substr(8);
+                size_t path_pos = remaining.find('/');
+                if (path_pos != std::string::npos) {
+                    url.host = remaining.substr(0, path_pos);
+                    url.path = remaining.substr(path_pos);
+                } else {
+                    url.host = remaining;
+                    url.path = "/";
+                }
+                url.port = 443;
+            }
+            return url;
+        }
+    };
+
+    const std::vector<std::string>& url_corpus() {
+        static const std::vector<std::string> corpus = [] {
+            std::mt19937 rng(20261018);
+            auto pick = [&rng](std::size_t n) { return static_cast<std::size_t>(rng() % n); };
+            const char* schemes[] = {"http", "https", "https", "https"};
+            const char* hosts[] = {"example.com", "www.example.org", "api.service.internal", "cdn.static-assets.net",
+                                   "127.0.0.1", "[2001:db8::1]", "shop.example.co.uk"};
+            const char* segments[] = {"api", "v1", "v2", "users", "orders", "search", "images", "static",
+                                      "products", "caf%C3%A9", "2024", "index.html", "assets", "js", "app.min.js"};
+            const char* keys[] = {"id", "q", "page", "sort", "utm_source", "utm_medium", "session", "lang"};
+            std::vector<std::string> urls;
+            urls.reserve(kCorpusSize);
+            for (std::size_t i = 0; i < kCorpusSize; ++i) {
+                std::string url = schemes[pick(4)];
+                url += "://";
+                if (pick(20) == 0) url += "user:pass@";
+                url += hosts[pick(7)];
+                if (pick(4) == 0) url += ":" + std::to_string(1024 + pick(60000));
+                for (std::size_t depth = pick(7); depth > 0; --depth) {
+                    url += "/";
+                    url += segments[pick(15)];
+                }
+                if (pick(2) == 0) {
+                    const std::size_t params = 1 + pick(6);
+                    for (std::size_t param = 0; param < params; ++param) {
+                        url += param == 0 ? "?" : "&";
+                        url += keys[pick(8)];
+                        url += "=" + std::to_string(rng() % 1000000);
+                    }
+                }
+                if (pick(8) == 0) url += "#section-" + std::to_string(pick(10));
+                urls.push_back(std::move(url));
+            }
+            return urls;
+        }();
+        return corpus;
+    }
+}
+
+BENCHMARK_CASE(url_parse) {
+    // 每种做法是一个扫描参数：语料在第一个被选中的做法的factory中才生成，过滤掉或--list时不生成
+    const std::vector<std::string> variants = {"legacy_substr", "owning_url", "url_view", "url_view_normalize"};
+    context.run_sweep("url_parse", variants, [](const std::string& variant) -> std::function<void()> {
+        const auto& corpus = url_corpus();
+        if (variant == "legacy_substr") {
+            return [&corpus] {
+                std::size_t total = 0;
+                for (const auto& text : corpus) total += LegacyURL::parse(text).host.size();
+                do_not_optimize(total);
+            };
+        }
+        // URL::parse现在由URLView解析，只在复制各部分时分配
+        if (variant == "owning_url") {
+            return [&corpus] {
+                std::size_t total = 0;
+                for (const auto& text : corpus) total += network_demo::URL::parse(text).host.size();
+                do_not_optimize(total);
+            };
+        }
+        if (variant == "url_view") {
+            return [&corpus] {
+                std::size_t total = 0;
+                for (const auto& text : corpus) {
+                    auto url = network_demo::URLView::parse(text);
+                    total += url->host.size() + url->effective_port() + url->query.size();
+                }
+                do_not_optimize(total);
+            };
+        }
+        // 惰性操作的开销单独计：解析后再规范化到复用的缓冲区
+        return [&corpus] {
+            char buffer[512];
+            std::size_t total = 0;
+            for (const auto& text : corpus) total += network_demo::URLView::parse(text)->normalize(buffer);
+            do_not_optimize(total);
+        };
+    });
+}
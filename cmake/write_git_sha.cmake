@@ -0,0 +1,17 @@
+# 每次构建时由cpp_learning_git_sha目标运行(cmake -P)：把当前的git提交写入OUTPUT。
+# 内容没有变化时不改写文件，避免无谓的重新编译
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE CPP_LEARNING_GIT_SHA
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+set(CONTENT "#define CPP_LEARNING_GIT_SHA \"${CPP_LEARNING_GIT_SHA}\"\n")
+set(PREVIOUS "")
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" PREVIOUS)
+endif()
+if(NOT PREVIOUS STREQUAL CONTENT)
+    file(WRITE "${OUTPUT}" "${CONTENT}")
+endif()
@@ -34,6 +34,8 @@
 
 // Performance benchmarking header
 #include "performance-benchmarking/performance_benchmarking_demo.h"
+// Allocation tracking hooks (replace global operator new/malloc; include in this TU only)
+#include "performance-benchmarking/allocation_hooks.h"
 
 // Filesystem header
 #include "filesystem/filesystem_demo.h"
@@ -121,8 +123,11 @@ int main() {
     multithreading_demo::basic_threading_demo();
     multithreading_demo::mutex_condition_variable_demo();
     multithreading_demo::atomic_operations_demo();
+    multithreading_demo::counter_scaling_benchmark();
     multithreading_demo::async_future_demo();
     multithreading_demo::shared_mutex_demo();
+    multithreading_demo::seqlock_demo();
+    multithreading_demo::read_mostly_benchmark();
     
     // 8. Design patterns demo
     std::cout << "\n\n8. 设计模式演示:" << std::endl;
@@ -8,6 +8,8 @@
 #include <new>
 #include <chrono>
 #include <cstring>
+#include <cstddef>
+#include <cstdlib>
 
 // 改进的内存池/内存竞技场实现
 namespace improved_memory_arena_demo {
@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <cstring>
+#include <cstddef>
+#include <cstdlib>
 #include <cstdint>
 #include <new>
 #include <chrono>
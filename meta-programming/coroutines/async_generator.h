@@ -0,0 +1,232 @@
+#ifndef CPP_LEARNING_DEMO_ASYNC_GENERATOR_H
+#define CPP_LEARNING_DEMO_ASYNC_GENERATOR_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "frame_allocator.h"
+
+// 异步生成器：生成器内部可以co_await(等待I/O、切换线程等)，消费者通过co_await next()拉取元素
+//
+// C++20没有保留协程TS中的for co_await语法，消费方式为：
+//     while (auto* item = co_await source.next()) { ... *item ... }
+//
+// - 拉取式：生产者只在消费者请求下一个元素时运行，产出一个元素后立即挂起，
+//   消费者处理得慢时生产者不会继续读取，天然具有背压
+// - 元素按地址传递：co_yield的对象留在生产者的协程帧中，next()返回指向它的指针，
+//   指针在下一次调用next()之前有效，整个管道中没有复制
+// - 生产者和消费者之间通过对等转移切换，不增加调用栈深度
+namespace coroutines_base {
+    template<typename T>
+    class AsyncGenerator {
+    public:
+        using value_type = std::remove_cvref_t<T>;
+        using pointer = std::add_pointer_t<std::remove_reference_t<T>>;
+
+        struct promise_type : PooledFrame {
+            pointer value = nullptr;
+            // co_yield的表达式类型与T不同时，转换后的值存放在这里
+            std::optional<value_type> converted;
+            std::coroutine_handle<> consumer;
+            std::exception_ptr exception;
+
+            // 产出元素或结束时把控制权交回消费者
+            struct TransferToConsumer {
+                bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    return h.promise().consumer;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            AsyncGenerator get_return_object() noexcept {
+                return AsyncGenerator{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            TransferToConsumer final_suspend() noexcept {
+                value = nullptr;
+                return {};
+            }
+
+            // 左值和临时对象都只记录地址：临时对象在co_yield所在的完整表达式结束前一直有效，
+            // 而生产者恢复执行之前完整表达式不会结束
+            TransferToConsumer yield_value(std::remove_reference_t<T>& v) noexcept {
+                value = std::addressof(v);
+                return {};
+            }
+
+            TransferToConsumer yield_value(std::remove_reference_t<T>&& v) noexcept {
+                value = std::addressof(v);
+                return {};
+            }
+
+            // const左值不能按地址交给非const的元素类型，先复制到converted，消费者拿到的是副本
+            TransferToConsumer yield_value(const value_type& v)
+                requires(!std::is_const_v<std::remove_reference_t<T>>)
+            {
+                converted.emplace(v);
+                value = std::addressof(*converted);
+                return {};
+            }
+
+            template<typename U>
+                requires(!std::is_same_v<std::remove_cvref_t<U>, value_type> &&
+                         std::is_constructible_v<value_type, U &&>)
+            TransferToConsumer yield_value(U&& v) {
+                converted.emplace(std::forward<U>(v));
+                value = std::addressof(*converted);
+                return {};
+            }
+
+            void return_void() noexcept {}
+
+            void unhandled_exception() noexcept {
+                exception = std::current_exception();
+            }
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        AsyncGenerator() noexcept = default;
+        explicit AsyncGenerator(handle_type h) noexcept : coro(h) {}
+
+        ~AsyncGenerator() {
+            if (coro) {
+                coro.destroy();
+            }
+        }
+
+        AsyncGenerator(const AsyncGenerator&) = delete;
+        AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+        AsyncGenerator(AsyncGenerator&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+        AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+            if (this != &other) {
+                if (coro) {
+                    coro.destroy();
+                }
+                coro = std::exchange(other.coro, nullptr);
+            }
+            return *this;
+        }
+
+        struct NextAwaiter {
+            handle_type coro;
+
+            bool await_ready() const noexcept {
+                return !coro || coro.done();
+            }
+
+            // 记下消费者，转移到生产者运行到下一个co_yield(或结束)
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+                coro.promise().consumer = consumer;
+                return coro;
+            }
+
+            // 返回指向下一个元素的指针；生成器结束时返回nullptr，生成器抛出的异常在这里重新抛出
+            pointer await_resume() {
+                if (!coro) return nullptr;
+                auto& promise = coro.promise();
+                if (promise.exception) std::rethrow_exception(std::exchange(promise.exception, nullptr));
+                return coro.done() ? nullptr : promise.value;
+            }
+        };
+
+        // 同一时刻只能有一个next()在等待
+        NextAwaiter next() noexcept {
+            return NextAwaiter{coro};
+        }
+
+    private:
+        handle_type coro;
+    };
+
+    // 管道阶段：每个阶段自身也是AsyncGenerator，从上游拉取，按需产出
+    //
+    // 阶段协程的帧来自线程局部帧池(见frame_allocator.h)，batch/window只在创建时分配一次缓冲区。
+
+    // 对每个元素调用f，产出返回值
+    template<typename T, typename F>
+    AsyncGenerator<std::remove_cvref_t<std::invoke_result_t<F&, T&>>> map(AsyncGenerator<T> source, F f) {
+        while (auto* item = co_await source.next()) {
+            co_yield f(*item);
+        }
+    }
+
+    // 只产出满足pred的元素；元素仍然位于上游的协程帧中，不复制
+    template<typename T, typename Pred>
+    AsyncGenerator<T> filter(AsyncGenerator<T> source, Pred pred) {
+        while (auto* item = co_await source.next()) {
+            if (pred(std::as_const(*item))) co_yield *item;
+        }
+    }
+
+    namespace async_generator_detail {
+        template<typename T>
+        AsyncGenerator<std::span<std::remove_cvref_t<T>>> batch(AsyncGenerator<T> source, std::size_t size) {
+            using Value = std::remove_cvref_t<T>;
+            std::vector<Value> buffer;
+            buffer.reserve(size);
+            while (auto* item = co_await source.next()) {
+                buffer.push_back(std::move(*item));
+                if (buffer.size() == size) {
+                    co_yield std::span<Value>(buffer);
+                    buffer.clear();
+                }
+            }
+            if (!buffer.empty()) co_yield std::span<Value>(buffer);
+        }
+
+        template<typename T>
+        AsyncGenerator<std::span<const std::remove_cvref_t<T>>> window(AsyncGenerator<T> source, std::size_t size,
+                                                                       std::size_t step) {
+            using Value = std::remove_cvref_t<T>;
+            std::vector<Value> buffer;
+            buffer.reserve(2 * size);
+            std::size_t count = 0;
+            while (auto* item = co_await source.next()) {
+                if (buffer.size() == 2 * size) {
+                    buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size));
+                }
+                buffer.push_back(std::move(*item));
+                ++count;
+                if (count >= size && (count - size) % step == 0) {
+                    co_yield std::span<const Value>(buffer.data() + buffer.size() - size, size);
+                }
+            }
+        }
+    }
+
+    // 每size个元素产出一批(最后一批可能不足size个)
+    // 元素从上游移动到批缓冲区中；缓冲区在各批之间复用，span在下一次next()之前有效
+    // size为0时在调用处抛出std::invalid_argument(而不是等到第一次next())
+    template<typename T>
+    AsyncGenerator<std::span<std::remove_cvref_t<T>>> batch(AsyncGenerator<T> source, std::size_t size) {
+        if (size == 0) throw std::invalid_argument("batch: size must be positive");
+        return async_generator_detail::batch(std::move(source), size);
+    }
+
+    // 滑动窗口：每step个元素产出最近size个元素(元素总数不足size时不产出)
+    // 缓冲区容量为2*size，写满后把最近size个元素移到开头，均摊每个元素移动一次
+    // size或step为0时在调用处抛出std::invalid_argument
+    template<typename T>
+    AsyncGenerator<std::span<const std::remove_cvref_t<T>>> window(AsyncGenerator<T> source, std::size_t size,
+                                                                   std::size_t step = 1) {
+        if (size == 0) throw std::invalid_argument("window: size must be positive");
+        if (step == 0) throw std::invalid_argument("window: step must be positive");
+        return async_generator_detail::window(std::move(source), size, step);
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_ASYNC_GENERATOR_H
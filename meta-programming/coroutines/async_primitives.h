@@ -0,0 +1,456 @@
+#ifndef CPP_LEARNING_DEMO_ASYNC_PRIMITIVES_H
+#define CPP_LEARNING_DEMO_ASYNC_PRIMITIVES_H
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// 协程同步原语：拿不到锁/信号量/通道元素时挂起协程，而不是阻塞整个工作线程
+//
+// 被唤醒的等待者交给唤醒它的线程上的恢复队列(async_detail::resume)：最外层的unlock()/release()/send()
+// 依次恢复队列中的协程，而在被恢复的协程里再次唤醒别人只是排队，交接链多长调用栈都不会加深。
+// 需要回到特定线程池时在co_await之后再co_await pool.schedule()。
+// 等待节点就是awaiter本身，位于等待者的协程帧中，挂起和唤醒都不分配内存。
+namespace coroutines_base {
+    namespace async_detail {
+        // 等待者的恢复节点，由各个awaiter继承
+        struct ResumeNode {
+            std::coroutine_handle<> handle_;
+            ResumeNode* resume_next_ = nullptr;
+        };
+
+        struct ResumeQueue {
+            ResumeNode* head = nullptr;
+            ResumeNode* tail = nullptr;
+            bool draining = false;
+        };
+
+        inline ResumeQueue& resume_queue() noexcept {
+            thread_local ResumeQueue queue;
+            return queue;
+        }
+
+        // 在当前线程上恢复node：外层已经在恢复等待者时只追加到队尾，返回后由外层的循环按顺序恢复。
+        // 被恢复的协程抛出异常时队列保持原样，由这个线程上的下一次resume()继续处理。
+        inline void resume(ResumeNode* node) {
+            ResumeQueue& queue = resume_queue();
+            node->resume_next_ = nullptr;
+            if (queue.tail) {
+                queue.tail->resume_next_ = node;
+            } else {
+                queue.head = node;
+            }
+            queue.tail = node;
+            if (queue.draining) return;
+
+            struct Draining {
+                ResumeQueue& queue;
+                explicit Draining(ResumeQueue& q) noexcept : queue(q) { queue.draining = true; }
+                ~Draining() { queue.draining = false; }
+            } draining(queue);
+            while (ResumeNode* next = queue.head) {
+                queue.head = next->resume_next_;
+                if (!queue.head) queue.tail = nullptr;
+                next->handle_.resume();
+            }
+        }
+    }
+
+    // 异步互斥锁(无锁实现)
+    //
+    // state_的三种取值：kUnlocked、0(已锁定且没有等待者)、最新等待者的地址(已锁定，等待者组成后进先出的链)。
+    // 持有者unlock()时把这条链整体取走并反转为先进先出的waiters_，之后按顺序把锁直接交给下一个等待者，
+    // 被唤醒的协程恢复时已经持有锁。
+    class AsyncMutex {
+    public:
+        class LockAwaiter : private async_detail::ResumeNode {
+        public:
+            explicit LockAwaiter(AsyncMutex& mutex) noexcept : mutex_(mutex) {}
+
+            bool await_ready() noexcept {
+                return mutex_.try_lock();
+            }
+
+            // 锁已释放则直接获取，否则把自己压入等待链
+            bool await_suspend(std::coroutine_handle<> h) noexcept {
+                handle_ = h;
+                std::uintptr_t old = mutex_.state_.load(std::memory_order_relaxed);
+                for (;;) {
+                    if (old == kUnlocked) {
+                        if (mutex_.state_.compare_exchange_weak(old, 0, std::memory_order_acquire,
+                                                                std::memory_order_relaxed)) {
+                            return false;
+                        }
+                    } else {
+                        next_ = reinterpret_cast<LockAwaiter*>(old);
+                        if (mutex_.state_.compare_exchange_weak(old, reinterpret_cast<std::uintptr_t>(this),
+                                                                std::memory_order_release,
+                                                                std::memory_order_relaxed)) {
+                            return true;
+                        }
+                    }
+                }
+            }
+
+            void await_resume() const noexcept {}
+
+        protected:
+            AsyncMutex& mutex_;
+
+        private:
+            friend class AsyncMutex;
+            LockAwaiter* next_ = nullptr;
+        };
+
+        // co_await scoped_lock()返回的RAII守卫，析构时unlock()
+        class Lock {
+        public:
+            explicit Lock(AsyncMutex& mutex) noexcept : mutex_(&mutex) {}
+            Lock(Lock&& other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+            Lock(const Lock&) = delete;
+            Lock& operator=(const Lock&) = delete;
+            Lock& operator=(Lock&&) = delete;
+
+            ~Lock() {
+                if (mutex_) mutex_->unlock();
+            }
+
+        private:
+            AsyncMutex* mutex_;
+        };
+
+        class ScopedLockAwaiter : public LockAwaiter {
+        public:
+            using LockAwaiter::LockAwaiter;
+
+            Lock await_resume() const noexcept {
+                return Lock(mutex_);
+            }
+        };
+
+        AsyncMutex() noexcept = default;
+        AsyncMutex(const AsyncMutex&) = delete;
+        AsyncMutex& operator=(const AsyncMutex&) = delete;
+
+        bool try_lock() noexcept {
+            std::uintptr_t expected = kUnlocked;
+            return state_.compare_exchange_strong(expected, 0, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        // co_await mutex.lock(); ...; mutex.unlock();
+        LockAwaiter lock() noexcept {
+            return LockAwaiter(*this);
+        }
+
+        // auto guard = co_await mutex.scoped_lock();
+        ScopedLockAwaiter scoped_lock() noexcept {
+            return ScopedLockAwaiter(*this);
+        }
+
+        // 有等待者时把锁交给最早的一个，经由当前线程的恢复队列恢复它
+        void unlock() {
+            LockAwaiter* head = waiters_;
+            if (!head) {
+                std::uintptr_t old = 0;
+                if (state_.compare_exchange_strong(old, kUnlocked, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+                    return;
+                }
+                // 有新的等待者：取走整条链，保持锁定状态
+                old = state_.exchange(0, std::memory_order_acquire);
+                auto* waiter = reinterpret_cast<LockAwaiter*>(old);
+                while (waiter) {
+                    LockAwaiter* next = waiter->next_;
+                    waiter->next_ = head;
+                    head = waiter;
+                    waiter = next;
+                }
+            }
+            waiters_ = head->next_;
+            async_detail::resume(head);
+        }
+
+    private:
+        static constexpr std::uintptr_t kUnlocked = 1;
+
+        std::atomic<std::uintptr_t> state_{kUnlocked};
+        // 已经从state_取走、按先进先出排列的等待者，只由锁的持有者访问
+        LockAwaiter* waiters_ = nullptr;
+    };
+
+    // 异步计数信号量
+    //
+    // count_为负数时表示有多少个acquire()已经决定等待。获取和释放在没有等待者时只是一次原子加减；
+    // 需要挂起或唤醒时才进入内部互斥锁保护的等待队列，锁只在修改链表时持有，不会跨越挂起或恢复。
+    // release()可能发生在等待者决定等待之后、入队之前，这时记下一个待领取的唤醒，由入队前的检查领取。
+    class AsyncSemaphore {
+    public:
+        class AcquireAwaiter : private async_detail::ResumeNode {
+        public:
+            explicit AcquireAwaiter(AsyncSemaphore& semaphore) noexcept : semaphore_(semaphore) {}
+
+            bool await_ready() noexcept {
+                return semaphore_.try_acquire();
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) {
+                if (semaphore_.count_.fetch_sub(1, std::memory_order_acquire) > 0) return false;
+                std::lock_guard<std::mutex> lock(semaphore_.mutex_);
+                if (semaphore_.pending_wakeups_ > 0) {
+                    --semaphore_.pending_wakeups_;
+                    return false;
+                }
+                handle_ = h;
+                if (semaphore_.tail_) {
+                    semaphore_.tail_->next_ = this;
+                } else {
+                    semaphore_.head_ = this;
+                }
+                semaphore_.tail_ = this;
+                return true;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            friend class AsyncSemaphore;
+            AsyncSemaphore& semaphore_;
+            AcquireAwaiter* next_ = nullptr;
+        };
+
+        explicit AsyncSemaphore(std::ptrdiff_t initial) noexcept : count_(initial) {}
+        AsyncSemaphore(const AsyncSemaphore&) = delete;
+        AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+        bool try_acquire() noexcept {
+            std::ptrdiff_t count = count_.load(std::memory_order_relaxed);
+            while (count > 0) {
+                if (count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        AcquireAwaiter acquire() noexcept {
+            return AcquireAwaiter(*this);
+        }
+
+        // 释放count个许可，按先进先出唤醒等待者
+        void release(std::ptrdiff_t count = 1) {
+            for (std::ptrdiff_t i = 0; i < count; ++i) {
+                if (count_.fetch_add(1, std::memory_order_release) >= 0) continue;
+                AcquireAwaiter* waiter = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    waiter = head_;
+                    if (waiter) {
+                        head_ = waiter->next_;
+                        if (!head_) tail_ = nullptr;
+                    } else {
+                        ++pending_wakeups_;
+                    }
+                }
+                if (waiter) async_detail::resume(waiter);
+            }
+        }
+
+        // 当前可用的许可数(有等待者时为0)
+        std::ptrdiff_t available() const noexcept {
+            std::ptrdiff_t count = count_.load(std::memory_order_relaxed);
+            return count > 0 ? count : 0;
+        }
+
+    private:
+        std::atomic<std::ptrdiff_t> count_;
+        std::mutex mutex_;
+        AcquireAwaiter* head_ = nullptr;
+        AcquireAwaiter* tail_ = nullptr;
+        std::size_t pending_wakeups_ = 0;
+    };
+
+    // 有界通道：co_await send(value)在缓冲区满时挂起，co_await recv()在缓冲区空时挂起
+    //
+    // - 有接收者在等待时，send()把元素直接交给它，不经过缓冲区
+    // - 容量为0时是同步交接：send()一直挂起到有接收者取走元素
+    // - close()之后send()返回false；recv()取完剩余元素后返回std::nullopt
+    // 缓冲区是创建时分配的环形数组。内部互斥锁只保护缓冲区和等待链表的几次指针操作，
+    // 挂起前和唤醒对方之前都已经释放，协程不会因为通道而阻塞线程。
+    // 交接元素的一方继续运行，被唤醒的一方进入当前线程的恢复队列。
+    template<typename T>
+    class Channel {
+    public:
+        class SendAwaiter : private async_detail::ResumeNode {
+        public:
+            SendAwaiter(Channel& channel, T value) : channel_(channel), value_(std::move(value)) {}
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::unique_lock<std::mutex> lock(channel_.mutex_);
+                if (channel_.closed_) return false;
+                if (RecvAwaiter* receiver = pop(channel_.receivers_)) {
+                    receiver->result_.emplace(std::move(value_));
+                    lock.unlock();
+                    async_detail::resume(receiver);
+                    sent_ = true;
+                    return false;
+                }
+                if (channel_.size_ < channel_.capacity_) {
+                    channel_.push_buffer(std::move(value_));
+                    sent_ = true;
+                    return false;
+                }
+                handle_ = h;
+                push(channel_.senders_, this);
+                return true;
+            }
+
+            // 通道已关闭时返回false，元素没有送出
+            bool await_resume() const noexcept {
+                return sent_;
+            }
+
+        private:
+            friend class Channel;
+            Channel& channel_;
+            T value_;
+            bool sent_ = false;
+            SendAwaiter* next_ = nullptr;
+        };
+
+        class RecvAwaiter : private async_detail::ResumeNode {
+        public:
+            explicit RecvAwaiter(Channel& channel) noexcept : channel_(channel) {}
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::unique_lock<std::mutex> lock(channel_.mutex_);
+                if (channel_.size_ > 0) {
+                    result_.emplace(channel_.pop_buffer());
+                    // 腾出的位置交给等待最久的发送者
+                    if (SendAwaiter* sender = pop(channel_.senders_)) {
+                        channel_.push_buffer(std::move(sender->value_));
+                        sender->sent_ = true;
+                        lock.unlock();
+                        async_detail::resume(sender);
+                    }
+                    return false;
+                }
+                if (SendAwaiter* sender = pop(channel_.senders_)) {
+                    result_.emplace(std::move(sender->value_));
+                    sender->sent_ = true;
+                    lock.unlock();
+                    async_detail::resume(sender);
+                    return false;
+                }
+                if (channel_.closed_) return false;
+                handle_ = h;
+                push(channel_.receivers_, this);
+                return true;
+            }
+
+            // 通道已关闭且没有剩余元素时返回std::nullopt
+            std::optional<T> await_resume() {
+                return std::move(result_);
+            }
+
+        private:
+            friend class Channel;
+            Channel& channel_;
+            std::optional<T> result_;
+            RecvAwaiter* next_ = nullptr;
+        };
+
+        explicit Channel(std::size_t capacity) : capacity_(capacity), buffer_(capacity) {}
+        Channel(const Channel&) = delete;
+        Channel& operator=(const Channel&) = delete;
+
+        SendAwaiter send(T value) {
+            return SendAwaiter(*this, std::move(value));
+        }
+
+        RecvAwaiter recv() noexcept {
+            return RecvAwaiter(*this);
+        }
+
+        // 唤醒所有等待者：挂起的send()返回false，挂起的recv()返回std::nullopt
+        void close() {
+            Waiters<SendAwaiter> senders;
+            Waiters<RecvAwaiter> receivers;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                senders = std::exchange(senders_, {});
+                receivers = std::exchange(receivers_, {});
+            }
+            while (SendAwaiter* sender = pop(senders)) async_detail::resume(sender);
+            while (RecvAwaiter* receiver = pop(receivers)) async_detail::resume(receiver);
+        }
+
+        std::size_t capacity() const noexcept {
+            return capacity_;
+        }
+
+    private:
+        // 等待者的先进先出链表
+        template<typename Awaiter>
+        struct Waiters {
+            Awaiter* head = nullptr;
+            Awaiter* tail = nullptr;
+        };
+
+        template<typename Awaiter>
+        static void push(Waiters<Awaiter>& list, Awaiter* waiter) noexcept {
+            waiter->next_ = nullptr;
+            if (list.tail) {
+                list.tail->next_ = waiter;
+            } else {
+                list.head = waiter;
+            }
+            list.tail = waiter;
+        }
+
+        template<typename Awaiter>
+        static Awaiter* pop(Waiters<Awaiter>& list) noexcept {
+            Awaiter* waiter = list.head;
+            if (waiter) {
+                list.head = waiter->next_;
+                if (!list.head) list.tail = nullptr;
+            }
+            return waiter;
+        }
+
+        void push_buffer(T value) {
+            buffer_[(head_ + size_) % capacity_].emplace(std::move(value));
+            ++size_;
+        }
+
+        T pop_buffer() {
+            std::optional<T>& slot = buffer_[head_];
+            T value = std::move(*slot);
+            slot.reset();
+            head_ = (head_ + 1) % capacity_;
+            --size_;
+            return value;
+        }
+
+        std::mutex mutex_;
+        const std::size_t capacity_;
+        std::vector<std::optional<T>> buffer_;
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+        bool closed_ = false;
+        Waiters<SendAwaiter> senders_;
+        Waiters<RecvAwaiter> receivers_;
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_ASYNC_PRIMITIVES_H
@@ -6,150 +6,646 @@
 #include <exception>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "frame_allocator.h"
 
 // Base classes and utilities for coroutines
 
 namespace coroutines_base {
-    // Simple generator coroutine that yields values
+    // co_yield elements_of(range)：把另一个Generator(或任意范围)的所有元素依次产出
+    template<typename R>
+    struct elements_of {
+        R range;
+    };
+
+    template<typename R>
+    elements_of(R&&) -> elements_of<R&&>;
+
+    // 同步生成器：co_yield的对象留在协程帧中，迭代器按地址访问，整个迭代过程没有复制
+    //
+    // - Generator<T>：*it返回T&，可以从中移动出只能移动的元素(std::unique_ptr等)
+    // - Generator<const T&>/Generator<T&>：直接产出对已有对象的引用
+    // - 生成器体内抛出的异常在begin()/++it处重新抛出
+    // - 满足std::ranges::input_range和view，可以与std::views组合
+    // - co_yield elements_of(child)嵌套产出：消费者直接恢复最内层的生成器，
+    //   元素不经过外层逐级转发，每个元素的开销与嵌套深度无关
+    // - 元素类型不同的Generator<U>和其他范围一样逐个转发并转换为T，多一层转发；
+    //   元素不能转换为T时在co_yield处static_assert报错
+    //
+    // 引用在下一次++it之前有效：co_yield的临时对象存活到所在的完整表达式结束，
+    // 而协程恢复之前这个表达式不会结束
     template<typename T>
-    class Generator {
+    class Generator : public std::ranges::view_base {
     public:
-        struct promise_type {
-            T current_value;
-            
-            std::suspend_always yield_value(T value) {
-                current_value = value;
+        using value_type = std::remove_cvref_t<T>;
+        using reference = std::conditional_t<std::is_reference_v<T>, T, T&>;
+        using pointer = std::add_pointer_t<reference>;
+
+        struct promise_type;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        struct promise_type : PooledFrame {
+            // 嵌套的生成器组成一条链：最外层(root)记录当前元素和正在运行的最内层(leaf)，
+            // 每一层记录自己的外层(parent)，结束时对等转移回去
+            promise_type* root = this;
+            promise_type* parent = nullptr;
+            handle_type leaf;
+            pointer value = nullptr;
+            // 产出const左值或其他类型的表达式时，先复制/转换到这里
+            std::optional<value_type> converted;
+            std::exception_ptr exception;
+
+            std::suspend_always yield_value(std::remove_reference_t<reference>& v) noexcept {
+                root->value = std::addressof(v);
+                return {};
+            }
+
+            std::suspend_always yield_value(std::remove_reference_t<reference>&& v) noexcept {
+                root->value = std::addressof(v);
+                return {};
+            }
+
+            template<typename U>
+                requires(!std::is_convertible_v<U&&, std::remove_reference_t<reference>&> &&
+                         !std::is_convertible_v<U&&, std::remove_reference_t<reference>&&> &&
+                         std::is_constructible_v<value_type, U &&>)
+            std::suspend_always yield_value(U&& v) {
+                converted.emplace(std::forward<U>(v));
+                root->value = std::addressof(*converted);
                 return {};
             }
-            
-            std::suspend_always initial_suspend() { return {}; }
-            std::suspend_always final_suspend() noexcept { return {}; }
-            void unhandled_exception() { std::terminate(); }
-            void return_void() {}
-            
-            Generator get_return_object() {
-                return Generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+
+            // 嵌套产出：挂起当前生成器，对等转移到子生成器；子生成器结束后转移回来
+            struct NestedAwaiter {
+                // 产出任意范围时由这个生成器逐个转发，它的生命周期跟随co_yield表达式
+                Generator owned;
+                handle_type child;
+
+                bool await_ready() const noexcept {
+                    return !child;
+                }
+
+                std::coroutine_handle<> await_suspend(handle_type current) noexcept {
+                    promise_type& self = current.promise();
+                    promise_type& nested = child.promise();
+                    nested.root = self.root;
+                    nested.parent = &self;
+                    self.root->leaf = child;
+                    return child;
+                }
+
+                // 子生成器中的异常在外层的co_yield处重新抛出
+                void await_resume() {
+                    if (child) child.promise().rethrow_if_failed();
+                }
+            };
+
+            template<typename G>
+                requires std::is_same_v<std::remove_cvref_t<G>, Generator>
+            NestedAwaiter yield_value(elements_of<G> nested) noexcept {
+                return NestedAwaiter{Generator{}, nested.range.coro};
+            }
+
+            // 其他范围(包括元素类型不同的Generator<U>)：由一个转发生成器逐个产出并转换元素
+            template<typename R>
+                requires(!std::is_same_v<std::remove_cvref_t<R>, Generator> && std::ranges::input_range<R>)
+            NestedAwaiter yield_value(elements_of<R> nested) {
+                using element = std::ranges::range_reference_t<R>;
+                static_assert(std::is_convertible_v<element, std::remove_reference_t<reference>&> ||
+                                  std::is_convertible_v<element, std::remove_reference_t<reference>&&> ||
+                                  std::is_constructible_v<value_type, element>,
+                              "elements_of: 范围的元素不能转换为Generator的元素类型");
+                Generator forward = forward_range<R>(std::forward<R>(nested.range));
+                handle_type child = forward.coro;
+                return NestedAwaiter{std::move(forward), child};
+            }
+
+            template<typename R>
+            static Generator forward_range(R range) {
+                for (auto&& element : range) co_yield static_cast<decltype(element)>(element);
+            }
+
+            // 最外层结束时回到消费者；内层结束时把leaf交还给外层并转移过去
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                    promise_type& self = h.promise();
+                    if (!self.parent) return std::noop_coroutine();
+                    auto parent = handle_type::from_promise(*self.parent);
+                    self.root->leaf = parent;
+                    return parent;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+            void return_void() noexcept {}
+
+            // 同步生成器中不能co_await
+            template<typename U>
+            std::suspend_never await_transform(U&&) = delete;
+
+            Generator get_return_object() noexcept {
+                leaf = handle_type::from_promise(*this);
+                return Generator{leaf};
+            }
+
+            void rethrow_if_failed() {
+                if (exception) std::rethrow_exception(std::exchange(exception, nullptr));
+            }
+
+            // 恢复最内层的生成器，运行到下一个co_yield或整个链结束
+            void resume_leaf() {
+                leaf.resume();
+                rethrow_if_failed();
             }
         };
-        
-        using handle_type = std::coroutine_handle<promise_type>;
-        
-        Generator(handle_type h) : coro(h) {}
-        
+
+        Generator() noexcept = default;
+        explicit Generator(handle_type h) noexcept : coro(h) {}
+
         ~Generator() {
             if (coro) {
                 coro.destroy();
             }
         }
-        
+
         // Disable copy and enable move
         Generator(const Generator&) = delete;
         Generator& operator=(const Generator&) = delete;
-        Generator(Generator&& other) : coro(other.coro) {
-            other.coro = nullptr;
-        }
-        Generator& operator=(Generator&& other) {
+        Generator(Generator&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+        Generator& operator=(Generator&& other) noexcept {
             if (this != &other) {
                 if (coro) {
                     coro.destroy();
                 }
-                coro = other.coro;
-                other.coro = nullptr;
+                coro = std::exchange(other.coro, nullptr);
             }
             return *this;
         }
-        
-        // Iterator interface
+
+        // 输入迭代器，结束位置用std::default_sentinel表示
         class Iterator {
             handle_type coro;
         public:
-            Iterator(handle_type h) : coro(h) {}
+            using value_type = Generator::value_type;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() noexcept = default;
+            explicit Iterator(handle_type h) noexcept : coro(h) {}
+
             Iterator& operator++() {
-                coro.resume();
+                coro.promise().resume_leaf();
                 return *this;
             }
-            bool operator!=(const Iterator& other) const {
-                return coro != other.coro && !coro.done();
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            reference operator*() const noexcept {
+                return static_cast<reference>(*coro.promise().value);
             }
-            T operator*() const {
-                return coro.promise().current_value;
+
+            friend bool operator==(const Iterator& it, std::default_sentinel_t) noexcept {
+                return !it.coro || it.coro.done();
             }
         };
-        
+
+        // 只能调用一次：启动协程运行到第一个co_yield
         Iterator begin() {
-            if (coro) coro.resume();
+            if (coro) coro.promise().resume_leaf();
             return Iterator{coro};
         }
-        
-        Iterator end() {
-            return Iterator{nullptr};
+
+        std::default_sentinel_t end() const noexcept {
+            return {};
         }
-        
+
     private:
         handle_type coro;
     };
-    
-    // Simple task coroutine that returns a value
+
+    template<typename T = void>
+    class Task;
+
+    namespace task_detail {
+        // 所有Task promise的公共部分：惰性启动，结束时对等转移(symmetric transfer)到等待者
+        struct PromiseBase : PooledFrame {
+            // 等待这个Task的协程；没有等待者时结束后什么也不做
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+            std::exception_ptr exception;
+
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+
+                // 返回等待者的句柄，由编译器直接跳转过去，不增加调用栈深度
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                    return h.promise().continuation;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+            void rethrow_if_failed() const {
+                if (exception) std::rethrow_exception(exception);
+            }
+        };
+
+        template<typename T>
+        struct Promise : PromiseBase {
+            std::optional<T> value;
+
+            Task<T> get_return_object() noexcept;
+
+            template<typename U = T>
+                requires std::is_convertible_v<U&&, T>
+            void return_value(U&& v) {
+                value.emplace(std::forward<U>(v));
+            }
+
+            T take() {
+                rethrow_if_failed();
+                return std::move(*value);
+            }
+        };
+
+        template<typename T>
+        struct Promise<T&> : PromiseBase {
+            T* value = nullptr;
+
+            Task<T&> get_return_object() noexcept;
+
+            void return_value(T& v) noexcept {
+                value = std::addressof(v);
+            }
+
+            T& take() {
+                rethrow_if_failed();
+                return *value;
+            }
+        };
+
+        template<>
+        struct Promise<void> : PromiseBase {
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept {}
+
+            void take() {
+                rethrow_if_failed();
+            }
+        };
+    }
+
+    // 惰性Task：创建时不执行，直到被co_await(或交给sync_wait/when_all)才开始
+    //
+    // 被等待的Task结束时直接恢复等待者(对等转移)，任意长的同步完成链也不会耗尽调用栈
+    // (依赖编译器把转移编译为尾调用；GCC在-O0或开启ASan/TSan时不保证这一点)。
+    // 协程体内抛出的异常保存在promise中，在co_await处重新抛出。
     template<typename T>
     class Task {
     public:
-        struct promise_type {
-            T value;
-            bool finished = false;
-            
-            std::suspend_never initial_suspend() { return {}; }
-            std::suspend_always final_suspend() noexcept { 
-                finished = true;
-                return {}; 
-            }
-            void unhandled_exception() { std::terminate(); }
-            
-            Task get_return_object() {
-                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
-            }
-            
-            void return_value(T v) {
-                value = v;
-            }
-        };
-        
+        using promise_type = task_detail::Promise<T>;
         using handle_type = std::coroutine_handle<promise_type>;
-        
-        Task(handle_type h) : coro(h) {}
-        
+        using value_type = T;
+
+        Task() noexcept = default;
+        explicit Task(handle_type h) noexcept : coro(h) {}
+
         ~Task() {
             if (coro) {
                 coro.destroy();
             }
         }
-        
-        T get() {
-            if (coro && !coro.done()) {
-                coro.resume();
-            }
-            return coro.promise().value;
-        }
-        
+
         // Disable copy and enable move
         Task(const Task&) = delete;
         Task& operator=(const Task&) = delete;
-        Task(Task&& other) : coro(other.coro) {
-            other.coro = nullptr;
-        }
-        Task& operator=(Task&& other) {
+        Task(Task&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+        Task& operator=(Task&& other) noexcept {
             if (this != &other) {
                 if (coro) {
                     coro.destroy();
                 }
-                coro = other.coro;
-                other.coro = nullptr;
+                coro = std::exchange(other.coro, nullptr);
             }
             return *this;
         }
-        
+
+        bool valid() const noexcept {
+            return static_cast<bool>(coro);
+        }
+
+        bool done() const noexcept {
+            return !coro || coro.done();
+        }
+
+        struct Awaiter {
+            handle_type coro;
+
+            bool await_ready() const noexcept {
+                return !coro || coro.done();
+            }
+
+            // 记下等待者，然后转移到被等待的Task开始执行
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                coro.promise().continuation = awaiting;
+                return coro;
+            }
+
+            T await_resume() {
+                if (!coro) throw std::logic_error("co_await on an empty Task");
+                return coro.promise().take();
+            }
+        };
+
+        // 结果只能取一次(值类型的结果会被移出)
+        Awaiter operator co_await() noexcept {
+            return Awaiter{coro};
+        }
+
+        // 在当前线程运行到结束并取得结果；协程中途切换到其他线程时阻塞等待
+        T get();
+
     private:
         handle_type coro;
     };
+
+    namespace task_detail {
+        template<typename T>
+        Task<T> Promise<T>::get_return_object() noexcept {
+            return Task<T>{std::coroutine_handle<Promise<T>>::from_promise(*this)};
+        }
+
+        template<typename T>
+        Task<T&> Promise<T&>::get_return_object() noexcept {
+            return Task<T&>{std::coroutine_handle<Promise<T&>>::from_promise(*this)};
+        }
+
+        inline Task<void> Promise<void>::get_return_object() noexcept {
+            return Task<void>{std::coroutine_handle<Promise<void>>::from_promise(*this)};
+        }
+    }
+
+    namespace sync_wait_detail {
+        // 一次性事件：协程在任意线程结束时通知等待的线程
+        class Event {
+        private:
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            bool set_ = false;
+
+        public:
+            // 持锁通知：等待的线程醒来后会立即销毁Event，不能在解锁后再访问cv_
+            void set() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                set_ = true;
+                cv_.notify_all();
+            }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return set_; });
+            }
+        };
+
+        // 包装协程：等待目标对象，结束时通知Event
+        class SyncWaitTask {
+        public:
+            struct promise_type : PooledFrame {
+                Event* event = nullptr;
+                std::exception_ptr exception;
+
+                SyncWaitTask get_return_object() noexcept {
+                    return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                // 先挂起再通知，等待的线程醒来后可以安全地销毁协程帧
+                auto final_suspend() noexcept {
+                    struct Notify {
+                        bool await_ready() const noexcept { return false; }
+                        void await_suspend(std::coroutine_handle<promise_type> h) noexcept { h.promise().event->set(); }
+                        void await_resume() noexcept {}
+                    };
+                    return Notify{};
+                }
+
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { exception = std::current_exception(); }
+            };
+
+            explicit SyncWaitTask(std::coroutine_handle<promise_type> h) noexcept : coro(h) {}
+            SyncWaitTask(SyncWaitTask&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+            SyncWaitTask(const SyncWaitTask&) = delete;
+            SyncWaitTask& operator=(const SyncWaitTask&) = delete;
+
+            ~SyncWaitTask() {
+                if (coro) coro.destroy();
+            }
+
+            void run() {
+                Event event;
+                coro.promise().event = &event;
+                coro.resume();
+                event.wait();
+                if (coro.promise().exception) std::rethrow_exception(coro.promise().exception);
+            }
+
+        private:
+            std::coroutine_handle<promise_type> coro;
+        };
+
+        // 有成员operator co_await的取它返回的awaiter，否则对象本身就是awaiter
+        template<typename Awaitable>
+        decltype(auto) get_awaiter(Awaitable&& awaitable) {
+            if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); }) {
+                return std::forward<Awaitable>(awaitable).operator co_await();
+            } else {
+                return std::forward<Awaitable>(awaitable);
+            }
+        }
+
+        template<typename Awaitable>
+        using await_result_t = decltype(get_awaiter(std::declval<Awaitable>()).await_resume());
+
+        template<typename Awaitable, typename Store>
+        SyncWaitTask make_sync_wait_task(Awaitable& awaitable, Store store) {
+            if constexpr (std::is_void_v<await_result_t<Awaitable&>>) {
+                co_await awaitable;
+            } else {
+                store(co_await awaitable);
+            }
+        }
+    }
+
+    // 在当前线程阻塞，直到awaitable完成，返回它的结果(异常原样抛出)
+    template<typename Awaitable>
+    auto sync_wait(Awaitable&& awaitable) -> std::conditional_t<
+        std::is_lvalue_reference_v<sync_wait_detail::await_result_t<Awaitable&>>,
+        sync_wait_detail::await_result_t<Awaitable&>,
+        std::remove_cvref_t<sync_wait_detail::await_result_t<Awaitable&>>> {
+        using Result = sync_wait_detail::await_result_t<Awaitable&>;
+        if constexpr (std::is_void_v<Result>) {
+            sync_wait_detail::make_sync_wait_task(awaitable, 0).run();
+        } else if constexpr (std::is_lvalue_reference_v<Result>) {
+            std::remove_reference_t<Result>* result = nullptr;
+            sync_wait_detail::make_sync_wait_task(awaitable, [&](Result value) { result = std::addressof(value); })
+                .run();
+            return static_cast<Result>(*result);
+        } else {
+            std::optional<std::remove_cvref_t<Result>> result;
+            sync_wait_detail::make_sync_wait_task(awaitable, [&](Result&& value) { result.emplace(std::move(value)); })
+                .run();
+            return std::move(*result);
+        }
+    }
+
+    template<typename T>
+    T Task<T>::get() {
+        return sync_wait(*this);
+    }
+
+    namespace when_all_detail {
+        // 计数为任务数+1：多出的1由等待者在启动全部任务后减掉，
+        // 这样无论任务同步完成还是在其他线程完成，都只会恢复等待者一次
+        struct Latch {
+            std::atomic<std::size_t> count;
+            std::coroutine_handle<> awaiting;
+
+            explicit Latch(std::size_t tasks) : count(tasks + 1) {}
+
+            // 返回true表示自己是最后一个到达的
+            bool arrive() noexcept {
+                return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+        };
+
+        class WhenAllTask {
+        public:
+            struct promise_type : PooledFrame {
+                Latch* latch = nullptr;
+
+                WhenAllTask get_return_object() noexcept {
+                    return WhenAllTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                auto final_suspend() noexcept {
+                    struct Arrive {
+                        bool await_ready() const noexcept { return false; }
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                            Latch* latch = h.promise().latch;
+                            return latch->arrive() ? latch->awaiting : std::noop_coroutine();
+                        }
+                        void await_resume() noexcept {}
+                    };
+                    return Arrive{};
+                }
+
+                void return_void() noexcept {}
+                // 包装协程内部已捕获所有异常
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+
+            explicit WhenAllTask(std::coroutine_handle<promise_type> h) noexcept : coro(h) {}
+            WhenAllTask(WhenAllTask&& other) noexcept : coro(std::exchange(other.coro, nullptr)) {}
+            WhenAllTask(const WhenAllTask&) = delete;
+            WhenAllTask& operator=(const WhenAllTask&) = delete;
+
+            ~WhenAllTask() {
+                if (coro) coro.destroy();
+            }
+
+            void start(Latch& latch) {
+                coro.promise().latch = &latch;
+                coro.resume();
+            }
+
+        private:
+            std::coroutine_handle<promise_type> coro;
+        };
+
+        template<typename T, typename Slot>
+        WhenAllTask make_when_all_task(Task<T>& task, Slot& slot, std::exception_ptr& error) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await task;
+                } else {
+                    slot.emplace(co_await task);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        struct LatchAwaiter {
+            Latch& latch;
+            std::vector<WhenAllTask>& tasks;
+
+            bool await_ready() const noexcept { return tasks.empty(); }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept {
+                latch.awaiting = h;
+                for (auto& task : tasks) task.start(latch);
+                // 所有任务都已同步完成时不挂起，直接继续
+                return !latch.arrive();
+            }
+
+            void await_resume() noexcept {}
+        };
+    }
+
+    // 同时启动所有Task，全部完成后按原顺序返回结果；有任务失败时抛出第一个失败任务的异常
+    // 各任务在哪个线程上运行由它们自己决定(例如先co_await pool.schedule())
+    template<typename T>
+    Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(std::vector<Task<T>> tasks) {
+        static_assert(!std::is_reference_v<T>, "when_all does not support Task<T&>");
+        using Slot = std::conditional_t<std::is_void_v<T>, std::optional<int>, std::optional<T>>;
+        std::vector<Slot> slots(tasks.size());
+        std::vector<std::exception_ptr> errors(tasks.size());
+        std::vector<when_all_detail::WhenAllTask> wrappers;
+        wrappers.reserve(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            wrappers.push_back(when_all_detail::make_when_all_task(tasks[i], slots[i], errors[i]));
+        }
+
+        when_all_detail::Latch latch(tasks.size());
+        co_await when_all_detail::LatchAwaiter{latch, wrappers};
+
+        for (auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            std::vector<T> results;
+            results.reserve(slots.size());
+            for (auto& slot : slots) results.push_back(std::move(*slot));
+            co_return results;
+        }
+    }
 }
 
 #endif //CPP_LEARNING_DEMO_COROUTINES_BASE_H
\ No newline at end of file
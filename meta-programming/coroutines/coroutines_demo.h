@@ -7,8 +7,12 @@
 #include <thread>
 #include <future>
 #include <vector>
+#include <algorithm>
 
 #include "coroutines_base.h"
+#include "async_generator.h"
+#include "async_primitives.h"
+#include "../../advanced-concurrency/thread_pool.h"
 
 namespace coroutines_demo {
     using namespace coroutines_base;
@@ -46,6 +50,13 @@ namespace coroutines_demo {
         }
     }
     
+    // 嵌套生成器：co_yield elements_of(...)让消费者直接恢复内层生成器，元素不经过外层转发
+    Generator<int> nested_levels(int level) {
+        co_yield level;
+        if (level > 1) co_yield elements_of(nested_levels(level - 1));
+        co_yield -level;
+    }
+    
     // Task example: Async addition
     Task<int> async_add(int a, int b) {
         // Simulate async work with a simple loop
@@ -69,6 +80,12 @@ namespace coroutines_demo {
             std::cout << value << " ";
         }
         std::cout << std::endl;
+        
+        std::cout << "嵌套生成器(elements_of): ";
+        for (int value : nested_levels(3)) {
+            std::cout << value << " ";
+        }
+        std::cout << std::endl;
     }
     
     // Demonstrate task usage
@@ -84,25 +101,158 @@ namespace coroutines_demo {
         std::cout << "10 + 20 = " << task2.get() << std::endl;
     }
     
+    // 处理一个"请求"：先切换到线程池，再做一点计算
+    Task<long> handle_request(advanced_concurrency_demo::ThreadPool& pool, int id) {
+        co_await pool.schedule();
+        long sum = 0;
+        for (int i = 0; i < 2000; ++i) sum += (id ^ i) % 7;
+        co_return sum;
+    }
+
+    // 聚合多个子任务：co_await子任务时对等转移，子任务结束后直接回到这里
+    Task<long> handle_batch(advanced_concurrency_demo::ThreadPool& pool, int first, int count) {
+        long total = 0;
+        for (int i = 0; i < count; ++i) {
+            total += co_await handle_request(pool, first + i);
+        }
+        co_return total;
+    }
+
     // Demonstrate concurrent tasks
     void concurrent_tasks_demo() {
         std::cout << "\n=== 并发任务演示 ===" << std::endl;
-        
-        // Launch and collect results immediately to avoid storing Tasks in a vector
-        std::cout << "并发计算平方: ";
+
+        // Task是惰性的：when_all同时启动所有任务，每个任务通过schedule()切换到线程池
+        advanced_concurrency_demo::ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+        std::vector<Task<int>> squares;
         for (int i = 1; i <= 5; ++i) {
-            auto task = async_computation(i);
-            std::cout << task.get() << " ";
+            squares.push_back([](advanced_concurrency_demo::ThreadPool& p, int x) -> Task<int> {
+                co_await p.schedule();
+                co_return x * x;
+            }(pool, i));
+        }
+        std::cout << "并发计算平方: ";
+        for (int value : sync_wait(when_all(std::move(squares)))) {
+            std::cout << value << " ";
         }
         std::cout << std::endl;
     }
-    
+
+    // 线程池上的大量协程 vs 每个请求一个线程
+    void scheduler_demo(int requests = 10000) {
+        std::cout << "\n=== 线程池协程调度演示 ===" << std::endl;
+        const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+        advanced_concurrency_demo::ThreadPool pool(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Task<long>> tasks;
+        tasks.reserve(requests / 100);
+        for (int b = 0; b < requests / 100; ++b) {
+            tasks.push_back(handle_batch(pool, b * 100, 100));
+        }
+        long coroutine_total = 0;
+        for (long v : sync_wait(when_all(std::move(tasks)))) coroutine_total += v;
+        auto coroutine_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        // 对照组：每个请求一个线程(只跑十分之一的请求，线程创建开销已经很明显)
+        start = std::chrono::steady_clock::now();
+        const int threaded_requests = requests / 10;
+        std::vector<long> results(threaded_requests);
+        std::vector<std::thread> workers;
+        workers.reserve(threaded_requests);
+        for (int i = 0; i < threaded_requests; ++i) {
+            workers.emplace_back([&results, i] {
+                long sum = 0;
+                for (int k = 0; k < 2000; ++k) sum += (i ^ k) % 7;
+                results[i] = sum;
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto thread_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        std::cout << requests << "个协程请求(" << threads << "个线程): " << coroutine_time.count()
+                  << " ms, 校验和 " << coroutine_total << std::endl;
+        std::cout << threaded_requests << "个线程请求(每个请求一个线程): " << thread_time.count() << " ms" << std::endl;
+    }
+
+    // 异步数据源：每读一"页"记录都要等待一次(这里用切换到线程池模拟)，记录本身按需产出
+    AsyncGenerator<int> sensor_readings(advanced_concurrency_demo::ThreadPool& pool, int count, int page_size) {
+        for (int i = 0; i < count; ++i) {
+            if (i % page_size == 0) co_await pool.schedule();
+            co_yield (i * 37) % 100;
+        }
+    }
+
+    bool is_valid_reading(int raw) {
+        return raw < 90;
+    }
+
+    double to_celsius(int raw) {
+        return raw / 2.0;
+    }
+
+    Task<void> consume_pipeline(advanced_concurrency_demo::ThreadPool& pool) {
+        // 去掉异常读数(>=90)，换算成摄氏度，再按4个一组计算平均值
+        auto celsius = map(filter(sensor_readings(pool, 40, 8), is_valid_reading), to_celsius);
+        auto windows = window(std::move(celsius), 4, 4);
+        std::cout << "每4个读数的平均值: ";
+        while (auto* w = co_await windows.next()) {
+            double sum = 0;
+            for (double v : *w) sum += v;
+            std::cout << sum / static_cast<double>(w->size()) << " ";
+        }
+        std::cout << std::endl;
+    }
+
+    // AsyncGenerator管道：生产者可以co_await，消费者拉取一个元素生产者才产出一个
+    void async_generator_demo() {
+        std::cout << "\n=== AsyncGenerator流式管道演示 ===" << std::endl;
+        advanced_concurrency_demo::ThreadPool pool(2);
+        sync_wait(consume_pipeline(pool));
+    }
+
+    // 生产者：通道满时挂起，不占用工作线程
+    Task<void> produce_orders(advanced_concurrency_demo::ThreadPool& pool, Channel<int>& orders, int count) {
+        co_await pool.schedule();
+        for (int i = 1; i <= count; ++i) co_await orders.send(i * 10);
+        orders.close();
+    }
+
+    // 消费者：多个消费者共享一个计数器，用AsyncMutex保护
+    Task<void> handle_orders(advanced_concurrency_demo::ThreadPool& pool, Channel<int>& orders, AsyncMutex& mutex,
+                             long& total, int& handled) {
+        co_await pool.schedule();
+        while (auto order = co_await orders.recv()) {
+            auto lock = co_await mutex.scoped_lock();
+            total += *order;
+            ++handled;
+        }
+    }
+
+    // 协程同步原语：有界Channel传递任务，AsyncMutex保护共享状态
+    void channel_demo() {
+        std::cout << "\n=== Channel与AsyncMutex演示 ===" << std::endl;
+        advanced_concurrency_demo::ThreadPool pool(2);
+        Channel<int> orders(4);
+        AsyncMutex mutex;
+        long total = 0;
+        int handled = 0;
+        std::vector<Task<void>> tasks;
+        tasks.push_back(produce_orders(pool, orders, 100));
+        for (int i = 0; i < 3; ++i) tasks.push_back(handle_orders(pool, orders, mutex, total, handled));
+        sync_wait(when_all(std::move(tasks)));
+        std::cout << "3个消费者处理了" << handled << "个订单，总额 " << total << std::endl;
+    }
+
     // Run all coroutine demos
     void run_demo() {
         std::cout << "=== C++协程演示 ===" << std::endl;
         generator_demo();
         task_demo();
         concurrent_tasks_demo();
+        scheduler_demo();
+        async_generator_demo();
+        channel_demo();
     }
 }
 
@@ -0,0 +1,208 @@
+#ifndef CPP_LEARNING_DEMO_FRAME_ALLOCATOR_H
+#define CPP_LEARNING_DEMO_FRAME_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// 协程帧分配
+//
+// 每次调用协程函数都会用operator new分配一个协程帧。短生命周期的Generator/Task被大量创建时，
+// 这部分分配往往比协程本身的工作还贵。promise_type继承PooledFrame后，协程帧的来源由当前线程决定：
+//
+// - 默认：线程局部的分级空闲链表。帧大小按64字节向上取整分级，释放的帧挂回当前线程的链表，
+//   下次分配同一级别时直接复用，不经过malloc；超过最大级别的帧直接使用operator new
+// - FrameArenaScope：作用域内创建的协程帧从调用方提供的内存池(如MemoryArena)中分配，
+//   释放时什么也不做，由调用方统一reset
+// - FrameHeapScope：作用域内直接使用operator new/delete，用于和默认分配器对比
+//
+// 帧前面有一个对齐到max_align_t的头，记录帧的来源，所以帧可以在任意线程上释放：
+// 在其他线程释放的池化帧会进入那个线程的空闲链表。
+namespace coroutines_base {
+    namespace frame_detail {
+        constexpr std::size_t kGranularity = 64;
+        constexpr std::size_t kSizeClasses = 16;  // 64 ~ 1024字节
+        // 每一级最多缓存的空闲帧数，超过的部分还给operator delete
+        constexpr std::size_t kMaxCachedPerClass = 256;
+        constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+
+        enum class Source : std::uint32_t { heap, pool, arena };
+
+        struct Header {
+            Source source;
+            std::uint32_t size_class;
+        };
+        static_assert(sizeof(Header) <= kHeaderSize);
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        // 调用方提供的内存池：类型擦除后的allocate
+        struct ArenaRef {
+            void* arena = nullptr;
+            void* (*allocate)(void* arena, std::size_t size) = nullptr;
+        };
+
+        class FramePool {
+        private:
+            std::array<FreeBlock*, kSizeClasses> free_{};
+            std::array<std::size_t, kSizeClasses> cached_{};
+
+        public:
+            FramePool() = default;
+            FramePool(const FramePool&) = delete;
+            FramePool& operator=(const FramePool&) = delete;
+
+            ~FramePool();
+
+            // 返回nullptr表示这一级没有空闲帧
+            void* pop(std::size_t size_class) noexcept {
+                FreeBlock* block = free_[size_class];
+                if (!block) return nullptr;
+                free_[size_class] = block->next;
+                --cached_[size_class];
+                return block;
+            }
+
+            // 返回false表示缓存已满，由调用方释放
+            bool push(void* block, std::size_t size_class) noexcept {
+                if (cached_[size_class] >= kMaxCachedPerClass) return false;
+                auto* free_block = static_cast<FreeBlock*>(block);
+                free_block->next = free_[size_class];
+                free_[size_class] = free_block;
+                ++cached_[size_class];
+                return true;
+            }
+
+            std::size_t cached_blocks() const noexcept {
+                std::size_t total = 0;
+                for (std::size_t n : cached_) total += n;
+                return total;
+            }
+        };
+
+        inline thread_local FramePool pool;
+        // 线程退出时pool可能先于其他thread_local对象中的协程析构；
+        // 这个标志是平凡类型，析构后仍可读取
+        inline thread_local constinit bool pool_destroyed = false;
+
+        inline FramePool::~FramePool() {
+            for (auto& head : free_) {
+                while (head) {
+                    FreeBlock* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+            pool_destroyed = true;
+        }
+
+        inline thread_local constinit Source current_source = Source::pool;
+        inline thread_local constinit ArenaRef current_arena{};
+
+        inline void* tag(void* block, Source source, std::size_t size_class) noexcept {
+            ::new (block) Header{source, static_cast<std::uint32_t>(size_class)};
+            return static_cast<char*>(block) + kHeaderSize;
+        }
+
+        inline void* allocate(std::size_t size) {
+            const std::size_t total = size + kHeaderSize;
+            switch (current_source) {
+                case Source::arena:
+                    return tag(current_arena.allocate(current_arena.arena, total), Source::arena, 0);
+                case Source::pool: {
+                    const std::size_t size_class = (total - 1) / kGranularity;
+                    if (size_class < kSizeClasses && !pool_destroyed) {
+                        void* block = pool.pop(size_class);
+                        if (!block) block = ::operator new((size_class + 1) * kGranularity);
+                        return tag(block, Source::pool, size_class);
+                    }
+                    break;
+                }
+                case Source::heap:
+                    break;
+            }
+            return tag(::operator new(total), Source::heap, 0);
+        }
+
+        inline void deallocate(void* frame) noexcept {
+            void* block = static_cast<char*>(frame) - kHeaderSize;
+            const Header header = *static_cast<Header*>(block);
+            switch (header.source) {
+                case Source::arena:
+                    return;
+                case Source::pool:
+                    if (!pool_destroyed && pool.push(block, header.size_class)) return;
+                    break;
+                case Source::heap:
+                    break;
+            }
+            ::operator delete(block);
+        }
+
+        // 作用域内切换当前线程的帧来源，离开时恢复
+        class SourceScope {
+        private:
+            Source saved_source_;
+            ArenaRef saved_arena_;
+
+        public:
+            SourceScope(Source source, ArenaRef arena = {}) noexcept
+                : saved_source_(current_source), saved_arena_(current_arena) {
+                current_source = source;
+                current_arena = arena;
+            }
+
+            ~SourceScope() {
+                current_source = saved_source_;
+                current_arena = saved_arena_;
+            }
+
+            SourceScope(const SourceScope&) = delete;
+            SourceScope& operator=(const SourceScope&) = delete;
+        };
+    }
+
+    // promise_type的基类：协程帧通过frame_detail分配
+    struct PooledFrame {
+        static void* operator new(std::size_t size) {
+            return frame_detail::allocate(size);
+        }
+
+        static void operator delete(void* frame) noexcept {
+            frame_detail::deallocate(frame);
+        }
+    };
+
+    // 作用域内创建的协程帧从arena分配。arena需要提供void* allocate(std::size_t)，
+    // 空间不足时由arena决定抛出异常；arena必须比这些协程活得更久，释放由调用方reset完成
+    class FrameArenaScope {
+    private:
+        frame_detail::SourceScope scope_;
+
+        template<typename Arena>
+        static frame_detail::ArenaRef make_ref(Arena& arena) noexcept {
+            return {&arena, [](void* a, std::size_t size) { return static_cast<Arena*>(a)->allocate(size); }};
+        }
+
+    public:
+        template<typename Arena>
+        explicit FrameArenaScope(Arena& arena) noexcept
+            : scope_(frame_detail::Source::arena, make_ref(arena)) {}
+    };
+
+    // 作用域内的协程帧直接使用operator new/delete
+    class FrameHeapScope {
+    private:
+        frame_detail::SourceScope scope_{frame_detail::Source::heap};
+    };
+
+    // 当前线程空闲链表中缓存的帧数
+    inline std::size_t cached_frame_count() noexcept {
+        return frame_detail::pool_destroyed ? 0 : frame_detail::pool.cached_blocks();
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_FRAME_ALLOCATOR_H
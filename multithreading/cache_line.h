@@ -0,0 +1,28 @@
+#ifndef CPP_LEARNING_DEMO_CACHE_LINE_H
+#define CPP_LEARNING_DEMO_CACHE_LINE_H
+
+#include <cstddef>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace multithreading_demo {
+    // 缓存行大小
+    // 不使用std::hardware_destructive_interference_size，因为它在不同编译选项下可能变化(GCC会给出ABI警告)
+    inline constexpr std::size_t kCacheLineSize = 64;
+
+    // 自旋等待时的CPU提示，降低忙等对超线程兄弟核的影响
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_CACHE_LINE_H
@@ -12,7 +12,13 @@
 #include <vector>
 #include <queue>
 #include <random>
+#include <string>
+#include <iomanip>
+#include <algorithm>
 #include "thread_safe_queue.h"
+#include "seqlock.h"
+#include "rcu_snapshot.h"
+#include "sharded_counter.h"
 
 // 演示多线程编程
 namespace multithreading_demo {
@@ -94,6 +100,80 @@ namespace multithreading_demo {
         }
         
         std::cout << "最终计数: " << counter << std::endl;
+
+        // 分片计数器：每个线程递增自己的缓存行，读取时汇总
+        ShardedCounter sharded;
+        threads.clear();
+        for (int i = 0; i < 10; ++i) {
+            threads.emplace_back([&sharded]() {
+                for (int j = 0; j < 1000; ++j) {
+                    ++sharded;
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::cout << "分片计数器最终计数: " << sharded.value()
+                  << " (分片数: " << sharded.shard_count() << ")" << std::endl;
+    }
+
+    // 多线程同时递增计数器，返回百万次递增每秒
+    template<typename Increment>
+    double run_counter_scaling(int threads, int increments, Increment increment) {
+        std::atomic<bool> start{false};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < increments; ++i) {
+                    increment();
+                }
+            });
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        for (auto& w : workers) {
+            w.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return static_cast<double>(threads) * increments / elapsed / 1e6;
+    }
+
+    // 单个原子变量与分片计数器在1到64个线程下的扩展性对比
+    void counter_scaling_benchmark(int increments_per_thread = 1000000) {
+        std::cout << "\n=== 计数器扩展性基准测试 ===" << std::endl;
+        std::cout << "每线程递增次数: " << increments_per_thread << " (单位: 百万次递增/秒)" << std::endl;
+        std::cout << std::left << std::setw(10) << "线程数"
+                  << std::setw(18) << "atomic fetch_add"
+                  << std::setw(18) << "ShardedCounter" << std::endl;
+
+        for (int threads = 1; threads <= 64; threads *= 2) {
+            std::atomic<std::int64_t> single{0};
+            double atomic_rate = run_counter_scaling(threads, increments_per_thread, [&]() {
+                single.fetch_add(1, std::memory_order_relaxed);
+            });
+
+            ShardedCounter sharded;
+            double sharded_rate = run_counter_scaling(threads, increments_per_thread, [&]() {
+                sharded.add(1);
+            });
+
+            if (single.load() != sharded.value()) {
+                std::cout << "计数不一致: " << single.load() << " vs " << sharded.value() << std::endl;
+            }
+
+            std::cout << std::left << std::setw(10) << threads
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(18) << atomic_rate
+                      << std::setw(18) << sharded_rate << std::endl;
+        }
     }
 
     // 演示异步操作和future
@@ -167,6 +247,157 @@ namespace multithreading_demo {
         }
     }
 
+    // 演示顺序锁：与SharedMutexDemo接口相同，但读者不写共享状态
+    class SeqLockDemo {
+    private:
+        SeqLock<int> value_;
+
+    public:
+        void write_value(int value) {
+            value_.store(value);
+            std::cout << "写入值: " << value << std::endl;
+        }
+
+        int read_value() const {
+            int value = value_.load();
+            std::cout << "读取值: " << value << std::endl;
+            return value;
+        }
+    };
+
+    // 读多写少的小型配置(可平凡拷贝，适合SeqLock)
+    struct SmallConfig {
+        int timeout_ms = 0;
+        int max_connections = 0;
+        double ratio = 0.0;
+        long generation = 0;
+    };
+
+    // 读多写少的大型配置(不可平凡拷贝，适合RCU快照)
+    struct LargeConfig {
+        std::string name;
+        std::vector<int> weights;
+        long generation = 0;
+    };
+
+    void seqlock_demo() {
+        std::cout << "\n=== 顺序锁(SeqLock)与RCU快照演示 ===" << std::endl;
+
+        SeqLockDemo demo;
+        demo.write_value(42);
+        demo.read_value();
+
+        Snapshot<LargeConfig> config(LargeConfig{"default", {1, 2, 3}, 0});
+        config.update([](LargeConfig& c) {
+            c.name = "updated";
+            c.weights.push_back(4);
+            ++c.generation;
+        });
+        config.read([](const LargeConfig& c) {
+            std::cout << "快照配置: " << c.name << ", 权重个数: " << c.weights.size()
+                      << ", 版本: " << c.generation << std::endl;
+        });
+    }
+
+    // 读写混合负载：每个线程执行ops次操作，每(ratio + 1)次中有一次写
+    template<typename ReadFn, typename WriteFn>
+    double run_read_mostly(int threads, int ops, int ratio, ReadFn read, WriteFn write) {
+        std::atomic<bool> start{false};
+        std::atomic<long> sink{0};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                long local = 0;
+                for (int i = 0; i < ops; ++i) {
+                    // 错开各线程的写入位置
+                    if ((i + t) % (ratio + 1) == 0) {
+                        write(i);
+                    } else {
+                        local += read();
+                    }
+                }
+                sink.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        for (auto& w : workers) {
+            w.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return static_cast<double>(threads) * ops / elapsed / 1e6;  // 百万次操作每秒
+    }
+
+    // 比较shared_mutex、SeqLock和RCU快照在不同读写比下的吞吐量
+    void read_mostly_benchmark(int ops_per_thread = 200000) {
+        std::cout << "\n=== 读多写少同步原语基准测试 ===" << std::endl;
+
+        const int threads = std::max(2u, std::thread::hardware_concurrency());
+        std::cout << "线程数: " << threads << ", 每线程操作数: " << ops_per_thread
+                  << " (单位: 百万次操作/秒)" << std::endl;
+        std::cout << std::left << std::setw(10) << "读:写"
+                  << std::setw(16) << "shared_mutex"
+                  << std::setw(16) << "SeqLock"
+                  << std::setw(18) << "shared_mutex(大)"
+                  << std::setw(16) << "Snapshot(大)" << std::endl;
+
+        for (int ratio : {10, 100, 1000, 10000}) {
+            // 小对象：shared_mutex
+            SmallConfig small_locked;
+            std::shared_mutex small_mutex;
+            double small_mutex_rate = run_read_mostly(threads, ops_per_thread, ratio,
+                [&]() {
+                    std::shared_lock<std::shared_mutex> lock(small_mutex);
+                    return small_locked.generation;
+                },
+                [&](int i) {
+                    std::unique_lock<std::shared_mutex> lock(small_mutex);
+                    small_locked.generation = i;
+                });
+
+            // 小对象：SeqLock
+            SeqLock<SmallConfig> small_seqlock;
+            double seqlock_rate = run_read_mostly(threads, ops_per_thread, ratio,
+                [&]() { return small_seqlock.load().generation; },
+                [&](int i) { small_seqlock.update([i](SmallConfig& c) { c.generation = i; }); });
+
+            // 大对象：shared_mutex
+            LargeConfig large_locked{"config", std::vector<int>(64, 1), 0};
+            std::shared_mutex large_mutex;
+            double large_mutex_rate = run_read_mostly(threads, ops_per_thread, ratio,
+                [&]() {
+                    std::shared_lock<std::shared_mutex> lock(large_mutex);
+                    return large_locked.generation + static_cast<long>(large_locked.weights.size());
+                },
+                [&](int i) {
+                    std::unique_lock<std::shared_mutex> lock(large_mutex);
+                    large_locked.generation = i;
+                });
+
+            // 大对象：RCU快照
+            Snapshot<LargeConfig> large_snapshot(LargeConfig{"config", std::vector<int>(64, 1), 0});
+            double snapshot_rate = run_read_mostly(threads, ops_per_thread, ratio,
+                [&]() {
+                    return large_snapshot.read([](const LargeConfig& c) {
+                        return c.generation + static_cast<long>(c.weights.size());
+                    });
+                },
+                [&](int i) { large_snapshot.update([i](LargeConfig& c) { c.generation = i; }); });
+
+            std::cout << std::left << std::setw(10) << (std::to_string(ratio) + ":1")
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(16) << small_mutex_rate
+                      << std::setw(16) << seqlock_rate
+                      << std::setw(18) << large_mutex_rate
+                      << std::setw(16) << snapshot_rate << std::endl;
+        }
+    }
+
     // 线程安全性测试
     void thread_safety_test() {
         std::cout << "\n=== 线程安全性测试 ===" << std::endl;
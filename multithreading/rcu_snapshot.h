@@ -0,0 +1,183 @@
+#ifndef CPP_LEARNING_DEMO_RCU_SNAPSHOT_H
+#define CPP_LEARNING_DEMO_RCU_SNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include "cache_line.h"
+
+namespace multithreading_demo {
+    namespace rcu_detail {
+        // 全局读者登记表：每个线程独占一个槽位(独占一个缓存行)
+        // 槽位计数器为奇数表示该线程正处于读临界区
+        inline constexpr std::size_t kMaxReaderThreads = 256;
+
+        struct alignas(kCacheLineSize) ReaderSlot {
+            std::atomic<std::uint64_t> counter{0};
+            std::atomic<bool> in_use{false};
+        };
+
+        inline ReaderSlot g_reader_slots[kMaxReaderThreads];
+
+        // 线程首次读取时申请槽位，线程退出时归还
+        class ThreadReaderState {
+        private:
+            ReaderSlot* slot_ = nullptr;
+
+        public:
+            int depth = 0;  // 嵌套读取深度，只有最外层修改计数器
+
+            ReaderSlot& slot() {
+                if (!slot_) {
+                    for (auto& candidate : g_reader_slots) {
+                        bool expected = false;
+                        if (!candidate.in_use.load(std::memory_order_relaxed) &&
+                            candidate.in_use.compare_exchange_strong(expected, true)) {
+                            slot_ = &candidate;
+                            break;
+                        }
+                    }
+                    if (!slot_) {
+                        throw std::runtime_error("RCU reader slots exhausted");
+                    }
+                }
+                return *slot_;
+            }
+
+            ~ThreadReaderState() {
+                if (slot_) {
+                    slot_->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        inline ThreadReaderState& thread_state() {
+            thread_local ThreadReaderState state;
+            return state;
+        }
+
+        inline void read_lock() {
+            auto& state = thread_state();
+            if (state.depth++ == 0) {
+                auto& counter = state.slot().counter;
+                // 只有本线程写自己的槽位，不与其他读者争抢缓存行
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                // 槽位写入必须先于读取指针(Store-Load顺序)
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        inline void read_unlock() {
+            auto& state = thread_state();
+            if (--state.depth == 0) {
+                auto& counter = state.slot().counter;
+                // release：临界区内的读取先于写者观察到退出
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+        }
+
+        // 等待宽限期：所有在调用时刻处于读临界区的线程都已退出
+        inline void synchronize() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::uint64_t observed[kMaxReaderThreads];
+            for (std::size_t i = 0; i < kMaxReaderThreads; ++i) {
+                observed[i] = g_reader_slots[i].counter.load(std::memory_order_acquire);
+            }
+            for (std::size_t i = 0; i < kMaxReaderThreads; ++i) {
+                if ((observed[i] & 1) == 0) continue;
+                for (int spins = 0; g_reader_slots[i].counter.load(std::memory_order_acquire) == observed[i]; ++spins) {
+                    // 读者可能被调度出去，自旋一段时间后让出CPU，再之后短暂休眠
+                    if (spins < 64) {
+                        cpu_relax();
+                    } else if (spins < 1024) {
+                        std::this_thread::yield();
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::microseconds(10));
+                    }
+                }
+            }
+        }
+    }
+
+    // RCU风格的快照容器：适用于读多写少的较大对象
+    //
+    // 读者进入临界区后直接解引用当前指针，不修改引用计数；
+    // 写者复制并发布新版本，等待宽限期结束后再释放旧版本。
+    // 读路径只写本线程独占的槽位，写路径代价较高(拷贝+等待宽限期)。
+    // 注意：不要在持有ReadGuard的线程上调用store/update，否则会等待自己退出临界区而死锁。
+    template<typename T>
+    class Snapshot {
+    private:
+        alignas(kCacheLineSize) std::atomic<const T*> current_;
+        alignas(kCacheLineSize) std::mutex writer_mutex_;
+
+        void publish(std::unique_ptr<const T> next) {
+            const T* old = current_.exchange(next.release(), std::memory_order_seq_cst);
+            rcu_detail::synchronize();
+            delete old;
+        }
+
+    public:
+        // 读保护：存活期间指向的对象不会被释放
+        class ReadGuard {
+        private:
+            const T* ptr_;
+
+        public:
+            explicit ReadGuard(const std::atomic<const T*>& source) {
+                rcu_detail::read_lock();
+                ptr_ = source.load(std::memory_order_acquire);
+            }
+            ~ReadGuard() { rcu_detail::read_unlock(); }
+
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+
+            const T& operator*() const { return *ptr_; }
+            const T* operator->() const { return ptr_; }
+        };
+
+        Snapshot() : Snapshot(T{}) {}
+
+        explicit Snapshot(T initial) : current_(new T(std::move(initial))) {}
+
+        ~Snapshot() {
+            delete current_.load(std::memory_order_relaxed);
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        ReadGuard read() const {
+            return ReadGuard(current_);
+        }
+
+        // 在读临界区内调用f(const T&)，返回f的结果
+        template<typename F>
+        auto read(F&& f) const {
+            ReadGuard guard(current_);
+            return f(*guard);
+        }
+
+        // 发布一个全新的值
+        void store(T value) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            publish(std::make_unique<const T>(std::move(value)));
+        }
+
+        // 复制当前值，修改后发布(写者之间串行化)
+        template<typename F>
+        void update(F&& f) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+            f(*next);
+            publish(std::move(next));
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_RCU_SNAPSHOT_H
@@ -0,0 +1,113 @@
+#ifndef CPP_LEARNING_DEMO_SEQLOCK_H
+#define CPP_LEARNING_DEMO_SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include "cache_line.h"
+
+namespace multithreading_demo {
+    // 顺序锁(SeqLock)：适用于读多写少的小型可平凡拷贝数据
+    //
+    // 读者只读取序列号和数据，从不写共享内存，因此多个读者之间不会争抢缓存行。
+    // 写者在写入前后各把序列号加一：奇数表示正在写，读者发现序列号为奇数
+    // 或者读取前后序列号不一致时重试。
+    //
+    // 数据按字保存在std::atomic<uint64_t>数组中并用relaxed读写，
+    // 这样读者与写者的并发访问不构成数据竞争(不依赖未定义行为)。
+    template<typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock<T>要求T可平凡拷贝");
+        static_assert(std::is_default_constructible_v<T>, "SeqLock<T>要求T可默认构造");
+
+    private:
+        static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        // 序列号和数据放在同一缓存行(小对象时)，读者一次取回
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> seq_{0};
+        std::atomic<std::uint64_t> words_[kWords];
+        // 写者之间互斥，单独占一个缓存行避免干扰读者
+        alignas(kCacheLineSize) std::mutex writer_mutex_;
+
+        void store_words(const T& value) {
+            std::uint64_t buffer[kWords] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words_[i].store(buffer[i], std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        SeqLock() : SeqLock(T{}) {}
+
+        explicit SeqLock(const T& initial) {
+            store_words(initial);
+        }
+
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        // 读取一份一致的快照，无锁且不写共享状态
+        T load() const {
+            std::uint64_t buffer[kWords];
+            for (;;) {
+                std::uint64_t before = seq_.load(std::memory_order_acquire);
+                if (before & 1) {
+                    // 写者正在写入
+                    cpu_relax();
+                    continue;
+                }
+                for (std::size_t i = 0; i < kWords; ++i) {
+                    buffer[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                // 保证数据读取先于第二次读取序列号
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq_.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            T result;
+            std::memcpy(&result, buffer, sizeof(T));
+            return result;
+        }
+
+        // 写入新值，多个写者之间通过互斥锁串行化
+        void store(const T& value) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            std::uint64_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            // 保证奇数序列号先于数据写入对读者可见
+            std::atomic_thread_fence(std::memory_order_release);
+            store_words(value);
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        // 读-改-写：在写者锁内基于当前值计算新值
+        template<typename F>
+        void update(F&& f) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            std::uint64_t buffer[kWords];
+            for (std::size_t i = 0; i < kWords; ++i) {
+                buffer[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            T value;
+            std::memcpy(&value, buffer, sizeof(T));
+            f(value);
+
+            std::uint64_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            store_words(value);
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        // 当前序列号(偶数)，可用于判断值是否发生过变化
+        std::uint64_t version() const {
+            return seq_.load(std::memory_order_acquire) & ~std::uint64_t{1};
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_SEQLOCK_H
@@ -0,0 +1,93 @@
+#ifndef CPP_LEARNING_DEMO_SHARDED_COUNTER_H
+#define CPP_LEARNING_DEMO_SHARDED_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "cache_line.h"
+
+namespace multithreading_demo {
+    // 分片计数器：每个线程递增自己的分片，读取时汇总所有分片
+    //
+    // 单个std::atomic被所有线程fetch_add时，缓存行在核之间来回传递(ping-pong)。
+    // 分片计数器把计数分散到多个独占缓存行的槽位上，递增几乎不产生争用，
+    // 代价是读取需要遍历所有分片，并且读到的只是某一时刻附近的近似值
+    // (所有写者停止后读取是精确的)。适合请求数、字节数这类写多读少的统计。
+    class ShardedCounter {
+    private:
+        struct alignas(kCacheLineSize) Slot {
+            std::atomic<std::int64_t> value{0};
+        };
+
+        std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_;
+
+        static std::size_t round_up_pow2(std::size_t n) {
+            std::size_t result = 1;
+            while (result < n) result <<= 1;
+            return result;
+        }
+
+        // 每个线程首次使用时分配一个递增编号，之后固定映射到同一分片
+        static std::size_t thread_index() {
+            static std::atomic<std::size_t> next_index{0};
+            thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+        Slot& local_slot() {
+            return slots_[thread_index() & mask_];
+        }
+
+    public:
+        // 默认分片数为硬件线程数向上取整到2的幂
+        explicit ShardedCounter(std::size_t shards = std::thread::hardware_concurrency())
+            : mask_(round_up_pow2(shards == 0 ? 1 : shards) - 1),
+              slots_(new Slot[mask_ + 1]) {}
+
+        ShardedCounter(const ShardedCounter&) = delete;
+        ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+        // 宽松递增：只保证原子性，不与其他内存操作建立顺序
+        void add(std::int64_t delta = 1) {
+            local_slot().value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        void increment() { add(1); }
+
+        ShardedCounter& operator++() {
+            add(1);
+            return *this;
+        }
+
+        ShardedCounter& operator+=(std::int64_t delta) {
+            add(delta);
+            return *this;
+        }
+
+        // 汇总所有分片
+        std::int64_t value() const {
+            std::int64_t total = 0;
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                total += slots_[i].value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        // 读取并清零，返回清零前的总数(并发递增不会丢失，只会计入下一轮)
+        std::int64_t exchange_reset() {
+            std::int64_t total = 0;
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                total += slots_[i].value.exchange(0, std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        std::size_t shard_count() const {
+            return mask_ + 1;
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_SHARDED_COUNTER_H
@@ -0,0 +1,634 @@
+#ifndef CPP_LEARNING_DEMO_CONNECTION_POOL_H
+#define CPP_LEARNING_DEMO_CONNECTION_POOL_H
+
+// 客户端TCP连接池，按host:port分组
+//
+// 连接建立(三次握手，以及后续的慢启动)往往比一次请求本身更慢。用完的连接还给池子，
+// 下一次向同一个主机和端口发请求时直接复用：
+// - 空闲超时：空闲超过idle_timeout的连接不再复用(服务器通常会先关闭长时间空闲的连接)
+// - 健康检查：复用前用非阻塞的recv(MSG_PEEK)确认对端没有关闭连接，也没有多余的数据
+// - 每个主机的上限：同一个host:port同时存在的连接(借出的和空闲的)不超过max_per_host，
+//   达到上限时新的请求排队，按先来先服务的顺序接手归还的连接或空出的名额
+// - 三种获取方式：阻塞的acquire()(带超时)；立即返回的try_acquire()，新连接的connect在后台进行，
+//   由调用方的事件循环等待可写；async_acquire()在Reactor上co_await，排队期间不占用线程
+//
+// 池中的套接字都是非阻塞的。连接池可以被多个线程共享；借出的连接(PooledConnection)同一时刻只属于一个使用者。
+// 借出的连接需要显式release()才会回到池子：只有使用者知道协议是否处于可以复用的状态
+// (例如响应已经完整读完)，析构或close()时直接关闭连接。
+#if defined(__linux__)
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "io_reactor.h"
+
+namespace network_demo {
+    struct ConnectionPoolOptions {
+        // 每个host:port同时存在的连接数上限(借出的和空闲的)
+        std::size_t max_per_host = 16;
+        // 每个host:port保留的空闲连接数上限；0表示不复用，每次都建立新连接
+        std::size_t max_idle_per_host = 16;
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds(30);
+        // acquire()建立新连接的超时
+        std::chrono::milliseconds connect_timeout = std::chrono::seconds(5);
+    };
+
+    struct ConnectionPoolStats {
+        std::uint64_t opened = 0;
+        std::uint64_t reused = 0;
+        // 空闲超时后关闭的连接
+        std::uint64_t expired = 0;
+        // 复用前健康检查失败的连接
+        std::uint64_t unhealthy = 0;
+        // 因为达到每个主机的上限而排队的次数
+        std::uint64_t waits = 0;
+    };
+
+    class ConnectionPool;
+
+    namespace connection_pool_detail {
+        using Clock = std::chrono::steady_clock;
+
+        struct IdleConnection {
+            int fd;
+            Clock::time_point since;
+        };
+
+        // 排队等待连接的使用者。归还连接的线程把连接(或者fd = -1，表示可以新建一个连接的名额)交给队首，
+        // 阻塞的等待者由条件变量唤醒，协程由它所在的Reactor恢复
+        struct Waiter {
+            Waiter* next = nullptr;
+            std::coroutine_handle<> handle;
+            Reactor* reactor = nullptr;
+            bool ready = false;
+            int fd = -1;
+        };
+
+        struct HostPool {
+            sockaddr_in address{};
+            // 末尾是最近归还的连接；按归还时间排序，过期的连接总在开头
+            std::vector<IdleConnection> idle;
+            // 借出的连接和交给等待者的名额
+            std::size_t leased = 0;
+            Waiter* first_waiter = nullptr;
+            Waiter* last_waiter = nullptr;
+        };
+
+        inline void close_fd(int fd) noexcept {
+            if (fd >= 0) ::close(fd);
+        }
+
+        // 对端关闭后recv返回0，出错时返回错误；空闲的长连接上也不应该有数据可读
+        inline bool healthy(int fd) noexcept {
+            char byte;
+            ssize_t n = ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+
+        inline int wait_fd(int fd, short events, std::chrono::milliseconds timeout) {
+            pollfd entry{fd, events, 0};
+            for (;;) {
+                int n = ::poll(&entry, 1, static_cast<int>(timeout.count()));
+                if (n >= 0 || errno != EINTR) return n;
+            }
+        }
+
+        inline int connect_error(int fd) noexcept {
+            int error = 0;
+            socklen_t size = sizeof(error);
+            if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) != 0) return errno;
+            return error;
+        }
+
+        // 非阻塞套接字，开始连接。返回false表示连接仍在进行
+        inline bool start_connect(int& fd, const sockaddr_in& address) {
+            fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) throw_errno(errno, "socket");
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) return true;
+            if (errno == EINPROGRESS) return false;
+            int error = errno;
+            ::close(fd);
+            fd = -1;
+            throw_errno(error, "connect");
+        }
+    }
+
+    // 从连接池借出的一个连接。可以移动，不能复制；连接池必须比它活得长
+    class PooledConnection {
+    private:
+        friend class ConnectionPool;
+
+        ConnectionPool* pool_ = nullptr;
+        connection_pool_detail::HostPool* host_ = nullptr;
+        int fd_ = -1;
+        bool reused_ = false;
+        bool connecting_ = false;
+        AsyncFd socket_;
+
+        PooledConnection(ConnectionPool* pool, connection_pool_detail::HostPool* host, int fd, bool reused,
+                         bool connecting) noexcept
+            : pool_(pool), host_(host), fd_(fd), reused_(reused), connecting_(connecting) {}
+
+        void give_back(bool keep) noexcept;
+        void give_back_slot() noexcept;
+
+    public:
+        PooledConnection() = default;
+
+        PooledConnection(PooledConnection&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr)), host_(std::exchange(other.host_, nullptr)),
+              fd_(std::exchange(other.fd_, -1)), reused_(other.reused_), connecting_(other.connecting_),
+              socket_(std::move(other.socket_)) {}
+
+        PooledConnection& operator=(PooledConnection&& other) noexcept {
+            if (this != &other) {
+                close();
+                pool_ = std::exchange(other.pool_, nullptr);
+                host_ = std::exchange(other.host_, nullptr);
+                fd_ = std::exchange(other.fd_, -1);
+                reused_ = other.reused_;
+                connecting_ = other.connecting_;
+                socket_ = std::move(other.socket_);
+            }
+            return *this;
+        }
+
+        ~PooledConnection() {
+            close();
+        }
+
+        explicit operator bool() const noexcept {
+            return fd_ >= 0;
+        }
+
+        int fd() const noexcept {
+            return fd_;
+        }
+
+        // 是否是复用的空闲连接。复用的连接可能在健康检查之后才被服务器关闭，第一次写入或读取失败时可以重试
+        bool reused() const noexcept {
+            return reused_;
+        }
+
+        // try_acquire()返回的新连接仍在进行connect：等到fd可写后调用finish_connect()
+        bool connecting() const noexcept {
+            return connecting_;
+        }
+
+        // 检查后台connect的结果，失败时抛出异常(连接已关闭)
+        void finish_connect() {
+            if (!connecting_) return;
+            int error = connection_pool_detail::connect_error(fd_);
+            if (error != 0) {
+                close();
+                throw_errno(error, "connect");
+            }
+            connecting_ = false;
+        }
+
+        // 注册到Reactor上，之后用socket()进行async_read/async_write；归还或关闭时自动注销
+        AsyncFd& attach(Reactor& reactor) {
+            if (socket_.valid()) return socket_;
+            try {
+                socket_ = AsyncFd(reactor, fd_);
+            } catch (...) {
+                // 注册失败时AsyncFd已经关闭了描述符，只归还名额
+                fd_ = -1;
+                connecting_ = false;
+                give_back_slot();
+                throw;
+            }
+            return socket_;
+        }
+
+        AsyncFd& socket() noexcept {
+            return socket_;
+        }
+
+        // 还给连接池。调用方保证连接处于可以复用的状态：没有未读完的响应，也没有挂起的异步操作
+        void release() noexcept {
+            give_back(true);
+        }
+
+        // 关闭连接，把名额还给连接池
+        void close() noexcept {
+            give_back(false);
+        }
+    };
+
+    class ConnectionPool {
+    private:
+        using Clock = connection_pool_detail::Clock;
+        using HostPool = connection_pool_detail::HostPool;
+        using Waiter = connection_pool_detail::Waiter;
+
+        friend class PooledConnection;
+
+        ConnectionPoolOptions options_;
+        mutable std::mutex mutex_;
+        std::condition_variable released_;
+        // HostPool的地址在连接池的生命周期内不变，借出的连接直接指向它
+        std::unordered_map<std::string, std::unique_ptr<HostPool>> hosts_;
+        std::atomic<std::uint64_t> opened_{0};
+        std::atomic<std::uint64_t> reused_{0};
+        std::atomic<std::uint64_t> expired_{0};
+        std::atomic<std::uint64_t> unhealthy_{0};
+        std::atomic<std::uint64_t> waits_{0};
+
+        // 地址在第一次使用时解析并缓存；解析在锁外进行
+        HostPool& host_pool(const std::string& host, std::uint16_t port) {
+            std::string key = host;
+            key.push_back(':');
+            key.append(std::to_string(port));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = hosts_.find(key);
+                if (it != hosts_.end()) return *it->second;
+            }
+            auto entry = std::make_unique<HostPool>();
+            entry->address = resolve(host, port);
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto [it, inserted] = hosts_.try_emplace(std::move(key), std::move(entry));
+            return *it->second;
+        }
+
+        static sockaddr_in resolve(const std::string& host, std::uint16_t port) {
+            addrinfo hints{};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* result = nullptr;
+            const std::string service = std::to_string(port);
+            int error = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+            if (error != 0) throw std::runtime_error("getaddrinfo(" + host + "): " + ::gai_strerror(error));
+            sockaddr_in address;
+            std::memcpy(&address, result->ai_addr, sizeof(address));
+            ::freeaddrinfo(result);
+            return address;
+        }
+
+        // 移除开头过期的空闲连接(持有锁时调用)，描述符放进doomed留到锁外关闭；返回移除的个数
+        std::size_t expire(HostPool& host, Clock::time_point now, std::vector<int>& doomed) {
+            std::size_t count = 0;
+            while (count < host.idle.size() && now - host.idle[count].since >= options_.idle_timeout) {
+                doomed.push_back(host.idle[count].fd);
+                ++count;
+            }
+            host.idle.erase(host.idle.begin(), host.idle.begin() + static_cast<std::ptrdiff_t>(count));
+            expired_.fetch_add(count, std::memory_order_relaxed);
+            return count;
+        }
+
+        // 取一个健康的空闲连接，或者占用一个新连接的名额(fd = -1)。都不行时返回false。
+        // 持有锁时调用；过期和不健康的连接放进doomed，由调用方在锁外(排队之后)关闭
+        bool grant(HostPool& host, int& fd, std::vector<int>& doomed) {
+            expire(host, Clock::now(), doomed);
+            bool granted = false;
+            while (!host.idle.empty()) {
+                fd = host.idle.back().fd;
+                host.idle.pop_back();
+                if (connection_pool_detail::healthy(fd)) {
+                    reused_.fetch_add(1, std::memory_order_relaxed);
+                    granted = true;
+                    break;
+                }
+                unhealthy_.fetch_add(1, std::memory_order_relaxed);
+                doomed.push_back(fd);
+            }
+            if (!granted && host.idle.size() + host.leased < options_.max_per_host) {
+                fd = -1;
+                granted = true;
+            }
+            if (granted) ++host.leased;
+            return granted;
+        }
+
+        static void close_all(const std::vector<int>& doomed) noexcept {
+            for (int fd : doomed) ::close(fd);
+        }
+
+        void enqueue(HostPool& host, Waiter& waiter) noexcept {
+            if (host.last_waiter) host.last_waiter->next = &waiter;
+            else host.first_waiter = &waiter;
+            host.last_waiter = &waiter;
+            waits_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void unlink(HostPool& host, Waiter& waiter) noexcept {
+            Waiter* previous = nullptr;
+            for (Waiter* w = host.first_waiter; w; previous = w, w = w->next) {
+                if (w != &waiter) continue;
+                if (previous) previous->next = w->next;
+                else host.first_waiter = w->next;
+                if (host.last_waiter == w) host.last_waiter = previous;
+                return;
+            }
+        }
+
+        // 借出的连接结束使用：交给队首的等待者，或者放回空闲列表，或者关闭。
+        // 协程等待者在持有锁时post：它的WaitAwaiter析构前要先拿到这把锁，所以协程帧和Reactor此时都还活着
+        void give_back(HostPool& host, int fd, bool keep) noexcept {
+            // 交给了阻塞在条件变量上的等待者
+            bool notify = false;
+            int doomed = -1;
+            keep = keep && options_.max_idle_per_host > 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (Waiter* waiter = host.first_waiter) {
+                    host.first_waiter = waiter->next;
+                    if (!host.first_waiter) host.last_waiter = nullptr;
+                    // 名额直接转给等待者，leased不变
+                    waiter->fd = keep ? fd : -1;
+                    if (keep) reused_.fetch_add(1, std::memory_order_relaxed);
+                    else doomed = fd;
+                    waiter->ready = true;
+                    if (waiter->reactor) waiter->reactor->post(waiter->handle);
+                    else notify = true;
+                } else {
+                    --host.leased;
+                    if (keep) {
+                        if (host.idle.size() >= options_.max_idle_per_host) {
+                            doomed = host.idle.front().fd;
+                            host.idle.erase(host.idle.begin());
+                        }
+                        host.idle.push_back({fd, Clock::now()});
+                    } else {
+                        doomed = fd;
+                    }
+                }
+            }
+            connection_pool_detail::close_fd(doomed);
+            if (notify) released_.notify_all();
+        }
+
+        // 用granted的结果(空闲连接或名额)构造借出的连接；名额需要阻塞地建立新连接
+        PooledConnection connect_granted(HostPool& host, int fd) {
+            if (fd >= 0) return PooledConnection(this, &host, fd, true, false);
+            try {
+                if (!connection_pool_detail::start_connect(fd, host.address)) {
+                    int ready = connection_pool_detail::wait_fd(fd, POLLOUT, options_.connect_timeout);
+                    int error = ready > 0 ? connection_pool_detail::connect_error(fd) : ready == 0 ? ETIMEDOUT : errno;
+                    if (error != 0) {
+                        ::close(fd);
+                        throw_errno(error, "connect");
+                    }
+                }
+            } catch (...) {
+                give_back(host, -1, false);
+                throw;
+            }
+            opened_.fetch_add(1, std::memory_order_relaxed);
+            return PooledConnection(this, &host, fd, false, false);
+        }
+
+        // async_acquire()占用的新连接名额：connect失败或者协程帧在connect期间被销毁时归还
+        class SlotGuard {
+        private:
+            ConnectionPool* pool_;
+            HostPool* host_;
+
+        public:
+            SlotGuard(ConnectionPool& pool, HostPool& host) noexcept : pool_(&pool), host_(&host) {}
+
+            SlotGuard(const SlotGuard&) = delete;
+            SlotGuard& operator=(const SlotGuard&) = delete;
+
+            ~SlotGuard() {
+                if (pool_) pool_->give_back(*host_, -1, false);
+            }
+
+            // 名额交给了借出的连接
+            void dismiss() noexcept {
+                pool_ = nullptr;
+            }
+        };
+
+        // 协程在Reactor上排队；归还连接的线程通过Reactor::post恢复它。
+        // 协程帧被销毁(例如Reactor析构)时，析构函数把自己从队列中移除，或者归还已经收到的连接
+        class WaitAwaiter {
+        private:
+            ConnectionPool& pool_;
+            HostPool& host_;
+            Reactor& reactor_;
+            Waiter waiter_;
+            bool taken_ = false;
+
+        public:
+            WaitAwaiter(ConnectionPool& pool, HostPool& host, Reactor& reactor)
+                : pool_(pool), host_(host), reactor_(reactor) {}
+
+            WaitAwaiter(const WaitAwaiter&) = delete;
+            WaitAwaiter& operator=(const WaitAwaiter&) = delete;
+
+            ~WaitAwaiter() {
+                if (taken_) return;
+                std::unique_lock<std::mutex> lock(pool_.mutex_);
+                if (!waiter_.ready) {
+                    pool_.unlink(host_, waiter_);
+                    return;
+                }
+                lock.unlock();
+                pool_.give_back(host_, waiter_.fd, waiter_.fd >= 0);
+            }
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::vector<int> doomed;
+                bool suspended = true;
+                {
+                    std::lock_guard<std::mutex> lock(pool_.mutex_);
+                    if (pool_.grant(host_, waiter_.fd, doomed)) {
+                        waiter_.ready = true;
+                        suspended = false;
+                    } else {
+                        waiter_.handle = h;
+                        waiter_.reactor = &reactor_;
+                        pool_.enqueue(host_, waiter_);
+                    }
+                }
+                // 只有本线程上的Reactor会恢复h，关闭描述符期间协程不会继续执行
+                close_all(doomed);
+                return suspended;
+            }
+
+            // 空闲连接的描述符，或者-1表示得到了新建连接的名额
+            int await_resume() noexcept {
+                taken_ = true;
+                return waiter_.fd;
+            }
+        };
+
+    public:
+        explicit ConnectionPool(ConnectionPoolOptions options = {}) : options_(options) {
+            if (options_.max_per_host == 0) options_.max_per_host = 1;
+        }
+
+        // 关闭所有空闲连接；借出的连接必须在此之前归还或关闭
+        ~ConnectionPool() {
+            for (auto& [key, host] : hosts_) {
+                for (const auto& idle : host->idle) ::close(idle.fd);
+            }
+        }
+
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        const ConnectionPoolOptions& options() const noexcept {
+            return options_;
+        }
+
+        // 阻塞地获取连接：复用空闲连接，或者建立新连接，或者排队直到有连接归还。超时时抛出异常
+        PooledConnection acquire(const std::string& host, std::uint16_t port,
+                                 std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+            HostPool& entry = host_pool(host, port);
+            const auto deadline = Clock::now() + timeout;
+            std::unique_lock<std::mutex> lock(mutex_);
+            int fd = -1;
+            std::vector<int> doomed;
+            if (!grant(entry, fd, doomed)) {
+                Waiter waiter;
+                enqueue(entry, waiter);
+                // 已经排队，锁外关闭描述符期间归还的连接不会丢失
+                if (!doomed.empty()) {
+                    lock.unlock();
+                    close_all(doomed);
+                    lock.lock();
+                }
+                if (!released_.wait_until(lock, deadline, [&waiter] { return waiter.ready; })) {
+                    unlink(entry, waiter);
+                    throw std::runtime_error("ConnectionPool: timed out waiting for a connection to " + host);
+                }
+                fd = waiter.fd;
+            }
+            lock.unlock();
+            close_all(doomed);
+            return connect_granted(entry, fd);
+        }
+
+        // 不阻塞：返回健康的空闲连接，或者已经开始connect的新连接(connecting()为true时由调用方
+        // 等待可写)；达到每个主机的上限时返回空
+        std::optional<PooledConnection> try_acquire(const std::string& host, std::uint16_t port) {
+            HostPool& entry = host_pool(host, port);
+            int fd = -1;
+            std::vector<int> doomed;
+            bool granted;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                granted = grant(entry, fd, doomed);
+            }
+            close_all(doomed);
+            if (!granted) return std::nullopt;
+            if (fd >= 0) return PooledConnection(this, &entry, fd, true, false);
+            bool connected;
+            try {
+                connected = connection_pool_detail::start_connect(fd, entry.address);
+            } catch (...) {
+                give_back(entry, -1, false);
+                throw;
+            }
+            opened_.fetch_add(1, std::memory_order_relaxed);
+            return PooledConnection(this, &entry, fd, false, !connected);
+        }
+
+        // 在Reactor上获取连接，返回已经attach到reactor的连接。排队和connect期间协程挂起，
+        // 不阻塞事件循环(首次使用某个主机名时的地址解析除外，建议使用数字地址)
+        Task<PooledConnection> async_acquire(Reactor& reactor, std::string host, std::uint16_t port) {
+            HostPool& entry = host_pool(host, port);
+            int fd;
+            {
+                WaitAwaiter wait(*this, entry, reactor);
+                fd = co_await wait;
+            }
+            if (fd >= 0) {
+                PooledConnection connection(this, &entry, fd, true, false);
+                connection.attach(reactor);
+                co_return connection;
+            }
+            // 声明在socket之前：先关闭套接字，再归还名额
+            SlotGuard slot(*this, entry);
+            AsyncFd socket = make_tcp_socket(reactor);
+            co_await async_connect(socket, entry.address);
+            int one = 1;
+            ::setsockopt(socket.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            opened_.fetch_add(1, std::memory_order_relaxed);
+            slot.dismiss();
+            PooledConnection connection(this, &entry, socket.fd(), false, false);
+            connection.socket_ = std::move(socket);
+            co_return connection;
+        }
+
+        // 关闭所有空闲超时的连接，可以由定时器周期性地调用；acquire时也会顺便清理
+        std::size_t prune() {
+            std::vector<int> doomed;
+            std::size_t count = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const auto now = Clock::now();
+                for (auto& [key, host] : hosts_) count += expire(*host, now, doomed);
+            }
+            for (int fd : doomed) ::close(fd);
+            return count;
+        }
+
+        std::size_t idle_connections() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::size_t count = 0;
+            for (const auto& [key, host] : hosts_) count += host->idle.size();
+            return count;
+        }
+
+        ConnectionPoolStats stats() const noexcept {
+            ConnectionPoolStats stats;
+            stats.opened = opened_.load(std::memory_order_relaxed);
+            stats.reused = reused_.load(std::memory_order_relaxed);
+            stats.expired = expired_.load(std::memory_order_relaxed);
+            stats.unhealthy = unhealthy_.load(std::memory_order_relaxed);
+            stats.waits = waits_.load(std::memory_order_relaxed);
+            return stats;
+        }
+    };
+
+    inline void PooledConnection::give_back(bool keep) noexcept {
+        if (fd_ < 0) return;
+        // 先从Reactor注销，描述符才能交给别的使用者
+        if (socket_.valid()) socket_.release();
+        keep = keep && !connecting_;
+        pool_->give_back(*host_, std::exchange(fd_, -1), keep);
+        pool_ = nullptr;
+        host_ = nullptr;
+    }
+
+    inline void PooledConnection::give_back_slot() noexcept {
+        pool_->give_back(*host_, -1, false);
+        pool_ = nullptr;
+        host_ = nullptr;
+    }
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_CONNECTION_POOL_H
@@ -0,0 +1,310 @@
+#ifndef CPP_LEARNING_DEMO_HTTP_CLIENT_H
+#define CPP_LEARNING_DEMO_HTTP_CLIENT_H
+
+// 阻塞的HTTP/1.1客户端
+//
+// 连接来自ConnectionPool(connection_pool.h)：每次请求借出一个到目标host:port的连接，
+// 完整读完长连接上的响应后还给连接池，下一次请求(或者共享同一个连接池的其他客户端)复用它；
+// 复用的连接已被服务器关闭时换一个连接重发一次(只重发幂等的方法，或者一个字节都没有发出去的请求)。
+// 1xx临时响应(101除外)被跳过。连接池不复用连接(max_idle_per_host = 0)时
+// 请求带上"Connection: close"，由服务器先关闭连接。
+// 响应用HTTPResponseParser解析(支持Content-Length、分块传输和读到连接关闭三种分帧方式)，
+// 解析结果复制到HTTPClientResponse中返回。只支持http://，不支持TLS。
+// 一个HTTPClient同一时刻只能在一个线程上使用；多个线程各用一个HTTPClient，共享同一个连接池。
+#if defined(__linux__)
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "connection_pool.h"
+#include "http_parser.h"
+#include "url_parser.h"
+
+namespace network_demo {
+    struct HTTPClientResponse {
+        int status = 0;
+        std::string reason;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+
+        // 第一个同名头部的值(名字不区分大小写)，不存在时返回空
+        std::string_view header(std::string_view name) const noexcept {
+            for (const auto& [key, value] : headers) {
+                if (http_detail::iequals(key, name)) return value;
+            }
+            return {};
+        }
+    };
+
+    class HTTPClient {
+    private:
+        struct Target {
+            std::string host;
+            std::uint16_t port = 80;
+            std::string path;
+        };
+
+        std::chrono::milliseconds timeout_;
+        std::shared_ptr<ConnectionPool> pool_;
+        // 当前请求借出的连接，请求结束后归还或关闭
+        PooledConnection connection_;
+        std::vector<char> buffer_;
+        std::size_t size_ = 0;
+        HTTPResponseParser parser_;
+        std::string request_;
+        // 这次尝试是否已经有字节写进了连接
+        bool sent_ = false;
+        std::uint64_t connections_opened_ = 0;
+
+        // "http://host[:port][/path][?query]"，片段不发送
+        static Target split_url(std::string_view url) {
+            std::optional<URLView> view = URLView::parse(url);
+            if (!view || !url_detail::iequals(view->scheme, "http") || !view->has_authority) {
+                throw std::invalid_argument("HTTPClient supports only http:// URLs: " + std::string(url));
+            }
+            if (view->host.empty()) throw std::invalid_argument("missing host in URL");
+            if (!view->port_text.empty() && view->port == 0) throw std::invalid_argument("invalid port in URL");
+            Target target;
+            target.host = std::string(view->host);
+            target.port = view->effective_port();
+            target.path = view->path.empty() ? "/" : std::string(view->path);
+            if (!view->query.empty()) target.path.append("?").append(view->query);
+            return target;
+        }
+
+        // 连接池中的套接字是非阻塞的，在这里等待就绪
+        void wait(short events, const char* what) {
+            pollfd entry{connection_.fd(), events, 0};
+            int n;
+            while ((n = ::poll(&entry, 1, static_cast<int>(timeout_.count()))) < 0 && errno == EINTR) {}
+            if (n > 0) return;
+            const int error = errno;
+            disconnect();
+            if (n == 0) throw std::runtime_error(std::string("HTTPClient: timed out waiting to ") + what);
+            throw_errno(error, "poll");
+        }
+
+        // 返回false表示连接已被对端关闭(可以重连后重试)
+        bool write_all(const char* data, std::size_t size) {
+            while (size > 0) {
+                ssize_t n = ::send(connection_.fd(), data, size, MSG_NOSIGNAL);
+                if (n > 0) {
+                    sent_ = true;
+                    data += n;
+                    size -= static_cast<std::size_t>(n);
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    wait(POLLOUT, "send the request");
+                } else if (n < 0 && (errno == EPIPE || errno == ECONNRESET)) {
+                    return false;
+                } else {
+                    throw_errno(n < 0 ? errno : EIO, "send");
+                }
+            }
+            return true;
+        }
+
+        void append_request(std::string_view method, const Target& target, std::string_view body,
+                            std::string_view content_type) {
+            request_.append(method).append(" ").append(target.path).append(" HTTP/1.1\r\nHost: ").append(target.host);
+            if (target.port != 80) request_.append(":").append(std::to_string(target.port));
+            request_.append("\r\n");
+            if (pool_->options().max_idle_per_host == 0) request_.append("Connection: close\r\n");
+            if (!body.empty() || method == "POST" || method == "PUT") {
+                if (!content_type.empty()) request_.append("Content-Type: ").append(content_type).append("\r\n");
+                request_.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+            }
+            request_.append("\r\n").append(body);
+        }
+
+        static HTTPClientResponse copy_response(const HTTPResponseView& view) {
+            HTTPClientResponse response;
+            response.status = view.status;
+            response.reason = std::string(view.reason);
+            response.headers.reserve(view.header_count);
+            for (const HTTPHeader& header : view.headers()) {
+                response.headers.emplace_back(std::string(header.name), std::string(header.value));
+            }
+            response.body = std::string(view.body);
+            return response;
+        }
+
+        // 读取并解析一个响应。连接在响应的第一个字节之前被关闭时返回false
+        bool read_response(HTTPClientResponse& response, bool head_request) {
+            parser_.expect_no_body(head_request);
+            parser_.reset();
+            bool fresh = true;
+            for (;;) {
+                if (size_ > 0 && fresh) {
+                    HTTPParseStatus status = parser_.parse(buffer_.data(), size_);
+                    if (status == HTTPParseStatus::error) {
+                        disconnect();
+                        throw std::runtime_error("HTTPClient: malformed response");
+                    }
+                    if (status == HTTPParseStatus::complete) {
+                        const int code = parser_.message().status;
+                        if (code >= 200 || code == 101) break;
+                        // 1xx临时响应(如100 Continue)之后才是真正的响应
+                        consume(parser_.consumed());
+                        parser_.reset();
+                        continue;
+                    }
+                }
+                if (buffer_.size() - size_ < 4096) buffer_.resize(std::max<std::size_t>(buffer_.size() * 2, size_ + 16 * 1024));
+                ssize_t n = ::recv(connection_.fd(), buffer_.data() + size_, buffer_.size() - size_, 0);
+                if (n > 0) {
+                    size_ += static_cast<std::size_t>(n);
+                    fresh = true;
+                } else if (n == 0 || errno == ECONNRESET) {
+                    if (size_ == 0) return false;
+                    if (parser_.finish(buffer_.data(), size_) != HTTPParseStatus::complete) {
+                        disconnect();
+                        throw std::runtime_error("HTTPClient: connection closed in the middle of a response");
+                    }
+                    break;
+                } else if (errno == EINTR) {
+                    fresh = false;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    wait(POLLIN, "receive the response");
+                    fresh = false;
+                } else {
+                    throw_errno(errno, "recv");
+                }
+            }
+
+            const HTTPResponseView& view = parser_.message();
+            response = copy_response(view);
+            const bool keep_alive = view.keep_alive;
+            consume(parser_.consumed());
+            if (!keep_alive) disconnect();
+            return true;
+        }
+
+        // 流水线中后续响应的字节移到缓冲区开头
+        void consume(std::size_t consumed) noexcept {
+            std::memmove(buffer_.data(), buffer_.data() + consumed, size_ - consumed);
+            size_ -= consumed;
+        }
+
+        // 幂等的方法重发不会改变服务器上的结果
+        static bool idempotent(std::string_view method) noexcept {
+            return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" ||
+                   method == "OPTIONS" || method == "TRACE";
+        }
+
+        // 借出一个连接，发送request_并读取count个响应；复用的连接已被服务器关闭时换一个连接重发一次。
+        // 非幂等的请求只在一个字节都没有发出去时重发，否则服务器可能已经执行过它。
+        // 响应都读完、服务器没有要求关闭、也没有多余的数据时，连接还给连接池
+        std::vector<HTTPClientResponse> exchange(const Target& target, std::size_t count, bool head_request,
+                                                 bool retryable) {
+            for (int attempt = 0;; ++attempt) {
+                connection_ = pool_->acquire(target.host, target.port, timeout_);
+                size_ = 0;
+                const bool reused = connection_.reused();
+                if (!reused) ++connections_opened_;
+                std::vector<HTTPClientResponse> responses;
+                responses.reserve(count);
+                sent_ = false;
+                bool ok = write_all(request_.data(), request_.size());
+                while (ok && responses.size() < count) {
+                    if (!connection_) throw std::runtime_error("HTTPClient: server closed the connection during pipelining");
+                    HTTPClientResponse response;
+                    ok = read_response(response, head_request);
+                    if (ok) responses.push_back(std::move(response));
+                }
+                if (ok) {
+                    if (size_ == 0) connection_.release();
+                    else disconnect();
+                    return responses;
+                }
+                disconnect();
+                // 只有还没收到任何响应、而且用的是复用的连接时才重试
+                if (!reused || attempt > 0 || !responses.empty() || (sent_ && !retryable)) {
+                    throw std::runtime_error("HTTPClient: connection closed before the response");
+                }
+            }
+        }
+
+    public:
+        // 使用自己的连接池
+        explicit HTTPClient(std::chrono::milliseconds timeout = std::chrono::seconds(10), HTTPLimits limits = {})
+            : HTTPClient(std::make_shared<ConnectionPool>(), timeout, limits) {}
+
+        // 与其他客户端共享连接池
+        explicit HTTPClient(std::shared_ptr<ConnectionPool> pool,
+                            std::chrono::milliseconds timeout = std::chrono::seconds(10), HTTPLimits limits = {})
+            : timeout_(timeout), pool_(std::move(pool)), parser_(limits) {}
+
+        ~HTTPClient() {
+            disconnect();
+        }
+
+        HTTPClient(const HTTPClient&) = delete;
+        HTTPClient& operator=(const HTTPClient&) = delete;
+
+        HTTPClientResponse request(std::string_view method, const std::string& url, std::string_view body = {},
+                                   std::string_view content_type = {}) {
+            const Target target = split_url(url);
+            request_.clear();
+            append_request(method, target, body, content_type);
+            return std::move(exchange(target, 1, method == "HEAD", idempotent(method)).front());
+        }
+
+        HTTPClientResponse get(const std::string& url) {
+            return request("GET", url);
+        }
+
+        HTTPClientResponse post(const std::string& url, std::string_view data,
+                                std::string_view content_type = "application/json") {
+            return request("POST", url, data, content_type);
+        }
+
+        // 流水线：在一个借出的连接上一次写出所有GET请求，再按顺序读取响应。所有URL必须指向同一个主机和端口
+        std::vector<HTTPClientResponse> get_pipelined(const std::vector<std::string>& urls) {
+            if (urls.empty()) return {};
+            const Target first = split_url(urls.front());
+            request_.clear();
+            for (const std::string& url : urls) {
+                Target target = split_url(url);
+                if (target.host != first.host || target.port != first.port) {
+                    throw std::invalid_argument("pipelined requests must share one host and port");
+                }
+                append_request("GET", target, {}, {});
+            }
+            return exchange(first, urls.size(), false, true);
+        }
+
+        // 这个客户端的请求新建的TCP连接数(其余请求复用了连接池中的连接)
+        std::uint64_t connections_opened() const noexcept {
+            return connections_opened_;
+        }
+
+        ConnectionPool& pool() noexcept {
+            return *pool_;
+        }
+
+        // 关闭当前借出的连接(不还给连接池)
+        void disconnect() noexcept {
+            connection_.close();
+            size_ = 0;
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_HTTP_CLIENT_H
@@ -0,0 +1,458 @@
+#ifndef CPP_LEARNING_DEMO_HTTP_PARSER_H
+#define CPP_LEARNING_DEMO_HTTP_PARSER_H
+
+// HTTP/1.1增量解析器
+//
+// - 零拷贝：解析结果中的方法、目标、头部和消息体都是指向接收缓冲区的std::string_view，
+//   在调用方取走(consume)这段数据之前有效
+// - 增量：数据分多次到达时，每次调用只扫描新到的字节；调用方每次传入从当前消息开头起的全部数据
+//   (缓冲区可以在两次调用之间扩容或移动，位置都按相对消息开头的偏移记录)
+// - 分块传输编码(chunked)在缓冲区内原地解码：块数据向前移动拼接成连续的消息体，不另外分配内存
+// - 流水线：一次调用只解析一条消息，consumed()给出它占用的字节数，后面的字节属于下一条消息
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace network_demo {
+    // 每条消息最多保存的头部数量，超过时按431(头部过大)处理
+    inline constexpr std::size_t kMaxHTTPHeaders = 32;
+
+    struct HTTPHeader {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    struct HTTPLimits {
+        // 起始行加全部头部的最大字节数
+        std::size_t max_header_bytes = 8 * 1024;
+        std::size_t max_body = 1 << 20;
+    };
+
+    enum class HTTPParseStatus { complete, incomplete, error };
+
+    namespace http_detail {
+        // RFC 9110中token允许的字符
+        inline constexpr auto kTokenTable = [] {
+            std::array<bool, 256> table{};
+            for (int c = '0'; c <= '9'; ++c) table[static_cast<std::size_t>(c)] = true;
+            for (int c = 'a'; c <= 'z'; ++c) table[static_cast<std::size_t>(c)] = true;
+            for (int c = 'A'; c <= 'Z'; ++c) table[static_cast<std::size_t>(c)] = true;
+            for (char c : std::string_view("!#$%&'*+-.^_`|~")) table[static_cast<unsigned char>(c)] = true;
+            return table;
+        }();
+
+        inline bool is_token(std::string_view s) noexcept {
+            if (s.empty()) return false;
+            for (char c : s) {
+                if (!kTokenTable[static_cast<unsigned char>(c)]) return false;
+            }
+            return true;
+        }
+
+        inline char to_lower(char c) noexcept {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        inline bool iequals(std::string_view a, std::string_view b) noexcept {
+            if (a.size() != b.size()) return false;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (to_lower(a[i]) != to_lower(b[i])) return false;
+            }
+            return true;
+        }
+
+        inline std::string_view trim(std::string_view s) noexcept {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+            return s;
+        }
+
+        // 逗号分隔的列表(如Connection头)中是否包含token，不区分大小写
+        inline bool list_contains(std::string_view list, std::string_view token) noexcept {
+            while (!list.empty()) {
+                std::size_t comma = list.find(',');
+                if (iequals(trim(list.substr(0, comma)), token)) return true;
+                if (comma == std::string_view::npos) break;
+                list.remove_prefix(comma + 1);
+            }
+            return false;
+        }
+
+        // 十进制的Content-Length；不是纯数字或溢出时返回false
+        inline bool parse_length(std::string_view s, std::uint64_t& value) noexcept {
+            if (s.empty() || s.size() > 18) return false;
+            value = 0;
+            for (char c : s) {
+                if (c < '0' || c > '9') return false;
+                value = value * 10 + static_cast<std::uint64_t>(c - '0');
+            }
+            return true;
+        }
+
+        inline int hex_value(char c) noexcept {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+    }
+
+    // 请求和响应共有的部分
+    struct HTTPMessage {
+        // HTTP/1.x中的x
+        int version_minor = 1;
+        // 这条消息之后连接是否保持：HTTP/1.1默认保持，HTTP/1.0默认关闭，Connection头可以改变默认值
+        bool keep_alive = true;
+        bool chunked = false;
+        std::string_view body;
+        std::array<HTTPHeader, kMaxHTTPHeaders> header_storage{};
+        std::size_t header_count = 0;
+
+        std::span<const HTTPHeader> headers() const noexcept {
+            return {header_storage.data(), header_count};
+        }
+
+        // 第一个同名头部的值(名字不区分大小写)，不存在时返回空
+        std::string_view header(std::string_view name) const noexcept {
+            for (std::size_t i = 0; i < header_count; ++i) {
+                if (http_detail::iequals(header_storage[i].name, name)) return header_storage[i].value;
+            }
+            return {};
+        }
+
+        bool has_header(std::string_view name) const noexcept {
+            for (std::size_t i = 0; i < header_count; ++i) {
+                if (http_detail::iequals(header_storage[i].name, name)) return true;
+            }
+            return false;
+        }
+    };
+
+    struct HTTPRequest : HTTPMessage {
+        std::string_view method;
+        std::string_view target;
+    };
+
+    struct HTTPResponseView : HTTPMessage {
+        int status = 0;
+        std::string_view reason;
+    };
+
+    // Message是HTTPRequest(服务器端)或HTTPResponseView(客户端)
+    template<class Message>
+    class BasicHTTPParser {
+    private:
+        static constexpr bool kIsRequest = std::is_same_v<Message, HTTPRequest>;
+
+        enum class Phase { start, head, fixed_body, chunk_size, chunk_data, chunk_end, trailers, until_close, done };
+
+        HTTPLimits limits_;
+        Phase phase_ = Phase::start;
+        Message message_;
+        // 上次解析头部时缓冲区的地址；完成时地址变了就重新解析头部，让string_view指向新位置
+        const char* head_base_ = nullptr;
+        // 已经确认不含头部结束标记的字节数
+        std::size_t scanned_ = 0;
+        std::size_t head_size_ = 0;
+        std::uint64_t content_length_ = 0;
+        // 分块解码：read_是下一个未解析的原始字节，write_是已解码消息体的末尾(都相对消息开头)
+        std::size_t read_ = 0;
+        std::size_t write_ = 0;
+        std::uint64_t chunk_left_ = 0;
+        std::size_t consumed_ = 0;
+        int error_status_ = 0;
+        // 客户端：对应的请求是HEAD，响应没有消息体
+        bool no_body_ = false;
+
+        HTTPParseStatus fail(int status) noexcept {
+            error_status_ = status;
+            return HTTPParseStatus::error;
+        }
+
+        // 起始行：请求为"METHOD SP target SP HTTP/1.x"，响应为"HTTP/1.x SP 3DIGIT SP reason"
+        bool parse_start_line(std::string_view line) noexcept {
+            auto parse_version = [this](std::string_view v) {
+                if (v.size() != 8 || v.substr(0, 7) != "HTTP/1." || (v[7] != '0' && v[7] != '1')) return false;
+                message_.version_minor = v[7] - '0';
+                return true;
+            };
+            if constexpr (kIsRequest) {
+                std::size_t first = line.find(' ');
+                if (first == std::string_view::npos) return false;
+                std::size_t second = line.find(' ', first + 1);
+                if (second == std::string_view::npos) return false;
+                message_.method = line.substr(0, first);
+                message_.target = line.substr(first + 1, second - first - 1);
+                if (!http_detail::is_token(message_.method) || message_.target.empty()) return false;
+                return parse_version(line.substr(second + 1));
+            } else {
+                if (line.size() < 12 || !parse_version(line.substr(0, 8)) || line[8] != ' ') return false;
+                int status = 0;
+                for (std::size_t i = 9; i < 12; ++i) {
+                    if (line[i] < '0' || line[i] > '9') return false;
+                    status = status * 10 + (line[i] - '0');
+                }
+                if (line.size() > 12 && line[12] != ' ') return false;
+                message_.status = status;
+                message_.reason = line.size() > 13 ? line.substr(13) : std::string_view{};
+                return true;
+            }
+        }
+
+        // 解析[0, head_size_)中的起始行和头部，确定消息体的分帧方式
+        HTTPParseStatus parse_head(const char* data) noexcept {
+            head_base_ = data;
+            std::string_view head(data, head_size_ - 2);
+            std::size_t end = head.find("\r\n");
+            if (!parse_start_line(head.substr(0, end))) return fail(400);
+            head.remove_prefix(end + 2);
+
+            message_.header_count = 0;
+            bool has_length = false;
+            bool close = false;
+            bool keep = false;
+            bool chunked = false;
+            bool other_coding = false;
+            while (!head.empty()) {
+                end = head.find("\r\n");
+                std::string_view line = head.substr(0, end);
+                head.remove_prefix(end + 2);
+                std::size_t colon = line.find(':');
+                if (colon == std::string_view::npos) return fail(400);
+                std::string_view name = line.substr(0, colon);
+                std::string_view value = http_detail::trim(line.substr(colon + 1));
+                // 名字必须是token(也排除了名字后的空白和折行)，值中不能有裸的CR或LF
+                if (!http_detail::is_token(name) || value.find_first_of("\r\n") != std::string_view::npos) {
+                    return fail(400);
+                }
+                if (message_.header_count == kMaxHTTPHeaders) return fail(431);
+                message_.header_storage[message_.header_count++] = HTTPHeader{name, value};
+
+                if (http_detail::iequals(name, "Content-Length")) {
+                    std::uint64_t length = 0;
+                    if (!http_detail::parse_length(value, length)) return fail(400);
+                    if (has_length && length != content_length_) return fail(400);
+                    has_length = true;
+                    content_length_ = length;
+                } else if (http_detail::iequals(name, "Transfer-Encoding")) {
+                    // 只支持chunked，它必须是最后一个编码
+                    std::size_t comma = value.rfind(',');
+                    std::string_view last = http_detail::trim(comma == std::string_view::npos ? value : value.substr(comma + 1));
+                    if (http_detail::iequals(last, "chunked") && comma == std::string_view::npos) {
+                        chunked = true;
+                    } else {
+                        other_coding = true;
+                    }
+                } else if (http_detail::iequals(name, "Connection")) {
+                    close = close || http_detail::list_contains(value, "close");
+                    keep = keep || http_detail::list_contains(value, "keep-alive");
+                }
+            }
+
+            message_.keep_alive = close ? false : (message_.version_minor >= 1 || keep);
+            message_.chunked = chunked;
+            if (other_coding) return fail(kIsRequest ? 501 : 502);
+            // 同时出现两种长度信息时无法确定消息边界(请求走私)，直接拒绝
+            if (chunked && has_length) return fail(400);
+            if (has_length && content_length_ > limits_.max_body) return fail(413);
+
+            read_ = write_ = head_size_;
+            if constexpr (!kIsRequest) {
+                const int status = message_.status;
+                if (no_body_ || (status >= 100 && status < 200) || status == 204 || status == 304) {
+                    content_length_ = 0;
+                    phase_ = Phase::fixed_body;
+                    return HTTPParseStatus::incomplete;
+                }
+                if (!chunked && !has_length) {
+                    // 没有长度信息的响应读到连接关闭为止
+                    message_.keep_alive = false;
+                    phase_ = Phase::until_close;
+                    return HTTPParseStatus::incomplete;
+                }
+            }
+            if (!has_length) content_length_ = 0;
+            phase_ = chunked ? Phase::chunk_size : Phase::fixed_body;
+            return HTTPParseStatus::incomplete;
+        }
+
+        HTTPParseStatus parse_chunks(char* data, std::size_t size) noexcept {
+            for (;;) {
+                switch (phase_) {
+                    case Phase::chunk_size: {
+                        const void* found = std::memchr(data + read_, '\n', size - read_);
+                        if (found == nullptr) {
+                            return size - read_ > 256 ? fail(400) : HTTPParseStatus::incomplete;
+                        }
+                        std::size_t newline = static_cast<std::size_t>(static_cast<const char*>(found) - data);
+                        if (newline == read_ || data[newline - 1] != '\r') return fail(400);
+                        std::uint64_t chunk = 0;
+                        std::size_t i = read_;
+                        for (; i < newline - 1 && http_detail::hex_value(data[i]) >= 0; ++i) {
+                            chunk = chunk * 16 + static_cast<std::uint64_t>(http_detail::hex_value(data[i]));
+                            if (chunk > limits_.max_body) return fail(413);
+                        }
+                        // 至少一位十六进制数字，之后只能是块扩展(";name=value"，忽略)
+                        if (i == read_ || (i < newline - 1 && data[i] != ';' && data[i] != ' ' && data[i] != '\t')) {
+                            return fail(400);
+                        }
+                        if (write_ - head_size_ + chunk > limits_.max_body) return fail(413);
+                        read_ = newline + 1;
+                        chunk_left_ = chunk;
+                        phase_ = chunk == 0 ? Phase::trailers : Phase::chunk_data;
+                        break;
+                    }
+                    case Phase::chunk_data: {
+                        std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_left_, size - read_));
+                        if (read_ != write_) std::memmove(data + write_, data + read_, n);
+                        read_ += n;
+                        write_ += n;
+                        chunk_left_ -= n;
+                        if (chunk_left_ > 0) return HTTPParseStatus::incomplete;
+                        phase_ = Phase::chunk_end;
+                        break;
+                    }
+                    case Phase::chunk_end:
+                        if (size - read_ < 2) return HTTPParseStatus::incomplete;
+                        if (data[read_] != '\r' || data[read_ + 1] != '\n') return fail(400);
+                        read_ += 2;
+                        phase_ = Phase::chunk_size;
+                        break;
+                    case Phase::trailers: {
+                        // 尾部头部逐行跳过，空行结束
+                        const void* found = std::memchr(data + read_, '\n', size - read_);
+                        if (found == nullptr) {
+                            return size - read_ > limits_.max_header_bytes ? fail(431) : HTTPParseStatus::incomplete;
+                        }
+                        std::size_t newline = static_cast<std::size_t>(static_cast<const char*>(found) - data);
+                        if (newline == read_ || data[newline - 1] != '\r') return fail(400);
+                        bool empty = newline == read_ + 1;
+                        read_ = newline + 1;
+                        if (empty) {
+                            consumed_ = read_;
+                            return HTTPParseStatus::complete;
+                        }
+                        break;
+                    }
+                    default:
+                        return fail(400);
+                }
+            }
+        }
+
+        HTTPParseStatus finish_message(const char* data, std::size_t body_end) noexcept {
+            if (data != head_base_) parse_head(data);
+            message_.body = std::string_view(data + head_size_, body_end - head_size_);
+            phase_ = Phase::done;
+            return HTTPParseStatus::complete;
+        }
+
+    public:
+        explicit BasicHTTPParser(HTTPLimits limits = {}) : limits_(limits) {}
+
+        // data指向当前消息的开头，size是目前收到的全部字节。返回complete时message()和consumed()有效，
+        // 下一次调用开始解析新的消息；返回error时error_status()给出应当回复的状态码
+        HTTPParseStatus parse(char* data, std::size_t size) noexcept {
+            if (phase_ == Phase::done || phase_ == Phase::start) reset();
+            if (phase_ == Phase::head) {
+                // 从上次扫描的位置之前3个字节开始，结束标记可能跨越两次到达的数据
+                std::size_t from = scanned_ >= 3 ? scanned_ - 3 : 0;
+                std::string_view received(data, std::min(size, limits_.max_header_bytes + 4));
+                std::size_t end = received.find("\r\n\r\n", from);
+                if (end == std::string_view::npos) {
+                    scanned_ = received.size();
+                    return size > limits_.max_header_bytes ? fail(431) : HTTPParseStatus::incomplete;
+                }
+                head_size_ = end + 4;
+                if (head_size_ > limits_.max_header_bytes + 2) return fail(431);
+                if (parse_head(data) == HTTPParseStatus::error) return HTTPParseStatus::error;
+            }
+            switch (phase_) {
+                case Phase::fixed_body:
+                    if (size - head_size_ < content_length_) return HTTPParseStatus::incomplete;
+                    consumed_ = head_size_ + static_cast<std::size_t>(content_length_);
+                    return finish_message(data, consumed_);
+                case Phase::until_close:
+                    if (size - head_size_ > limits_.max_body) return fail(413);
+                    return HTTPParseStatus::incomplete;
+                case Phase::chunk_size:
+                case Phase::chunk_data:
+                case Phase::chunk_end:
+                case Phase::trailers: {
+                    HTTPParseStatus status = parse_chunks(data, size);
+                    return status == HTTPParseStatus::complete ? finish_message(data, write_) : status;
+                }
+                default:
+                    return fail(400);
+            }
+        }
+
+        // 连接在消息结束前关闭：读到关闭为止的响应在这里完成，其他情况是错误
+        HTTPParseStatus finish(char* data, std::size_t size) noexcept {
+            if (phase_ != Phase::until_close) return fail(400);
+            consumed_ = size;
+            return finish_message(data, size);
+        }
+
+        // 开始解析新消息，丢弃未完成的状态
+        void reset() noexcept {
+            phase_ = Phase::head;
+            message_.header_count = 0;
+            message_.body = {};
+            head_base_ = nullptr;
+            scanned_ = head_size_ = read_ = write_ = consumed_ = 0;
+            content_length_ = chunk_left_ = 0;
+            error_status_ = 0;
+        }
+
+        // 客户端在发送HEAD请求后设置：对应的响应只有头部
+        void expect_no_body(bool no_body) noexcept {
+            no_body_ = no_body;
+        }
+
+        const Message& message() const noexcept {
+            return message_;
+        }
+
+        std::size_t consumed() const noexcept {
+            return consumed_;
+        }
+
+        int error_status() const noexcept {
+            return error_status_;
+        }
+    };
+
+    using HTTPRequestParser = BasicHTTPParser<HTTPRequest>;
+    using HTTPResponseParser = BasicHTTPParser<HTTPResponseView>;
+
+    // 常见状态码的原因短语
+    inline std::string_view http_reason(int status) noexcept {
+        switch (status) {
+            case 100: return "Continue";
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 301: return "Moved Permanently";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 413: return "Content Too Large";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 502: return "Bad Gateway";
+            case 503: return "Service Unavailable";
+            default: return "Unknown";
+        }
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_HTTP_PARSER_H
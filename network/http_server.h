@@ -0,0 +1,303 @@
+#ifndef CPP_LEARNING_DEMO_HTTP_SERVER_H
+#define CPP_LEARNING_DEMO_HTTP_SERVER_H
+
+// 基于TCPServer的HTTP/1.1服务器
+//
+// - 请求用HTTPRequestParser在连接的输入缓冲区上原地解析，处理函数拿到的HTTPRequest指向接收缓冲区
+// - 长连接：HTTP/1.1默认保持连接，"Connection: close"或HTTP/1.0(没有keep-alive)时发完响应后关闭
+// - 流水线：一次读到的多个完整请求依次处理，它们的响应收集成iovec数组，用一次聚集写(sendmsg)发出；
+//   响应体可以直接引用请求中的数据或静态数据，发出前不复制
+// - 每个连接的解析器和响应对象来自所属事件循环的空闲列表，连接关闭后放回复用：建立连接和处理请求的路径上
+//   都不分配内存(响应对象中的字符串保留容量，只在超过以前的大小时扩容)
+#if defined(__linux__)
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "http_parser.h"
+#include "tcp_server.h"
+
+namespace network_demo {
+    // 处理函数填写的响应：状态码、头部和消息体。服务器负责Content-Length/Transfer-Encoding和Connection头
+    class HTTPResponse {
+    private:
+        int status_ = 200;
+        std::string_view reason_;
+        // 处理函数添加的头部，已经是"Name: value\r\n"的形式
+        std::string headers_;
+        std::string_view body_;
+        std::string storage_;
+        bool chunked_ = false;
+        bool keep_alive_ = true;
+        // 序列化后的状态行和头部(分块时还包括第一个块的长度行)
+        std::string head_;
+
+        static constexpr std::string_view kChunkedTail = "\r\n0\r\n\r\n";
+        static constexpr std::string_view kLastChunk = "0\r\n\r\n";
+
+        void append_number(std::uint64_t value, int base) {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+            head_.append(digits, result.ptr);
+        }
+
+    public:
+        // 复用前恢复默认值，字符串的容量保留
+        void reset() noexcept {
+            status_ = 200;
+            reason_ = {};
+            headers_.clear();
+            body_ = {};
+            storage_.clear();
+            chunked_ = false;
+            keep_alive_ = true;
+        }
+
+        // reason为空时使用状态码的标准原因短语；reason需要在响应发出前保持有效
+        void set_status(int status, std::string_view reason = {}) noexcept {
+            status_ = status;
+            reason_ = reason;
+        }
+
+        int status() const noexcept {
+            return status_;
+        }
+
+        // 名字和值立即复制到头部缓冲区，可以传入临时字符串
+        void add_header(std::string_view name, std::string_view value) {
+            headers_.append(name).append(": ").append(value).append("\r\n");
+        }
+
+        // 零拷贝的消息体：body必须在处理函数返回后、响应发出前保持有效，例如静态数据或请求中的数据
+        void set_body(std::string_view body) noexcept {
+            body_ = body;
+        }
+
+        // 生成的消息体写到这里；调用后消息体就是这个字符串
+        std::string& body_buffer() noexcept {
+            body_ = {};
+            return storage_;
+        }
+
+        std::string_view body() const noexcept {
+            return body_.data() != nullptr ? body_ : std::string_view(storage_);
+        }
+
+        // 用分块传输编码发送消息体(整个消息体作为一个块)
+        void set_chunked(bool chunked) noexcept {
+            chunked_ = chunked;
+        }
+
+        // 发完这个响应后关闭连接
+        void close_connection() noexcept {
+            keep_alive_ = false;
+        }
+
+        bool keep_alive() const noexcept {
+            return keep_alive_;
+        }
+
+        // 把响应写成最多3个iovec(头部、消息体、分块结尾)，返回个数。head_only用于HEAD请求：
+        // 头部中的长度照常给出，但不发送消息体。iovec指向这个对象和消息体，在发出前不能修改它们
+        int serialize(iovec* iov, bool head_only) {
+            const std::string_view body = this->body();
+            head_.clear();
+            head_.append("HTTP/1.1 ");
+            append_number(static_cast<std::uint64_t>(status_), 10);
+            head_.push_back(' ');
+            head_.append(reason_.empty() ? http_reason(status_) : reason_);
+            head_.append("\r\n");
+            head_.append(headers_);
+            if (chunked_) {
+                head_.append("Transfer-Encoding: chunked\r\n");
+            } else {
+                head_.append("Content-Length: ");
+                append_number(body.size(), 10);
+                head_.append("\r\n");
+            }
+            if (!keep_alive_) head_.append("Connection: close\r\n");
+            head_.append("\r\n");
+
+            int count = 1;
+            if (head_only) {
+                // 没有消息体
+            } else if (chunked_ && body.empty()) {
+                head_.append(kLastChunk);
+            } else if (chunked_) {
+                append_number(body.size(), 16);
+                head_.append("\r\n");
+                iov[count++] = iovec{const_cast<char*>(body.data()), body.size()};
+                iov[count++] = iovec{const_cast<char*>(kChunkedTail.data()), kChunkedTail.size()};
+            } else if (!body.empty()) {
+                iov[count++] = iovec{const_cast<char*>(body.data()), body.size()};
+            }
+            iov[0] = iovec{head_.data(), head_.size()};
+            return count;
+        }
+    };
+
+    using HTTPHandler = std::function<void(const HTTPRequest&, HTTPResponse&)>;
+
+    struct HTTPServerOptions {
+        TCPServerOptions tcp;
+        HTTPLimits limits;
+        // 一次聚集写最多包含的流水线响应数
+        std::size_t max_pipeline_batch = 64;
+    };
+
+    class HTTPServer {
+    private:
+        // 每个连接的解析状态和可复用的响应对象
+        struct Session {
+            HTTPRequestParser parser;
+            std::vector<HTTPResponse> responses;
+            std::vector<iovec> iov;
+
+            Session(const HTTPLimits& limits, std::size_t batch)
+                : parser(limits), responses(batch), iov(batch * 3) {}
+        };
+
+        HTTPServerOptions options_;
+        HTTPHandler handler_;
+        std::atomic<std::uint64_t> requests_{0};
+        // 每个事件循环一个空闲Session列表，只由这个事件循环的线程访问，不需要加锁
+        std::vector<std::vector<std::unique_ptr<Session>>> free_sessions_;
+        // 最后声明：析构时先停止事件循环，关闭的连接把Session放回上面的空闲列表
+        TCPServer server_;
+
+        TCPServerCallbacks callbacks() {
+            TCPServerCallbacks callbacks;
+            callbacks.on_open = [this](TCPConnection& connection) {
+                auto& free = free_sessions_[connection.loop()];
+                std::unique_ptr<Session> session;
+                if (free.empty()) {
+                    session = std::make_unique<Session>(options_.limits, options_.max_pipeline_batch);
+                } else {
+                    session = std::move(free.back());
+                    free.pop_back();
+                    session->parser.reset();
+                }
+                connection.set_user_data(session.release());
+            };
+            callbacks.on_close = [this](TCPConnection& connection) {
+                std::unique_ptr<Session> session(static_cast<Session*>(connection.user_data()));
+                connection.set_user_data(nullptr);
+                if (session) free_sessions_[connection.loop()].push_back(std::move(session));
+            };
+            callbacks.on_message = [this](TCPConnection& connection, ByteBuffer& input) {
+                on_message(connection, input);
+            };
+            return callbacks;
+        }
+
+        void on_message(TCPConnection& connection, ByteBuffer& input) {
+            // 已经决定关闭的连接上后续的请求不再处理
+            if (!connection.open()) {
+                input.consume(input.size());
+                return;
+            }
+            Session& session = *static_cast<Session*>(connection.user_data());
+            char* data = input.data();
+            std::size_t offset = 0;
+            bool close = false;
+            while (!close) {
+                std::size_t batch = 0;
+                std::uint64_t handled = 0;
+                int count = 0;
+                bool incomplete = false;
+                while (batch < session.responses.size()) {
+                    HTTPParseStatus status = session.parser.parse(data + offset, input.size() - offset);
+                    if (status == HTTPParseStatus::incomplete) {
+                        incomplete = true;
+                        break;
+                    }
+                    HTTPResponse& response = session.responses[batch++];
+                    response.reset();
+                    bool head_only = false;
+                    if (status == HTTPParseStatus::error) {
+                        response.set_status(session.parser.error_status());
+                        response.set_body(http_reason(session.parser.error_status()));
+                        response.close_connection();
+                    } else {
+                        const HTTPRequest& request = session.parser.message();
+                        try {
+                            handler_(request, response);
+                        } catch (...) {
+                            response.reset();
+                            response.set_status(500);
+                            response.set_body(http_reason(500));
+                        }
+                        if (!request.keep_alive) response.close_connection();
+                        head_only = request.method == "HEAD";
+                        offset += session.parser.consumed();
+                        ++handled;
+                    }
+                    count += response.serialize(session.iov.data() + count, head_only);
+                    if (!response.keep_alive()) {
+                        close = true;
+                        break;
+                    }
+                }
+                // 先计数再发送，客户端收到响应时计数已经包含这些请求
+                if (handled > 0) requests_.fetch_add(handled, std::memory_order_relaxed);
+                // 请求中的数据在发出之前一直留在输入缓冲区，响应体可以直接引用它们
+                if (count > 0) connection.send(session.iov.data(), count);
+                if (incomplete || batch == 0) break;
+            }
+            input.consume(offset);
+            if (close) connection.close();
+        }
+
+    public:
+        HTTPServer(HTTPServerOptions options, HTTPHandler handler)
+            : options_(std::move(options)), handler_(std::move(handler)), server_(options_.tcp, callbacks()) {
+            if (options_.max_pipeline_batch == 0) options_.max_pipeline_batch = 1;
+        }
+
+        HTTPServer(const HTTPServer&) = delete;
+        HTTPServer& operator=(const HTTPServer&) = delete;
+
+        void start() {
+            free_sessions_.resize(std::max<std::size_t>(1, options_.tcp.threads));
+            server_.start();
+        }
+
+        void stop() {
+            server_.stop();
+        }
+
+        std::uint16_t port() const noexcept {
+            return server_.port();
+        }
+
+        std::size_t threads() const noexcept {
+            return server_.threads();
+        }
+
+        std::size_t connections() const noexcept {
+            return server_.connections();
+        }
+
+        std::uint64_t total_accepted() const noexcept {
+            return server_.total_accepted();
+        }
+
+        // 已处理的请求数(不包括解析失败的请求)
+        std::uint64_t total_requests() const noexcept {
+            return requests_.load(std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_HTTP_SERVER_H
@@ -0,0 +1,1152 @@
+#ifndef CPP_LEARNING_DEMO_IO_REACTOR_H
+#define CPP_LEARNING_DEMO_IO_REACTOR_H
+
+// 基于epoll的协程I/O反应器(仅Linux)
+//
+// 一个Reactor在一个线程上运行事件循环，协程通过co_await等待文件描述符就绪或定时器到期，
+// 挂起期间不占用线程。成千上万个连接只需要一个线程(或每个CPU核心一个Reactor，
+// 监听套接字使用SO_REUSEPORT，由内核把新连接分摊到各个Reactor)。
+//
+// - 文件描述符在创建AsyncFd时以边缘触发(EPOLLET)方式注册一次，读写时不再调用epoll_ctl
+// - 每个I/O操作先直接尝试系统调用，只有返回EAGAIN时才挂起，数据已就绪时不经过事件循环
+// - 挂起的操作在就绪事件到达后由Reactor重试，成功或出错后才恢复协程
+// - 一个AsyncFd同一时刻最多有一个读操作和一个写操作在等待
+//
+// 内核支持时Reactor同时创建一个io_uring(见io_uring.h)：环的描述符也注册在epoll上，
+// 文件读写(async_read_at/async_write_at/async_read_fixed)和async_recv/async_send
+// 以SQE的形式排队，每轮事件循环只用一次io_uring_enter批量提交。
+// 不支持io_uring时，文件读写直接调用pread/pwrite(普通文件总是"就绪"，epoll无法等待它们)，
+// 套接字读写回到epoll就绪通知。
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include "io_uring.h"
+
+namespace network_demo {
+    using coroutines_base::Task;
+
+    class Reactor;
+
+    [[noreturn]] inline void throw_errno(int error, const char* what) {
+        throw std::system_error(error, std::system_category(), what);
+    }
+
+    namespace reactor_detail {
+        // 等待就绪的I/O操作：Reactor在事件到达后调用attempt重试，返回true表示操作已完成
+        struct IoWaiter {
+            std::coroutine_handle<> handle;
+            bool (*attempt)(IoWaiter*) = nullptr;
+            // 登记在FdState::reader或writer中时指向那个槽位
+            IoWaiter** slot = nullptr;
+            // 失败时的errno；等待期间描述符被关闭时为ECANCELED
+            int error = 0;
+        };
+
+        // 注册在epoll上的一个文件描述符；地址作为epoll_event.data.ptr，在AsyncFd移动时保持不变
+        struct FdState {
+            int fd = -1;
+            Reactor* reactor = nullptr;
+            IoWaiter* reader = nullptr;
+            IoWaiter* writer = nullptr;
+        };
+
+        // 通过io_uring提交的请求；地址作为SQE的user_data，完成时由Reactor写入结果并恢复协程。
+        // 尚未完成的请求链在Reactor上，析构时逐个取消；owner是套接字请求所属的描述符，关闭时取消
+        struct UringCompletion {
+            std::coroutine_handle<> handle;
+            int result = 0;
+            const FdState* owner = nullptr;
+            UringCompletion* prev = nullptr;
+            UringCompletion* next = nullptr;
+        };
+
+        template<typename Operation>
+        class UringAwaiter;
+
+        // 一次非阻塞I/O操作。Operation提供:
+        //   ssize_t attempt(int fd)                     失败时设置errno，EAGAIN表示需要等待
+        //   auto finish(FdState& state, ssize_t result) 转换为co_await的结果
+        template<typename Operation>
+        class IoAwaiter : private IoWaiter {
+        private:
+            FdState* state_;
+            bool write_side_;
+            Operation op_;
+            ssize_t result_ = -1;
+
+            bool try_once() {
+                for (;;) {
+                    ssize_t r = op_.attempt(state_->fd);
+                    if (r >= 0) {
+                        result_ = r;
+                        return true;
+                    }
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+                    error = errno;
+                    return true;
+                }
+            }
+
+        public:
+            IoAwaiter(FdState* state, bool write_side, Operation op)
+                : state_(state), write_side_(write_side), op_(std::move(op)) {}
+
+            bool await_ready() {
+                if (!state_ || state_->fd < 0) {
+                    error = EBADF;
+                    return true;
+                }
+                return try_once();
+            }
+
+            IoAwaiter(const IoAwaiter&) = delete;
+            IoAwaiter& operator=(const IoAwaiter&) = delete;
+
+            // 挂起的协程被销毁时注销自己，描述符不会再访问这个等待者
+            ~IoAwaiter() {
+                if (slot) *slot = nullptr;
+            }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                handle = h;
+                attempt = [](IoWaiter* w) { return static_cast<IoAwaiter*>(w)->try_once(); };
+                IoWaiter*& target = write_side_ ? state_->writer : state_->reader;
+                if (target) throw std::logic_error("another operation is already waiting on this descriptor");
+                target = this;
+                slot = &target;
+            }
+
+            auto await_resume() {
+                if (error != 0) throw_errno(error, Operation::name);
+                return op_.finish(*state_, result_);
+            }
+        };
+    }
+
+    // 注册在Reactor上的非阻塞文件描述符，析构时关闭
+    class AsyncFd {
+    private:
+        std::unique_ptr<reactor_detail::FdState> state_;
+
+    public:
+        AsyncFd() = default;
+
+        // 接管fd：设为非阻塞并以边缘触发方式注册读写事件
+        AsyncFd(Reactor& reactor, int fd);
+
+        ~AsyncFd() {
+            close();
+        }
+
+        AsyncFd(AsyncFd&&) noexcept = default;
+        AsyncFd& operator=(AsyncFd&& other) noexcept {
+            if (this != &other) {
+                close();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+
+        bool valid() const noexcept {
+            return state_ && state_->fd >= 0;
+        }
+
+        int fd() const noexcept {
+            return state_ ? state_->fd : -1;
+        }
+
+        Reactor& reactor() const noexcept {
+            return *state_->reactor;
+        }
+
+        // 关闭描述符；状态对象交给Reactor，在本轮事件处理结束后释放。
+        // 挂起在这个描述符上的读写操作以ECANCELED结束(在Reactor的下一轮恢复，不在close()内部)
+        void close() noexcept;
+
+        // 从epoll中注销并交出描述符(不关闭)，例如把连接还给连接池。调用时不能有挂起的读写操作
+        int release() noexcept;
+
+        reactor_detail::FdState* state() const noexcept {
+            return state_.get();
+        }
+    };
+
+    struct ReactorOptions {
+        // 内核支持时启用io_uring后端；不支持时自动回退
+        bool use_io_uring = true;
+        unsigned io_uring_entries = 256;
+    };
+
+    // 单线程事件循环。除stop()、schedule()和post()外，所有成员函数只能在运行run()的线程上调用
+    class Reactor {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        struct Timer {
+            Clock::time_point deadline;
+            std::uint64_t sequence;
+            std::coroutine_handle<> handle;
+
+            // 到期时间相同的定时器按加入顺序触发
+            bool operator>(const Timer& other) const {
+                if (deadline != other.deadline) return deadline > other.deadline;
+                return sequence > other.sequence;
+            }
+        };
+
+        // spawn()启动的协程：自己销毁自己，Reactor析构时销毁仍挂起的部分
+        struct Detached {
+            struct promise_type : coroutines_base::PooledFrame {
+                Reactor* reactor = nullptr;
+                promise_type* prev = nullptr;
+                promise_type* next = nullptr;
+
+                Detached get_return_object() noexcept {
+                    return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                auto final_suspend() noexcept {
+                    struct Unlink {
+                        bool await_ready() const noexcept { return false; }
+                        void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                            h.promise().reactor->unlink(h.promise());
+                            h.destroy();
+                        }
+                        void await_resume() noexcept {}
+                    };
+                    return Unlink{};
+                }
+
+                void return_void() noexcept {}
+                // 包装协程内部已捕获所有异常
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        int epoll_fd_ = -1;
+        int wake_fd_ = -1;
+        std::atomic<bool> stop_requested_{false};
+
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+        std::uint64_t timer_sequence_ = 0;
+
+        std::mutex posted_mutex_;
+        std::vector<std::coroutine_handle<>> posted_;
+        std::atomic<bool> has_posted_{false};
+
+        std::vector<std::unique_ptr<reactor_detail::FdState>> retired_;
+        Detached::promise_type* detached_ = nullptr;
+        std::size_t detached_count_ = 0;
+        std::function<void(std::exception_ptr)> error_handler_;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+        std::unique_ptr<IoUring> uring_;
+        bool uring_sockets_ = false;
+        // 已经交给io_uring、还没有取走结果的请求
+        reactor_detail::UringCompletion* uring_pending_ = nullptr;
+#endif
+        // 注册的文件和缓冲区；没有io_uring时async_read_fixed按下标查这两张表
+        std::vector<int> registered_files_;
+        std::vector<iovec> registered_buffers_;
+
+        static Detached run_detached(Task<void> task, std::function<void(std::exception_ptr)>* handler) {
+            try {
+                co_await task;
+            } catch (...) {
+                if (*handler) {
+                    (*handler)(std::current_exception());
+                } else {
+                    try {
+                        throw;
+                    } catch (const std::exception& e) {
+                        std::cerr << "reactor: unhandled exception in spawned task: " << e.what() << std::endl;
+                    } catch (...) {
+                        std::cerr << "reactor: unhandled exception in spawned task" << std::endl;
+                    }
+                }
+            }
+        }
+
+        void unlink(Detached::promise_type& promise) noexcept {
+            if (promise.prev) promise.prev->next = promise.next;
+            else detached_ = promise.next;
+            if (promise.next) promise.next->prev = promise.prev;
+            --detached_count_;
+        }
+
+        void wake() noexcept {
+            std::uint64_t one = 1;
+            [[maybe_unused]] ssize_t r = ::write(wake_fd_, &one, sizeof(one));
+        }
+
+        void drain_wake() noexcept {
+            std::uint64_t value;
+            [[maybe_unused]] ssize_t r = ::read(wake_fd_, &value, sizeof(value));
+        }
+
+        void run_posted() {
+            if (!has_posted_.load(std::memory_order_acquire)) return;
+            std::vector<std::coroutine_handle<>> batch;
+            {
+                std::lock_guard<std::mutex> lock(posted_mutex_);
+                batch.swap(posted_);
+                has_posted_.store(false, std::memory_order_relaxed);
+            }
+            for (auto h : batch) h.resume();
+        }
+
+        // 只触发进入本函数前已经到期的定时器，回调中新加的定时器留到下一轮
+        void fire_timers() {
+            const auto now = Clock::now();
+            while (!timers_.empty() && timers_.top().deadline <= now) {
+                auto h = timers_.top().handle;
+                timers_.pop();
+                h.resume();
+            }
+        }
+
+        int next_timeout_ms() const {
+            if (has_posted_.load(std::memory_order_acquire)) return 0;
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            if (uring_ && uring_->has_completions()) return 0;
+#endif
+            if (timers_.empty()) return -1;
+            auto remaining = timers_.top().deadline - Clock::now();
+            if (remaining <= Clock::duration::zero()) return 0;
+            // 向上取整，避免在到期前提前醒来空转
+            auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+            return static_cast<int>(std::min<decltype(ms)>(ms, 60 * 1000));
+        }
+
+        static void complete(reactor_detail::IoWaiter*& slot) {
+            reactor_detail::IoWaiter* waiter = slot;
+            if (waiter && waiter->attempt(waiter)) {
+                slot = nullptr;
+                waiter->slot = nullptr;
+                waiter->handle.resume();
+            }
+        }
+
+        void dispatch(reactor_detail::FdState* state, std::uint32_t events) {
+            // 出错或挂断时读写两边都重试，由系统调用给出具体结果
+            const bool failed = events & (EPOLLERR | EPOLLHUP);
+            if ((events & (EPOLLIN | EPOLLRDHUP)) || failed) complete(state->reader);
+            // 读操作恢复的协程可能已经关闭了这个描述符
+            if (state->fd >= 0 && ((events & EPOLLOUT) || failed)) complete(state->writer);
+        }
+
+        friend class AsyncFd;
+        template<typename Operation>
+        friend class reactor_detail::UringAwaiter;
+
+        void add(reactor_detail::FdState* state) {
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.ptr = state;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, state->fd, &event) != 0) throw_errno(errno, "epoll_ctl");
+        }
+
+        void remove(reactor_detail::FdState* state) noexcept {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, state->fd, nullptr);
+        }
+
+        void retire(std::unique_ptr<reactor_detail::FdState> state) {
+            retired_.push_back(std::move(state));
+        }
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+        // epoll_event.data.ptr中代表io_uring环的标记，不会与FdState的地址重复
+        void* uring_marker() noexcept {
+            return &uring_;
+        }
+
+        void track(reactor_detail::UringCompletion& completion) noexcept {
+            completion.prev = nullptr;
+            completion.next = uring_pending_;
+            if (uring_pending_) uring_pending_->prev = &completion;
+            uring_pending_ = &completion;
+        }
+
+        void untrack(reactor_detail::UringCompletion& completion) noexcept {
+            if (completion.prev) completion.prev->next = completion.next;
+            else uring_pending_ = completion.next;
+            if (completion.next) completion.next->prev = completion.prev;
+        }
+
+        void reap_completions() {
+            uring_->reap([this](const io_uring_cqe& cqe) {
+                // AsyncFd::close()提交的取消请求自己的完成结果
+                if (cqe.user_data == 0) return;
+                auto* completion = reinterpret_cast<reactor_detail::UringCompletion*>(cqe.user_data);
+                untrack(*completion);
+                completion->result = cqe.res;
+                completion->handle.resume();
+            });
+        }
+#endif
+
+    public:
+        Reactor() : Reactor(ReactorOptions{}) {}
+
+        explicit Reactor(const ReactorOptions& options) {
+            epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd_ < 0) throw_errno(errno, "epoll_create1");
+            wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wake_fd_ < 0) {
+                int error = errno;
+                ::close(epoll_fd_);
+                throw_errno(error, "eventfd");
+            }
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = nullptr;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            if (options.use_io_uring) {
+                uring_ = IoUring::create(options.io_uring_entries);
+                if (uring_) {
+                    uring_sockets_ = uring_->supports(IORING_OP_RECV) && uring_->supports(IORING_OP_SEND);
+                    // 水平触发：只要完成队列非空，epoll_wait就会返回
+                    event.events = EPOLLIN;
+                    event.data.ptr = uring_marker();
+                    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, uring_->fd(), &event);
+                }
+            }
+#else
+            (void)options;
+#endif
+        }
+
+        ~Reactor() {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            // 内核可能还在写入挂起协程的缓冲区：先等所有请求完成(丢弃结果)，再销毁协程帧。
+            // 空闲套接字上的RECV可能永远不会完成，所以先取消所有未完成的请求
+            if (uring_) {
+                try {
+                    for (auto* completion = uring_pending_; completion; completion = completion->next) {
+                        uring_->cancel(reinterpret_cast<std::uint64_t>(completion));
+                    }
+                    uring_->drain([](const io_uring_cqe&) {});
+                } catch (...) {
+                    // 提交失败(内存不足、提交队列无法腾出空位)时析构函数不能抛出异常：
+                    // 关闭环，由内核取消剩下的请求
+                    uring_.reset();
+                }
+            }
+#endif
+            // 先销毁挂起的协程(会关闭它们持有的AsyncFd)，再释放描述符状态
+            while (detached_) {
+                auto h = std::coroutine_handle<Detached::promise_type>::from_promise(*detached_);
+                unlink(*detached_);
+                h.destroy();
+            }
+            retired_.clear();
+            ::close(wake_fd_);
+            ::close(epoll_fd_);
+        }
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        // 运行事件循环，直到stop()被调用
+        void run() {
+            constexpr int kMaxEvents = 256;
+            epoll_event events[kMaxEvents];
+            while (!stop_requested_.load(std::memory_order_acquire)) {
+                run_posted();
+                fire_timers();
+                retired_.clear();
+                if (stop_requested_.load(std::memory_order_acquire)) break;
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+                // 本轮产生的所有SQE一次提交
+                if (uring_) uring_->submit();
+#endif
+
+                int n = ::epoll_wait(epoll_fd_, events, kMaxEvents, next_timeout_ms());
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    throw_errno(errno, "epoll_wait");
+                }
+                for (int i = 0; i < n; ++i) {
+                    auto* state = static_cast<reactor_detail::FdState*>(events[i].data.ptr);
+                    if (!state) {
+                        drain_wake();
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+                    } else if (events[i].data.ptr == uring_marker()) {
+                        continue;
+#endif
+                    } else if (state->fd >= 0) {
+                        dispatch(state, events[i].events);
+                    }
+                }
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+                // 读取完成队列只访问共享内存，每轮都检查一次
+                if (uring_) reap_completions();
+#endif
+            }
+            stop_requested_.store(false, std::memory_order_relaxed);
+        }
+
+        // 运行事件循环直到task完成，返回它的结果(异常原样抛出)
+        template<typename T>
+        T run_until_complete(Task<T> task) {
+            using Slot = std::conditional_t<std::is_void_v<T>, std::optional<int>, std::optional<T>>;
+            Slot slot;
+            std::exception_ptr error;
+            auto wrapper = [](Reactor& reactor, Task<T>& inner, Slot& out, std::exception_ptr& err) -> Task<void> {
+                try {
+                    if constexpr (std::is_void_v<T>) {
+                        co_await inner;
+                        out.emplace(0);
+                    } else {
+                        out.emplace(co_await inner);
+                    }
+                } catch (...) {
+                    err = std::current_exception();
+                }
+                reactor.stop();
+            };
+            spawn(wrapper(*this, task, slot, error));
+            run();
+            if (error) std::rethrow_exception(error);
+            if (!slot) throw std::logic_error("reactor stopped before the task completed");
+            if constexpr (!std::is_void_v<T>) return std::move(*slot);
+        }
+
+        // 可以在任意线程调用；run()处理完当前这一轮后返回
+        void stop() noexcept {
+            stop_requested_.store(true, std::memory_order_release);
+            wake();
+        }
+
+        // 立即开始执行task直到它第一次挂起，之后由事件循环驱动；Reactor负责它的生命周期
+        void spawn(Task<void> task) {
+            Detached detached = run_detached(std::move(task), &error_handler_);
+            auto& promise = detached.handle.promise();
+            promise.reactor = this;
+            promise.next = detached_;
+            if (detached_) detached_->prev = &promise;
+            detached_ = &promise;
+            ++detached_count_;
+            detached.handle.resume();
+        }
+
+        // spawn()启动、尚未结束的协程数
+        std::size_t active_tasks() const noexcept {
+            return detached_count_;
+        }
+
+        // spawn()启动的协程抛出的异常交给handler；默认输出到std::cerr
+        void set_error_handler(std::function<void(std::exception_ptr)> handler) {
+            error_handler_ = std::move(handler);
+        }
+
+        struct TimerAwaiter {
+            Reactor& reactor;
+            Clock::time_point deadline;
+
+            bool await_ready() const noexcept {
+                return deadline <= Clock::now();
+            }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                reactor.timers_.push(Timer{deadline, reactor.timer_sequence_++, h});
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        TimerAwaiter sleep_until(Clock::time_point deadline) {
+            return TimerAwaiter{*this, deadline};
+        }
+
+        template<typename Rep, typename Period>
+        TimerAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+            return TimerAwaiter{*this, Clock::now() + std::chrono::duration_cast<Clock::duration>(duration)};
+        }
+
+        // 从其他线程切换到这个Reactor的线程上继续执行
+        struct ScheduleAwaiter {
+            Reactor& reactor;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                reactor.post(h);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        ScheduleAwaiter schedule() {
+            return ScheduleAwaiter{*this};
+        }
+
+        // 在这个Reactor的线程上恢复h(可以从任何线程调用)，例如由其他线程唤醒等待资源的协程
+        void post(std::coroutine_handle<> h) {
+            {
+                std::lock_guard<std::mutex> lock(posted_mutex_);
+                posted_.push_back(h);
+                has_posted_.store(true, std::memory_order_release);
+            }
+            wake();
+        }
+
+        // 是否启用了io_uring后端
+        bool uses_io_uring() const noexcept {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            return uring_ != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        // async_recv/async_send是否经过io_uring
+        bool uses_io_uring_for_sockets() const noexcept {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            return uring_ && uring_sockets_;
+#else
+            return false;
+#endif
+        }
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+        IoUring* uring() noexcept {
+            return uring_.get();
+        }
+#endif
+
+        // 注册文件表，async_read_fixed用下标引用这些文件；描述符仍由调用方关闭
+        void register_files(std::vector<int> fds) {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            if (uring_) uring_->register_files(fds);
+#endif
+            registered_files_ = std::move(fds);
+        }
+
+        // 注册缓冲区，async_read_fixed读入其中一个；缓冲区必须在Reactor销毁或重新注册前保持有效
+        void register_buffers(std::vector<iovec> buffers) {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            if (uring_) uring_->register_buffers(buffers);
+#endif
+            registered_buffers_ = std::move(buffers);
+        }
+
+        int registered_file(unsigned index) const {
+            return registered_files_.at(index);
+        }
+
+        const iovec& registered_buffer(unsigned index) const {
+            return registered_buffers_.at(index);
+        }
+    };
+
+    inline AsyncFd::AsyncFd(Reactor& reactor, int fd) {
+        if (fd < 0) throw std::invalid_argument("invalid file descriptor");
+        int flags = ::fcntl(fd, F_GETFL);
+        if (flags < 0 || (!(flags & O_NONBLOCK) && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+            int error = errno;
+            ::close(fd);
+            throw_errno(error, "fcntl");
+        }
+        auto state = std::make_unique<reactor_detail::FdState>();
+        state->fd = fd;
+        state->reactor = &reactor;
+        try {
+            reactor.add(state.get());
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        state_ = std::move(state);
+    }
+
+    inline void AsyncFd::close() noexcept {
+        if (!state_) return;
+        Reactor* reactor = state_->reactor;
+        // 等待就绪的操作不会再收到事件：登记ECANCELED，交给事件循环恢复。
+        // close()可能在协程帧析构的过程中调用，所以不在这里直接恢复
+        for (reactor_detail::IoWaiter** slot : {&state_->reader, &state_->writer}) {
+            if (reactor_detail::IoWaiter* waiter = *slot) {
+                *slot = nullptr;
+                waiter->slot = nullptr;
+                waiter->error = ECANCELED;
+                reactor->post(waiter->handle);
+            }
+        }
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+        // 已经提交给内核的RECV/SEND持有文件的引用，关闭描述符不会结束它们，需要显式取消
+        if (reactor->uring_) {
+            for (auto* completion = reactor->uring_pending_; completion; completion = completion->next) {
+                if (completion->owner != state_.get()) continue;
+                completion->owner = nullptr;
+                try {
+                    reactor->uring_->cancel(reinterpret_cast<std::uint64_t>(completion));
+                } catch (...) {
+                    // 取消请求提交失败时，请求仍会在对端有数据、关闭或Reactor析构时结束
+                }
+            }
+        }
+#endif
+        // close会把描述符从epoll中移除；本轮已经取出的事件看到fd < 0后跳过
+        ::close(state_->fd);
+        state_->fd = -1;
+        reactor->retire(std::move(state_));
+    }
+
+    inline int AsyncFd::release() noexcept {
+        if (!state_) return -1;
+        const int fd = state_->fd;
+        Reactor* reactor = state_->reactor;
+        if (fd >= 0) reactor->remove(state_.get());
+        state_->fd = -1;
+        reactor->retire(std::move(state_));
+        return fd;
+    }
+
+    namespace reactor_detail {
+        struct ReadOp {
+            static constexpr const char* name = "read";
+            void* buffer;
+            std::size_t size;
+
+            ssize_t attempt(int fd) {
+                return ::read(fd, buffer, size);
+            }
+
+            std::size_t finish(FdState&, ssize_t result) {
+                return static_cast<std::size_t>(result);
+            }
+        };
+
+        struct WriteOp {
+            static constexpr const char* name = "write";
+            const void* buffer;
+            std::size_t size;
+
+            // 套接字用send(MSG_NOSIGNAL)，对端关闭时返回EPIPE而不是触发SIGPIPE
+            ssize_t attempt(int fd) {
+                ssize_t r = ::send(fd, buffer, size, MSG_NOSIGNAL);
+                if (r < 0 && errno == ENOTSOCK) r = ::write(fd, buffer, size);
+                return r;
+            }
+
+            std::size_t finish(FdState&, ssize_t result) {
+                return static_cast<std::size_t>(result);
+            }
+        };
+
+        struct AcceptOp {
+            static constexpr const char* name = "accept";
+
+            ssize_t attempt(int fd) {
+                return ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            }
+
+            AsyncFd finish(FdState& listener, ssize_t result) {
+                return AsyncFd(*listener.reactor, static_cast<int>(result));
+            }
+        };
+
+        // 第一次尝试发起connect；EINPROGRESS时等待可写，再从SO_ERROR读取结果
+        struct ConnectOp {
+            static constexpr const char* name = "connect";
+            sockaddr_storage address;
+            socklen_t length;
+            bool started = false;
+
+            ssize_t attempt(int fd) {
+                if (!started) {
+                    started = true;
+                    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), length) == 0) return 0;
+                    if (errno == EINPROGRESS) errno = EAGAIN;
+                    return -1;
+                }
+                int error = 0;
+                socklen_t size = sizeof(error);
+                if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) != 0) return -1;
+                if (error != 0) {
+                    errno = error;
+                    return -1;
+                }
+                return 0;
+            }
+
+            void finish(FdState&, ssize_t) {}
+        };
+    }
+
+    // 读取最多size字节，返回实际读取的字节数；0表示对端已关闭
+    inline auto async_read(AsyncFd& fd, void* buffer, std::size_t size) {
+        return reactor_detail::IoAwaiter<reactor_detail::ReadOp>(fd.state(), false, {buffer, size});
+    }
+
+    // 写入最多size字节，返回实际写入的字节数(可能少于size)
+    inline auto async_write(AsyncFd& fd, const void* buffer, std::size_t size) {
+        return reactor_detail::IoAwaiter<reactor_detail::WriteOp>(fd.state(), true, {buffer, size});
+    }
+
+    // 写完全部数据
+    inline Task<void> async_write_all(AsyncFd& fd, const void* buffer, std::size_t size) {
+        const char* data = static_cast<const char*>(buffer);
+        while (size > 0) {
+            std::size_t written = co_await async_write(fd, data, size);
+            data += written;
+            size -= written;
+        }
+    }
+
+    // 接受一个连接，返回注册在同一个Reactor上的AsyncFd
+    inline auto async_accept(AsyncFd& listener) {
+        return reactor_detail::IoAwaiter<reactor_detail::AcceptOp>(listener.state(), false, {});
+    }
+
+    // socket必须是尚未连接的非阻塞TCP套接字
+    inline auto async_connect(AsyncFd& socket, const sockaddr_in& address) {
+        reactor_detail::ConnectOp op{};
+        std::memcpy(&op.address, &address, sizeof(address));
+        op.length = sizeof(address);
+        return reactor_detail::IoAwaiter<reactor_detail::ConnectOp>(socket.state(), true, op);
+    }
+
+    namespace reactor_detail {
+        // 交给io_uring执行的操作。Operation提供:
+        //   void prepare(io_uring_sqe& sqe, Reactor& reactor)  填写SQE(user_data除外)
+        //   ssize_t fallback(Reactor& reactor)                 没有io_uring时同步执行，失败时设置errno
+        template<typename Operation>
+        class UringAwaiter {
+        private:
+            Reactor& reactor_;
+            Operation op_;
+            UringCompletion completion_;
+
+        public:
+            // owner非空时，关闭这个描述符会取消请求
+            UringAwaiter(Reactor& reactor, Operation op, const FdState* owner = nullptr)
+                : reactor_(reactor), op_(std::move(op)) {
+                completion_.owner = owner;
+            }
+
+            bool await_ready() {
+                if (reactor_.uses_io_uring()) return false;
+                for (;;) {
+                    ssize_t r = op_.fallback(reactor_);
+                    if (r >= 0) {
+                        completion_.result = static_cast<int>(r);
+                        return true;
+                    }
+                    if (errno != EINTR) {
+                        completion_.result = -errno;
+                        return true;
+                    }
+                }
+            }
+
+            // SQE只是排队，由事件循环在本轮结束时和其他请求一起提交
+            void await_suspend(std::coroutine_handle<> h) {
+                completion_.handle = h;
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+                io_uring_sqe& sqe = reactor_.uring()->next_sqe();
+                op_.prepare(sqe, reactor_);
+                sqe.user_data = reinterpret_cast<std::uint64_t>(&completion_);
+                reactor_.track(completion_);
+#endif
+            }
+
+            std::size_t await_resume() {
+                if (completion_.result < 0) throw_errno(-completion_.result, Operation::name);
+                return static_cast<std::size_t>(completion_.result);
+            }
+        };
+
+        struct ReadAtOp {
+            static constexpr const char* name = "read";
+            int fd;
+            void* buffer;
+            std::size_t size;
+            std::uint64_t offset;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            void prepare(io_uring_sqe& sqe, Reactor&) const {
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+                sqe.len = static_cast<std::uint32_t>(size);
+                sqe.off = offset;
+            }
+#endif
+
+            ssize_t fallback(Reactor&) const {
+                return ::pread(fd, buffer, size, static_cast<off_t>(offset));
+            }
+        };
+
+        struct WriteAtOp {
+            static constexpr const char* name = "write";
+            int fd;
+            const void* buffer;
+            std::size_t size;
+            std::uint64_t offset;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            void prepare(io_uring_sqe& sqe, Reactor&) const {
+                sqe.opcode = IORING_OP_WRITE;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+                sqe.len = static_cast<std::uint32_t>(size);
+                sqe.off = offset;
+            }
+#endif
+
+            ssize_t fallback(Reactor&) const {
+                return ::pwrite(fd, buffer, size, static_cast<off_t>(offset));
+            }
+        };
+
+        // 注册文件 + 注册缓冲区：内核不需要每次查文件表、固定用户页
+        struct ReadFixedOp {
+            static constexpr const char* name = "read_fixed";
+            unsigned file;
+            unsigned buffer;
+            std::size_t size;
+            std::uint64_t offset;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            void prepare(io_uring_sqe& sqe, Reactor& reactor) const {
+                const iovec& target = reactor.registered_buffer(buffer);
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.flags = IOSQE_FIXED_FILE;
+                sqe.fd = static_cast<int>(file);
+                sqe.addr = reinterpret_cast<std::uint64_t>(target.iov_base);
+                sqe.len = static_cast<std::uint32_t>(std::min(size, target.iov_len));
+                sqe.off = offset;
+                sqe.buf_index = static_cast<std::uint16_t>(buffer);
+            }
+#endif
+
+            ssize_t fallback(Reactor& reactor) const {
+                const iovec& target = reactor.registered_buffer(buffer);
+                return ::pread(reactor.registered_file(file), target.iov_base, std::min(size, target.iov_len),
+                               static_cast<off_t>(offset));
+            }
+        };
+
+        // 套接字收发；只在uses_io_uring_for_sockets()时经过这里，fallback仅为完整性
+        struct RecvOp {
+            static constexpr const char* name = "recv";
+            int fd;
+            void* buffer;
+            std::size_t size;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            void prepare(io_uring_sqe& sqe, Reactor&) const {
+                sqe.opcode = IORING_OP_RECV;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+                sqe.len = static_cast<std::uint32_t>(size);
+            }
+#endif
+
+            ssize_t fallback(Reactor&) const {
+                return ::recv(fd, buffer, size, 0);
+            }
+        };
+
+        struct SendOp {
+            static constexpr const char* name = "send";
+            int fd;
+            const void* buffer;
+            std::size_t size;
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+            void prepare(io_uring_sqe& sqe, Reactor&) const {
+                sqe.opcode = IORING_OP_SEND;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+                sqe.len = static_cast<std::uint32_t>(size);
+                sqe.msg_flags = MSG_NOSIGNAL;
+            }
+#endif
+
+            ssize_t fallback(Reactor&) const {
+                return ::send(fd, buffer, size, MSG_NOSIGNAL);
+            }
+        };
+    }
+
+    // 从文件的offset处读取最多size字节(普通文件或块设备)
+    inline auto async_read_at(Reactor& reactor, int fd, void* buffer, std::size_t size, std::uint64_t offset) {
+        return reactor_detail::UringAwaiter<reactor_detail::ReadAtOp>(reactor, {fd, buffer, size, offset});
+    }
+
+    inline auto async_write_at(Reactor& reactor, int fd, const void* buffer, std::size_t size, std::uint64_t offset) {
+        return reactor_detail::UringAwaiter<reactor_detail::WriteAtOp>(reactor, {fd, buffer, size, offset});
+    }
+
+    // 从注册文件表的第file项读取到第buffer个注册缓冲区的开头，最多size字节
+    inline auto async_read_fixed(Reactor& reactor, unsigned file, unsigned buffer, std::size_t size,
+                                 std::uint64_t offset) {
+        return reactor_detail::UringAwaiter<reactor_detail::ReadFixedOp>(reactor, {file, buffer, size, offset});
+    }
+
+    // 套接字读写：有io_uring时提交RECV/SEND请求，否则等同于async_read/async_write
+    inline Task<std::size_t> async_recv(AsyncFd& socket, void* buffer, std::size_t size) {
+        Reactor& reactor = socket.reactor();
+        if (reactor.uses_io_uring_for_sockets()) {
+            co_return co_await reactor_detail::UringAwaiter<reactor_detail::RecvOp>(
+                reactor, {socket.fd(), buffer, size}, socket.state());
+        }
+        co_return co_await async_read(socket, buffer, size);
+    }
+
+    inline Task<std::size_t> async_send(AsyncFd& socket, const void* buffer, std::size_t size) {
+        Reactor& reactor = socket.reactor();
+        if (reactor.uses_io_uring_for_sockets()) {
+            co_return co_await reactor_detail::UringAwaiter<reactor_detail::SendOp>(
+                reactor, {socket.fd(), buffer, size}, socket.state());
+        }
+        co_return co_await async_write(socket, buffer, size);
+    }
+
+    inline sockaddr_in make_address(const std::string& host, std::uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+            throw std::invalid_argument("invalid IPv4 address: " + host);
+        }
+        return address;
+    }
+
+    inline AsyncFd make_tcp_socket(Reactor& reactor) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) throw_errno(errno, "socket");
+        return AsyncFd(reactor, fd);
+    }
+
+    // 创建套接字并连接到address
+    inline Task<AsyncFd> tcp_connect(Reactor& reactor, sockaddr_in address) {
+        AsyncFd socket = make_tcp_socket(reactor);
+        co_await async_connect(socket, address);
+        int one = 1;
+        ::setsockopt(socket.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        co_return socket;
+    }
+
+    struct ListenOptions {
+        std::string host = "127.0.0.1";
+        // 0表示由内核分配端口，用local_port()查询
+        std::uint16_t port = 0;
+        int backlog = SOMAXCONN;
+        // 多个Reactor各自监听同一端口，由内核把新连接分摊到各个监听套接字
+        bool reuse_port = false;
+    };
+
+    inline AsyncFd tcp_listen(Reactor& reactor, const ListenOptions& options) {
+        AsyncFd listener = make_tcp_socket(reactor);
+        int one = 1;
+        ::setsockopt(listener.fd(), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (options.reuse_port && ::setsockopt(listener.fd(), SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+            throw_errno(errno, "setsockopt(SO_REUSEPORT)");
+        }
+        sockaddr_in address = make_address(options.host, options.port);
+        if (::bind(listener.fd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            throw_errno(errno, "bind");
+        }
+        if (::listen(listener.fd(), options.backlog) != 0) throw_errno(errno, "listen");
+        return listener;
+    }
+
+    inline std::uint16_t local_port(const AsyncFd& socket) {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        if (::getsockname(socket.fd(), reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            throw_errno(errno, "getsockname");
+        }
+        return ntohs(address.sin_port);
+    }
+
+    // 每个线程一个Reactor。setup在启动线程之前依次对每个Reactor调用，
+    // 通常在其中创建SO_REUSEPORT监听套接字并spawn接受循环
+    class ReactorThreads {
+    private:
+        std::vector<std::unique_ptr<Reactor>> reactors_;
+        std::vector<std::thread> threads_;
+
+    public:
+        ReactorThreads(std::size_t count, std::function<void(Reactor&, std::size_t)> setup) {
+            reactors_.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) reactors_.push_back(std::make_unique<Reactor>());
+            // 先在调用线程上完成setup：监听套接字绑定失败时直接在这里抛出
+            for (std::size_t i = 0; i < count; ++i) setup(*reactors_[i], i);
+            for (std::size_t i = 0; i < count; ++i) {
+                threads_.emplace_back([reactor = reactors_[i].get()] { reactor->run(); });
+            }
+        }
+
+        ~ReactorThreads() {
+            stop();
+        }
+
+        ReactorThreads(const ReactorThreads&) = delete;
+        ReactorThreads& operator=(const ReactorThreads&) = delete;
+
+        std::size_t size() const noexcept {
+            return reactors_.size();
+        }
+
+        Reactor& operator[](std::size_t i) {
+            return *reactors_[i];
+        }
+
+        // 停止所有事件循环并等待线程退出
+        void stop() {
+            for (auto& reactor : reactors_) reactor->stop();
+            for (auto& thread : threads_) {
+                if (thread.joinable()) thread.join();
+            }
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_IO_REACTOR_H
@@ -0,0 +1,251 @@
+#ifndef CPP_LEARNING_DEMO_IO_URING_H
+#define CPP_LEARNING_DEMO_IO_URING_H
+
+// io_uring提交/完成队列(直接使用系统调用，不依赖liburing)
+//
+// 提交队列(SQ)和完成队列(CQ)是与内核共享的环形缓冲区：
+// - 应用程序把请求写入SQE，推进SQ尾指针，再用一次io_uring_enter提交一批请求
+// - 内核把结果写入CQE并推进CQ尾指针，应用程序直接读取共享内存，不需要系统调用
+// 注册缓冲区(IORING_REGISTER_BUFFERS)和注册文件(IORING_REGISTER_FILES)让内核省去
+// 每次请求时的页面固定和文件表查找。
+//
+// 头文件不存在(非Linux或内核头文件过旧)时不定义IoUring；
+// 内核不支持或被禁用时IoUring::create返回nullptr，调用方回退到其他实现。
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define CPP_LEARNING_HAVE_IO_URING 1
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+namespace network_demo {
+    class IoUring {
+    private:
+        int fd_ = -1;
+        io_uring_params params_{};
+
+        void* sq_ring_ = nullptr;
+        std::size_t sq_ring_size_ = 0;
+        void* cq_ring_ = nullptr;
+        std::size_t cq_ring_size_ = 0;
+        io_uring_sqe* sqes_ = nullptr;
+        std::size_t sqes_size_ = 0;
+
+        // 共享环中的字段：head/tail由一方写入、另一方读取，通过atomic_ref访问
+        unsigned* sq_head_ = nullptr;
+        unsigned* sq_tail_ = nullptr;
+        unsigned sq_mask_ = 0;
+        unsigned* sq_array_ = nullptr;
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        unsigned cq_mask_ = 0;
+        io_uring_cqe* cqes_ = nullptr;
+
+        // 已填写但尚未提交的SQE位于[submitted_, sqe_tail_)
+        unsigned sqe_tail_ = 0;
+        unsigned submitted_ = 0;
+        // 已提交但还没有取走完成结果的请求数
+        std::size_t in_flight_ = 0;
+
+        static unsigned load_acquire(unsigned* p) {
+            return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+        }
+
+        static void store_release(unsigned* p, unsigned value) {
+            std::atomic_ref<unsigned>(*p).store(value, std::memory_order_release);
+        }
+
+        static void* map(std::size_t size, int fd, off_t offset) {
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        IoUring() = default;
+
+        // 失败时返回errno
+        int setup(unsigned entries) {
+            fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params_));
+            if (fd_ < 0) return errno;
+
+            sq_ring_size_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+            cq_ring_size_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = params_.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+            sq_ring_ = map(sq_ring_size_, fd_, IORING_OFF_SQ_RING);
+            if (!sq_ring_) return errno;
+            cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, fd_, IORING_OFF_CQ_RING);
+            if (!cq_ring_) return errno;
+            sqes_size_ = params_.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, fd_, IORING_OFF_SQES));
+            if (!sqes_) return errno;
+
+            auto* sq = static_cast<char*>(sq_ring_);
+            sq_head_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.head);
+            sq_tail_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.tail);
+            sq_mask_ = *reinterpret_cast<unsigned*>(sq + params_.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.array);
+            auto* cq = static_cast<char*>(cq_ring_);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<unsigned*>(cq + params_.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params_.cq_off.cqes);
+            sqe_tail_ = submitted_ = *sq_tail_;
+            return 0;
+        }
+
+        int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+            for (;;) {
+                int r = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0));
+                if (r >= 0 || errno != EINTR) return r;
+            }
+        }
+
+        int register_op(unsigned opcode, const void* arg, unsigned count) {
+            return static_cast<int>(::syscall(__NR_io_uring_register, fd_, opcode, arg, count));
+        }
+
+    public:
+        // 内核不支持io_uring、被seccomp或io_uring_disabled禁用、或缺少需要的操作码时返回nullptr
+        static std::unique_ptr<IoUring> create(unsigned entries = 256) {
+            std::unique_ptr<IoUring> ring(new IoUring());
+            if (ring->setup(entries) != 0) return nullptr;
+            if (!ring->supports(IORING_OP_READ) || !ring->supports(IORING_OP_WRITE)) return nullptr;
+            return ring;
+        }
+
+        ~IoUring() {
+            if (sqes_) ::munmap(sqes_, sqes_size_);
+            if (cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+            if (sq_ring_) ::munmap(sq_ring_, sq_ring_size_);
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        // 环的文件描述符：有完成结果时可读，可以交给epoll等待
+        int fd() const noexcept {
+            return fd_;
+        }
+
+        // 通过IORING_REGISTER_PROBE查询内核是否支持某个操作码
+        bool supports(unsigned opcode) {
+            constexpr unsigned kOps = 256;
+            std::vector<char> storage(sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op), 0);
+            auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+            if (register_op(IORING_REGISTER_PROBE, probe, kOps) != 0) return false;
+            return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+        }
+
+        // 取一个空闲的SQE(已清零)；提交队列满时先提交已填写的部分。
+        // 内核可能只接受其中一部分(例如完成队列溢出时)，所以一直提交到腾出空位为止；
+        // 内核一个也不接受时抛出std::system_error(EBUSY)，而不是覆盖还没被内核读取的SQE
+        io_uring_sqe& next_sqe() {
+            while (sqe_tail_ - load_acquire(sq_head_) >= params_.sq_entries) {
+                if (submit() == 0) {
+                    throw std::system_error(EBUSY, std::system_category(), "io_uring submission queue full");
+                }
+            }
+            unsigned index = sqe_tail_ & sq_mask_;
+            io_uring_sqe& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sq_array_[index] = index;
+            ++sqe_tail_;
+            return sqe;
+        }
+
+        // 尚未提交的SQE数
+        unsigned pending() const noexcept {
+            return sqe_tail_ - submitted_;
+        }
+
+        std::size_t in_flight() const noexcept {
+            return in_flight_;
+        }
+
+        // 一次系统调用提交所有已填写的SQE，返回提交的数量
+        unsigned submit(unsigned wait_for = 0) {
+            unsigned count = pending();
+            if (count == 0 && wait_for == 0) return 0;
+            store_release(sq_tail_, sqe_tail_);
+            int r = enter(count, wait_for, wait_for ? IORING_ENTER_GETEVENTS : 0);
+            if (r < 0) throw std::system_error(errno, std::system_category(), "io_uring_enter");
+            submitted_ += static_cast<unsigned>(r);
+            in_flight_ += static_cast<unsigned>(r);
+            return static_cast<unsigned>(r);
+        }
+
+        bool has_completions() const noexcept {
+            return load_acquire(cq_tail_) != *cq_head_;
+        }
+
+        // 取走所有已完成的CQE，对每个调用handler(cqe)，返回处理的数量
+        template<typename Handler>
+        std::size_t reap(Handler&& handler) {
+            unsigned head = *cq_head_;
+            unsigned tail = load_acquire(cq_tail_);
+            std::size_t count = 0;
+            while (head != tail) {
+                // 先复制再推进头指针：handler恢复的协程可能提交新请求，但不会覆盖这个CQE
+                io_uring_cqe cqe = cqes_[head & cq_mask_];
+                store_release(cq_head_, ++head);
+                --in_flight_;
+                ++count;
+                handler(cqe);
+                tail = load_acquire(cq_tail_);
+            }
+            return count;
+        }
+
+        // 请求内核取消user_data对应的请求(IORING_OP_ASYNC_CANCEL)：被取消的请求以-ECANCELED完成，
+        // 取消请求自己也产生一个user_data为tag的CQE。已经在执行的请求(例如普通文件读写)照常完成
+        void cancel(std::uint64_t user_data, std::uint64_t tag = 0) {
+            io_uring_sqe& sqe = next_sqe();
+            sqe.opcode = IORING_OP_ASYNC_CANCEL;
+            sqe.fd = -1;
+            sqe.addr = user_data;
+            sqe.user_data = tag;
+        }
+
+        // 提交并阻塞等待所有请求完成，结果交给handler
+        template<typename Handler>
+        void drain(Handler&& handler) {
+            while (pending() > 0 || in_flight_ > 0) {
+                reap(handler);
+                if (pending() > 0 || in_flight_ > 0) submit(1);
+            }
+        }
+
+        // 替换已注册的缓冲区；注册期间这些内存被内核固定
+        void register_buffers(const std::vector<iovec>& buffers) {
+            register_op(IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            if (register_op(IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size())) != 0) {
+                throw std::system_error(errno, std::system_category(), "io_uring_register(BUFFERS)");
+            }
+        }
+
+        // 替换已注册的文件表；SQE通过IOSQE_FIXED_FILE和表中的下标引用文件
+        void register_files(const std::vector<int>& fds) {
+            register_op(IORING_UNREGISTER_FILES, nullptr, 0);
+            if (register_op(IORING_REGISTER_FILES, fds.data(), static_cast<unsigned>(fds.size())) != 0) {
+                throw std::system_error(errno, std::system_category(), "io_uring_register(FILES)");
+            }
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_IO_URING_H
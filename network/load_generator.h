@@ -0,0 +1,275 @@
+#ifndef CPP_LEARNING_DEMO_LOAD_GENERATOR_H
+#define CPP_LEARNING_DEMO_LOAD_GENERATOR_H
+
+// 闭环负载生成器：每个连接发送一条固定的消息，收到固定大小的回复后立即发送下一条
+//
+// 默认是回显协议(回复与消息大小相同)；设置request和response_size后可以对HTTP等请求-响应协议施加负载，
+// 只要每个响应的字节数固定(例如处理函数返回固定内容的HTTP服务器)，客户端不需要解析响应。
+//
+// 连接在构造时建立并在多次run()之间保持，测量的是稳定状态下的往返，而不是建连开销。
+// 每个工作线程有自己的epoll实例和一部分连接，各自记录往返延迟，run()结束后合并。
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io_reactor.h"
+#include "../performance-benchmarking/latency_histogram.h"
+
+namespace network_demo {
+    struct LoadGeneratorOptions {
+        std::string host = "127.0.0.1";
+        std::uint16_t port = 0;
+        std::size_t connections = 16;
+        std::size_t threads = 1;
+        std::size_t message_size = 64;
+        // 非空时每次发送这些字节，代替message_size字节的生成消息
+        std::string request{};
+        // 每个回复的字节数，0表示与请求相同(回显)
+        std::size_t response_size = 0;
+        // 在这段时间内没有任何进展时run()抛出异常，避免服务器出错时永远等待
+        std::chrono::milliseconds stall_timeout{10000};
+    };
+
+    struct LoadReport {
+        std::uint64_t requests = 0;
+        std::uint64_t bytes = 0;
+        std::chrono::nanoseconds elapsed{0};
+        // 每次往返的延迟(纳秒)
+        performance_benchmarking_demo::LatencyHistogram latency;
+
+        double requests_per_second() const {
+            return elapsed.count() > 0 ? static_cast<double>(requests) * 1e9 / static_cast<double>(elapsed.count()) : 0;
+        }
+    };
+
+    class LoadGenerator {
+    private:
+        struct Client {
+            int fd = -1;
+            std::size_t sent = 0;
+            std::size_t received = 0;
+            std::uint64_t remaining = 0;
+            std::uint64_t started_ns = 0;
+        };
+
+        struct Worker {
+            int epoll_fd = -1;
+            std::vector<Client> clients;
+        };
+
+        LoadGeneratorOptions options_;
+        std::vector<char> message_;
+        std::size_t response_size_;
+        std::vector<Worker> workers_;
+
+        static std::uint64_t now_ns() {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // 继续发送当前消息；返回false表示连接出错
+        bool send_pending(Client& client) {
+            while (client.sent < message_.size()) {
+                ssize_t n = ::send(client.fd, message_.data() + client.sent, message_.size() - client.sent,
+                                   MSG_NOSIGNAL);
+                if (n > 0) {
+                    client.sent += static_cast<std::size_t>(n);
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                }
+            }
+            return true;
+        }
+
+        void start_request(Client& client) {
+            client.sent = 0;
+            client.started_ns = now_ns();
+            if (!send_pending(client)) throw_errno(errno, "send");
+        }
+
+        // 读取回复；每收满一条消息记录一次往返并发送下一条，返回完成的请求数
+        std::uint64_t receive(Client& client, std::vector<char>& scratch,
+                              performance_benchmarking_demo::LatencyHistogram& latency) {
+            std::uint64_t completed = 0;
+            for (;;) {
+                ssize_t n = ::read(client.fd, scratch.data(), scratch.size());
+                if (n > 0) {
+                    client.received += static_cast<std::size_t>(n);
+                    while (client.received >= response_size_ && client.remaining > 0) {
+                        client.received -= response_size_;
+                        latency.record(now_ns() - client.started_ns);
+                        ++completed;
+                        if (--client.remaining > 0) start_request(client);
+                    }
+                } else if (n == 0) {
+                    throw std::runtime_error("load generator: server closed the connection");
+                } else if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return completed;
+                } else {
+                    throw_errno(errno, "read");
+                }
+            }
+        }
+
+        void run_worker(Worker& worker, std::uint64_t requests, LoadReport& report) {
+            std::uint64_t outstanding = 0;
+            const std::size_t count = worker.clients.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                Client& client = worker.clients[i];
+                client.received = 0;
+                client.remaining = requests / count + (i < requests % count ? 1 : 0);
+                outstanding += client.remaining;
+                if (client.remaining > 0) start_request(client);
+            }
+
+            std::vector<char> scratch(std::max<std::size_t>(response_size_, 16 * 1024));
+            std::vector<epoll_event> events(count);
+            const int timeout = static_cast<int>(options_.stall_timeout.count());
+            while (outstanding > 0) {
+                int ready = ::epoll_wait(worker.epoll_fd, events.data(), static_cast<int>(events.size()), timeout);
+                if (ready < 0) {
+                    if (errno == EINTR) continue;
+                    throw_errno(errno, "epoll_wait");
+                }
+                if (ready == 0) throw std::runtime_error("load generator: no progress before stall timeout");
+                for (int i = 0; i < ready; ++i) {
+                    Client& client = *static_cast<Client*>(events[static_cast<std::size_t>(i)].data.ptr);
+                    if (client.remaining == 0) continue;
+                    if ((events[static_cast<std::size_t>(i)].events & EPOLLOUT) && !send_pending(client)) {
+                        throw_errno(errno, "send");
+                    }
+                    std::uint64_t completed = receive(client, scratch, report.latency);
+                    outstanding -= completed;
+                    report.requests += completed;
+                    report.bytes += completed * (message_.size() + response_size_);
+                }
+            }
+        }
+
+    public:
+        explicit LoadGenerator(LoadGeneratorOptions options)
+            : options_(std::move(options)) {
+            if (options_.request.empty()) {
+                message_.resize(std::max<std::size_t>(1, options_.message_size));
+                for (std::size_t i = 0; i < message_.size(); ++i) message_[i] = static_cast<char>('a' + i % 26);
+            } else {
+                message_.assign(options_.request.begin(), options_.request.end());
+            }
+            response_size_ = options_.response_size > 0 ? options_.response_size : message_.size();
+            const std::size_t threads = std::max<std::size_t>(1, std::min(options_.threads, options_.connections));
+            workers_.resize(threads);
+            try {
+                for (auto& worker : workers_) {
+                    worker.epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+                    if (worker.epoll_fd < 0) throw_errno(errno, "epoll_create1");
+                }
+                // 连接按轮转分配给工作线程；clients的容量预先确定，Client的地址作为epoll数据不会失效
+                for (std::size_t i = 0; i < workers_.size(); ++i) {
+                    workers_[i].clients.reserve(options_.connections / threads + 1);
+                }
+                const sockaddr_in address = make_address(options_.host, options_.port);
+                for (std::size_t i = 0; i < options_.connections; ++i) {
+                    Worker& worker = workers_[i % threads];
+                    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                    if (fd < 0) throw_errno(errno, "socket");
+                    worker.clients.push_back(Client{fd});
+                    // 阻塞方式建立连接，之后切换为非阻塞
+                    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                        throw_errno(errno, "connect");
+                    }
+                    int one = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    int flags = ::fcntl(fd, F_GETFL);
+                    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) throw_errno(errno, "fcntl");
+                    epoll_event event{};
+                    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+                    event.data.ptr = &worker.clients.back();
+                    if (::epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) throw_errno(errno, "epoll_ctl");
+                }
+            } catch (...) {
+                close_all();
+                throw;
+            }
+        }
+
+        ~LoadGenerator() {
+            close_all();
+        }
+
+        LoadGenerator(const LoadGenerator&) = delete;
+        LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+        std::size_t connections() const noexcept {
+            return options_.connections;
+        }
+
+        // 完成requests次往返(平均分给所有连接)后返回
+        LoadReport run(std::uint64_t requests) {
+            std::vector<LoadReport> partial(workers_.size());
+            const auto start = std::chrono::steady_clock::now();
+            if (workers_.size() == 1) {
+                run_worker(workers_[0], requests, partial[0]);
+            } else {
+                std::vector<std::thread> threads;
+                std::vector<std::exception_ptr> errors(workers_.size());
+                for (std::size_t i = 0; i < workers_.size(); ++i) {
+                    std::uint64_t share = requests / workers_.size() + (i < requests % workers_.size() ? 1 : 0);
+                    threads.emplace_back([this, i, share, &partial, &errors] {
+                        try {
+                            run_worker(workers_[i], share, partial[i]);
+                        } catch (...) {
+                            errors[i] = std::current_exception();
+                        }
+                    });
+                }
+                for (auto& thread : threads) thread.join();
+                for (auto& error : errors) {
+                    if (error) std::rethrow_exception(error);
+                }
+            }
+            LoadReport report;
+            report.elapsed = std::chrono::steady_clock::now() - start;
+            for (const auto& part : partial) {
+                report.requests += part.requests;
+                report.bytes += part.bytes;
+                report.latency.merge(part.latency);
+            }
+            return report;
+        }
+
+    private:
+        void close_all() noexcept {
+            for (auto& worker : workers_) {
+                for (auto& client : worker.clients) {
+                    if (client.fd >= 0) ::close(client.fd);
+                    client.fd = -1;
+                }
+                if (worker.epoll_fd >= 0) ::close(worker.epoll_fd);
+                worker.epoll_fd = -1;
+            }
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_LOAD_GENERATOR_H
@@ -6,9 +6,20 @@
 #include <thread>
 #include <chrono>
 #include <sstream>
+#include <vector>
+#include <optional>
 
-// 注意：实际的网络编程需要使用套接字API，这里提供概念性示例
-// 在实际项目中，您可能需要包含 <sys/socket.h>, <netinet/in.h> 等
+#include "io_reactor.h"
+#include "tcp_server.h"
+#include "load_generator.h"
+#include "http_server.h"
+#include "http_client.h"
+#include "connection_pool.h"
+#include "url_parser.h"
+
+// 注意：TCPClient是概念性示例，不会真正联网；
+// TCP/HTTP服务器(tcp_server.h、http_server.h)、HTTP客户端(http_client.h)、连接池(connection_pool.h)
+// 和协程反应器(io_reactor.h)使用真实的套接字，只在Linux上可用
 
 namespace network_demo {
     // 模拟TCP客户端
@@ -36,84 +47,28 @@ namespace network_demo {
         }
     };
     
-    // 模拟TCP服务器
-    class TCPServer {
-    private:
-        int port_;
-        
-    public:
-        explicit TCPServer(int port) : port_(port) {}
-        
-        void start() {
-            std::cout << "服务器启动，监听端口 " << port_ << std::endl;
-        }
-        
-        void handle_client() {
-            std::cout << "处理客户端连接..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            std::cout << "接收到来自客户端的消息" << std::endl;
-            std::cout << "发送响应给客户端" << std::endl;
-        }
-        
-        void stop() {
-            std::cout << "服务器停止" << std::endl;
-        }
-    };
-    
-    // HTTP客户端模拟
-    class HTTPClient {
-    public:
-        std::string get(const std::string& url) {
-            std::cout << "发送GET请求到: " << url << std::endl;
-            // 模拟网络延迟
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            return "HTTP/1.1 200 OK\nContent-Type: text/html\n\n<html><body><h1>欢迎!</h1></body></html>";
-        }
-        
-        std::string post(const std::string& url, const std::string& data) {
-            std::cout << "发送POST请求到: " << url << std::endl;
-            std::cout << "数据: " << data << std::endl;
-            // 模拟网络延迟
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            return "HTTP/1.1 201 Created\nContent-Type: application/json\n\n{\"status\": \"success\"}";
-        }
-    };
-    
-    // URL解析器
+    // 拥有数据的URL，由零分配的URLView(url_parser.h)解析后复制各部分；
+    // 需要大量解析时直接使用URLView，避免这里的字符串分配
     struct URL {
         std::string protocol;
         std::string host;
-        int port;
+        // 显式端口，或者scheme的默认端口
+        int port = 0;
         std::string path;
-        
+        std::string query;
+        std::string fragment;
+
+        // 无法解析时返回所有字段为空的URL
         static URL parse(const std::string& url_str) {
             URL url;
-            // 简单的URL解析实现
-            if (url_str.substr(0, 7) == "http://") {
-                url.protocol = "http";
-                std::string remaining = url_str.substr(7);
-                size_t path_pos = remaining.find('/');
-                if (path_pos != std::string::npos) {
-                    url.host = remaining.substr(0, path_pos);
-                    url.path = remaining.substr(path_pos);
-                } else {
-                    url.host = remaining;
-                    url.path = "/";
-                }
-                url.port = 80;
-            } else if (url_str.substr(0, 8) == "https://") {
-                url.protocol = "https";
-                std::string remaining = url_str.substr(8);
-                size_t path_pos = remaining.find('/');
-                if (path_pos != std::string::npos) {
-                    url.host = remaining.substr(0, path_pos);
-                    url.path = remaining.substr(path_pos);
-                } else {
-                    url.host = remaining;
-                    url.path = "/";
-                }
-                url.port = 443;
-            }
+            std::optional<URLView> view = URLView::parse(url_str);
+            if (!view) return url;
+            url.protocol = std::string(view->scheme);
+            url.host = std::string(view->host);
+            url.port = view->effective_port();
+            url.path = view->path.empty() && view->has_authority ? "/" : std::string(view->path);
+            url.query = std::string(view->query);
+            url.fragment = std::string(view->fragment);
             return url;
         }
     };
@@ -129,47 +84,201 @@ namespace network_demo {
         client.disconnect();
     }
     
-    // TCP服务器演示
+#if defined(__linux__)
+    // TCP服务器演示：两个事件循环线程的回显服务器，由负载生成器在回环地址上施加负载
     void tcp_server_demo() {
         std::cout << "\n=== TCP服务器演示 ===" << std::endl;
-        TCPServer server(8080);
+        TCPServerCallbacks callbacks;
+        callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+            connection.send(input.data(), input.size());
+            input.consume(input.size());
+        };
+        TCPServerOptions options;
+        options.threads = 2;
+        TCPServer server(options, std::move(callbacks));
         server.start();
-        server.handle_client();
+        std::cout << "服务器启动，监听端口 " << server.port() << "，" << server.threads() << " 个事件循环线程" << std::endl;
+
+        LoadGeneratorOptions load;
+        load.port = server.port();
+        load.connections = 32;
+        LoadReport report = LoadGenerator(load).run(20000);
+        std::cout << load.connections << " 个连接完成 " << report.requests << " 次往返，"
+                  << static_cast<long>(report.requests_per_second()) << " 请求/秒，p50 "
+                  << report.latency.percentile(50) / 1000.0 << " us，p99 "
+                  << report.latency.percentile(99) / 1000.0 << " us" << std::endl;
         server.stop();
+        std::cout << "服务器停止，共接受 " << server.total_accepted() << " 个连接" << std::endl;
     }
-    
-    // HTTP客户端演示
+
+    // HTTP演示：本地HTTP/1.1服务器，客户端在同一个长连接上发送GET、POST和流水线请求
+    void http_demo_handler(const HTTPRequest& request, HTTPResponse& response) {
+        if (request.method == "POST") {
+            response.set_status(201);
+            response.add_header("Content-Type", "application/json");
+            response.body_buffer().append("{\"status\": \"success\", \"received\": ").append(request.body).append("}");
+        } else if (request.target == "/index.html") {
+            response.add_header("Content-Type", "text/html; charset=utf-8");
+            response.set_body("<html><body><h1>欢迎!</h1></body></html>");
+        } else {
+            response.add_header("Content-Type", "text/plain");
+            response.body_buffer().append("path: ").append(request.target);
+        }
+    }
+
     void http_client_demo() {
         std::cout << "\n=== HTTP客户端演示 ===" << std::endl;
+        HTTPServer server(HTTPServerOptions{}, http_demo_handler);
+        server.start();
+        const std::string base = "http://127.0.0.1:" + std::to_string(server.port());
         HTTPClient client;
-        
-        // GET请求
-        std::string response = client.get("http://example.com/index.html");
-        std::cout << "GET响应:\n" << response << std::endl;
-        
-        // POST请求
-        response = client.post("http://example.com/api/users", "{\"name\": \"张三\", \"age\": 30}");
-        std::cout << "POST响应:\n" << response << std::endl;
+
+        HTTPClientResponse response = client.get(base + "/index.html");
+        std::cout << "GET " << response.status << " " << response.reason << " ("
+                  << response.header("Content-Type") << "): " << response.body << std::endl;
+
+        response = client.post(base + "/api/users", "{\"name\": \"张三\", \"age\": 30}");
+        std::cout << "POST " << response.status << " " << response.reason << ": " << response.body << std::endl;
+
+        // 流水线：三个请求一次写出，响应按顺序返回
+        std::vector<std::string> urls = {base + "/a", base + "/b", base + "/c"};
+        for (const auto& r : client.get_pipelined(urls)) std::cout << "流水线响应: " << r.body << std::endl;
+        std::cout << "共 " << server.total_requests() << " 个请求，使用 " << client.connections_opened()
+                  << " 个TCP连接" << std::endl;
+        server.stop();
     }
-    
+
+    // 连接池演示：同样的GET请求，复用连接池中的长连接 vs 每次建立新连接
+    void connection_pool_demo() {
+        std::cout << "\n=== 连接池演示 ===" << std::endl;
+        HTTPServer server(HTTPServerOptions{}, http_demo_handler);
+        server.start();
+        const std::string url = "http://127.0.0.1:" + std::to_string(server.port()) + "/ping";
+        constexpr int kRequests = 200;
+
+        auto measure = [&url](HTTPClient& client) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRequests; ++i) client.get(url);
+            auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            return elapsed.count() / kRequests;
+        };
+
+        auto pool = std::make_shared<ConnectionPool>();
+        HTTPClient pooled(pool);
+        double pooled_us = measure(pooled);
+        ConnectionPoolOptions options;
+        options.max_idle_per_host = 0;
+        HTTPClient unpooled(std::make_shared<ConnectionPool>(options));
+        double unpooled_us = measure(unpooled);
+
+        ConnectionPoolStats stats = pool->stats();
+        std::cout << "复用连接: 平均 " << pooled_us << " us/请求，新建 " << stats.opened << " 个连接，复用 "
+                  << stats.reused << " 次" << std::endl;
+        std::cout << "不复用:   平均 " << unpooled_us << " us/请求，新建 " << unpooled.connections_opened()
+                  << " 个连接" << std::endl;
+        server.stop();
+    }
+#endif
+
     // URL解析演示
     void url_parsing_demo() {
         std::cout << "\n=== URL解析演示 ===" << std::endl;
-        std::string url_str = "https://www.example.com:443/api/users?id=123";
+        std::string url_str = "https://www.example.com:8443/api/users?id=123#top";
         URL url = URL::parse(url_str);
         std::cout << "协议: " << url.protocol << std::endl;
         std::cout << "主机: " << url.host << std::endl;
         std::cout << "端口: " << url.port << std::endl;
         std::cout << "路径: " << url.path << std::endl;
+        std::cout << "查询: " << url.query << std::endl;
+        std::cout << "片段: " << url.fragment << std::endl;
+
+        // URLView不复制：各部分都指向原字符串，解码和规范化在需要时才做
+        std::string_view text = "HTTP://user@Example.COM:80/a/./b/../%7Edocs/caf%C3%A9?lang=zh&q=c%2B%2B";
+        if (std::optional<URLView> view = URLView::parse(text)) {
+            char decoded[128];
+            char normalized[128];
+            std::cout << "用户信息: " << view->userinfo << "，主机: " << view->host
+                      << "，端口: " << view->effective_port() << std::endl;
+            std::cout << "解码后的路径: " << view->decoded_path(decoded) << std::endl;
+            std::cout << "查询参数q: " << view->query_param("q").value_or("") << std::endl;
+            std::cout << "规范化: " << std::string_view(normalized, view->normalize(normalized)) << std::endl;
+        }
     }
     
+#if defined(__linux__)
+    // 协程回显服务器：一个线程上的Reactor同时服务所有连接
+    Task<void> reactor_echo_session(AsyncFd connection) {
+        char buffer[1024];
+        for (;;) {
+            std::size_t n = co_await async_read(connection, buffer, sizeof(buffer));
+            if (n == 0) co_return;
+            co_await async_write_all(connection, buffer, n);
+        }
+    }
+
+    Task<void> reactor_accept_loop(AsyncFd& listener) {
+        for (;;) {
+            listener.reactor().spawn(reactor_echo_session(co_await async_accept(listener)));
+        }
+    }
+
+    // 每个客户端发送若干条消息并等待回显，消息之间用定时器稍作停顿
+    Task<std::size_t> reactor_echo_client(Reactor& reactor, std::uint16_t port, int messages) {
+        AsyncFd socket = co_await tcp_connect(reactor, make_address("127.0.0.1", port));
+        const char message[] = "ping";
+        char reply[sizeof(message)];
+        std::size_t echoed = 0;
+        for (int i = 0; i < messages; ++i) {
+            co_await async_write_all(socket, message, sizeof(message));
+            std::size_t received = 0;
+            while (received < sizeof(reply)) {
+                std::size_t n = co_await async_read(socket, reply + received, sizeof(reply) - received);
+                if (n == 0) co_return echoed;
+                received += n;
+            }
+            echoed += received;
+            co_await reactor.sleep_for(std::chrono::milliseconds(1));
+        }
+        co_return echoed;
+    }
+
+    Task<std::size_t> reactor_clients(Reactor& reactor, std::uint16_t port, int clients, int messages) {
+        std::vector<Task<std::size_t>> tasks;
+        tasks.reserve(clients);
+        for (int i = 0; i < clients; ++i) tasks.push_back(reactor_echo_client(reactor, port, messages));
+        std::size_t total = 0;
+        for (std::size_t bytes : co_await coroutines_base::when_all(std::move(tasks))) total += bytes;
+        co_return total;
+    }
+
+    void reactor_echo_demo(int clients = 200, int messages = 10) {
+        std::cout << "\n=== epoll协程回显服务器演示 ===" << std::endl;
+        Reactor reactor;
+        AsyncFd listener = tcp_listen(reactor, ListenOptions{});
+        const std::uint16_t port = local_port(listener);
+        reactor.spawn(reactor_accept_loop(listener));
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t bytes = reactor.run_until_complete(reactor_clients(reactor, port, clients, messages));
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "单线程服务 " << clients << " 个并发连接(客户端在同一Reactor上)，每个连接 " << messages
+                  << " 次往返，共回显 " << bytes << " 字节，用时 " << elapsed.count() << " ms" << std::endl;
+    }
+#endif
+
     // 运行所有演示
     void run_demo() {
         std::cout << "=== 网络编程演示 ===" << std::endl;
         tcp_client_demo();
+#if defined(__linux__)
         tcp_server_demo();
-        http_client_demo();
+#endif
         url_parsing_demo();
+#if defined(__linux__)
+        http_client_demo();
+        connection_pool_demo();
+        reactor_echo_demo();
+#endif
     }
 }
 
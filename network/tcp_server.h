@@ -0,0 +1,658 @@
+#ifndef CPP_LEARNING_DEMO_TCP_SERVER_H
+#define CPP_LEARNING_DEMO_TCP_SERVER_H
+
+// 非阻塞TCP服务器(回调接口)
+//
+// - 每个事件循环线程有自己的epoll实例和自己的SO_REUSEPORT监听套接字，内核把新连接分摊到各个线程，
+//   线程之间不共享连接，也不需要加锁
+// - 输入和输出缓冲区都有上限：on_message取走数据之前暂停读取，仍然放不下一条消息时关闭连接；
+//   对端读得太慢、排队的输出超过上限时也关闭连接
+// - 监听套接字和连接都以边缘触发方式注册一次(EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLET)，
+//   事件到达时读到EAGAIN为止，之后不再调用epoll_ctl修改关注的事件
+// - 每个连接有自己的输入/输出缓冲区；send()先尝试直接写，写不完的部分留在输出缓冲区，等可写事件再发
+// - 连接对象和它的缓冲区来自每个线程的对象池，关闭后回收复用：连接建立、收发和关闭的路径上
+//   不分配内存(缓冲区只在数据超过已有容量时扩容)
+//
+// 回调在连接所属的事件循环线程上调用；TCPConnection的成员函数只能在这些回调中使用。
+// 回调不应抛出异常：逃出事件循环的异常交给on_error，然后整个服务器停止。
+#if defined(__linux__)
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "io_reactor.h"
+
+namespace network_demo {
+    // 连接的读写缓冲区：[read_, write_)是有效数据，取走的部分在需要空间时才移动，容量在复用时保留
+    class ByteBuffer {
+    private:
+        std::vector<char> data_;
+        std::size_t read_ = 0;
+        std::size_t write_ = 0;
+
+    public:
+        explicit ByteBuffer(std::size_t capacity = 0) : data_(capacity) {}
+
+        const char* data() const noexcept {
+            return data_.data() + read_;
+        }
+
+        // 可写的有效数据，供原地解析(例如HTTP分块解码)使用
+        char* data() noexcept {
+            return data_.data() + read_;
+        }
+
+        std::size_t size() const noexcept {
+            return write_ - read_;
+        }
+
+        bool empty() const noexcept {
+            return read_ == write_;
+        }
+
+        std::size_t capacity() const noexcept {
+            return data_.size();
+        }
+
+        std::string_view view() const noexcept {
+            return {data(), size()};
+        }
+
+        // 取走开头的n字节
+        void consume(std::size_t n) noexcept {
+            read_ += std::min(n, size());
+            if (read_ == write_) read_ = write_ = 0;
+        }
+
+        void clear() noexcept {
+            read_ = write_ = 0;
+        }
+
+        // 返回至少n字节的可写空间：先把有效数据移到开头，仍然不够时扩容
+        char* prepare(std::size_t n) {
+            if (data_.size() - write_ < n) {
+                if (read_ > 0) {
+                    std::memmove(data_.data(), data_.data() + read_, size());
+                    write_ -= read_;
+                    read_ = 0;
+                }
+                if (data_.size() - write_ < n) data_.resize(std::max(data_.size() * 2, write_ + n));
+            }
+            return data_.data() + write_;
+        }
+
+        // 当前可写空间的大小(不扩容)
+        std::size_t writable() const noexcept {
+            return data_.size() - write_;
+        }
+
+        void commit(std::size_t n) noexcept {
+            write_ += n;
+        }
+
+        void append(const void* bytes, std::size_t n) {
+            std::memcpy(prepare(n), bytes, n);
+            commit(n);
+        }
+    };
+
+    class TCPServer;
+
+    class TCPConnection {
+    private:
+        friend class TCPServer;
+
+        int fd_ = -1;
+        std::uint64_t id_ = 0;
+        bool open_ = false;
+        // 输出缓冲区发完后关闭
+        bool closing_ = false;
+        bool failed_ = false;
+        void* user_data_ = nullptr;
+        ByteBuffer input_;
+        ByteBuffer output_;
+        // 输出缓冲区的上限，0表示不限制
+        std::size_t max_output_;
+        // 所属事件循环的编号；连接对象只在这个事件循环中复用
+        std::size_t loop_;
+
+        TCPConnection(std::size_t input_capacity, std::size_t output_capacity, std::size_t max_output, std::size_t loop)
+            : input_(input_capacity), output_(output_capacity), max_output_(max_output), loop_(loop) {}
+
+        // 排队的输出超过上限时标记连接失败，丢弃这次的数据
+        bool queue(const char* bytes, std::size_t size) {
+            if (max_output_ != 0 && output_.size() + size > max_output_) {
+                failed_ = true;
+                return false;
+            }
+            output_.append(bytes, size);
+            return true;
+        }
+
+        // 尽量发送输出缓冲区中的数据；出错时标记连接失败
+        void flush() {
+            while (!output_.empty()) {
+                ssize_t n = ::send(fd_, output_.data(), output_.size(), MSG_NOSIGNAL);
+                if (n > 0) {
+                    output_.consume(static_cast<std::size_t>(n));
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) failed_ = true;
+                    return;
+                }
+            }
+        }
+
+    public:
+        TCPConnection(const TCPConnection&) = delete;
+        TCPConnection& operator=(const TCPConnection&) = delete;
+
+        // 服务器内唯一的连接编号，不随连接对象复用而重复
+        std::uint64_t id() const noexcept {
+            return id_;
+        }
+
+        int fd() const noexcept {
+            return fd_;
+        }
+
+        // 所属事件循环的编号(0到threads() - 1)，可以用来索引每个事件循环自己的数据而不加锁
+        std::size_t loop() const noexcept {
+            return loop_;
+        }
+
+        bool open() const noexcept {
+            return open_ && !closing_ && !failed_;
+        }
+
+        ByteBuffer& input() noexcept {
+            return input_;
+        }
+
+        // 尚未发出的字节数，可以用来判断对端是否读得太慢
+        std::size_t pending_output() const noexcept {
+            return output_.size();
+        }
+
+        // 输出缓冲区为空时直接写套接字，写不完的部分排队；连接已关闭时丢弃，排队超过max_output_buffer时关闭连接
+        void send(const void* data, std::size_t size) {
+            if (!open()) return;
+            const char* bytes = static_cast<const char*>(data);
+            if (output_.empty()) {
+                while (size > 0) {
+                    ssize_t n = ::send(fd_, bytes, size, MSG_NOSIGNAL);
+                    if (n > 0) {
+                        bytes += n;
+                        size -= static_cast<std::size_t>(n);
+                    } else if (n < 0 && errno == EINTR) {
+                        continue;
+                    } else {
+                        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                            failed_ = true;
+                            return;
+                        }
+                        break;
+                    }
+                }
+            }
+            if (size > 0) queue(bytes, size);
+        }
+
+        void send(std::string_view data) {
+            send(data.data(), data.size());
+        }
+
+        // 聚集写：按顺序发出count段数据(最多IOV_MAX段)。输出缓冲区为空时一次sendmsg直接写套接字，
+        // 写不完的部分复制到输出缓冲区；返回后调用方可以立即复用iov指向的内存
+        void send(const iovec* iov, int count) {
+            if (!open()) return;
+            int index = 0;
+            std::size_t offset = 0;
+            if (output_.empty()) {
+                msghdr message{};
+                message.msg_iov = const_cast<iovec*>(iov);
+                message.msg_iovlen = static_cast<std::size_t>(count);
+                ssize_t n;
+                do {
+                    n = ::sendmsg(fd_, &message, MSG_NOSIGNAL);
+                } while (n < 0 && errno == EINTR);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        failed_ = true;
+                        return;
+                    }
+                    n = 0;
+                }
+                // 跳过已经完整发出的段
+                std::size_t written = static_cast<std::size_t>(n);
+                while (index < count && written >= iov[index].iov_len) {
+                    written -= iov[index].iov_len;
+                    ++index;
+                }
+                offset = written;
+            }
+            for (; index < count; ++index, offset = 0) {
+                if (!queue(static_cast<const char*>(iov[index].iov_base) + offset, iov[index].iov_len - offset)) return;
+            }
+        }
+
+        // 发完已排队的输出后关闭连接
+        void close() noexcept {
+            closing_ = true;
+        }
+
+        // 每个连接一个用户指针，通常在on_open中设置，指向调用方自己的连接状态
+        void* user_data() const noexcept {
+            return user_data_;
+        }
+
+        void set_user_data(void* data) noexcept {
+            user_data_ = data;
+        }
+    };
+
+    struct TCPServerOptions {
+        std::string host = "127.0.0.1";
+        // 0表示由内核分配端口，start()之后用port()查询
+        std::uint16_t port = 0;
+        std::size_t threads = 1;
+        int backlog = SOMAXCONN;
+        // 新连接对象的初始缓冲区大小；每次read最少准备read_chunk字节的空间
+        std::size_t input_buffer = 16 * 1024;
+        std::size_t output_buffer = 16 * 1024;
+        std::size_t read_chunk = 16 * 1024;
+        // 输入缓冲区达到上限时暂停读取，先交给on_message；on_message取走数据后仍然满时关闭连接
+        // (一条消息超过了上限)。0表示不限制
+        std::size_t max_input_buffer = 4 * 1024 * 1024;
+        // 排队等待发送的输出超过上限时关闭连接。0表示不限制
+        std::size_t max_output_buffer = 16 * 1024 * 1024;
+        int max_events = 256;
+        // 监听套接字设置SO_REUSEPORT；多个线程时必须开启，每个线程各自监听同一端口
+        bool reuse_port = true;
+    };
+
+    struct TCPServerCallbacks {
+        std::function<void(TCPConnection&)> on_open;
+        // 输入缓冲区中有新数据；处理完的部分用input.consume()取走，剩下的留到下次(例如不完整的消息)
+        std::function<void(TCPConnection&, ByteBuffer&)> on_message;
+        // 对端关闭、出错或调用close()之后调用一次
+        std::function<void(TCPConnection&)> on_close;
+        // 逃出事件循环的异常(通常来自回调)，在出错的事件循环线程上调用，之后服务器停止；默认输出到std::cerr
+        std::function<void(std::exception_ptr)> on_error;
+    };
+
+    class TCPServer {
+    private:
+        // 每个线程一个事件循环，独占自己的监听套接字、epoll实例和连接池
+        class EventLoop {
+        private:
+            TCPServer& server_;
+            std::size_t index_;
+            int epoll_fd_ = -1;
+            int listen_fd_ = -1;
+            int wake_fd_ = -1;
+            // epoll_event.data.ptr指向连接对象，这两个地址标记监听套接字和唤醒用的eventfd
+            char listen_tag_ = 0;
+            char wake_tag_ = 0;
+
+            std::vector<std::unique_ptr<TCPConnection>> connections_;
+            std::vector<TCPConnection*> free_;
+            // 本轮关闭的连接：同一批事件里可能还有它们的事件，处理完这一批再放回free_
+            std::vector<TCPConnection*> closed_;
+            std::vector<epoll_event> events_;
+
+            TCPConnection* acquire() {
+                if (free_.empty()) {
+                    connections_.push_back(std::unique_ptr<TCPConnection>(
+                        new TCPConnection(server_.options_.input_buffer, server_.options_.output_buffer,
+                                          server_.options_.max_output_buffer, index_)));
+                    return connections_.back().get();
+                }
+                TCPConnection* connection = free_.back();
+                free_.pop_back();
+                return connection;
+            }
+
+            void accept_all() {
+                for (;;) {
+                    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (fd < 0) {
+                        if (errno == EINTR || errno == ECONNABORTED) continue;
+                        // EAGAIN：已取完；EMFILE等：留在队列中，下一次新连接到达时再试
+                        return;
+                    }
+                    int one = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    TCPConnection* connection = acquire();
+                    connection->fd_ = fd;
+                    connection->id_ = server_.next_id_.fetch_add(1, std::memory_order_relaxed);
+                    connection->open_ = true;
+                    epoll_event event{};
+                    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    event.data.ptr = connection;
+                    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+                        ::close(fd);
+                        connection->open_ = false;
+                        free_.push_back(connection);
+                        continue;
+                    }
+                    server_.active_.fetch_add(1, std::memory_order_relaxed);
+                    server_.accepted_.fetch_add(1, std::memory_order_relaxed);
+                    if (server_.callbacks_.on_open) server_.callbacks_.on_open(*connection);
+                    finish_if_closing(*connection);
+                }
+            }
+
+            // 读到EAGAIN为止，然后把新数据交给on_message；返回对端是否已关闭。
+            // 输入缓冲区满时先交给on_message，它取走数据后继续读(边缘触发不会为已到达的数据再通知一次)
+            bool read_all(TCPConnection& connection) {
+                const std::size_t limit = server_.options_.max_input_buffer;
+                ByteBuffer& input = connection.input_;
+                bool peer_closed = false;
+                for (;;) {
+                    bool full = false;
+                    for (;;) {
+                        std::size_t want = server_.options_.read_chunk;
+                        if (limit != 0) {
+                            if (input.size() >= limit) {
+                                full = true;
+                                break;
+                            }
+                            want = std::min(want, limit - input.size());
+                        }
+                        char* space = input.prepare(want);
+                        std::size_t room = input.writable();
+                        if (limit != 0) room = std::min(room, limit - input.size());
+                        ssize_t n = ::read(connection.fd_, space, room);
+                        if (n > 0) {
+                            input.commit(static_cast<std::size_t>(n));
+                        } else if (n == 0) {
+                            peer_closed = true;
+                            break;
+                        } else if (errno == EINTR) {
+                            continue;
+                        } else {
+                            if (errno != EAGAIN && errno != EWOULDBLOCK) connection.failed_ = true;
+                            break;
+                        }
+                    }
+                    if (!input.empty() && server_.callbacks_.on_message) {
+                        server_.callbacks_.on_message(connection, input);
+                    }
+                    if (!full || !connection.open()) break;
+                    if (input.size() >= limit) {
+                        connection.failed_ = true;
+                        break;
+                    }
+                }
+                return peer_closed;
+            }
+
+            void finish_if_closing(TCPConnection& connection) {
+                if (!connection.open_) return;
+                if (connection.failed_ || (connection.closing_ && connection.output_.empty())) {
+                    close_now(connection);
+                }
+            }
+
+            void close_now(TCPConnection& connection) {
+                if (!connection.open_) return;
+                connection.closing_ = true;
+                if (server_.callbacks_.on_close) server_.callbacks_.on_close(connection);
+                // close会把描述符从epoll中移除
+                ::close(connection.fd_);
+                connection.fd_ = -1;
+                connection.open_ = false;
+                server_.active_.fetch_sub(1, std::memory_order_relaxed);
+                closed_.push_back(&connection);
+            }
+
+            void handle(TCPConnection& connection, std::uint32_t events) {
+                if (!connection.open_) return;
+                if (events & EPOLLOUT) connection.flush();
+                if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    bool peer_closed = read_all(connection);
+                    if (!connection.open_) return;
+                    if (events & EPOLLERR) {
+                        close_now(connection);
+                        return;
+                    }
+                    // 对端关闭写方向后，把已排队的响应发完再关闭
+                    if (peer_closed) connection.closing_ = true;
+                    connection.flush();
+                }
+                finish_if_closing(connection);
+            }
+
+            void recycle() {
+                for (TCPConnection* connection : closed_) {
+                    connection->input_.clear();
+                    connection->output_.clear();
+                    connection->closing_ = false;
+                    connection->failed_ = false;
+                    connection->user_data_ = nullptr;
+                    free_.push_back(connection);
+                }
+                closed_.clear();
+            }
+
+            void close_fds() noexcept {
+                if (listen_fd_ >= 0) ::close(listen_fd_);
+                if (wake_fd_ >= 0) ::close(wake_fd_);
+                if (epoll_fd_ >= 0) ::close(epoll_fd_);
+                listen_fd_ = wake_fd_ = epoll_fd_ = -1;
+            }
+
+            void open_fds(std::uint16_t port) {
+                epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+                if (epoll_fd_ < 0) throw_errno(errno, "epoll_create1");
+                wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (wake_fd_ < 0) throw_errno(errno, "eventfd");
+
+                listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (listen_fd_ < 0) throw_errno(errno, "socket");
+                int one = 1;
+                ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                if (server_.options_.reuse_port &&
+                    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+                    throw_errno(errno, "setsockopt(SO_REUSEPORT)");
+                }
+                sockaddr_in address = make_address(server_.options_.host, port);
+                if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                    throw_errno(errno, "bind");
+                }
+                if (::listen(listen_fd_, server_.options_.backlog) != 0) throw_errno(errno, "listen");
+
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLET;
+                event.data.ptr = &listen_tag_;
+                if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) != 0) throw_errno(errno, "epoll_ctl");
+                event.events = EPOLLIN;
+                event.data.ptr = &wake_tag_;
+                if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) != 0) throw_errno(errno, "epoll_ctl");
+            }
+
+        public:
+            EventLoop(TCPServer& server, std::uint16_t port, std::size_t index) : server_(server), index_(index) {
+                try {
+                    open_fds(port);
+                } catch (...) {
+                    close_fds();
+                    throw;
+                }
+                events_.resize(static_cast<std::size_t>(std::max(1, server.options_.max_events)));
+            }
+
+            ~EventLoop() {
+                close_fds();
+            }
+
+            EventLoop(const EventLoop&) = delete;
+            EventLoop& operator=(const EventLoop&) = delete;
+
+            std::uint16_t local_port() const {
+                sockaddr_in address{};
+                socklen_t length = sizeof(address);
+                if (::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+                    throw_errno(errno, "getsockname");
+                }
+                return ntohs(address.sin_port);
+            }
+
+            void wake() {
+                std::uint64_t one = 1;
+                ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+                (void)ignored;
+            }
+
+            void poll() {
+                while (!server_.stopping_.load(std::memory_order_acquire)) {
+                    int count = ::epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()), -1);
+                    if (count < 0) {
+                        if (errno == EINTR) continue;
+                        throw_errno(errno, "epoll_wait");
+                    }
+                    for (int i = 0; i < count; ++i) {
+                        void* tag = events_[static_cast<std::size_t>(i)].data.ptr;
+                        if (tag == &listen_tag_) {
+                            accept_all();
+                        } else if (tag != &wake_tag_) {
+                            handle(*static_cast<TCPConnection*>(tag), events_[static_cast<std::size_t>(i)].events);
+                        }
+                    }
+                    recycle();
+                }
+            }
+
+            // 异常不会逃出线程函数(那会调用std::terminate)：交给on_error并停止整个服务器
+            void run() {
+                try {
+                    poll();
+                } catch (...) {
+                    server_.fail(std::current_exception());
+                }
+                // 退出前关闭剩余的连接，每个连接仍然收到一次on_close
+                for (auto& connection : connections_) {
+                    try {
+                        close_now(*connection);
+                    } catch (...) {
+                        server_.fail(std::current_exception());
+                    }
+                }
+                recycle();
+            }
+        };
+
+        TCPServerOptions options_;
+        TCPServerCallbacks callbacks_;
+        std::vector<std::unique_ptr<EventLoop>> loops_;
+        std::vector<std::thread> threads_;
+        std::uint16_t port_ = 0;
+        std::atomic<bool> stopping_{false};
+        std::atomic<std::uint64_t> next_id_{1};
+        std::atomic<std::size_t> active_{0};
+        std::atomic<std::uint64_t> accepted_{0};
+
+        void fail(std::exception_ptr error) noexcept {
+            if (callbacks_.on_error) {
+                try {
+                    callbacks_.on_error(error);
+                } catch (...) {
+                }
+            } else {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& e) {
+                    std::cerr << "tcp server: unhandled exception in event loop: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "tcp server: unhandled exception in event loop" << std::endl;
+                }
+            }
+            stopping_.store(true, std::memory_order_release);
+            for (auto& loop : loops_) loop->wake();
+        }
+
+    public:
+        TCPServer(TCPServerOptions options, TCPServerCallbacks callbacks)
+            : options_(std::move(options)), callbacks_(std::move(callbacks)) {}
+
+        ~TCPServer() {
+            stop();
+        }
+
+        TCPServer(const TCPServer&) = delete;
+        TCPServer& operator=(const TCPServer&) = delete;
+
+        // 在调用线程上创建所有监听套接字(绑定失败时在这里抛出)，然后启动事件循环线程
+        void start() {
+            if (!loops_.empty()) throw std::logic_error("TCPServer already started");
+            const std::size_t count = std::max<std::size_t>(1, options_.threads);
+            if (count > 1 && !options_.reuse_port) {
+                throw std::invalid_argument("TCPServer: multiple threads require reuse_port");
+            }
+            std::uint16_t port = options_.port;
+            for (std::size_t i = 0; i < count; ++i) {
+                loops_.push_back(std::make_unique<EventLoop>(*this, port, i));
+                // 端口0时由第一个监听套接字确定端口，其余的绑定到同一端口
+                if (i == 0) port = loops_.front()->local_port();
+            }
+            port_ = port;
+            for (auto& loop : loops_) threads_.emplace_back([&loop = *loop] { loop.run(); });
+        }
+
+        // 事件循环是否在运行；stop()之后，或者事件循环因为未捕获的异常停止之后为false
+        bool running() const noexcept {
+            return !loops_.empty() && !stopping_.load(std::memory_order_acquire);
+        }
+
+        // 停止所有事件循环，关闭剩余连接并等待线程退出
+        void stop() {
+            stopping_.store(true, std::memory_order_release);
+            for (auto& loop : loops_) loop->wake();
+            for (auto& thread : threads_) {
+                if (thread.joinable()) thread.join();
+            }
+        }
+
+        std::uint16_t port() const noexcept {
+            return port_;
+        }
+
+        std::size_t threads() const noexcept {
+            return loops_.size();
+        }
+
+        // 当前打开的连接数
+        std::size_t connections() const noexcept {
+            return active_.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t total_accepted() const noexcept {
+            return accepted_.load(std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_TCP_SERVER_H
@@ -0,0 +1,340 @@
+#ifndef CPP_LEARNING_DEMO_URL_PARSER_H
+#define CPP_LEARNING_DEMO_URL_PARSER_H
+
+// 零分配的URL解析器
+//
+// URLView::parse把"scheme://userinfo@host:port/path?query#fragment"切分成指向原字符串的std::string_view，
+// 不复制也不分配内存：
+// - 分隔符用SIMD查找：x86-64上每次比较16字节(SSE2，所有x86-64处理器都支持，不需要额外的编译选项)，
+//   其他平台退回逐字节查找；同一遍还检查控制字符和空白
+// - 百分号解码、查询参数查找和规范化都是惰性的，只在调用时进行，结果写到调用方提供的缓冲区
+//
+// 只接受带scheme的绝对URL；相对引用和非法端口返回std::nullopt。
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace network_demo {
+    namespace url_detail {
+#if defined(__SSE2__)
+        // 16字节中等于任一分隔符的位置的掩码
+        template<char... Delimiters>
+        inline unsigned match_block(__m128i block) noexcept {
+            __m128i hits = _mm_setzero_si128();
+            ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(Delimiters)))), ...);
+            return static_cast<unsigned>(_mm_movemask_epi8(hits));
+        }
+#endif
+
+        // text[from, size)中第一个属于Delimiters的字符的位置，没有时返回size。
+        // 不足16字节的结尾部分(而且整个text至少16字节时)重新加载最后16字节、屏蔽已经查过的位置，
+        // 不退回逐字节循环：长度不固定的尾部循环会带来难以预测的分支
+        template<char... Delimiters>
+        inline std::size_t find_any(std::string_view text, std::size_t from) noexcept {
+            const char* data = text.data();
+            const std::size_t size = text.size();
+            std::size_t i = from;
+#if defined(__SSE2__)
+            for (; i + 16 <= size; i += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                unsigned mask = match_block<Delimiters...>(block);
+                if (mask != 0) return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+            if (i < size && size >= 16) {
+                const std::size_t last = size - 16;
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + last));
+                unsigned mask = match_block<Delimiters...>(block) >> (i - last);
+                return mask != 0 ? i + static_cast<std::size_t>(std::countr_zero(mask)) : size;
+            }
+#endif
+            for (; i < size; ++i) {
+                if (((data[i] == Delimiters) || ...)) return i;
+            }
+            return size;
+        }
+
+        // 是否含有控制字符、空格或DEL(这些字符在URL中必须经过百分号编码)
+        inline bool has_invalid_byte(std::string_view text) noexcept {
+            const char* data = text.data();
+            const std::size_t size = text.size();
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            auto invalid = [](__m128i block) {
+                // 无符号比较x <= 0x20：min(x, 0x20) == x
+                __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(block, _mm_set1_epi8(0x20)), block);
+                return _mm_movemask_epi8(_mm_or_si128(low, _mm_cmpeq_epi8(block, _mm_set1_epi8(0x7f)))) != 0;
+            };
+            if (size >= 16) {
+                for (; i + 16 <= size; i += 16) {
+                    if (invalid(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)))) return true;
+                }
+                // 最后16字节与已检查的部分重叠，重复检查不影响结果
+                return i < size && invalid(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + size - 16)));
+            }
+#endif
+            for (; i < size; ++i) {
+                unsigned char c = static_cast<unsigned char>(data[i]);
+                if (c <= 0x20 || c == 0x7f) return true;
+            }
+            return false;
+        }
+
+        inline char to_lower(char c) noexcept {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        inline bool iequals(std::string_view a, std::string_view b) noexcept {
+            if (a.size() != b.size()) return false;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (to_lower(a[i]) != to_lower(b[i])) return false;
+            }
+            return true;
+        }
+
+        inline int hex_value(char c) noexcept {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        // RFC 3986的非保留字符：它们的百分号编码形式与字符本身等价
+        inline bool is_unreserved(char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' ||
+                   c == '.' || c == '_' || c == '~';
+        }
+
+        inline bool is_scheme_char(char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '+' ||
+                   c == '-' || c == '.';
+        }
+    }
+
+    // 把in中的%XX解码后写到out(至少in.size()字节)，返回写入的长度；不完整或非法的转义原样保留。
+    // plus_as_space用于application/x-www-form-urlencoded格式的查询参数
+    inline std::size_t percent_decode(std::string_view in, char* out, bool plus_as_space = false) noexcept {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            char c = in[i];
+            if (c == '%' && i + 2 < in.size() && url_detail::hex_value(in[i + 1]) >= 0 &&
+                url_detail::hex_value(in[i + 2]) >= 0) {
+                out[n++] = static_cast<char>(url_detail::hex_value(in[i + 1]) * 16 + url_detail::hex_value(in[i + 2]));
+                i += 2;
+            } else {
+                out[n++] = plus_as_space && c == '+' ? ' ' : c;
+            }
+        }
+        return n;
+    }
+
+    // 所有字段都指向传给parse()的字符串，不包含分隔符；不存在的部分为空
+    struct URLView {
+        std::string_view scheme;
+        std::string_view userinfo;
+        // IPv6地址保留方括号，例如"[::1]"
+        std::string_view host;
+        std::string_view port_text;
+        std::string_view path;
+        std::string_view query;
+        std::string_view fragment;
+        // 显式给出的端口，没有时为0
+        std::uint16_t port = 0;
+        bool has_authority = false;
+
+        static std::optional<URLView> parse(std::string_view text) noexcept {
+            using namespace url_detail;
+            if (text.empty() || has_invalid_byte(text)) return std::nullopt;
+
+            URLView url;
+            // scheme = ALPHA *(ALPHA / DIGIT / "+" / "-" / ".")
+            std::size_t colon = find_any<':', '/', '?', '#'>(text, 0);
+            if (colon == 0 || colon == text.size() || text[colon] != ':') return std::nullopt;
+            char first = text[0];
+            if (!((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z'))) return std::nullopt;
+            for (std::size_t i = 1; i < colon; ++i) {
+                if (!is_scheme_char(text[i])) return std::nullopt;
+            }
+            url.scheme = text.substr(0, colon);
+            std::size_t pos = colon + 1;
+
+            if (text.size() - pos >= 2 && text[pos] == '/' && text[pos + 1] == '/') {
+                url.has_authority = true;
+                pos += 2;
+                const std::size_t end = find_any<'/', '?', '#'>(text, pos);
+                // 在authority范围内查找：截断text而不是取子串，结尾的重叠加载仍然可以读到authority之前的字节
+                const std::string_view head = text.substr(0, end);
+                std::size_t host = pos;
+                for (std::size_t at = find_any<'@'>(head, pos); at != end; at = find_any<'@'>(head, at + 1)) {
+                    host = at + 1;
+                }
+                if (host != pos) url.userinfo = text.substr(pos, host - 1 - pos);
+
+                std::size_t port_colon = end;
+                if (host < end && text[host] == '[') {
+                    std::size_t close = find_any<']'>(head, host);
+                    if (close == end) return std::nullopt;
+                    if (close + 1 < end) {
+                        if (text[close + 1] != ':') return std::nullopt;
+                        port_colon = close + 1;
+                    }
+                } else {
+                    port_colon = find_any<':'>(head, host);
+                }
+                url.host = text.substr(host, port_colon - host);
+                if (port_colon != end) {
+                    url.port_text = text.substr(port_colon + 1, end - port_colon - 1);
+                    if (url.port_text.size() > 5) return std::nullopt;
+                    std::uint32_t port = 0;
+                    for (char c : url.port_text) {
+                        if (c < '0' || c > '9') return std::nullopt;
+                        port = port * 10 + static_cast<std::uint32_t>(c - '0');
+                    }
+                    if (port > 65535) return std::nullopt;
+                    url.port = static_cast<std::uint16_t>(port);
+                }
+                pos = end;
+            }
+
+            const std::size_t path_end = find_any<'?', '#'>(text, pos);
+            url.path = text.substr(pos, path_end - pos);
+            pos = path_end;
+            if (pos < text.size() && text[pos] == '?') {
+                const std::size_t query_end = find_any<'#'>(text, pos + 1);
+                url.query = text.substr(pos + 1, query_end - pos - 1);
+                pos = query_end;
+            }
+            if (pos < text.size()) url.fragment = text.substr(pos + 1);
+            return url;
+        }
+
+        // 显式端口，或者常见scheme的默认端口；未知scheme且没有端口时为0
+        std::uint16_t effective_port() const noexcept {
+            if (!port_text.empty()) return port;
+            return default_port(scheme);
+        }
+
+        static std::uint16_t default_port(std::string_view scheme) noexcept {
+            using url_detail::iequals;
+            if (iequals(scheme, "http") || iequals(scheme, "ws")) return 80;
+            if (iequals(scheme, "https") || iequals(scheme, "wss")) return 443;
+            if (iequals(scheme, "ftp")) return 21;
+            return 0;
+        }
+
+        // 路径的百分号解码结果：没有'%'时直接返回path，否则解码到buffer(至少path.size()字节)
+        std::string_view decoded_path(char* buffer) const noexcept {
+            if (std::memchr(path.data(), '%', path.size()) == nullptr) return path;
+            return {buffer, percent_decode(path, buffer)};
+        }
+
+        // 查询参数key的原始(未解码)值；key不存在时返回nullopt，"?flag"这样没有'='的参数返回空值
+        std::optional<std::string_view> query_param(std::string_view key) const noexcept {
+            for (std::size_t start = 0; start < query.size();) {
+                const std::size_t amp = url_detail::find_any<'&'>(query, start);
+                std::string_view pair = query.substr(start, amp - start);
+                std::size_t eq = pair.find('=');
+                if (pair.substr(0, eq) == key) {
+                    return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+                }
+                start = amp + 1;
+            }
+            return std::nullopt;
+        }
+
+        // 规范化形式的长度上限，normalize()的缓冲区至少要这么大
+        std::size_t normalized_size_bound() const noexcept {
+            return scheme.size() + userinfo.size() + host.size() + port_text.size() + path.size() + query.size() +
+                   fragment.size() + 8;
+        }
+
+        // RFC 3986第6.2.2节的语法规范化，写到buffer并返回长度：
+        // scheme和host转小写、去掉默认端口、百分号转义的十六进制大写、非保留字符解码、
+        // 移除路径中的"."和".."段、有authority时空路径写成"/"
+        std::size_t normalize(char* buffer) const noexcept {
+            char* out = buffer;
+            auto put = [&out](std::string_view s) {
+                std::memcpy(out, s.data(), s.size());
+                out += s.size();
+            };
+            // 百分号编码规范化：非保留字符解码，其余转义的十六进制转大写
+            auto put_normalized = [&out](std::string_view s) {
+                for (std::size_t i = 0; i < s.size(); ++i) {
+                    if (s[i] == '%' && i + 2 < s.size() && url_detail::hex_value(s[i + 1]) >= 0 &&
+                        url_detail::hex_value(s[i + 2]) >= 0) {
+                        char decoded = static_cast<char>(url_detail::hex_value(s[i + 1]) * 16 +
+                                                         url_detail::hex_value(s[i + 2]));
+                        if (url_detail::is_unreserved(decoded)) {
+                            *out++ = decoded;
+                        } else {
+                            *out++ = '%';
+                            *out++ = static_cast<char>(s[i + 1] >= 'a' ? s[i + 1] - 'a' + 'A' : s[i + 1]);
+                            *out++ = static_cast<char>(s[i + 2] >= 'a' ? s[i + 2] - 'a' + 'A' : s[i + 2]);
+                        }
+                        i += 2;
+                    } else {
+                        *out++ = s[i];
+                    }
+                }
+            };
+
+            for (char c : scheme) *out++ = url_detail::to_lower(c);
+            *out++ = ':';
+            if (has_authority) {
+                put("//");
+                if (!userinfo.empty()) {
+                    put_normalized(userinfo);
+                    *out++ = '@';
+                }
+                for (char c : host) *out++ = url_detail::to_lower(c);
+                if (!port_text.empty() && port != default_port(scheme)) {
+                    *out++ = ':';
+                    put(port_text);
+                }
+            }
+
+            // 逐段写出，写完一段后检查它是否是"."或".."
+            const char* path_start = out;
+            if (has_authority && path.empty()) *out++ = '/';
+            std::string_view rest = path;
+            while (!rest.empty()) {
+                std::size_t slash = rest.find('/', 1);
+                std::string_view segment = rest.substr(0, slash);
+                rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash);
+                const bool leading_slash = segment[0] == '/';
+                char* segment_start = out;
+                if (leading_slash) *out++ = '/';
+                char* name = out;
+                put_normalized(leading_slash ? segment.substr(1) : segment);
+                std::string_view written(name, static_cast<std::size_t>(out - name));
+                if (written == "." || written == "..") {
+                    out = segment_start;
+                    if (written == "..") {
+                        // 同时去掉上一段"/name"
+                        while (out > path_start && *(out - 1) != '/') --out;
+                        if (out > path_start) --out;
+                    }
+                    // 以点段结尾的路径保留末尾的'/'
+                    if (rest.empty() && leading_slash) *out++ = '/';
+                }
+            }
+            if (!query.empty()) {
+                *out++ = '?';
+                put_normalized(query);
+            }
+            if (!fragment.empty()) {
+                *out++ = '#';
+                put_normalized(fragment);
+            }
+            return static_cast<std::size_t>(out - buffer);
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_URL_PARSER_H
@@ -0,0 +1,235 @@
+#ifndef CPP_LEARNING_DEMO_ALLOCATION_HOOKS_H
+#define CPP_LEARNING_DEMO_ALLOCATION_HOOKS_H
+
+#include <cstdlib>
+#include <new>
+#include "allocation_tracker.h"
+
+// 分配钩子：替换全局operator new/delete，在glibc上同时替换malloc/calloc/realloc/free
+//
+// 这里定义的是非inline的全局函数，一个程序只能有一个编译单元包含本头文件
+// (演示程序在main.cpp，基准测试程序在benchmark_main.cpp)。
+//
+// - glibc：malloc系列转发给__libc_malloc等内部入口并计数，C代码和标准库内部的分配也能统计到；
+//   operator new直接调用malloc，不会重复计数
+// - 其他POSIX平台(macOS等)：无法静态替换malloc，只统计operator new/delete
+// - 地址消毒器(ASan)会拦截同一组函数，此时不安装钩子
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer) || __has_feature(thread_sanitizer)
+#define CPP_LEARNING_ALLOCATION_HOOKS_SANITIZED 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define CPP_LEARNING_ALLOCATION_HOOKS_SANITIZED 1
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(CPP_LEARNING_ALLOCATION_HOOKS_SANITIZED)
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#if defined(__GLIBC__)
+#define CPP_LEARNING_ALLOCATION_MALLOC_HOOKS 1
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t count, std::size_t size);
+    void* __libc_realloc(void* ptr, std::size_t size);
+    void* __libc_memalign(std::size_t alignment, std::size_t size);
+    void __libc_free(void* ptr);
+}
+#endif
+
+namespace performance_benchmarking_demo::allocation_detail {
+    // 分配器实际给出的块大小，用于在释放时扣减持有字节数
+    inline std::size_t usable_size(void* ptr) {
+#if defined(__APPLE__)
+        return malloc_size(ptr);
+#else
+        return malloc_usable_size(ptr);
+#endif
+    }
+
+    inline void* tracked_malloc(std::size_t size) {
+#if defined(CPP_LEARNING_ALLOCATION_MALLOC_HOOKS)
+        return std::malloc(size);
+#else
+        void* ptr = std::malloc(size);
+        if (ptr) record_allocation(size, usable_size(ptr));
+        return ptr;
+#endif
+    }
+
+    inline void* tracked_aligned_alloc(std::size_t size, std::size_t alignment) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, std::max(alignment, sizeof(void*)), size) != 0) return nullptr;
+#if !defined(CPP_LEARNING_ALLOCATION_MALLOC_HOOKS)
+        record_allocation(size, usable_size(ptr));
+#endif
+        return ptr;
+    }
+
+    inline void tracked_free(void* ptr) {
+#if !defined(CPP_LEARNING_ALLOCATION_MALLOC_HOOKS)
+        if (ptr) record_deallocation(usable_size(ptr));
+#endif
+        std::free(ptr);
+    }
+
+    // 按operator new的约定：失败时调用new_handler，没有handler时抛出std::bad_alloc
+    template<typename Allocate>
+    void* new_or_throw(Allocate allocate) {
+        for (;;) {
+            if (void* ptr = allocate()) return ptr;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    [[maybe_unused]] const bool hooks_registered = (hooks_installed = true);
+}
+
+#if defined(CPP_LEARNING_ALLOCATION_MALLOC_HOOKS)
+extern "C" {
+    void* malloc(std::size_t size) noexcept {
+        void* ptr = __libc_malloc(size);
+        if (ptr) performance_benchmarking_demo::allocation_detail::record_allocation(size, malloc_usable_size(ptr));
+        return ptr;
+    }
+
+    void* calloc(std::size_t count, std::size_t size) noexcept {
+        void* ptr = __libc_calloc(count, size);
+        if (ptr) {
+            performance_benchmarking_demo::allocation_detail::record_allocation(count * size, malloc_usable_size(ptr));
+        }
+        return ptr;
+    }
+
+    // realloc按一次释放加一次分配计数
+    void* realloc(void* old_ptr, std::size_t size) noexcept {
+        std::size_t old_size = old_ptr ? malloc_usable_size(old_ptr) : 0;
+        void* ptr = __libc_realloc(old_ptr, size);
+        if (old_ptr && (ptr || size == 0)) {
+            performance_benchmarking_demo::allocation_detail::record_deallocation(old_size);
+        }
+        if (ptr) performance_benchmarking_demo::allocation_detail::record_allocation(size, malloc_usable_size(ptr));
+        return ptr;
+    }
+
+    void free(void* ptr) noexcept {
+        if (ptr) performance_benchmarking_demo::allocation_detail::record_deallocation(malloc_usable_size(ptr));
+        __libc_free(ptr);
+    }
+
+    int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept {
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return 22;  // EINVAL
+        void* ptr = __libc_memalign(alignment, size);
+        if (!ptr) return 12;  // ENOMEM
+        performance_benchmarking_demo::allocation_detail::record_allocation(size, malloc_usable_size(ptr));
+        *result = ptr;
+        return 0;
+    }
+
+    void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+        void* ptr = __libc_memalign(alignment, size);
+        if (ptr) performance_benchmarking_demo::allocation_detail::record_allocation(size, malloc_usable_size(ptr));
+        return ptr;
+    }
+
+    void* memalign(std::size_t alignment, std::size_t size) noexcept {
+        return aligned_alloc(alignment, size);
+    }
+}
+#endif
+
+void* operator new(std::size_t size) {
+    using namespace performance_benchmarking_demo::allocation_detail;
+    return new_or_throw([size] { return tracked_malloc(size ? size : 1); });
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return performance_benchmarking_demo::allocation_detail::tracked_malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return performance_benchmarking_demo::allocation_detail::tracked_malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    using namespace performance_benchmarking_demo::allocation_detail;
+    return new_or_throw([=] { return tracked_aligned_alloc(size ? size : 1, static_cast<std::size_t>(alignment)); });
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return performance_benchmarking_demo::allocation_detail::tracked_aligned_alloc(
+        size ? size : 1, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return performance_benchmarking_demo::allocation_detail::tracked_aligned_alloc(
+        size ? size : 1, static_cast<std::size_t>(alignment));
+}
+
+// 所有delete形式都归结为tracked_free：释放的字节数取分配器记录的块大小，不依赖sized delete的参数
+void operator delete(void* ptr) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    performance_benchmarking_demo::allocation_detail::tracked_free(ptr);
+}
+
+#endif
+
+#endif //CPP_LEARNING_DEMO_ALLOCATION_HOOKS_H
@@ -0,0 +1,136 @@
+#ifndef CPP_LEARNING_DEMO_ALLOCATION_TRACKER_H
+#define CPP_LEARNING_DEMO_ALLOCATION_TRACKER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+// 分配统计
+//
+// 计数由allocation_hooks.h中替换的operator new/delete和malloc系列函数写入。
+// 每个线程只修改自己的thread_local计数器(普通整数，没有原子操作和共享缓存行)，
+// 统计本身不会在并发基准测试中引入争用。没有包含allocation_hooks.h的程序里
+// allocation_tracking_available()为false，所有计数保持为0。
+namespace performance_benchmarking_demo {
+    // 一个线程的累计计数
+    struct AllocationCounters {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        // 申请的字节数
+        std::uint64_t bytes_allocated = 0;
+        // 当前仍被持有的字节数(按分配器实际给出的块大小)；跨线程释放时可能为负
+        std::int64_t live_bytes = 0;
+        std::int64_t peak_live_bytes = 0;
+    };
+
+    // 一段代码内的分配情况
+    struct AllocationDelta {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t bytes_allocated = 0;
+        // 相对于开始时的最大持有字节数
+        std::int64_t peak_live_bytes = 0;
+
+        AllocationDelta& operator+=(const AllocationDelta& other) {
+            allocations += other.allocations;
+            deallocations += other.deallocations;
+            bytes_allocated += other.bytes_allocated;
+            peak_live_bytes = std::max(peak_live_bytes, other.peak_live_bytes);
+            return *this;
+        }
+    };
+
+    namespace allocation_detail {
+        // 常量初始化的thread_local：访问时不需要初始化守卫，也不会反过来调用malloc
+        inline thread_local constinit AllocationCounters thread_counters{};
+        inline bool hooks_installed = false;
+
+        inline void record_allocation(std::size_t requested, std::size_t usable) {
+            AllocationCounters& c = thread_counters;
+            ++c.allocations;
+            c.bytes_allocated += requested;
+            c.live_bytes += static_cast<std::int64_t>(usable);
+            if (c.live_bytes > c.peak_live_bytes) c.peak_live_bytes = c.live_bytes;
+        }
+
+        inline void record_deallocation(std::size_t usable) {
+            AllocationCounters& c = thread_counters;
+            ++c.deallocations;
+            c.live_bytes -= static_cast<std::int64_t>(usable);
+        }
+    }
+
+    // 当前程序是否安装了分配钩子(链接了包含allocation_hooks.h的编译单元)
+    inline bool allocation_tracking_available() {
+        return allocation_detail::hooks_installed;
+    }
+
+    // 当前线程的累计计数
+    inline AllocationCounters thread_allocation_counters() {
+        return allocation_detail::thread_counters;
+    }
+
+    // 统计当前线程在begin()和end()之间的分配；可以嵌套
+    class AllocationScope {
+    private:
+        AllocationCounters start_;
+        std::int64_t saved_peak_ = 0;
+
+    public:
+        void begin() {
+            AllocationCounters& c = allocation_detail::thread_counters;
+            start_ = c;
+            saved_peak_ = c.peak_live_bytes;
+            // 峰值从当前持有量重新开始记录，结束时再与外层的峰值合并
+            c.peak_live_bytes = c.live_bytes;
+        }
+
+        AllocationDelta end() {
+            AllocationCounters& c = allocation_detail::thread_counters;
+            AllocationDelta delta;
+            delta.allocations = c.allocations - start_.allocations;
+            delta.deallocations = c.deallocations - start_.deallocations;
+            delta.bytes_allocated = c.bytes_allocated - start_.bytes_allocated;
+            delta.peak_live_bytes = std::max<std::int64_t>(0, c.peak_live_bytes - start_.live_bytes);
+            c.peak_live_bytes = std::max(saved_peak_, c.peak_live_bytes);
+            return delta;
+        }
+    };
+
+    // 基准测试结果中的分配统计，次数和字节数为每次迭代的平均值
+    struct AllocationStats {
+        bool valid = false;
+        double allocations = 0.0;
+        double deallocations = 0.0;
+        double bytes = 0.0;
+        // 单个样本内的最大持有字节数
+        std::int64_t peak_live_bytes = 0;
+
+        static AllocationStats from_delta(const AllocationDelta& delta, double iterations) {
+            AllocationStats stats;
+            stats.valid = true;
+            if (iterations > 0) {
+                stats.allocations = static_cast<double>(delta.allocations) / iterations;
+                stats.deallocations = static_cast<double>(delta.deallocations) / iterations;
+                stats.bytes = static_cast<double>(delta.bytes_allocated) / iterations;
+            }
+            stats.peak_live_bytes = delta.peak_live_bytes;
+            return stats;
+        }
+    };
+
+    inline void print_allocations(std::ostream& os, const AllocationStats& stats) {
+        if (!stats.valid) return;
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::fixed << std::setprecision(2) << "  allocs " << stats.allocations << "/iter"
+           << std::setprecision(1) << "  bytes " << stats.bytes << "/iter"
+           << "  peak live " << stats.peak_live_bytes << " B";
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_ALLOCATION_TRACKER_H
@@ -0,0 +1,78 @@
+// 基准测试结果比较工具
+//
+// 用法: bench_compare <baseline.json> <current.json> [--threshold 0.05] [--alpha 0.01]
+// 退出码: 0 没有回归, 1 存在显著回归, 2 参数或文件错误
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "benchmark_report.h"
+
+using namespace performance_benchmarking_demo;
+
+namespace {
+    int usage(const char* program) {
+        std::cerr << "usage: " << program << " <baseline.json> <current.json> [--threshold R] [--alpha P]" << std::endl;
+        return 2;
+    }
+
+    // 整个参数必须是一个有限的数字("0.05x"、空串和溢出都不接受)
+    bool parse_number(const char* text, double& value) {
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtod(text, &end);
+        return end != text && *end == '\0' && errno == 0 && std::isfinite(value);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) return usage(argv[0]);
+
+    RegressionOptions options;
+    for (int i = 3; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag != "--threshold" && flag != "--alpha") {
+            std::cerr << "unknown option: " << flag << std::endl;
+            return usage(argv[0]);
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << flag << std::endl;
+            return usage(argv[0]);
+        }
+        double value = 0.0;
+        if (!parse_number(argv[i + 1], value)) {
+            std::cerr << "invalid value for " << flag << ": " << argv[i + 1] << std::endl;
+            return usage(argv[0]);
+        }
+        if (flag == "--threshold") {
+            if (value < 0.0) {
+                std::cerr << "--threshold must not be negative" << std::endl;
+                return usage(argv[0]);
+            }
+            options.threshold = value;
+        } else {
+            if (value <= 0.0 || value > 1.0) {
+                std::cerr << "--alpha must be in (0, 1]" << std::endl;
+                return usage(argv[0]);
+            }
+            options.alpha = value;
+        }
+    }
+
+    try {
+        BenchmarkReport baseline = BenchmarkReport::load(argv[1]);
+        BenchmarkReport current = BenchmarkReport::load(argv[2]);
+        if (baseline.metadata().cpu_model != current.metadata().cpu_model ||
+            baseline.metadata().compiler != current.metadata().compiler) {
+            std::cerr << "warning: baseline was recorded with a different CPU or compiler ("
+                      << baseline.metadata().cpu_model << ", " << baseline.metadata().compiler << ")" << std::endl;
+        }
+        std::cout << "baseline " << baseline.metadata().git_sha << " (" << baseline.metadata().timestamp << ")"
+                  << " vs current " << current.metadata().git_sha << " (" << current.metadata().timestamp << ")\n";
+        return print_comparison(std::cout, compare_reports(baseline, current, options));
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 2;
+    }
+}
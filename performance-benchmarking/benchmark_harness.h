@@ -0,0 +1,573 @@
+#ifndef CPP_LEARNING_DEMO_BENCHMARK_HARNESS_H
+#define CPP_LEARNING_DEMO_BENCHMARK_HARNESS_H
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "allocation_tracker.h"
+#include "perf_counters.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace performance_benchmarking_demo {
+    // 阻止编译器把被测代码当作无用代码删除
+    // value被视为会被读取(并且可能被修改)，计算它的代码必须保留
+    template<typename T>
+    inline void do_not_optimize(T&& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        using Value = std::remove_reference_t<T>;
+        // 可修改的小对象放进寄存器并声明被改写，后续代码不能再依赖它原来的值
+        if constexpr (!std::is_const_v<Value> && std::is_trivially_copyable_v<Value> && sizeof(Value) <= sizeof(void*)) {
+            asm volatile("" : "+r"(value) : : "memory");
+        } else {
+            asm volatile("" : : "r,m"(value) : "memory");
+        }
+#else
+        static volatile const void* sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#endif
+    }
+
+    // 编译器层面的内存屏障：之前的写入必须真正落到内存，之后的读取不能复用寄存器中的旧值
+    inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        _ReadWriteBarrier();
+#endif
+    }
+
+    // 一次基准测试的统计结果，时间单位均为每次迭代的纳秒数
+    struct BenchmarkStats {
+        std::string name;
+        size_t samples = 0;
+        std::uint64_t iterations_per_sample = 0;
+        double min_ns = 0.0;
+        double max_ns = 0.0;
+        double mean_ns = 0.0;
+        double median_ns = 0.0;
+        double p90_ns = 0.0;
+        double p99_ns = 0.0;
+        double stddev_ns = 0.0;
+        // 均值的置信区间(默认95%)
+        double ci_low_ns = 0.0;
+        double ci_high_ns = 0.0;
+        // 按Tukey规则(超出四分位距1.5倍)判定的离群样本数
+        size_t outliers_low = 0;
+        size_t outliers_high = 0;
+        std::vector<double> sample_ns;
+        // 每次迭代的硬件计数器平均值，未开启或不可用时valid()为false
+        PerfCounterValues counters;
+        // 每次迭代的分配次数和字节数，未安装分配钩子时valid为false
+        AllocationStats allocations;
+
+        // 变异系数，超过几个百分点说明测量噪声较大
+        double cv() const {
+            return mean_ns > 0 ? stddev_ns / mean_ns : 0.0;
+        }
+    };
+
+    // 多线程基准测试的结果
+    struct ThreadedBenchmarkStats {
+        // 每个样本为 墙钟时间 / (迭代次数 * 线程数)，即整个线程组每完成一次操作的平均耗时
+        BenchmarkStats aggregate;
+        // 每个线程自己的每次迭代耗时
+        std::vector<BenchmarkStats> per_thread;
+        size_t threads = 0;
+
+        // 线程组的总吞吐量(次/秒)，按中位数计算
+        double ops_per_second() const {
+            return aggregate.median_ns > 0 ? 1e9 / aggregate.median_ns : 0.0;
+        }
+    };
+
+    struct BenchmarkOptions {
+        // 每个样本至少运行的时长，迭代次数据此自动校准
+        std::chrono::nanoseconds min_sample_time = std::chrono::milliseconds(5);
+        // 样本个数
+        size_t samples = 20;
+        // 正式采样前的预热时长
+        std::chrono::nanoseconds warmup_time = std::chrono::milliseconds(20);
+        // 每个样本的迭代次数上限
+        std::uint64_t max_iterations_per_sample = 1000000000ULL;
+        // 置信水平(0.90/0.95/0.99)
+        double confidence = 0.95;
+        // 采样时同时读取硬件性能计数器(仅Linux，不可用时自动忽略)
+        bool perf_counters = false;
+        // 统计采样期间的内存分配(程序需包含allocation_hooks.h，否则忽略)
+        bool track_allocations = true;
+    };
+
+    namespace harness_detail {
+        using Clock = std::chrono::steady_clock;
+
+        inline double elapsed_ns(Clock::time_point begin, Clock::time_point end) {
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        }
+
+        // 已排序数据的线性插值分位数
+        inline double percentile(const std::vector<double>& sorted, double p) {
+            if (sorted.empty()) return 0.0;
+            double rank = p * (sorted.size() - 1);
+            size_t lower = static_cast<size_t>(rank);
+            size_t upper = std::min(lower + 1, sorted.size() - 1);
+            double fraction = rank - lower;
+            return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+        }
+
+        // 标准正态分布的双侧临界值
+        inline double normal_critical(double confidence) {
+            if (confidence >= 0.99) return 2.576;
+            if (confidence >= 0.95) return 1.960;
+            return 1.645;
+        }
+
+        // Student t分布的双侧临界值：小样本查表，大样本用Cornish-Fisher展开逼近
+        inline double t_critical(double confidence, size_t degrees_of_freedom) {
+            static const double t95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086};
+            if (degrees_of_freedom == 0) return 0.0;
+            if (confidence >= 0.95 && confidence < 0.99 && degrees_of_freedom <= 20) {
+                return t95[degrees_of_freedom - 1];
+            }
+            double z = normal_critical(confidence);
+            double v = static_cast<double>(degrees_of_freedom);
+            return z + (z * z * z + z) / (4 * v) + (5 * std::pow(z, 5) + 16 * z * z * z + 3 * z) / (96 * v * v);
+        }
+
+        // 只在正式采样时读取计数器和统计分配；预热和校准时两者都关闭
+        struct CounterSampler {
+            PerfCounterGroup* group = nullptr;
+            PerfCounterValues total;
+            bool allocations = false;
+            AllocationScope allocation_scope;
+            AllocationDelta allocation_total;
+
+            void begin() {
+                if (allocations) allocation_scope.begin();
+                if (group) group->start();
+            }
+
+            void end() {
+                if (group) total += group->stop();
+                if (allocations) allocation_total += allocation_scope.end();
+            }
+        };
+
+        // 读取一次时钟本身的开销，逐次计时时从结果中扣除
+        inline double clock_overhead_ns() {
+            static const double overhead = [] {
+                double best = 1e9;
+                for (int i = 0; i < 1000; ++i) {
+                    auto a = Clock::now();
+                    auto b = Clock::now();
+                    best = std::min(best, elapsed_ns(a, b));
+                }
+                return best;
+            }();
+            return overhead;
+        }
+
+        template<typename Body>
+        inline void invoke_thread_body(Body& body, size_t thread_index) {
+            if constexpr (std::is_void_v<std::invoke_result_t<Body&, size_t>>) {
+                body(thread_index);
+                clobber_memory();
+            } else {
+                do_not_optimize(body(thread_index));
+            }
+        }
+
+        // 常驻的一组线程：每个批次通过起跑屏障同时开始，各自计时，结束屏障后由主线程汇总
+        // 线程在整个测试期间复用，线程创建开销不计入结果
+        template<typename Body>
+        class ThreadTeam {
+        private:
+            Body& body_;
+            const size_t size_;
+            std::barrier<> start_;
+            std::barrier<> done_;
+            std::uint64_t iterations_ = 0;
+            bool quit_ = false;
+            bool track_allocations_ = false;
+            std::vector<Clock::time_point> begin_;
+            std::vector<Clock::time_point> end_;
+            std::vector<AllocationDelta> allocations_;
+            std::vector<std::thread> threads_;
+
+            void loop(size_t index) {
+                for (;;) {
+                    start_.arrive_and_wait();
+                    if (quit_) return;
+                    // 每个线程只读写自己的thread_local计数，统计不引入线程间共享
+                    AllocationScope scope;
+                    if (track_allocations_) scope.begin();
+                    auto begin = Clock::now();
+                    for (std::uint64_t i = 0; i < iterations_; ++i) {
+                        invoke_thread_body(body_, index);
+                    }
+                    auto end = Clock::now();
+                    begin_[index] = begin;
+                    end_[index] = end;
+                    allocations_[index] = track_allocations_ ? scope.end() : AllocationDelta{};
+                    done_.arrive_and_wait();
+                }
+            }
+
+        public:
+            ThreadTeam(size_t threads, Body& body)
+                : body_(body), size_(threads), start_(static_cast<std::ptrdiff_t>(threads + 1)),
+                  done_(static_cast<std::ptrdiff_t>(threads + 1)), begin_(threads), end_(threads),
+                  allocations_(threads) {
+                threads_.reserve(threads);
+                for (size_t i = 0; i < threads; ++i) {
+                    threads_.emplace_back([this, i] { loop(i); });
+                }
+            }
+
+            ~ThreadTeam() {
+                quit_ = true;
+                start_.arrive_and_wait();
+                for (auto& t : threads_) t.join();
+            }
+
+            ThreadTeam(const ThreadTeam&) = delete;
+            ThreadTeam& operator=(const ThreadTeam&) = delete;
+
+            // 所有线程各执行iterations次，返回从最早开始到最晚结束的墙钟纳秒数
+            double run(std::uint64_t iterations, bool track_allocations = false) {
+                iterations_ = iterations;
+                track_allocations_ = track_allocations;
+                start_.arrive_and_wait();
+                done_.arrive_and_wait();
+                auto first = *std::min_element(begin_.begin(), begin_.end());
+                auto last = *std::max_element(end_.begin(), end_.end());
+                return elapsed_ns(first, last);
+            }
+
+            double thread_elapsed_ns(size_t index) const {
+                return elapsed_ns(begin_[index], end_[index]);
+            }
+
+            // 上一批次中该线程的分配情况(run时track_allocations为true才有数据)
+            const AllocationDelta& thread_allocations(size_t index) const {
+                return allocations_[index];
+            }
+
+            size_t size() const {
+                return size_;
+            }
+        };
+
+        template<typename T>
+        std::string param_label(const T& value) {
+            std::ostringstream os;
+            os << value;
+            return os.str();
+        }
+    }
+
+    // 参数扫描用的2的幂序列：power_of_two_range(10, 24)得到2^10..2^24
+    inline std::vector<std::size_t> power_of_two_range(unsigned low_exponent, unsigned high_exponent,
+                                                       unsigned step = 1) {
+        std::vector<std::size_t> values;
+        for (unsigned e = low_exponent; e <= high_exponent; e += (step == 0 ? 1 : step)) {
+            values.push_back(std::size_t{1} << e);
+        }
+        return values;
+    }
+
+    // 按类型扫描：f以std::type_identity<T>{}为参数对每个类型调用一次
+    // 例如 for_each_type<int, double>([&](auto tag) { using T = typename decltype(tag)::type; ... });
+    template<typename... Ts, typename F>
+    void for_each_type(F&& f) {
+        (f(std::type_identity<Ts>{}), ...);
+    }
+
+    // 根据样本计算统计量(样本为每次迭代的纳秒数)
+    inline BenchmarkStats compute_stats(const std::string& name, std::vector<double> samples,
+                                        std::uint64_t iterations_per_sample = 1, double confidence = 0.95) {
+        BenchmarkStats stats;
+        stats.name = name;
+        stats.samples = samples.size();
+        stats.iterations_per_sample = iterations_per_sample;
+        stats.sample_ns = samples;
+        if (samples.empty()) return stats;
+
+        std::sort(samples.begin(), samples.end());
+        const double n = static_cast<double>(samples.size());
+        stats.min_ns = samples.front();
+        stats.max_ns = samples.back();
+        stats.mean_ns = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+        stats.median_ns = harness_detail::percentile(samples, 0.5);
+        stats.p90_ns = harness_detail::percentile(samples, 0.9);
+        stats.p99_ns = harness_detail::percentile(samples, 0.99);
+
+        double squares = 0.0;
+        for (double s : samples) squares += (s - stats.mean_ns) * (s - stats.mean_ns);
+        stats.stddev_ns = samples.size() > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+        double margin = samples.size() > 1
+            ? harness_detail::t_critical(confidence, samples.size() - 1) * stats.stddev_ns / std::sqrt(n)
+            : 0.0;
+        stats.ci_low_ns = stats.mean_ns - margin;
+        stats.ci_high_ns = stats.mean_ns + margin;
+
+        double q1 = harness_detail::percentile(samples, 0.25);
+        double q3 = harness_detail::percentile(samples, 0.75);
+        double iqr = q3 - q1;
+        for (double s : samples) {
+            if (s < q1 - 1.5 * iqr) ++stats.outliers_low;
+            if (s > q3 + 1.5 * iqr) ++stats.outliers_high;
+        }
+        return stats;
+    }
+
+    // 基准测试执行器：预热、自动校准迭代次数、多次采样
+    class BenchmarkRunner {
+    private:
+        BenchmarkOptions options_;
+
+        // 运行body共iterations次，返回总纳秒数
+        template<typename Body>
+        static double time_batch(Body& body, std::uint64_t iterations, harness_detail::CounterSampler& counters) {
+            counters.begin();
+            auto begin = harness_detail::Clock::now();
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                if constexpr (std::is_void_v<std::invoke_result_t<Body&>>) {
+                    body();
+                    clobber_memory();
+                } else {
+                    do_not_optimize(body());
+                }
+            }
+            auto end = harness_detail::Clock::now();
+            counters.end();
+            return harness_detail::elapsed_ns(begin, end);
+        }
+
+        // 迭代次数按倍数增长，直到一个批次的时长达到min_sample_time
+        // 同时限制批次的实际耗时(含setup/teardown)，避免被测部分极短而setup很慢时无限放大
+        template<typename BatchFn>
+        std::uint64_t calibrate(BatchFn& batch) const {
+            const double target = static_cast<double>(options_.min_sample_time.count());
+            std::uint64_t iterations = 1;
+            harness_detail::CounterSampler no_counters;
+            for (;;) {
+                auto begin = harness_detail::Clock::now();
+                double elapsed = batch(iterations, no_counters);
+                double wall = harness_detail::elapsed_ns(begin, harness_detail::Clock::now());
+                if (elapsed >= target || wall >= target || iterations >= options_.max_iterations_per_sample) {
+                    return iterations;
+                }
+                // 根据已测时间估计所需次数，至少翻倍、最多放大10倍
+                double scale = elapsed > 0 ? target / elapsed * 1.2 : 10.0;
+                scale = std::clamp(scale, 2.0, 10.0);
+                iterations = std::min<std::uint64_t>(options_.max_iterations_per_sample,
+                                                     static_cast<std::uint64_t>(iterations * scale));
+            }
+        }
+
+        template<typename BatchFn>
+        BenchmarkStats sample(const std::string& name, BatchFn batch) const {
+            // 预热：让缓存、分支预测器和CPU频率进入稳定状态
+            harness_detail::CounterSampler sampler;
+            auto warmup_end = harness_detail::Clock::now() + options_.warmup_time;
+            while (harness_detail::Clock::now() < warmup_end) {
+                batch(1, sampler);
+            }
+
+            std::uint64_t iterations = calibrate(batch);
+            std::unique_ptr<PerfCounterGroup> group;
+            if (options_.perf_counters) {
+                group = std::make_unique<PerfCounterGroup>();
+                if (group->available()) sampler.group = group.get();
+            }
+            sampler.allocations = options_.track_allocations && allocation_tracking_available();
+            std::vector<double> samples;
+            samples.reserve(options_.samples);
+            for (size_t s = 0; s < options_.samples; ++s) {
+                samples.push_back(batch(iterations, sampler) / static_cast<double>(iterations));
+            }
+            auto stats = compute_stats(name, std::move(samples), iterations, options_.confidence);
+            if (sampler.group) {
+                stats.counters = sampler.total.scaled(1.0 / (static_cast<double>(iterations) * options_.samples));
+            }
+            if (sampler.allocations) {
+                stats.allocations = AllocationStats::from_delta(sampler.allocation_total,
+                                                                static_cast<double>(iterations) * options_.samples);
+            }
+            return stats;
+        }
+
+    public:
+        explicit BenchmarkRunner(BenchmarkOptions options = {}) : options_(options) {}
+
+        const BenchmarkOptions& options() const {
+            return options_;
+        }
+
+        // 测量body()本身；返回值会经过do_not_optimize
+        template<typename Body>
+        BenchmarkStats run(const std::string& name, Body&& body) const {
+            return sample(name, [&body](std::uint64_t iterations, harness_detail::CounterSampler& counters) {
+                return time_batch(body, iterations, counters);
+            });
+        }
+
+        // 每次迭代先调用setup()得到状态，只对body(state)计时，最后调用teardown(state)
+        // 每次迭代单独计时，结果中已扣除读取时钟的开销；计数器同样只覆盖body
+        template<typename Setup, typename Body, typename Teardown>
+        BenchmarkStats run_with_setup(const std::string& name, Setup&& setup, Body&& body, Teardown&& teardown) const {
+            auto batch = [&](std::uint64_t iterations, harness_detail::CounterSampler& counters) {
+                double total = 0.0;
+                for (std::uint64_t i = 0; i < iterations; ++i) {
+                    auto state = setup();
+                    clobber_memory();
+                    counters.begin();
+                    auto begin = harness_detail::Clock::now();
+                    if constexpr (std::is_void_v<std::invoke_result_t<Body&, decltype(state)&>>) {
+                        body(state);
+                        clobber_memory();
+                    } else {
+                        do_not_optimize(body(state));
+                    }
+                    auto end = harness_detail::Clock::now();
+                    counters.end();
+                    total += std::max(0.0, harness_detail::elapsed_ns(begin, end) - harness_detail::clock_overhead_ns());
+                    teardown(state);
+                }
+                return total;
+            };
+            return sample(name, batch);
+        }
+
+        // 参数扫描：对每个参数调用factory(param)构造被测对象(构造不计时)，再测量它
+        // 结果命名为 name/param
+        template<typename Param, typename Factory>
+        std::vector<BenchmarkStats> run_sweep(const std::string& name, const std::vector<Param>& params,
+                                              Factory&& factory) const {
+            std::vector<BenchmarkStats> results;
+            results.reserve(params.size());
+            for (const Param& param : params) {
+                auto body = factory(param);
+                results.push_back(run(name + "/" + harness_detail::param_label(param), body));
+            }
+            return results;
+        }
+
+        // 多线程基准测试：threads个线程通过起跑屏障同时开始，各自执行body(thread_index)
+        // 迭代次数按整个线程组的墙钟时间校准。硬件计数器只统计调用线程，这里不采集
+        template<typename Body>
+        ThreadedBenchmarkStats run_threads(const std::string& name, size_t threads, Body&& body) const {
+            if (threads == 0) threads = 1;
+            harness_detail::ThreadTeam<std::remove_reference_t<Body>> team(threads, body);
+            auto batch = [&team](std::uint64_t iterations, harness_detail::CounterSampler&) {
+                return team.run(iterations);
+            };
+
+            auto warmup_end = harness_detail::Clock::now() + options_.warmup_time;
+            while (harness_detail::Clock::now() < warmup_end) {
+                team.run(1);
+            }
+            std::uint64_t iterations = calibrate(batch);
+
+            const bool track_allocations = options_.track_allocations && allocation_tracking_available();
+            std::vector<double> aggregate;
+            std::vector<std::vector<double>> per_thread(threads);
+            std::vector<AllocationDelta> thread_allocations(threads);
+            aggregate.reserve(options_.samples);
+            for (size_t s = 0; s < options_.samples; ++s) {
+                double wall = team.run(iterations, track_allocations);
+                aggregate.push_back(wall / (static_cast<double>(iterations) * threads));
+                for (size_t t = 0; t < threads; ++t) {
+                    per_thread[t].push_back(team.thread_elapsed_ns(t) / static_cast<double>(iterations));
+                    thread_allocations[t] += team.thread_allocations(t);
+                }
+            }
+
+            ThreadedBenchmarkStats stats;
+            stats.threads = threads;
+            stats.aggregate = compute_stats(name + "/threads:" + std::to_string(threads), std::move(aggregate),
+                                            iterations, options_.confidence);
+            for (size_t t = 0; t < threads; ++t) {
+                stats.per_thread.push_back(compute_stats(name + "/thread " + std::to_string(t),
+                                                         std::move(per_thread[t]), iterations, options_.confidence));
+            }
+            if (track_allocations) {
+                // 汇总结果按每次操作计，峰值取各线程中最大的一个
+                const double per_thread_iterations = static_cast<double>(iterations) * options_.samples;
+                AllocationDelta total;
+                for (size_t t = 0; t < threads; ++t) {
+                    stats.per_thread[t].allocations =
+                        AllocationStats::from_delta(thread_allocations[t], per_thread_iterations);
+                    total += thread_allocations[t];
+                }
+                stats.aggregate.allocations = AllocationStats::from_delta(total, per_thread_iterations * threads);
+            }
+            return stats;
+        }
+    };
+
+    // 以统一格式打印统计结果
+    inline void print_stats(std::ostream& os, const BenchmarkStats& stats) {
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::left << std::setw(32) << stats.name << std::right << std::fixed << std::setprecision(2)
+           << " median " << std::setw(10) << stats.median_ns << " ns"
+           << "  mean " << stats.mean_ns << " ns [" << stats.ci_low_ns << ", " << stats.ci_high_ns << "]"
+           << "  p90 " << stats.p90_ns << "  p99 " << stats.p99_ns
+           << "  stddev " << stats.stddev_ns << " (cv " << std::setprecision(1) << stats.cv() * 100 << "%)"
+           << "  samples " << stats.samples << " x " << stats.iterations_per_sample;
+        if (stats.outliers_low + stats.outliers_high > 0) {
+            os << "  outliers " << stats.outliers_low << "/" << stats.outliers_high;
+        }
+        print_counters(os, stats.counters);
+        print_allocations(os, stats.allocations);
+        os << std::endl;
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    // 打印线程组汇总结果；per_thread为true时逐个打印每个线程的中位数和p99
+    inline void print_threaded_stats(std::ostream& os, const ThreadedBenchmarkStats& stats, bool per_thread = false) {
+        print_stats(os, stats.aggregate);
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::fixed << std::setprecision(0) << "    throughput " << stats.ops_per_second() << " ops/s";
+        if (!stats.per_thread.empty()) {
+            auto by_median = [](const BenchmarkStats& a, const BenchmarkStats& b) { return a.median_ns < b.median_ns; };
+            auto fastest = std::min_element(stats.per_thread.begin(), stats.per_thread.end(), by_median);
+            auto slowest = std::max_element(stats.per_thread.begin(), stats.per_thread.end(), by_median);
+            // 最快和最慢线程的差距反映了调度或争用的不公平程度
+            os << std::setprecision(2) << "  per-thread median " << fastest->median_ns << " .. "
+               << slowest->median_ns << " ns";
+        }
+        os << std::endl;
+        if (per_thread) {
+            for (const auto& t : stats.per_thread) {
+                os << "    " << std::left << std::setw(28) << t.name << std::right << std::setprecision(2)
+                   << " median " << t.median_ns << " ns  p99 " << t.p99_ns << " ns" << std::endl;
+            }
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_BENCHMARK_HARNESS_H
@@ -0,0 +1,263 @@
+#ifndef CPP_LEARNING_DEMO_BENCHMARK_REGISTRY_H
+#define CPP_LEARNING_DEMO_BENCHMARK_REGISTRY_H
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "benchmark_harness.h"
+#include "benchmark_report.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace performance_benchmarking_demo {
+    // 基准测试程序的运行配置(由命令行参数填充)
+    struct BenchmarkConfig {
+        BenchmarkOptions options;
+        std::optional<std::regex> filter;
+        int repetitions = 1;
+        bool list_only = false;
+        // 单线程测量期间把测量线程固定到这个CPU；-1表示不固定
+        int cpu = -1;
+    };
+
+    // 把当前线程固定到指定CPU上，减少迁移带来的缓存失效和频率差异
+    // 仅Linux支持；其他平台返回false
+    inline bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    // 在作用域内把当前线程固定到cpu，离开时恢复原来的亲和性掩码。
+    // 固定期间创建的线程会继承只有一个CPU的掩码，所以只包住单线程的测量；cpu为负数时什么都不做
+    class CpuPinScope {
+    private:
+        bool pinned_ = false;
+#if defined(__linux__)
+        cpu_set_t original_;
+#endif
+
+    public:
+        explicit CpuPinScope(int cpu) {
+#if defined(__linux__)
+            if (cpu >= 0 && sched_getaffinity(0, sizeof(original_), &original_) == 0) {
+                pinned_ = pin_current_thread(cpu);
+            }
+#else
+            (void)cpu;
+#endif
+        }
+
+        ~CpuPinScope() {
+#if defined(__linux__)
+            if (pinned_) sched_setaffinity(0, sizeof(original_), &original_);
+#endif
+        }
+
+        CpuPinScope(const CpuPinScope&) = delete;
+        CpuPinScope& operator=(const CpuPinScope&) = delete;
+
+        bool pinned() const {
+            return pinned_;
+        }
+    };
+
+    // 传给每个注册的基准测试函数：按名字过滤、重复执行、打印并收集结果
+    //
+    // 基准测试函数里耗时的数据准备应放在factory或setup中，
+    // 这样被过滤掉或者只列出名字(--list)时不会执行。
+    //
+    // 配置了cpu时，run/run_with_setup/run_sweep的测量期间把调用线程固定到该CPU，结束后恢复；
+    // run_threads和selected()之后的自定义测量不固定。测量体自己创建线程的基准测试
+    // 用unpinned()包住这些测量，否则新线程都会挤在同一个CPU上。
+    class BenchmarkContext {
+    private:
+        const BenchmarkConfig& config_;
+        BenchmarkReport& report_;
+        std::ostream& out_;
+        BenchmarkRunner runner_;
+        size_t selected_count_ = 0;
+        int unpinned_depth_ = 0;
+
+        // 重复执行measure；多次重复时逐次打印，并把所有样本合并为一条结果写入报告。
+        // measure返回BenchmarkStats或ThreadedBenchmarkStats(合并线程组的汇总结果，测量期间不固定CPU)
+        template<typename Measure>
+        void repeat(const std::string& name, Measure&& measure) {
+            using Result = std::invoke_result_t<Measure&>;
+            constexpr bool threaded = std::is_same_v<Result, ThreadedBenchmarkStats>;
+            CpuPinScope pin(threaded || unpinned_depth_ > 0 ? -1 : config_.cpu);
+            const int repetitions = std::max(1, config_.repetitions);
+            std::vector<double> pooled;
+            std::uint64_t iterations = 0;
+            PerfCounterValues counters;
+            AllocationStats allocations;
+            for (int r = 0; r < repetitions; ++r) {
+                Result result = measure();
+                BenchmarkStats& stats = [&result]() -> BenchmarkStats& {
+                    if constexpr (threaded) return result.aggregate;
+                    else return result;
+                }();
+                if (repetitions > 1) stats.name = name + "/repeat:" + std::to_string(r);
+                if constexpr (threaded) print_threaded_stats(out_, result);
+                else print_stats(out_, stats);
+                pooled.insert(pooled.end(), stats.sample_ns.begin(), stats.sample_ns.end());
+                iterations = std::max(iterations, stats.iterations_per_sample);
+                counters += stats.counters.scaled(1.0 / repetitions);
+                if (stats.allocations.valid) {
+                    allocations.valid = true;
+                    allocations.allocations += stats.allocations.allocations / repetitions;
+                    allocations.deallocations += stats.allocations.deallocations / repetitions;
+                    allocations.bytes += stats.allocations.bytes / repetitions;
+                    allocations.peak_live_bytes = std::max(allocations.peak_live_bytes, stats.allocations.peak_live_bytes);
+                }
+                if (repetitions == 1) {
+                    report_.add(std::move(stats));
+                    return;
+                }
+            }
+            BenchmarkStats merged = compute_stats(name, std::move(pooled), iterations, config_.options.confidence);
+            merged.counters = counters;
+            merged.allocations = allocations;
+            print_stats(out_, merged);
+            report_.add(std::move(merged));
+        }
+
+    public:
+        // unpinned()返回的作用域对象：存在期间的测量不固定CPU
+        class UnpinnedScope {
+        private:
+            BenchmarkContext& context_;
+
+        public:
+            explicit UnpinnedScope(BenchmarkContext& context) : context_(context) {
+                ++context_.unpinned_depth_;
+            }
+
+            ~UnpinnedScope() {
+                --context_.unpinned_depth_;
+            }
+
+            UnpinnedScope(const UnpinnedScope&) = delete;
+            UnpinnedScope& operator=(const UnpinnedScope&) = delete;
+        };
+
+        BenchmarkContext(const BenchmarkConfig& config, BenchmarkReport& report, std::ostream& out = std::cout)
+            : config_(config), report_(report), out_(out), runner_(config.options) {}
+
+        [[nodiscard]] UnpinnedScope unpinned() {
+            return UnpinnedScope(*this);
+        }
+
+        bool listing() const {
+            return config_.list_only;
+        }
+
+        // 自定义测量(例如延迟分布)用：名字被过滤掉或处于--list模式时返回false
+        bool selected(const std::string& name) {
+            if (config_.filter && !std::regex_search(name, *config_.filter)) return false;
+            ++selected_count_;
+            if (config_.list_only) {
+                out_ << name << '\n';
+                return false;
+            }
+            return true;
+        }
+
+        std::ostream& out() {
+            return out_;
+        }
+
+        // 被选中(或在--list模式下被列出)的基准测试数
+        size_t selected_count() const {
+            return selected_count_;
+        }
+
+        template<typename Body>
+        void run(const std::string& name, Body&& body) {
+            if (!selected(name)) return;
+            repeat(name, [&] { return runner_.run(name, body); });
+        }
+
+        template<typename Setup, typename Body, typename Teardown>
+        void run_with_setup(const std::string& name, Setup&& setup, Body&& body, Teardown&& teardown) {
+            if (!selected(name)) return;
+            repeat(name, [&] { return runner_.run_with_setup(name, setup, body, teardown); });
+        }
+
+        // 参数扫描：每个参数是一条独立的基准测试(name/param)，可以单独过滤
+        template<typename Param, typename Factory>
+        void run_sweep(const std::string& name, const std::vector<Param>& params, Factory&& factory) {
+            for (const Param& param : params) {
+                std::string full_name = name + "/" + harness_detail::param_label(param);
+                if (!selected(full_name)) continue;
+                auto body = factory(param);
+                repeat(full_name, [&] { return runner_.run(full_name, body); });
+            }
+        }
+
+        // 多线程基准测试：报告中记录线程组的汇总结果，多次重复时合并为一条
+        template<typename Body>
+        void run_threads(const std::string& name, size_t threads, Body&& body) {
+            std::string full_name = name + "/threads:" + std::to_string(threads);
+            if (!selected(full_name)) return;
+            repeat(full_name, [&] { return runner_.run_threads(name, threads, body); });
+        }
+    };
+
+    // 基准测试注册表：BENCHMARK_CASE在静态初始化阶段把函数登记到这里
+    class BenchmarkRegistry {
+    public:
+        using Function = std::function<void(BenchmarkContext&)>;
+
+        struct Entry {
+            std::string name;
+            Function function;
+        };
+
+        static BenchmarkRegistry& instance() {
+            static BenchmarkRegistry registry;
+            return registry;
+        }
+
+        bool add(std::string name, Function function) {
+            entries_.push_back(Entry{std::move(name), std::move(function)});
+            return true;
+        }
+
+        // 按名字排序，输出顺序不依赖链接顺序
+        std::vector<Entry> entries() const {
+            std::vector<Entry> sorted = entries_;
+            std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+            return sorted;
+        }
+
+    private:
+        std::vector<Entry> entries_;
+    };
+}
+
+// 定义并注册一个基准测试函数，函数体内通过context执行测量：
+//   BENCHMARK_CASE(vector_push_back) {
+//       context.run_sweep("vector/push_back", power_of_two_range(10, 20), ...);
+//   }
+#define BENCHMARK_CASE(function_name)                                                                     \
+    static void function_name(::performance_benchmarking_demo::BenchmarkContext& context);               \
+    [[maybe_unused]] static const bool function_name##_registered =                                      \
+        ::performance_benchmarking_demo::BenchmarkRegistry::instance().add(#function_name, function_name); \
+    static void function_name([[maybe_unused]] ::performance_benchmarking_demo::BenchmarkContext& context)
+
+#endif //CPP_LEARNING_DEMO_BENCHMARK_REGISTRY_H
@@ -0,0 +1,712 @@
+#ifndef CPP_LEARNING_DEMO_BENCHMARK_REPORT_H
+#define CPP_LEARNING_DEMO_BENCHMARK_REPORT_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "benchmark_harness.h"
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+// 构建选项由CMake在配置时注入；git提交由CMake在每次构建时写入生成的头文件。
+// 直接用编译器构建时使用默认值，git提交在运行时查询
+#if __has_include("cpp_learning_git_sha.h")
+#include "cpp_learning_git_sha.h"
+#endif
+#ifndef CPP_LEARNING_BUILD_FLAGS
+#define CPP_LEARNING_BUILD_FLAGS ""
+#endif
+#ifndef CPP_LEARNING_GIT_SHA
+#define CPP_LEARNING_GIT_SHA ""
+#endif
+
+namespace performance_benchmarking_demo {
+    // 结果文件附带的运行环境信息，比较不同机器或编译选项的结果时用来判断是否可比
+    struct BenchmarkMetadata {
+        std::string compiler;
+        std::string flags;
+        std::string cpu_model;
+        std::string git_sha;
+        std::string timestamp;
+
+        static std::string detect_compiler() {
+#if defined(__clang__)
+            return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+            return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        static std::string detect_flags() {
+            std::string flags = CPP_LEARNING_BUILD_FLAGS;
+            // 没有CMake注入时至少记录是否开启了优化和断言
+#if defined(__OPTIMIZE__)
+            if (flags.empty()) flags = "optimized";
+#endif
+#if defined(NDEBUG)
+            flags += flags.empty() ? "NDEBUG" : " NDEBUG";
+#endif
+            return flags;
+        }
+
+        static std::string detect_cpu_model() {
+#if defined(__linux__)
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line)) {
+                if (line.rfind("model name", 0) == 0) {
+                    auto colon = line.find(':');
+                    if (colon != std::string::npos) {
+                        auto begin = line.find_first_not_of(' ', colon + 1);
+                        return begin == std::string::npos ? "" : line.substr(begin);
+                    }
+                }
+            }
+#elif defined(__APPLE__)
+            char buffer[256];
+            size_t size = sizeof(buffer);
+            if (sysctlbyname("machdep.cpu.brand_string", buffer, &size, nullptr, 0) == 0) {
+                return std::string(buffer);
+            }
+#endif
+            return "unknown";
+        }
+
+        static std::string detect_git_sha() {
+            std::string sha = CPP_LEARNING_GIT_SHA;
+#if defined(__unix__) || defined(__APPLE__)
+            // 未通过CMake构建时尝试在当前目录查询
+            if (sha.empty()) {
+                if (FILE* pipe = popen("git rev-parse --short HEAD 2>/dev/null", "r")) {
+                    char buffer[64] = {};
+                    if (fgets(buffer, sizeof(buffer), pipe)) sha = buffer;
+                    pclose(pipe);
+                    while (!sha.empty() && std::isspace(static_cast<unsigned char>(sha.back()))) sha.pop_back();
+                }
+            }
+#endif
+            return sha.empty() ? "unknown" : sha;
+        }
+
+        // ISO 8601 UTC时间
+        static std::string current_timestamp() {
+            std::time_t now = std::time(nullptr);
+            std::tm utc{};
+#if defined(_WIN32)
+            gmtime_s(&utc, &now);
+#else
+            gmtime_r(&now, &utc);
+#endif
+            char buffer[32];
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+            return buffer;
+        }
+
+        static BenchmarkMetadata collect() {
+            return {detect_compiler(), detect_flags(), detect_cpu_model(), detect_git_sha(), current_timestamp()};
+        }
+    };
+
+    namespace report_detail {
+        inline std::string json_escape(const std::string& s) {
+            std::string out;
+            out.reserve(s.size() + 2);
+            for (char c : s) {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char buffer[8];
+                            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                            out += buffer;
+                        } else {
+                            out += c;
+                        }
+                }
+            }
+            return out;
+        }
+
+        // JSON没有NaN和无穷大：不是有限值的数字(例如只有一个样本时的区间)写成null
+        struct JsonNumber {
+            double value;
+        };
+
+        inline std::ostream& operator<<(std::ostream& os, JsonNumber number) {
+            if (std::isfinite(number.value)) return os << number.value;
+            return os << "null";
+        }
+
+        // CSV中不是有限值的数字和不可用的值一样留空
+        struct CsvNumber {
+            double value;
+        };
+
+        inline std::ostream& operator<<(std::ostream& os, CsvNumber number) {
+            if (std::isfinite(number.value)) os << number.value;
+            return os;
+        }
+
+        inline std::string csv_escape(const std::string& s) {
+            if (s.find_first_of(",\"\n") == std::string::npos) return s;
+            std::string out = "\"";
+            for (char c : s) {
+                if (c == '"') out += '"';
+                out += c;
+            }
+            return out + "\"";
+        }
+
+        // 读取结果文件所需的最小JSON解析器：支持对象、数组、字符串、数字、布尔和null
+        struct JsonValue {
+            enum class Type { Null, Bool, Number, String, Array, Object };
+            Type type = Type::Null;
+            bool boolean = false;
+            double number = 0.0;
+            std::string string;
+            std::vector<JsonValue> array;
+            std::map<std::string, JsonValue> object;
+
+            const JsonValue* find(const std::string& key) const {
+                if (type != Type::Object) return nullptr;
+                auto it = object.find(key);
+                return it == object.end() ? nullptr : &it->second;
+            }
+
+            double number_or(const std::string& key, double fallback) const {
+                const JsonValue* v = find(key);
+                return v && v->type == Type::Number ? v->number : fallback;
+            }
+
+            std::string string_or(const std::string& key, const std::string& fallback) const {
+                const JsonValue* v = find(key);
+                return v && v->type == Type::String ? v->string : fallback;
+            }
+        };
+
+        class JsonParser {
+        private:
+            const std::string& text_;
+            size_t pos_ = 0;
+
+            [[noreturn]] void fail(const std::string& what) const {
+                throw std::runtime_error("JSON parse error at offset " + std::to_string(pos_) + ": " + what);
+            }
+
+            void skip_whitespace() {
+                while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+            }
+
+            void expect(char c) {
+                skip_whitespace();
+                if (pos_ >= text_.size() || text_[pos_] != c) fail(std::string("expected '") + c + "'");
+                ++pos_;
+            }
+
+            bool consume_literal(const char* literal) {
+                size_t len = std::char_traits<char>::length(literal);
+                if (text_.compare(pos_, len, literal) != 0) return false;
+                pos_ += len;
+                return true;
+            }
+
+            std::string parse_string() {
+                expect('"');
+                std::string out;
+                while (pos_ < text_.size() && text_[pos_] != '"') {
+                    char c = text_[pos_++];
+                    if (c != '\\') {
+                        out += c;
+                        continue;
+                    }
+                    if (pos_ >= text_.size()) fail("unterminated escape");
+                    char e = text_[pos_++];
+                    switch (e) {
+                        case 'n': out += '\n'; break;
+                        case 'r': out += '\r'; break;
+                        case 't': out += '\t'; break;
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'u': {
+                            if (pos_ + 4 > text_.size()) fail("bad unicode escape");
+                            unsigned code = std::stoul(text_.substr(pos_, 4), nullptr, 16);
+                            pos_ += 4;
+                            // 结果文件只会包含ASCII控制字符的转义，其余按UTF-8编码写回
+                            if (code < 0x80) {
+                                out += static_cast<char>(code);
+                            } else if (code < 0x800) {
+                                out += static_cast<char>(0xC0 | (code >> 6));
+                                out += static_cast<char>(0x80 | (code & 0x3F));
+                            } else {
+                                out += static_cast<char>(0xE0 | (code >> 12));
+                                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                                out += static_cast<char>(0x80 | (code & 0x3F));
+                            }
+                            break;
+                        }
+                        default: out += e;
+                    }
+                }
+                if (pos_ >= text_.size()) fail("unterminated string");
+                ++pos_;
+                return out;
+            }
+
+            JsonValue parse_value() {
+                skip_whitespace();
+                if (pos_ >= text_.size()) fail("unexpected end of input");
+                JsonValue value;
+                char c = text_[pos_];
+                if (c == '{') {
+                    value.type = JsonValue::Type::Object;
+                    ++pos_;
+                    skip_whitespace();
+                    if (pos_ < text_.size() && text_[pos_] == '}') {
+                        ++pos_;
+                        return value;
+                    }
+                    for (;;) {
+                        std::string key = parse_string();
+                        expect(':');
+                        value.object[key] = parse_value();
+                        skip_whitespace();
+                        if (pos_ < text_.size() && text_[pos_] == ',') {
+                            ++pos_;
+                            continue;
+                        }
+                        expect('}');
+                        return value;
+                    }
+                }
+                if (c == '[') {
+                    value.type = JsonValue::Type::Array;
+                    ++pos_;
+                    skip_whitespace();
+                    if (pos_ < text_.size() && text_[pos_] == ']') {
+                        ++pos_;
+                        return value;
+                    }
+                    for (;;) {
+                        value.array.push_back(parse_value());
+                        skip_whitespace();
+                        if (pos_ < text_.size() && text_[pos_] == ',') {
+                            ++pos_;
+                            continue;
+                        }
+                        expect(']');
+                        return value;
+                    }
+                }
+                if (c == '"') {
+                    value.type = JsonValue::Type::String;
+                    value.string = parse_string();
+                    return value;
+                }
+                if (consume_literal("true")) {
+                    value.type = JsonValue::Type::Bool;
+                    value.boolean = true;
+                    return value;
+                }
+                if (consume_literal("false")) {
+                    value.type = JsonValue::Type::Bool;
+                    return value;
+                }
+                if (consume_literal("null")) {
+                    return value;
+                }
+                size_t consumed = 0;
+                try {
+                    value.number = std::stod(text_.substr(pos_, 64), &consumed);
+                } catch (const std::exception&) {
+                    fail("invalid value");
+                }
+                pos_ += consumed;
+                value.type = JsonValue::Type::Number;
+                return value;
+            }
+
+        public:
+            explicit JsonParser(const std::string& text) : text_(text) {}
+
+            JsonValue parse() {
+                JsonValue value = parse_value();
+                skip_whitespace();
+                if (pos_ != text_.size()) fail("trailing characters");
+                return value;
+            }
+        };
+
+        // 标准正态分布的上尾概率
+        inline double normal_upper_tail(double z) {
+            return 0.5 * std::erfc(z / std::sqrt(2.0));
+        }
+    }
+
+    // Mann-Whitney U检验(正态近似，含并列修正)的双侧p值
+    // 不假设正态分布，对基准测试中常见的长尾和离群样本更稳健
+    inline double mann_whitney_p_value(const std::vector<double>& a, const std::vector<double>& b) {
+        const size_t n1 = a.size();
+        const size_t n2 = b.size();
+        if (n1 == 0 || n2 == 0) return 1.0;
+
+        std::vector<std::pair<double, int>> all;
+        all.reserve(n1 + n2);
+        for (double v : a) all.emplace_back(v, 0);
+        for (double v : b) all.emplace_back(v, 1);
+        std::sort(all.begin(), all.end());
+
+        // 并列值取平均秩
+        double rank_sum_a = 0.0;
+        double tie_term = 0.0;
+        for (size_t i = 0; i < all.size();) {
+            size_t j = i;
+            while (j < all.size() && all[j].first == all[i].first) ++j;
+            double average_rank = (i + 1 + j) / 2.0;
+            for (size_t k = i; k < j; ++k) {
+                if (all[k].second == 0) rank_sum_a += average_rank;
+            }
+            double t = static_cast<double>(j - i);
+            tie_term += t * t * t - t;
+            i = j;
+        }
+
+        const double N = static_cast<double>(n1 + n2);
+        double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+        double mean_u = n1 * n2 / 2.0;
+        double variance = n1 * n2 / 12.0 * ((N + 1) - tie_term / (N * (N - 1)));
+        if (variance <= 0) return 1.0;
+        // 连续性修正
+        double z = (std::abs(u - mean_u) - 0.5) / std::sqrt(variance);
+        return std::min(1.0, 2.0 * report_detail::normal_upper_tail(std::max(0.0, z)));
+    }
+
+    // 一次运行的全部结果，可以写成JSON/CSV，也可以从JSON读回作为基线
+    class BenchmarkReport {
+    private:
+        BenchmarkMetadata metadata_;
+        std::vector<BenchmarkStats> results_;
+
+        static void read_counters(const report_detail::JsonValue& entry, PerfCounterValues& counters) {
+            const report_detail::JsonValue* object = entry.find("counters");
+            if (!object) return;
+            for (size_t c = 0; c < kPerfCounterCount; ++c) {
+                const report_detail::JsonValue* v = object->find(to_string(static_cast<PerfCounter>(c)));
+                if (v && v->type == report_detail::JsonValue::Type::Number) {
+                    counters.values[c] = v->number;
+                    counters.available[c] = true;
+                }
+            }
+        }
+
+        static void read_allocations(const report_detail::JsonValue& entry, AllocationStats& allocations) {
+            const report_detail::JsonValue* object = entry.find("allocations");
+            if (!object) return;
+            allocations.valid = true;
+            allocations.allocations = object->number_or("allocations", 0);
+            allocations.deallocations = object->number_or("deallocations", 0);
+            allocations.bytes = object->number_or("bytes", 0);
+            allocations.peak_live_bytes = static_cast<std::int64_t>(object->number_or("peak_live_bytes", 0));
+        }
+
+    public:
+        BenchmarkReport() : metadata_(BenchmarkMetadata::collect()) {}
+        explicit BenchmarkReport(BenchmarkMetadata metadata) : metadata_(std::move(metadata)) {}
+
+        void add(BenchmarkStats stats) {
+            results_.push_back(std::move(stats));
+        }
+
+        const BenchmarkMetadata& metadata() const {
+            return metadata_;
+        }
+
+        const std::vector<BenchmarkStats>& results() const {
+            return results_;
+        }
+
+        const BenchmarkStats* find(const std::string& name) const {
+            for (const auto& stats : results_) {
+                if (stats.name == name) return &stats;
+            }
+            return nullptr;
+        }
+
+        void write_json(std::ostream& os) const {
+            using report_detail::json_escape;
+            using N = report_detail::JsonNumber;
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::setprecision(17);
+            os << "{\n  \"metadata\": {\n"
+               << "    \"compiler\": \"" << json_escape(metadata_.compiler) << "\",\n"
+               << "    \"flags\": \"" << json_escape(metadata_.flags) << "\",\n"
+               << "    \"cpu_model\": \"" << json_escape(metadata_.cpu_model) << "\",\n"
+               << "    \"git_sha\": \"" << json_escape(metadata_.git_sha) << "\",\n"
+               << "    \"timestamp\": \"" << json_escape(metadata_.timestamp) << "\"\n"
+               << "  },\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results_.size(); ++i) {
+                const auto& s = results_[i];
+                os << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(s.name) << "\""
+                   << ", \"samples\": " << s.samples
+                   << ", \"iterations_per_sample\": " << s.iterations_per_sample
+                   << ", \"min_ns\": " << N{s.min_ns} << ", \"max_ns\": " << N{s.max_ns}
+                   << ", \"mean_ns\": " << N{s.mean_ns} << ", \"median_ns\": " << N{s.median_ns}
+                   << ", \"p90_ns\": " << N{s.p90_ns} << ", \"p99_ns\": " << N{s.p99_ns}
+                   << ", \"stddev_ns\": " << N{s.stddev_ns}
+                   << ", \"ci_low_ns\": " << N{s.ci_low_ns} << ", \"ci_high_ns\": " << N{s.ci_high_ns}
+                   << ", \"outliers_low\": " << s.outliers_low << ", \"outliers_high\": " << s.outliers_high;
+                if (s.counters.valid()) {
+                    os << ", \"counters\": {";
+                    bool first = true;
+                    for (size_t c = 0; c < kPerfCounterCount; ++c) {
+                        if (!s.counters.available[c]) continue;
+                        os << (first ? "" : ", ") << "\"" << to_string(static_cast<PerfCounter>(c)) << "\": "
+                           << N{s.counters.values[c]};
+                        first = false;
+                    }
+                    os << "}";
+                }
+                if (s.allocations.valid) {
+                    os << ", \"allocations\": {\"allocations\": " << N{s.allocations.allocations}
+                       << ", \"deallocations\": " << N{s.allocations.deallocations}
+                       << ", \"bytes\": " << N{s.allocations.bytes}
+                       << ", \"peak_live_bytes\": " << s.allocations.peak_live_bytes << "}";
+                }
+                os << ", \"sample_ns\": [";
+                for (size_t k = 0; k < s.sample_ns.size(); ++k) {
+                    os << (k ? ", " : "") << N{s.sample_ns[k]};
+                }
+                os << "]}";
+            }
+            os << "\n  ]\n}\n";
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        // 每行一个基准测试，元数据重复在每行末尾，方便直接导入表格工具
+        void write_csv(std::ostream& os) const {
+            using report_detail::csv_escape;
+            using N = report_detail::CsvNumber;
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::setprecision(10);
+            os << "name,samples,iterations_per_sample,min_ns,median_ns,mean_ns,p90_ns,p99_ns,max_ns,stddev_ns,"
+                  "ci_low_ns,ci_high_ns,outliers_low,outliers_high,compiler,flags,cpu_model,git_sha,timestamp";
+            for (size_t c = 0; c < kPerfCounterCount; ++c) {
+                os << ',' << to_string(static_cast<PerfCounter>(c));
+            }
+            os << ",allocs_per_iter,alloc_bytes_per_iter,peak_live_bytes\n";
+            for (const auto& s : results_) {
+                os << csv_escape(s.name) << ',' << s.samples << ',' << s.iterations_per_sample << ','
+                   << N{s.min_ns} << ',' << N{s.median_ns} << ',' << N{s.mean_ns} << ',' << N{s.p90_ns} << ','
+                   << N{s.p99_ns} << ',' << N{s.max_ns} << ',' << N{s.stddev_ns} << ',' << N{s.ci_low_ns} << ','
+                   << N{s.ci_high_ns} << ',' << s.outliers_low << ',' << s.outliers_high << ','
+                   << csv_escape(metadata_.compiler) << ',' << csv_escape(metadata_.flags) << ','
+                   << csv_escape(metadata_.cpu_model) << ',' << csv_escape(metadata_.git_sha) << ','
+                   << csv_escape(metadata_.timestamp);
+                // 不可用的计数器留空
+                for (size_t c = 0; c < kPerfCounterCount; ++c) {
+                    os << ',';
+                    if (s.counters.available[c]) os << N{s.counters.values[c]};
+                }
+                // 未统计分配时同样留空
+                if (s.allocations.valid) {
+                    os << ',' << N{s.allocations.allocations} << ',' << N{s.allocations.bytes} << ','
+                       << s.allocations.peak_live_bytes;
+                } else {
+                    os << ",,,";
+                }
+                os << '\n';
+            }
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        // 按扩展名选择格式(.csv为CSV，其余为JSON)；写入失败时抛出std::runtime_error
+        void save(const std::string& path) const {
+            std::ofstream out(path);
+            if (!out) throw std::runtime_error("cannot open " + path + " for writing");
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            if (csv) {
+                write_csv(out);
+            } else {
+                write_json(out);
+            }
+            if (!out) throw std::runtime_error("failed to write " + path);
+        }
+
+        // 从write_json()的输出读回；有原始样本时重新计算统计量
+        static BenchmarkReport from_json(const std::string& text) {
+            using report_detail::JsonValue;
+            JsonValue root = report_detail::JsonParser(text).parse();
+
+            BenchmarkMetadata metadata;
+            if (const JsonValue* m = root.find("metadata")) {
+                metadata.compiler = m->string_or("compiler", "");
+                metadata.flags = m->string_or("flags", "");
+                metadata.cpu_model = m->string_or("cpu_model", "");
+                metadata.git_sha = m->string_or("git_sha", "");
+                metadata.timestamp = m->string_or("timestamp", "");
+            }
+            BenchmarkReport report(metadata);
+
+            const JsonValue* benchmarks = root.find("benchmarks");
+            if (!benchmarks || benchmarks->type != JsonValue::Type::Array) {
+                throw std::runtime_error("benchmark report has no \"benchmarks\" array");
+            }
+            for (const JsonValue& entry : benchmarks->array) {
+                std::string name = entry.string_or("name", "");
+                auto iterations = static_cast<std::uint64_t>(entry.number_or("iterations_per_sample", 1));
+                std::vector<double> samples;
+                if (const JsonValue* raw = entry.find("sample_ns"); raw && raw->type == JsonValue::Type::Array) {
+                    for (const JsonValue& v : raw->array) {
+                        if (v.type == JsonValue::Type::Number) samples.push_back(v.number);
+                    }
+                }
+                BenchmarkStats stats;
+                if (!samples.empty()) {
+                    stats = compute_stats(name, std::move(samples), iterations);
+                    read_counters(entry, stats.counters);
+                    read_allocations(entry, stats.allocations);
+                    report.add(std::move(stats));
+                    continue;
+                }
+                stats.name = name;
+                stats.iterations_per_sample = iterations;
+                stats.samples = static_cast<size_t>(entry.number_or("samples", 0));
+                stats.min_ns = entry.number_or("min_ns", 0);
+                stats.max_ns = entry.number_or("max_ns", 0);
+                stats.mean_ns = entry.number_or("mean_ns", 0);
+                stats.median_ns = entry.number_or("median_ns", 0);
+                stats.p90_ns = entry.number_or("p90_ns", 0);
+                stats.p99_ns = entry.number_or("p99_ns", 0);
+                stats.stddev_ns = entry.number_or("stddev_ns", 0);
+                stats.ci_low_ns = entry.number_or("ci_low_ns", 0);
+                stats.ci_high_ns = entry.number_or("ci_high_ns", 0);
+                read_counters(entry, stats.counters);
+                read_allocations(entry, stats.allocations);
+                report.add(std::move(stats));
+            }
+            return report;
+        }
+
+        static BenchmarkReport load(const std::string& path) {
+            std::ifstream in(path);
+            if (!in) throw std::runtime_error("cannot open " + path);
+            std::stringstream buffer;
+            buffer << in.rdbuf();
+            return from_json(buffer.str());
+        }
+    };
+
+    struct RegressionOptions {
+        // 中位数变化超过该比例才认为有实际意义
+        double threshold = 0.05;
+        // 显著性水平
+        double alpha = 0.01;
+    };
+
+    struct BaselineComparison {
+        enum class Verdict { Unchanged, Improved, Regressed, Added, Removed };
+
+        std::string name;
+        double baseline_median_ns = 0.0;
+        double current_median_ns = 0.0;
+        double change = 0.0;   // (current - baseline) / baseline
+        double p_value = 1.0;
+        Verdict verdict = Verdict::Unchanged;
+    };
+
+    inline const char* to_string(BaselineComparison::Verdict verdict) {
+        switch (verdict) {
+            case BaselineComparison::Verdict::Unchanged: return "unchanged";
+            case BaselineComparison::Verdict::Improved: return "improved";
+            case BaselineComparison::Verdict::Regressed: return "REGRESSED";
+            case BaselineComparison::Verdict::Added: return "new";
+            case BaselineComparison::Verdict::Removed: return "missing";
+        }
+        return "unknown";
+    }
+
+    // 逐项比较：中位数变化超过阈值且样本分布差异显著时才判定为回归或改进
+    // 没有原始样本时无法做检验，只按阈值判断
+    inline std::vector<BaselineComparison> compare_reports(const BenchmarkReport& baseline,
+                                                           const BenchmarkReport& current,
+                                                           RegressionOptions options = {}) {
+        using Verdict = BaselineComparison::Verdict;
+        std::vector<BaselineComparison> comparisons;
+        for (const auto& now : current.results()) {
+            BaselineComparison c;
+            c.name = now.name;
+            c.current_median_ns = now.median_ns;
+            const BenchmarkStats* before = baseline.find(now.name);
+            if (!before) {
+                c.verdict = Verdict::Added;
+                comparisons.push_back(c);
+                continue;
+            }
+            c.baseline_median_ns = before->median_ns;
+            c.change = before->median_ns > 0 ? (now.median_ns - before->median_ns) / before->median_ns : 0.0;
+            bool testable = before->sample_ns.size() > 1 && now.sample_ns.size() > 1;
+            c.p_value = testable ? mann_whitney_p_value(before->sample_ns, now.sample_ns) : 0.0;
+            if (c.p_value < options.alpha && std::abs(c.change) > options.threshold) {
+                c.verdict = c.change > 0 ? Verdict::Regressed : Verdict::Improved;
+            }
+            comparisons.push_back(c);
+        }
+        for (const auto& before : baseline.results()) {
+            if (!current.find(before.name)) {
+                BaselineComparison c;
+                c.name = before.name;
+                c.baseline_median_ns = before.median_ns;
+                c.verdict = Verdict::Removed;
+                comparisons.push_back(c);
+            }
+        }
+        return comparisons;
+    }
+
+    // 打印比较表；存在回归时返回1，可直接作为进程退出码
+    inline int print_comparison(std::ostream& os, const std::vector<BaselineComparison>& comparisons) {
+        auto flags = os.flags();
+        auto precision = os.precision();
+        int regressions = 0;
+        os << std::left << std::setw(36) << "benchmark" << std::right << std::setw(14) << "baseline ns"
+           << std::setw(14) << "current ns" << std::setw(10) << "change" << std::setw(10) << "p" << "  verdict\n";
+        for (const auto& c : comparisons) {
+            os << std::left << std::setw(36) << c.name << std::right << std::fixed << std::setprecision(2)
+               << std::setw(14) << c.baseline_median_ns << std::setw(14) << c.current_median_ns
+               << std::setw(9) << c.change * 100 << "%" << std::setw(10) << std::setprecision(4) << c.p_value
+               << "  " << to_string(c.verdict) << '\n';
+            if (c.verdict == BaselineComparison::Verdict::Regressed) ++regressions;
+        }
+        os << regressions << " regression(s)" << std::endl;
+        os.flags(flags);
+        os.precision(precision);
+        return regressions > 0 ? 1 : 0;
+    }
+}
+
+#endif //CPP_LEARNING_DEMO_BENCHMARK_REPORT_H
@@ -0,0 +1,343 @@
+#ifndef CPP_LEARNING_DEMO_LATENCY_HISTOGRAM_H
+#define CPP_LEARNING_DEMO_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// HDR风格的延迟直方图
+//
+// 桶按"对数分段、段内线性"划分：小于2^P的值每个值一个桶(精确)，之后每个2的幂区间
+// 再均分为2^(P-1)个桶，因此任意值的相对误差不超过1/2^(P-1)(P=7时约1.6%)。
+// 桶数在构造时确定，记录一个值只需要一次bit_width和一次数组自增。
+namespace performance_benchmarking_demo {
+    namespace histogram_detail {
+        // 值v所在的桶下标
+        inline std::size_t bucket_index(std::uint64_t v, unsigned precision_bits) {
+            const std::uint64_t linear = std::uint64_t{1} << precision_bits;
+            if (v < linear) return static_cast<std::size_t>(v);
+            const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - precision_bits;
+            const std::uint64_t half = linear >> 1;
+            return static_cast<std::size_t>(linear + (shift - 1) * half + ((v >> shift) - half));
+        }
+
+        // 桶index覆盖的值区间 [lowest, highest]
+        inline std::uint64_t bucket_lowest(std::size_t index, unsigned precision_bits) {
+            const std::uint64_t linear = std::uint64_t{1} << precision_bits;
+            if (index < linear) return index;
+            const std::uint64_t half = linear >> 1;
+            const std::uint64_t shift = (index - linear) / half + 1;
+            const std::uint64_t top = (index - linear) % half + half;
+            return top << shift;
+        }
+
+        inline std::uint64_t bucket_highest(std::size_t index, unsigned precision_bits) {
+            const std::uint64_t linear = std::uint64_t{1} << precision_bits;
+            if (index < linear) return index;
+            const std::uint64_t shift = (index - linear) / (linear >> 1) + 1;
+            return bucket_lowest(index, precision_bits) + (std::uint64_t{1} << shift) - 1;
+        }
+    }
+
+    // 单线程使用的直方图；多线程记录用LatencyRecorder
+    class LatencyHistogram {
+    private:
+        friend class LatencyRecorder;
+
+        unsigned precision_bits_;
+        std::uint64_t max_trackable_;
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t total_ = 0;
+        std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t max_ = 0;
+        // 用long double累加，避免大量大值求和时丢失精度
+        long double sum_ = 0;
+
+    public:
+        // precision_bits: 3..16；max_trackable: 超过它的值计入最后一个桶，但min/max/mean仍然精确
+        explicit LatencyHistogram(unsigned precision_bits = 7, std::uint64_t max_trackable = std::uint64_t{1} << 40)
+            : precision_bits_(precision_bits), max_trackable_(max_trackable) {
+            if (precision_bits < 3 || precision_bits > 16) {
+                throw std::invalid_argument("LatencyHistogram precision_bits must be in [3, 16]");
+            }
+            max_trackable_ = std::max<std::uint64_t>(max_trackable_, std::uint64_t{1} << precision_bits_);
+            counts_.assign(histogram_detail::bucket_index(max_trackable_, precision_bits_) + 1, 0);
+        }
+
+        void record(std::uint64_t value, std::uint64_t count = 1) {
+            const std::uint64_t clamped = std::min(value, max_trackable_);
+            counts_[histogram_detail::bucket_index(clamped, precision_bits_)] += count;
+            total_ += count;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+            sum_ += static_cast<long double>(value) * count;
+        }
+
+        template<typename Rep, typename Period>
+        void record(std::chrono::duration<Rep, Period> duration) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            record(static_cast<std::uint64_t>(std::max<decltype(ns)>(ns, 0)));
+        }
+
+        // 合并另一个直方图；两者的精度和范围必须相同
+        void merge(const LatencyHistogram& other) {
+            if (other.precision_bits_ != precision_bits_ || other.counts_.size() != counts_.size()) {
+                throw std::invalid_argument("cannot merge histograms with different layouts");
+            }
+            for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+            total_ += other.total_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            sum_ += other.sum_;
+        }
+
+        void reset() {
+            std::fill(counts_.begin(), counts_.end(), 0);
+            total_ = 0;
+            min_ = std::numeric_limits<std::uint64_t>::max();
+            max_ = 0;
+            sum_ = 0;
+        }
+
+        std::uint64_t count() const {
+            return total_;
+        }
+
+        std::uint64_t min() const {
+            return total_ ? min_ : 0;
+        }
+
+        std::uint64_t max() const {
+            return max_;
+        }
+
+        double mean() const {
+            return total_ ? static_cast<double>(sum_ / total_) : 0.0;
+        }
+
+        unsigned precision_bits() const {
+            return precision_bits_;
+        }
+
+        std::uint64_t max_trackable() const {
+            return max_trackable_;
+        }
+
+        // 第p百分位(0..100)：返回包含该排名的桶的上界，并限制在[min, max]内
+        std::uint64_t percentile(double p) const {
+            if (total_ == 0) return 0;
+            p = std::clamp(p, 0.0, 100.0);
+            auto rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_)));
+            rank = std::max<std::uint64_t>(rank, 1);
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < counts_.size(); ++i) {
+                seen += counts_[i];
+                if (seen >= rank) {
+                    return std::clamp(histogram_detail::bucket_highest(i, precision_bits_), min_, max_);
+                }
+            }
+            return max_;
+        }
+
+        // 遍历非空桶：f(lowest, highest, count)
+        template<typename F>
+        void for_each_bucket(F&& f) const {
+            for (std::size_t i = 0; i < counts_.size(); ++i) {
+                if (counts_[i]) {
+                    f(histogram_detail::bucket_lowest(i, precision_bits_),
+                      histogram_detail::bucket_highest(i, precision_bits_), counts_[i]);
+                }
+            }
+        }
+
+        // 一行摘要：count/mean/p50/p90/p99/p99.9/max
+        void print(std::ostream& os, const std::string& unit = "ns") const {
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::fixed << std::setprecision(1) << "count " << total_ << "  mean " << mean() << ' ' << unit
+               << "  p50 " << percentile(50) << "  p90 " << percentile(90) << "  p99 " << percentile(99)
+               << "  p99.9 " << percentile(99.9) << "  max " << max() << ' ' << unit;
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        // 百分位分布表，格式接近HdrHistogram的outputPercentileDistribution
+        void print_distribution(std::ostream& os) const {
+            static const double points[] = {0, 10, 25, 50, 75, 90, 95, 99, 99.5, 99.9, 99.95, 99.99, 100};
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::setw(12) << "value" << std::setw(12) << "percentile" << '\n';
+            for (double p : points) {
+                os << std::setw(12) << percentile(p) << std::setw(12) << std::fixed << std::setprecision(3) << p
+                   << '\n';
+            }
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        // JSON：摘要统计量加非空桶 [lowest, highest, count]
+        void write_json(std::ostream& os) const {
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::setprecision(17) << "{\"count\": " << total_ << ", \"min\": " << min() << ", \"max\": " << max()
+               << ", \"mean\": " << mean() << ", \"p50\": " << percentile(50) << ", \"p90\": " << percentile(90)
+               << ", \"p99\": " << percentile(99) << ", \"p99_9\": " << percentile(99.9)
+               << ", \"precision_bits\": " << precision_bits_ << ", \"buckets\": [";
+            bool first = true;
+            for_each_bucket([&](std::uint64_t lowest, std::uint64_t highest, std::uint64_t count) {
+                os << (first ? "" : ", ") << '[' << lowest << ", " << highest << ", " << count << ']';
+                first = false;
+            });
+            os << "]}";
+            os.flags(flags);
+            os.precision(precision);
+        }
+    };
+
+    // 多线程记录的直方图
+    //
+    // 每个线程首次记录时得到自己的分片，之后只写自己的分片：计数器是原子变量，但只有
+    // 所属线程写入，用relaxed的load+store代替原子加法，没有锁也没有缓存行争用。
+    // 分片记录所属线程的id，由recorder持有；线程这一侧只有几项的缓存，不随recorder的创建和销毁增长。
+    // snapshot()读取所有分片并合并为一个LatencyHistogram，可以在记录过程中调用。
+    class LatencyRecorder {
+    private:
+        struct Shard {
+            // 写这个分片的线程；线程退出后id可能被新线程复用，新线程接着写同一个分片
+            std::thread::id owner;
+            std::vector<std::atomic<std::uint64_t>> counts;
+            std::atomic<std::uint64_t> total{0};
+            std::atomic<std::uint64_t> min{std::numeric_limits<std::uint64_t>::max()};
+            std::atomic<std::uint64_t> max{0};
+            std::atomic<std::uint64_t> sum{0};
+
+            Shard(std::thread::id owner, std::size_t buckets) : owner(owner), counts(buckets) {}
+
+            static void bump(std::atomic<std::uint64_t>& a, std::uint64_t by) {
+                a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+            }
+        };
+
+        unsigned precision_bits_;
+        std::uint64_t max_trackable_;
+        std::size_t buckets_;
+        // 递增的编号，用来在线程局部缓存中区分不同的recorder(地址可能被复用，编号不会)
+        std::uint64_t id_;
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<Shard>> shards_;
+
+        static std::uint64_t next_id() {
+            static std::atomic<std::uint64_t> counter{0};
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        // 在shards_中找当前线程的分片，没有时创建
+        Shard* find_or_create_shard() {
+            const std::thread::id self = std::this_thread::get_id();
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& shard : shards_) {
+                if (shard->owner == self) return shard.get();
+            }
+            shards_.push_back(std::make_shared<Shard>(self, buckets_));
+            return shards_.back().get();
+        }
+
+        Shard& local_shard() {
+            // 线程通常只写一两个recorder，固定大小的缓存按recorder编号查找，未命中时轮流替换。
+            // 编号不会复用，已销毁的recorder留下的缓存项不会再被命中，只是等着被替换
+            struct CacheEntry {
+                std::uint64_t id = 0;
+                Shard* shard = nullptr;
+            };
+            thread_local std::array<CacheEntry, 4> cache{};
+            thread_local std::size_t next_slot = 0;
+            for (const CacheEntry& entry : cache) {
+                if (entry.id == id_) return *entry.shard;
+            }
+
+            Shard* shard = find_or_create_shard();
+            cache[next_slot] = CacheEntry{id_, shard};
+            next_slot = (next_slot + 1) % cache.size();
+            return *shard;
+        }
+
+    public:
+        explicit LatencyRecorder(unsigned precision_bits = 7, std::uint64_t max_trackable = std::uint64_t{1} << 40)
+            : precision_bits_(precision_bits), id_(next_id()) {
+            // 借用LatencyHistogram的参数检查和桶布局，snapshot()时两者布局一致
+            LatencyHistogram layout(precision_bits, max_trackable);
+            max_trackable_ = layout.max_trackable();
+            buckets_ = layout.counts_.size();
+        }
+
+        LatencyRecorder(const LatencyRecorder&) = delete;
+        LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+        void record(std::uint64_t value) {
+            Shard& shard = local_shard();
+            const std::uint64_t clamped = std::min(value, max_trackable_);
+            Shard::bump(shard.counts[histogram_detail::bucket_index(clamped, precision_bits_)], 1);
+            Shard::bump(shard.total, 1);
+            Shard::bump(shard.sum, value);
+            if (value < shard.min.load(std::memory_order_relaxed)) shard.min.store(value, std::memory_order_relaxed);
+            if (value > shard.max.load(std::memory_order_relaxed)) shard.max.store(value, std::memory_order_relaxed);
+        }
+
+        template<typename Rep, typename Period>
+        void record(std::chrono::duration<Rep, Period> duration) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            record(static_cast<std::uint64_t>(std::max<decltype(ns)>(ns, 0)));
+        }
+
+        // 写过这个recorder的线程数(每个线程一个分片)
+        std::size_t shard_count() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return shards_.size();
+        }
+
+        // 合并所有线程的记录
+        LatencyHistogram snapshot() const {
+            LatencyHistogram result(precision_bits_, max_trackable_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& shard : shards_) {
+                std::uint64_t total = shard->total.load(std::memory_order_relaxed);
+                if (total == 0) continue;
+                for (std::size_t i = 0; i < buckets_; ++i) {
+                    result.counts_[i] += shard->counts[i].load(std::memory_order_relaxed);
+                }
+                result.total_ += total;
+                result.min_ = std::min(result.min_, shard->min.load(std::memory_order_relaxed));
+                result.max_ = std::max(result.max_, shard->max.load(std::memory_order_relaxed));
+                result.sum_ += shard->sum.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        // 清空所有分片；应在没有线程记录时调用
+        void reset() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& shard : shards_) {
+                for (auto& c : shard->counts) c.store(0, std::memory_order_relaxed);
+                shard->total.store(0, std::memory_order_relaxed);
+                shard->min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+                shard->max.store(0, std::memory_order_relaxed);
+                shard->sum.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_LATENCY_HISTOGRAM_H
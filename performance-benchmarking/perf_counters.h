@@ -0,0 +1,221 @@
+#ifndef CPP_LEARNING_DEMO_PERF_COUNTERS_H
+#define CPP_LEARNING_DEMO_PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace performance_benchmarking_demo {
+    // 硬件性能计数器种类
+    enum class PerfCounter : size_t {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        Count
+    };
+
+    inline constexpr size_t kPerfCounterCount = static_cast<size_t>(PerfCounter::Count);
+
+    inline const char* to_string(PerfCounter counter) {
+        switch (counter) {
+            case PerfCounter::Cycles: return "cycles";
+            case PerfCounter::Instructions: return "instructions";
+            case PerfCounter::L1DMisses: return "l1d_misses";
+            case PerfCounter::LLCMisses: return "llc_misses";
+            case PerfCounter::BranchMisses: return "branch_misses";
+            case PerfCounter::Count: break;
+        }
+        return "unknown";
+    }
+
+    // 一段代码的计数器读数；不可用的计数器available为false
+    // 数值为double，方便按迭代次数求平均
+    struct PerfCounterValues {
+        std::array<double, kPerfCounterCount> values{};
+        std::array<bool, kPerfCounterCount> available{};
+        // 多个事件超过硬件寄存器数时内核会分时复用，读数已按运行时间比例放大
+        bool multiplexed = false;
+
+        bool valid() const {
+            for (bool a : available) {
+                if (a) return true;
+            }
+            return false;
+        }
+
+        bool has(PerfCounter counter) const {
+            return available[static_cast<size_t>(counter)];
+        }
+
+        double operator[](PerfCounter counter) const {
+            return values[static_cast<size_t>(counter)];
+        }
+
+        // 每周期指令数
+        double ipc() const {
+            return has(PerfCounter::Cycles) && has(PerfCounter::Instructions) && (*this)[PerfCounter::Cycles] > 0
+                ? (*this)[PerfCounter::Instructions] / (*this)[PerfCounter::Cycles]
+                : 0.0;
+        }
+
+        PerfCounterValues& operator+=(const PerfCounterValues& other) {
+            for (size_t i = 0; i < kPerfCounterCount; ++i) {
+                values[i] += other.values[i];
+                available[i] = available[i] || other.available[i];
+            }
+            multiplexed = multiplexed || other.multiplexed;
+            return *this;
+        }
+
+        PerfCounterValues scaled(double factor) const {
+            PerfCounterValues result = *this;
+            for (double& v : result.values) v *= factor;
+            return result;
+        }
+    };
+
+    inline void print_counters(std::ostream& os, const PerfCounterValues& counters) {
+        if (!counters.valid()) return;
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::fixed << std::setprecision(1);
+        for (size_t i = 0; i < kPerfCounterCount; ++i) {
+            if (counters.available[i]) {
+                os << "  " << to_string(static_cast<PerfCounter>(i)) << " " << counters.values[i];
+            }
+        }
+        if (counters.has(PerfCounter::Cycles) && counters.has(PerfCounter::Instructions)) {
+            os << "  IPC " << std::setprecision(2) << counters.ipc();
+        }
+        if (counters.multiplexed) os << "  (multiplexed)";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    // 通过Linux perf_event_open读取的计数器组，只统计当前线程的用户态事件
+    //
+    // 所有事件放在同一个组里同时启停，读数对应同一段代码。容器、虚拟机或
+    // perf_event_paranoid限制下部分或全部事件无法打开，此时available()为false，
+    // start()/stop()变成空操作，调用方不需要区分平台。非Linux平台总是不可用。
+    class PerfCounterGroup {
+    private:
+        std::array<int, kPerfCounterCount> fds_;
+        std::array<std::uint64_t, kPerfCounterCount> ids_{};
+        int leader_ = -1;
+
+#if defined(__linux__)
+        static int open_event(std::uint32_t type, std::uint64_t config, int group_fd) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = group_fd == -1 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                               PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+        }
+
+        static std::uint64_t cache_config(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+            return cache | (op << 8) | (result << 16);
+        }
+#endif
+
+    public:
+        PerfCounterGroup() {
+            fds_.fill(-1);
+#if defined(__linux__)
+            struct EventSpec {
+                PerfCounter counter;
+                std::uint32_t type;
+                std::uint64_t config;
+            };
+            const EventSpec specs[] = {
+                {PerfCounter::Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PerfCounter::Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PerfCounter::L1DMisses, PERF_TYPE_HW_CACHE,
+                 cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+                {PerfCounter::LLCMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {PerfCounter::BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            };
+            // 第一个能打开的事件作为组长，其余事件加入它的组；个别事件不支持时跳过
+            for (const EventSpec& spec : specs) {
+                int fd = open_event(spec.type, spec.config, leader_);
+                if (fd < 0) continue;
+                size_t index = static_cast<size_t>(spec.counter);
+                fds_[index] = fd;
+                ioctl(fd, PERF_EVENT_IOC_ID, &ids_[index]);
+                if (leader_ == -1) leader_ = fd;
+            }
+#endif
+        }
+
+        ~PerfCounterGroup() {
+#if defined(__linux__)
+            for (int fd : fds_) {
+                if (fd >= 0) close(fd);
+            }
+#endif
+        }
+
+        PerfCounterGroup(const PerfCounterGroup&) = delete;
+        PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+        bool available() const {
+            return leader_ >= 0;
+        }
+
+        void start() {
+#if defined(__linux__)
+            if (leader_ < 0) return;
+            ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        // 停止计数并返回从start()以来的读数
+        PerfCounterValues stop() {
+            PerfCounterValues result;
+#if defined(__linux__)
+            if (leader_ < 0) return result;
+            ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            // 读取格式: nr, time_enabled, time_running, 然后nr组{value, id}
+            std::uint64_t buffer[3 + 2 * kPerfCounterCount] = {};
+            if (read(leader_, buffer, sizeof(buffer)) <= 0) return result;
+            std::uint64_t nr = buffer[0];
+            std::uint64_t enabled = buffer[1];
+            std::uint64_t running = buffer[2];
+            double scale = running > 0 ? static_cast<double>(enabled) / running : 0.0;
+            result.multiplexed = running < enabled;
+            for (std::uint64_t i = 0; i < nr && i < kPerfCounterCount; ++i) {
+                std::uint64_t value = buffer[3 + 2 * i];
+                std::uint64_t id = buffer[4 + 2 * i];
+                for (size_t c = 0; c < kPerfCounterCount; ++c) {
+                    if (fds_[c] >= 0 && ids_[c] == id) {
+                        result.values[c] = static_cast<double>(value) * scale;
+                        result.available[c] = running > 0;
+                    }
+                }
+            }
+#endif
+            return result;
+        }
+    };
+}
+
+#endif //CPP_LEARNING_DEMO_PERF_COUNTERS_H
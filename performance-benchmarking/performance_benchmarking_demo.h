@@ -7,71 +7,131 @@
 #include <string>
 #include <functional>
 #include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cstdlib>
+#include <memory>
+#include "benchmark_harness.h"
+#include "benchmark_report.h"
+#include "perf_counters.h"
 
 namespace performance_benchmarking_demo {
     // 高精度计时器类
+    // with_counters为true时同时读取硬件性能计数器(仅Linux，不可用时只计时)
     class Timer {
     private:
         std::chrono::high_resolution_clock::time_point start_time;
         std::string name;
         bool running;
+        std::unique_ptr<PerfCounterGroup> perf_group;
+        PerfCounterValues last_counters;
 
     public:
-        explicit Timer(const std::string& timer_name = "Timer") 
+        explicit Timer(const std::string& timer_name = "Timer", bool with_counters = false) 
             : name(timer_name), running(false) {
+            if (with_counters) {
+                perf_group = std::make_unique<PerfCounterGroup>();
+            }
             start();
         }
 
         void start() {
-            start_time = std::chrono::high_resolution_clock::now();
             running = true;
+            if (perf_group) perf_group->start();
+            start_time = std::chrono::high_resolution_clock::now();
         }
 
         double stop() {
             if (!running) return 0.0;
             
             auto end_time = std::chrono::high_resolution_clock::now();
+            if (perf_group) last_counters = perf_group->stop();
             auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time);
             running = false;
             return duration.count() / 1e9; // 转换为秒
         }
 
+        // 最近一次stop()时的计数器读数
+        const PerfCounterValues& counters() const {
+            return last_counters;
+        }
+
         void stop_and_print() {
             double elapsed = stop();
             std::cout << name << " took: " << std::fixed << std::setprecision(6) 
-                      << elapsed << " seconds" << std::endl;
+                      << elapsed << " seconds";
+            print_counters(std::cout, last_counters);
+            std::cout << std::endl;
         }
     };
 
-    // 基准测试函数
+    // 用统计基准测试执行器测量一个函数，返回结果的完整统计
+    template<typename Func, typename... Args>
+    BenchmarkStats benchmark(const std::string& name, Func&& func, Args&&... args) {
+        BenchmarkRunner runner;
+        return runner.run(name, [&]() -> decltype(auto) { return func(args...); });
+    }
+
+    // 基准测试函数：返回每次调用的中位数耗时(秒)
+    // iterations是每个样本迭代次数的上限，实际次数按样本时长自动校准
     template<typename Func, typename... Args>
     double benchmark_function(int iterations, Func&& func, Args&&... args) {
-        // 预热
-        for (int i = 0; i < 1000; ++i) {
-            func(args...);
-        }
+        BenchmarkOptions options;
+        options.max_iterations_per_sample = iterations > 0 ? static_cast<std::uint64_t>(iterations) : 1;
+        BenchmarkRunner runner(options);
+        auto stats = runner.run("benchmark", [&]() -> decltype(auto) { return func(args...); });
+        return stats.median_ns / 1e9;
+    }
 
-        Timer timer("Benchmark");
-        for (int i = 0; i < iterations; ++i) {
-            func(args...);
+    // 简单的性能比较函数：比较中位数，并用置信区间判断差异是否显著
+    // 传入report时两组结果同时记录下来，用于导出或与基线比较
+    template<typename Func1, typename Func2, typename... Args>
+    void compare_functions(BenchmarkReport* report,
+                          const std::string& name1, Func1&& func1, 
+                          const std::string& name2, Func2&& func2, 
+                          Args&&... args) {
+        auto stats1 = benchmark(name1, func1, args...);
+        auto stats2 = benchmark(name2, func2, args...);
+        
+        std::cout << "Performance comparison:" << std::endl;
+        print_stats(std::cout, stats1);
+        print_stats(std::cout, stats2);
+        bool overlap = stats1.ci_low_ns <= stats2.ci_high_ns && stats2.ci_low_ns <= stats1.ci_high_ns;
+        std::cout << "Median ratio (" << name1 << "/" << name2 << "): " << std::fixed << std::setprecision(3)
+                  << stats1.median_ns / stats2.median_ns
+                  << (overlap ? "  (置信区间重叠，差异不显著)" : "  (差异显著)") << std::endl;
+        if (report) {
+            report->add(std::move(stats1));
+            report->add(std::move(stats2));
         }
-        return timer.stop() / iterations; // 返回平均时间
     }
 
-    // 简单的性能比较函数
     template<typename Func1, typename Func2, typename... Args>
     void compare_functions(const std::string& name1, Func1&& func1, 
                           const std::string& name2, Func2&& func2, 
                           Args&&... args) {
-        const int iterations = 100000;
-        
-        double time1 = benchmark_function(iterations, func1, args...);
-        double time2 = benchmark_function(iterations, func2, args...);
-        
-        std::cout << "Performance comparison:" << std::endl;
-        std::cout << name1 << ": " << std::fixed << std::setprecision(9) << time1 << " seconds per call" << std::endl;
-        std::cout << name2 << ": " << std::fixed << std::setprecision(9) << time2 << " seconds per call" << std::endl;
-        std::cout << "Ratio (" << name1 << "/" << name2 << "): " << time1 / time2 << std::endl;
+        compare_functions(nullptr, name1, std::forward<Func1>(func1), name2, std::forward<Func2>(func2),
+                          std::forward<Args>(args)...);
+    }
+
+    // 导出结果并与基线比较
+    // CPP_LEARNING_BENCH_OUT: 结果文件路径(.json或.csv)
+    // CPP_LEARNING_BENCH_BASELINE: 之前保存的JSON结果，存在显著回归时打印REGRESSED
+    // 需要用退出码卡住合并时，用bench_compare比较两个JSON文件
+    inline void export_report(const BenchmarkReport& report) {
+        try {
+            if (const char* out = std::getenv("CPP_LEARNING_BENCH_OUT")) {
+                report.save(out);
+                std::cout << "结果已写入 " << out << std::endl;
+            }
+            if (const char* baseline_path = std::getenv("CPP_LEARNING_BENCH_BASELINE")) {
+                std::cout << "\n与基线 " << baseline_path << " 比较:" << std::endl;
+                print_comparison(std::cout, compare_reports(BenchmarkReport::load(baseline_path), report));
+            }
+        } catch (const std::exception& e) {
+            std::cout << "导出基准测试结果失败: " << e.what() << std::endl;
+        }
     }
 
     // 示例函数1: 向量操作
@@ -80,6 +140,9 @@ namespace performance_benchmarking_demo {
         for (int i = 0; i < size; ++i) {
             v.push_back(i);
         }
+        // 让编译器认为结果被使用，避免整个循环被优化掉
+        do_not_optimize(v.data());
+        clobber_memory();
     }
 
     // 示例函数2: 预分配向量操作
@@ -89,6 +152,9 @@ namespace performance_benchmarking_demo {
         for (int i = 0; i < size; ++i) {
             v.push_back(i);
         }
+        // 让编译器认为结果被使用，避免整个循环被优化掉
+        do_not_optimize(v.data());
+        clobber_memory();
     }
 
     // 运行演示
@@ -101,9 +167,12 @@ namespace performance_benchmarking_demo {
             std::vector<int> v(1000000, 42);
         }
         
+        BenchmarkReport report;
+
         // 函数性能比较
         std::cout << "\n比较vector操作性能:" << std::endl;
         compare_functions(
+            &report,
             "push_back without reserve", vector_push_back_test,
             "push_back with reserve", vector_reserve_test,
             10000
@@ -116,12 +185,80 @@ namespace performance_benchmarking_demo {
             int x = 0;
             for (int i = 0; i < 100; ++i) {
                 x += i;
+                do_not_optimize(x);
             }
+            return x;
         };
         
-        double avg_time = benchmark_function(iterations, lambda_test);
-        std::cout << "Lambda test average time: " << std::fixed << std::setprecision(9) 
-                  << avg_time << " seconds per call" << std::endl;
+        double median_time = benchmark_function(iterations, lambda_test);
+        std::cout << "Lambda test median time: " << std::fixed << std::setprecision(9) 
+                  << median_time << " seconds per call" << std::endl;
+
+        // 带setup/teardown的基准测试：打乱数据不计入排序耗时
+        std::cout << "\n排除准备工作的基准测试:" << std::endl;
+        std::vector<int> source(10000);
+        std::iota(source.begin(), source.end(), 0);
+        std::mt19937 rng(42);
+        BenchmarkRunner runner;
+        auto sort_stats = runner.run_with_setup(
+            "std::sort 10000 shuffled ints",
+            [&]() {
+                std::vector<int> data = source;
+                std::shuffle(data.begin(), data.end(), rng);
+                return data;
+            },
+            [](std::vector<int>& data) {
+                std::sort(data.begin(), data.end());
+                do_not_optimize(data.data());
+            },
+            [](std::vector<int>&) {});
+        print_stats(std::cout, sort_stats);
+        report.add(std::move(sort_stats));
+
+        // 参数扫描：不同数据规模和元素类型下的求和耗时，构造数据不计时
+        std::cout << "\n参数扫描(std::accumulate):" << std::endl;
+        BenchmarkOptions sweep_options;
+        sweep_options.samples = 10;
+        sweep_options.min_sample_time = std::chrono::milliseconds(2);
+        BenchmarkRunner sweep_runner(sweep_options);
+        for_each_type<int, double>([&](auto tag) {
+            using T = typename decltype(tag)::type;
+            std::string type_name = std::is_same_v<T, int> ? "int" : "double";
+            auto results = sweep_runner.run_sweep("accumulate<" + type_name + ">", power_of_two_range(10, 20, 2),
+                [](std::size_t n) {
+                    return [data = std::vector<T>(n, T(1))] {
+                        return std::accumulate(data.begin(), data.end(), T(0));
+                    };
+                });
+            for (auto& stats : results) {
+                print_stats(std::cout, stats);
+                report.add(std::move(stats));
+            }
+        });
+
+        // 硬件性能计数器：区分耗时变化来自指令数、缓存未命中还是分支预测失败
+        std::cout << "\n硬件性能计数器:" << std::endl;
+        if (PerfCounterGroup().available()) {
+            Timer counted("Sum 1M ints", true);
+            std::vector<int> values(1000000, 1);
+            long long sum = std::accumulate(values.begin(), values.end(), 0LL);
+            do_not_optimize(sum);
+            counted.stop_and_print();
+
+            BenchmarkOptions counter_options;
+            counter_options.perf_counters = true;
+            auto counted_stats = BenchmarkRunner(counter_options).run("push_back with reserve (counters)",
+                                                                      [] { vector_reserve_test(10000); });
+            print_stats(std::cout, counted_stats);
+            report.add(std::move(counted_stats));
+        } else {
+            std::cout << "当前环境无法读取硬件计数器(非Linux、容器/虚拟机或perf_event_paranoid限制)，只报告时间" << std::endl;
+        }
+
+        // 机器可读的输出
+        std::cout << "\nCSV格式结果:" << std::endl;
+        report.write_csv(std::cout);
+        export_report(report);
     }
 }
 
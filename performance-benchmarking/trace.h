@@ -0,0 +1,399 @@
+#ifndef CPP_LEARNING_DEMO_TRACE_H
+#define CPP_LEARNING_DEMO_TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// 热路径追踪
+//
+// 默认关闭：TRACE_*宏展开为空语句，不产生任何代码和数据。
+// 编译时定义CPP_LEARNING_ENABLE_TRACING=1(CMake选项同名)后开启。
+//
+// 每个线程把事件写入自己的环形缓冲区，写入只涉及线程局部数据和几次release存储，
+// 时间戳直接读取TSC，单个事件的记录开销在几十纳秒以内。缓冲区写满后覆盖最旧的事件。
+// flush时把所有线程的事件导出为Chrome Trace Event JSON，可在chrome://tracing或
+// https://ui.perfetto.dev 中打开。
+//
+// 线程退出后它的缓冲区留给之后的新线程复用，缓冲区总数不随线程的创建和退出增长。
+//
+// 事件名必须是字符串字面量或生命周期覆盖到导出为止的静态字符串，记录时只保存指针。
+namespace performance_benchmarking_demo {
+    // 追踪时间戳：x86上为TSC，aarch64上为虚拟计数器，其他平台退化为steady_clock纳秒
+    inline std::uint64_t trace_ticks() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    struct TraceEvent {
+        enum class Phase : char { Begin = 'B', End = 'E', Complete = 'X', Instant = 'i' };
+
+        const char* name;
+        std::uint64_t start;     // 时间戳(tick)
+        std::uint64_t duration;  // 仅Complete事件使用(tick)
+        Phase phase;
+    };
+
+    // 单个线程的事件缓冲区：只有所属线程写入，导出线程可以同时读取。
+    // 每个槽位是一个小的顺序锁：写入前序号置为奇数，写完置为2 * (下标 + 1)。读取方前后两次
+    // 读到的序号不是期望值时，说明槽位正在被改写或已被覆盖，这个事件被丢弃而不是导出撕裂的数据
+    class TraceBuffer {
+    private:
+        struct Slot {
+            std::atomic<std::uint64_t> sequence{0};
+            std::atomic<const char*> name{nullptr};
+            std::atomic<std::uint64_t> start{0};
+            std::atomic<std::uint64_t> duration{0};
+            std::atomic<TraceEvent::Phase> phase{TraceEvent::Phase::Instant};
+        };
+
+        std::unique_ptr<Slot[]> slots_;
+        std::size_t capacity_;
+        std::size_t mask_;
+        std::atomic<std::uint64_t> head_{0};
+        // clear()之后从这个下标开始导出；写入方从不修改它
+        std::atomic<std::uint64_t> first_{0};
+        // 线程id和名字可能在缓冲区被新线程复用时改变
+        mutable std::mutex identity_mutex_;
+        std::uint32_t thread_id_;
+        std::string thread_name_;
+
+        bool read(std::uint64_t index, TraceEvent& event) const {
+            const Slot& slot = slots_[index & mask_];
+            const std::uint64_t expected = 2 * index + 2;
+            if (slot.sequence.load(std::memory_order_acquire) != expected) return false;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.start = slot.start.load(std::memory_order_relaxed);
+            event.duration = slot.duration.load(std::memory_order_relaxed);
+            event.phase = slot.phase.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.sequence.load(std::memory_order_relaxed) == expected;
+        }
+
+    public:
+        TraceBuffer(std::uint32_t thread_id, std::size_t capacity_pow2)
+            : slots_(std::make_unique<Slot[]>(capacity_pow2)), capacity_(capacity_pow2), mask_(capacity_pow2 - 1),
+              thread_id_(thread_id) {}
+
+        void record(const char* name, TraceEvent::Phase phase, std::uint64_t start, std::uint64_t duration = 0) {
+            std::uint64_t head = head_.load(std::memory_order_relaxed);
+            Slot& slot = slots_[head & mask_];
+            slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.name.store(name, std::memory_order_relaxed);
+            slot.start.store(start, std::memory_order_relaxed);
+            slot.duration.store(duration, std::memory_order_relaxed);
+            slot.phase.store(phase, std::memory_order_relaxed);
+            slot.sequence.store(2 * head + 2, std::memory_order_release);
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        void set_thread_name(std::string name) {
+            std::lock_guard<std::mutex> lock(identity_mutex_);
+            thread_name_ = std::move(name);
+        }
+
+        std::string thread_name() const {
+            std::lock_guard<std::mutex> lock(identity_mutex_);
+            return thread_name_;
+        }
+
+        std::uint32_t thread_id() const {
+            std::lock_guard<std::mutex> lock(identity_mutex_);
+            return thread_id_;
+        }
+
+        std::size_t capacity() const {
+            return capacity_;
+        }
+
+        // 交给新线程：丢弃旧线程的事件，换成新的线程id。由新线程在第一次写入之前调用
+        void reset(std::uint32_t thread_id) {
+            std::lock_guard<std::mutex> lock(identity_mutex_);
+            thread_id_ = thread_id;
+            thread_name_.clear();
+            first_.store(head_.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        struct Snapshot {
+            std::uint32_t thread_id;
+            std::string thread_name;
+            std::vector<TraceEvent> events;
+        };
+
+        // 复制线程信息和仍在缓冲区中的事件(按时间先后)，三者属于同一个线程。可以和写入线程并发调用：
+        // 正在被改写或已被覆盖的槽位直接跳过，所以线程仍在写入时最旧的几个事件可能缺失
+        Snapshot snapshot_thread() const {
+            Snapshot result;
+            std::uint64_t first;
+            std::uint64_t head;
+            {
+                std::lock_guard<std::mutex> lock(identity_mutex_);
+                result.thread_id = thread_id_;
+                result.thread_name = thread_name_;
+                first = first_.load(std::memory_order_acquire);
+                head = head_.load(std::memory_order_acquire);
+            }
+            first = std::max<std::uint64_t>(first, head > capacity_ ? head - capacity_ : 0);
+            result.events.reserve(head - first);
+            TraceEvent event;
+            for (std::uint64_t i = first; i < head; ++i) {
+                if (read(i, event)) result.events.push_back(event);
+            }
+            return result;
+        }
+
+        std::vector<TraceEvent> snapshot() const {
+            return snapshot_thread().events;
+        }
+
+        // 被覆盖丢失的事件数
+        std::uint64_t dropped() const {
+            std::uint64_t head = head_.load(std::memory_order_acquire);
+            std::uint64_t recorded = head - std::min(head, first_.load(std::memory_order_acquire));
+            return recorded > capacity_ ? recorded - capacity_ : 0;
+        }
+
+        // 丢弃已记录的事件；写入线程不受影响，可以随时调用
+        void clear() {
+            first_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    };
+
+    // 全局追踪器：登记各线程的缓冲区并负责导出
+    class Tracer {
+    private:
+        std::mutex mutex_;
+        // 缓冲区由tracer持有，线程退出后事件仍然可以导出，直到缓冲区被新线程复用
+        std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+        // 线程已经退出的缓冲区，新线程优先复用，缓冲区总数不超过同时记录过事件的线程数
+        std::vector<TraceBuffer*> retired_;
+        std::uint32_t next_thread_id_ = 1;
+        std::size_t capacity_ = 1 << 16;
+        // 进程启动时的tick与steady_clock对照点，用来把tick换算为微秒
+        std::uint64_t origin_ticks_;
+        std::chrono::steady_clock::time_point origin_time_;
+
+        Tracer() : origin_ticks_(trace_ticks()), origin_time_(std::chrono::steady_clock::now()) {}
+
+        // 用导出时的对照点计算tick频率，不需要在启动时睡眠校准
+        double ticks_per_us() {
+            std::uint64_t ticks = trace_ticks();
+            auto now = std::chrono::steady_clock::now();
+            double us = std::chrono::duration<double, std::micro>(now - origin_time_).count();
+            return us > 0 && ticks > origin_ticks_ ? (ticks - origin_ticks_) / us : 1000.0;
+        }
+
+        static void write_escaped(std::ostream& os, const std::string& s) {
+            for (char c : s) {
+                if (c == '"' || c == '\\') os << '\\';
+                if (static_cast<unsigned char>(c) >= 0x20) os << c;
+            }
+        }
+
+    public:
+        static Tracer& instance() {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        // 新线程的缓冲区容量(事件数，向上取整到2的幂)；只影响之后首次记录的线程
+        void set_buffer_capacity(std::size_t events) {
+            std::size_t capacity = 1;
+            while (capacity < events) capacity <<= 1;
+            std::lock_guard<std::mutex> lock(mutex_);
+            capacity_ = capacity;
+        }
+
+        // 线程退出时把缓冲区还给tracer；它的事件保留到被新线程复用为止
+        void retire(TraceBuffer* buffer) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retired_.push_back(buffer);
+        }
+
+        // 当前线程的缓冲区，首次调用时复用已退出线程的缓冲区或者登记一个新的
+        TraceBuffer& local_buffer() {
+            struct Local {
+                TraceBuffer* buffer = nullptr;
+                ~Local() {
+                    if (buffer) Tracer::instance().retire(buffer);
+                }
+            };
+            thread_local Local local;
+            if (!local.buffer) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                // 容量与当前设置不同的旧缓冲区不再复用，直接释放
+                std::erase_if(retired_, [this](TraceBuffer* stale) {
+                    if (stale->capacity() == capacity_) return false;
+                    std::erase_if(buffers_, [stale](const auto& buffer) { return buffer.get() == stale; });
+                    return true;
+                });
+                if (!retired_.empty()) {
+                    local.buffer = retired_.back();
+                    retired_.pop_back();
+                    local.buffer->reset(next_thread_id_++);
+                } else {
+                    buffers_.push_back(std::make_shared<TraceBuffer>(next_thread_id_++, capacity_));
+                    local.buffer = buffers_.back().get();
+                }
+            }
+            return *local.buffer;
+        }
+
+        // 登记的缓冲区数
+        std::size_t buffer_count() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return buffers_.size();
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& buffer : buffers_) buffer->clear();
+        }
+
+        std::uint64_t dropped_events() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::uint64_t total = 0;
+            for (auto& buffer : buffers_) total += buffer->dropped();
+            return total;
+        }
+
+        // 导出Chrome Trace Event JSON，返回导出的事件数
+        std::size_t write_chrome_trace(std::ostream& os) {
+            std::vector<std::shared_ptr<TraceBuffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffers = buffers_;
+            }
+            const double scale = ticks_per_us();
+            auto flags = os.flags();
+            auto precision = os.precision();
+            os << std::fixed << std::setprecision(3);
+            os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+            bool first = true;
+            std::size_t count = 0;
+            for (const auto& buffer : buffers) {
+                TraceBuffer::Snapshot thread = buffer->snapshot_thread();
+                if (!thread.thread_name.empty()) {
+                    os << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                       << thread.thread_id << ", \"args\": {\"name\": \"";
+                    write_escaped(os, thread.thread_name);
+                    os << "\"}}";
+                    first = false;
+                }
+                for (const TraceEvent& e : thread.events) {
+                    // 早于对照点的事件(理论上不存在)按0处理
+                    double ts = e.start > origin_ticks_ ? (e.start - origin_ticks_) / scale : 0.0;
+                    os << (first ? "\n" : ",\n") << "{\"name\": \"";
+                    write_escaped(os, e.name ? e.name : "");
+                    os << "\", \"ph\": \"" << static_cast<char>(e.phase) << "\", \"pid\": 1, \"tid\": "
+                       << thread.thread_id << ", \"ts\": " << ts;
+                    if (e.phase == TraceEvent::Phase::Complete) {
+                        os << ", \"dur\": " << e.duration / scale;
+                    } else if (e.phase == TraceEvent::Phase::Instant) {
+                        os << ", \"s\": \"t\"";
+                    }
+                    os << "}";
+                    first = false;
+                    ++count;
+                }
+            }
+            os << "\n]}\n";
+            os.flags(flags);
+            os.precision(precision);
+            return count;
+        }
+
+        std::size_t save_chrome_trace(const std::string& path) {
+            std::ofstream out(path);
+            if (!out) throw std::runtime_error("cannot open " + path + " for writing");
+            return write_chrome_trace(out);
+        }
+    };
+
+    // 作用域内的耗时记录为一个Complete事件
+    class TraceScope {
+    private:
+        const char* name_;
+        std::uint64_t start_;
+
+    public:
+        explicit TraceScope(const char* name) : name_(name), start_(trace_ticks()) {}
+
+        ~TraceScope() {
+            std::uint64_t end = trace_ticks();
+            Tracer::instance().local_buffer().record(name_, TraceEvent::Phase::Complete, start_, end - start_);
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    };
+
+    inline void trace_complete(const char* name, std::uint64_t start_ticks, std::uint64_t end_ticks) {
+        Tracer::instance().local_buffer().record(name, TraceEvent::Phase::Complete, start_ticks,
+                                                 end_ticks > start_ticks ? end_ticks - start_ticks : 0);
+    }
+
+    inline void trace_instant(const char* name) {
+        Tracer::instance().local_buffer().record(name, TraceEvent::Phase::Instant, trace_ticks());
+    }
+
+    inline void trace_begin(const char* name) {
+        Tracer::instance().local_buffer().record(name, TraceEvent::Phase::Begin, trace_ticks());
+    }
+
+    inline void trace_end(const char* name) {
+        Tracer::instance().local_buffer().record(name, TraceEvent::Phase::End, trace_ticks());
+    }
+}
+
+#define CPP_LEARNING_TRACE_CONCAT_INNER(a, b) a##b
+#define CPP_LEARNING_TRACE_CONCAT(a, b) CPP_LEARNING_TRACE_CONCAT_INNER(a, b)
+
+#if defined(CPP_LEARNING_ENABLE_TRACING) && CPP_LEARNING_ENABLE_TRACING
+#define TRACE_ENABLED 1
+#define TRACE_SCOPE(name) \
+    ::performance_benchmarking_demo::TraceScope CPP_LEARNING_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_BEGIN(name) ::performance_benchmarking_demo::trace_begin(name)
+#define TRACE_END(name) ::performance_benchmarking_demo::trace_end(name)
+#define TRACE_INSTANT(name) ::performance_benchmarking_demo::trace_instant(name)
+#define TRACE_COMPLETE(name, start_ticks, end_ticks) \
+    ::performance_benchmarking_demo::trace_complete(name, start_ticks, end_ticks)
+#define TRACE_THREAD_NAME(name) \
+    ::performance_benchmarking_demo::Tracer::instance().local_buffer().set_thread_name(name)
+#else
+#define TRACE_ENABLED 0
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_COMPLETE(name, start_ticks, end_ticks) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif //CPP_LEARNING_DEMO_TRACE_H
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "../meta-programming/coroutines/async_generator.h"
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include "../advanced-concurrency/thread_pool.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace coroutines_base;
+using advanced_concurrency_demo::ThreadPool;
+
+namespace {
+    // 每个元素之前切换一次线程池，模拟等待I/O的生产者
+    AsyncGenerator<int> numbers(ThreadPool& pool, int count, int& produced) {
+        for (int i = 0; i < count; ++i) {
+            co_await pool.schedule();
+            ++produced;
+            co_yield i;
+        }
+    }
+
+    AsyncGenerator<int> counting(int count, int& produced) {
+        for (int i = 0; i < count; ++i) {
+            ++produced;
+            co_yield i;
+        }
+    }
+
+    template<typename T>
+    Task<std::vector<std::remove_cvref_t<T>>> collect(AsyncGenerator<T> source) {
+        std::vector<std::remove_cvref_t<T>> out;
+        while (auto* item = co_await source.next()) out.push_back(*item);
+        co_return out;
+    }
+
+    template<typename T>
+    Task<std::vector<std::vector<int>>> collect_spans(AsyncGenerator<T> source) {
+        std::vector<std::vector<int>> out;
+        while (auto* span = co_await source.next()) out.emplace_back(span->begin(), span->end());
+        co_return out;
+    }
+}
+
+TEST(AsyncGeneratorTest, ProducerCanAwaitBetweenYields) {
+    ThreadPool pool(2);
+    int produced = 0;
+    auto values = sync_wait(collect(numbers(pool, 100, produced)));
+    ASSERT_EQ(values.size(), 100u);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(values[i], i);
+    EXPECT_EQ(produced, 100);
+}
+
+TEST(AsyncGeneratorTest, PullBasedBackpressure) {
+    int produced = 0;
+    auto consume_three = [](AsyncGenerator<int> source, int& seen_produced) -> Task<int> {
+        int sum = 0;
+        for (int i = 0; i < 3; ++i) {
+            int* item = co_await source.next();
+            sum += *item;
+            // 生产者最多比消费者多产出当前这一个元素
+            seen_produced = std::max(seen_produced, *item + 1);
+        }
+        co_return sum;
+    };
+    int seen = 0;
+    EXPECT_EQ(sync_wait(consume_three(counting(1000000, produced), seen)), 0 + 1 + 2);
+    EXPECT_EQ(produced, 3);
+    EXPECT_EQ(seen, 3);
+}
+
+TEST(AsyncGeneratorTest, StagesCompose) {
+    int produced = 0;
+    auto pipeline = batch(filter(map(counting(20, produced), [](int x) { return x * 3; }),
+                                 [](int x) { return x % 2 == 0; }),
+                          4);
+    auto batches = sync_wait(collect_spans(std::move(pipeline)));
+    // 偶数的3倍: 0 6 12 ... 54，共10个，分为4+4+2
+    ASSERT_EQ(batches.size(), 3u);
+    EXPECT_EQ(batches[0], (std::vector<int>{0, 6, 12, 18}));
+    EXPECT_EQ(batches[1], (std::vector<int>{24, 30, 36, 42}));
+    EXPECT_EQ(batches[2], (std::vector<int>{48, 54}));
+
+    auto windows = sync_wait(collect_spans(window(counting(7, produced), 3, 2)));
+    ASSERT_EQ(windows.size(), 3u);
+    EXPECT_EQ(windows[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(windows[1], (std::vector<int>{2, 3, 4}));
+    EXPECT_EQ(windows[2], (std::vector<int>{4, 5, 6}));
+}
+
+// 批大小、窗口大小或步长为0时在创建时抛出std::invalid_argument，不会读取上游
+TEST(AsyncGeneratorTest, RejectsZeroSizes) {
+    int produced = 0;
+    EXPECT_THROW(batch(counting(5, produced), 0), std::invalid_argument);
+    EXPECT_THROW(window(counting(5, produced), 0), std::invalid_argument);
+    EXPECT_THROW(window(counting(5, produced), 3, 0), std::invalid_argument);
+    EXPECT_EQ(produced, 0);
+
+    auto windows = sync_wait(collect_spans(window(counting(4, produced), 4, 1)));
+    ASSERT_EQ(windows.size(), 1u);
+    EXPECT_EQ(windows[0], (std::vector<int>{0, 1, 2, 3}));
+}
+
+// 产出const左值：元素类型非const时复制一份，消费者可以修改或移走副本；const引用类型按地址交出
+TEST(AsyncGeneratorTest, YieldsConstLvalues) {
+    const std::vector<std::string> lines{"alpha", "beta", "gamma"};
+    auto copies = [](const std::vector<std::string>& source) -> AsyncGenerator<std::string> {
+        for (const std::string& line : source) co_yield line;
+    };
+    auto take_all = [](AsyncGenerator<std::string> source) -> Task<std::vector<std::string>> {
+        std::vector<std::string> taken;
+        while (auto* line = co_await source.next()) taken.push_back(std::move(*line));
+        co_return taken;
+    };
+    EXPECT_EQ(sync_wait(take_all(copies(lines))), lines);
+    EXPECT_EQ(lines, (std::vector<std::string>{"alpha", "beta", "gamma"}));
+
+    auto views = [](const std::vector<std::string>& source) -> AsyncGenerator<const std::string&> {
+        for (const std::string& line : source) co_yield line;
+    };
+    auto addresses = [](AsyncGenerator<const std::string&> source) -> Task<std::vector<const std::string*>> {
+        std::vector<const std::string*> seen;
+        while (auto* line = co_await source.next()) seen.push_back(line);
+        co_return seen;
+    };
+    EXPECT_EQ(sync_wait(addresses(views(lines))),
+              (std::vector<const std::string*>{&lines[0], &lines[1], &lines[2]}));
+}
+
+TEST(AsyncGeneratorTest, MoveOnlyValuesAndExceptions) {
+    auto boxes = [](int count) -> AsyncGenerator<std::unique_ptr<int>> {
+        for (int i = 0; i < count; ++i) co_yield std::make_unique<int>(i);
+    };
+    auto take_all = [](AsyncGenerator<std::span<std::unique_ptr<int>>> source) -> Task<int> {
+        int sum = 0;
+        while (auto* group = co_await source.next()) {
+            for (auto& box : *group) sum += *box;
+        }
+        co_return sum;
+    };
+    EXPECT_EQ(sync_wait(take_all(batch(boxes(10), 3))), 45);
+
+    auto failing = []() -> AsyncGenerator<std::string> {
+        co_yield "first";
+        throw std::runtime_error("source failed");
+    };
+    auto drain = [](AsyncGenerator<std::string> source) -> Task<std::size_t> {
+        std::size_t count = 0;
+        while (co_await source.next()) ++count;
+        co_return count;
+    };
+    EXPECT_THROW(sync_wait(drain(failing())), std::runtime_error);
+}
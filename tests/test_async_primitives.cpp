@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "../meta-programming/coroutines/async_primitives.h"
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include "../advanced-concurrency/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace coroutines_base;
+using advanced_concurrency_demo::ThreadPool;
+
+namespace {
+    // 创建后立即运行的协程，用于在单线程中精确控制挂起顺序
+    struct Eager {
+        struct promise_type {
+            Eager get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    Eager lock_and_record(AsyncMutex& mutex, std::vector<int>& order, int id) {
+        auto guard = co_await mutex.scoped_lock();
+        order.push_back(id);
+    }
+
+    // 协程的局部变量位于协程帧中，栈的位置要在普通函数里取
+    [[gnu::noinline]] std::uintptr_t stack_position() {
+        volatile int marker = 0;
+        return reinterpret_cast<std::uintptr_t>(&marker);
+    }
+
+    // 记录恢复时调用栈的位置，用于比较交接链中每一环的栈深度
+    Eager lock_and_record_stack(AsyncMutex& mutex, std::vector<std::uintptr_t>& frames) {
+        auto guard = co_await mutex.scoped_lock();
+        frames.push_back(stack_position());
+    }
+
+    Task<void> increment_many(ThreadPool& pool, AsyncMutex& mutex, long& counter, int times) {
+        co_await pool.schedule();
+        for (int i = 0; i < times; ++i) {
+            co_await mutex.lock();
+            ++counter;
+            mutex.unlock();
+        }
+    }
+
+    Task<void> limited_work(ThreadPool& pool, AsyncSemaphore& semaphore, std::atomic<int>& running,
+                            std::atomic<int>& peak) {
+        co_await pool.schedule();
+        co_await semaphore.acquire();
+        int now = running.fetch_add(1) + 1;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        // 在持有许可期间换一个工作线程继续，让其他协程有机会竞争
+        co_await pool.schedule();
+        running.fetch_sub(1);
+        semaphore.release();
+    }
+
+    Task<void> produce(ThreadPool& pool, Channel<int>& channel, int first, int count) {
+        co_await pool.schedule();
+        for (int i = first; i < first + count; ++i) {
+            if (!co_await channel.send(i)) throw std::runtime_error("channel closed early");
+        }
+    }
+
+    Task<void> produce_then_close(ThreadPool& pool, Channel<int>& channel, int producers, int per_producer) {
+        std::vector<Task<void>> tasks;
+        for (int p = 0; p < producers; ++p) tasks.push_back(produce(pool, channel, p * per_producer, per_producer));
+        co_await when_all(std::move(tasks));
+        channel.close();
+    }
+
+    Task<void> consume(ThreadPool& pool, Channel<int>& channel, std::vector<int>& received) {
+        co_await pool.schedule();
+        while (auto value = co_await channel.recv()) received.push_back(*value);
+    }
+
+    Eager send_and_record(Channel<std::unique_ptr<int>>& channel, int value, std::vector<int>& sent) {
+        bool ok = co_await channel.send(std::make_unique<int>(value));
+        sent.push_back(ok ? value : -value);
+    }
+
+    Eager recv_and_record(Channel<std::unique_ptr<int>>& channel, std::vector<int>& received) {
+        auto value = co_await channel.recv();
+        received.push_back(value ? **value : 0);
+    }
+}
+
+// 等待者按到达顺序获得锁，恢复时已经持有锁
+TEST(AsyncPrimitivesTest, MutexHandsOffInFifoOrder) {
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.try_lock());
+    std::vector<int> order;
+    for (int id = 1; id <= 3; ++id) lock_and_record(mutex, order, id);
+    EXPECT_TRUE(order.empty());
+    EXPECT_FALSE(mutex.try_lock());
+
+    mutex.unlock();
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+// 被唤醒的等待者在恢复队列中依次恢复：一长串交接不会让调用栈逐环加深
+TEST(AsyncPrimitivesTest, MutexHandoffChainKeepsStackFlat) {
+    constexpr int kWaiters = 10000;
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.try_lock());
+    std::vector<std::uintptr_t> frames;
+    for (int i = 0; i < kWaiters; ++i) lock_and_record_stack(mutex, frames);
+
+    mutex.unlock();
+    ASSERT_EQ(frames.size(), static_cast<std::size_t>(kWaiters));
+    auto [low, high] = std::minmax_element(frames.begin(), frames.end());
+    EXPECT_LT(*high - *low, 4096u);
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST(AsyncPrimitivesTest, MutexSerializesCoroutinesOnThreadPool) {
+    ThreadPool pool(4);
+    AsyncMutex mutex;
+    long counter = 0;
+    std::vector<Task<void>> tasks;
+    for (int i = 0; i < 50; ++i) tasks.push_back(increment_many(pool, mutex, counter, 1000));
+    sync_wait(when_all(std::move(tasks)));
+    EXPECT_EQ(counter, 50 * 1000);
+}
+
+TEST(AsyncPrimitivesTest, SemaphoreLimitsConcurrency) {
+    ThreadPool pool(4);
+    AsyncSemaphore semaphore(3);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::vector<Task<void>> tasks;
+    for (int i = 0; i < 200; ++i) tasks.push_back(limited_work(pool, semaphore, running, peak));
+    sync_wait(when_all(std::move(tasks)));
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_GE(peak.load(), 1);
+    EXPECT_EQ(semaphore.available(), 3);
+}
+
+// 多个生产者和消费者：每个元素恰好被接收一次，关闭后消费者退出
+TEST(AsyncPrimitivesTest, ChannelDeliversEveryValueOnce) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 2000;
+    constexpr int kConsumers = 3;
+    ThreadPool pool(4);
+    Channel<int> channel(8);
+    std::vector<std::vector<int>> received(kConsumers);
+
+    std::vector<Task<void>> tasks;
+    tasks.push_back(produce_then_close(pool, channel, kProducers, kPerProducer));
+    for (auto& out : received) tasks.push_back(consume(pool, channel, out));
+    sync_wait(when_all(std::move(tasks)));
+
+    std::vector<int> all;
+    for (const auto& out : received) all.insert(all.end(), out.begin(), out.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), static_cast<std::size_t>(kProducers * kPerProducer));
+    for (int i = 0; i < kProducers * kPerProducer; ++i) EXPECT_EQ(all[i], i);
+}
+
+// 容量为0时发送者一直挂起到接收者取走元素；关闭时挂起的一方被唤醒
+TEST(AsyncPrimitivesTest, ChannelRendezvousAndClose) {
+    Channel<std::unique_ptr<int>> channel(0);
+    std::vector<int> sent;
+    std::vector<int> received;
+
+    send_and_record(channel, 1, sent);
+    send_and_record(channel, 2, sent);
+    EXPECT_TRUE(sent.empty());
+    recv_and_record(channel, received);
+    EXPECT_EQ(sent, (std::vector<int>{1}));
+    EXPECT_EQ(received, (std::vector<int>{1}));
+
+    recv_and_record(channel, received);
+    EXPECT_EQ(received, (std::vector<int>{1, 2}));
+    EXPECT_EQ(sent, (std::vector<int>{1, 2}));
+
+    // 接收者先到：发送者把元素直接交给它
+    recv_and_record(channel, received);
+    send_and_record(channel, 3, sent);
+    EXPECT_EQ(received, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(sent, (std::vector<int>{1, 2, 3}));
+
+    recv_and_record(channel, received);
+    channel.close();
+    EXPECT_EQ(received, (std::vector<int>{1, 2, 3, 0}));
+    send_and_record(channel, 4, sent);
+    EXPECT_EQ(sent, (std::vector<int>{1, 2, 3, -4}));
+}
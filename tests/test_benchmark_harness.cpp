@@ -0,0 +1,443 @@
+#include <gtest/gtest.h>
+#include "../performance-benchmarking/benchmark_harness.h"
+#include "../performance-benchmarking/benchmark_registry.h"
+#include "../performance-benchmarking/benchmark_report.h"
+#include "../performance-benchmarking/perf_counters.h"
+#include "../performance-benchmarking/trace.h"
+// 测试程序中只有这个文件安装分配钩子
+#include "../performance-benchmarking/allocation_hooks.h"
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+
+using namespace performance_benchmarking_demo;
+
+// 测试统计量的计算
+TEST(BenchmarkHarnessTest, ComputeStats) {
+    std::vector<double> samples = {5, 1, 4, 2, 3};
+    auto stats = compute_stats("basic", samples);
+    EXPECT_EQ(stats.samples, 5u);
+    EXPECT_DOUBLE_EQ(stats.min_ns, 1.0);
+    EXPECT_DOUBLE_EQ(stats.max_ns, 5.0);
+    EXPECT_DOUBLE_EQ(stats.mean_ns, 3.0);
+    EXPECT_DOUBLE_EQ(stats.median_ns, 3.0);
+    EXPECT_NEAR(stats.stddev_ns, 1.5811, 1e-3);
+    // t(0.975, 4) = 2.776
+    EXPECT_NEAR(stats.ci_high_ns - stats.mean_ns, 2.776 * 1.5811 / std::sqrt(5.0), 1e-3);
+    EXPECT_DOUBLE_EQ(stats.mean_ns - stats.ci_low_ns, stats.ci_high_ns - stats.mean_ns);
+    EXPECT_EQ(stats.outliers_low + stats.outliers_high, 0u);
+}
+
+// 测试分位数和离群值判定
+TEST(BenchmarkHarnessTest, PercentilesAndOutliers) {
+    std::vector<double> samples;
+    for (int i = 1; i <= 100; ++i) samples.push_back(i);
+    samples.push_back(10000);
+    auto stats = compute_stats("outliers", samples);
+    EXPECT_DOUBLE_EQ(stats.median_ns, 51.0);
+    EXPECT_NEAR(stats.p90_ns, 91.0, 1e-9);
+    EXPECT_EQ(stats.outliers_high, 1u);
+    EXPECT_EQ(stats.outliers_low, 0u);
+    // 中位数不受离群值影响，均值会被拉高
+    EXPECT_GT(stats.mean_ns, stats.median_ns);
+}
+
+// 测试迭代次数校准和setup不计入耗时
+TEST(BenchmarkHarnessTest, RunnerCalibratesAndExcludesSetup) {
+    BenchmarkOptions options;
+    options.min_sample_time = std::chrono::milliseconds(1);
+    options.warmup_time = std::chrono::milliseconds(1);
+    options.samples = 5;
+    BenchmarkRunner runner(options);
+
+    auto cheap = runner.run("cheap", [] {
+        int x = 1;
+        do_not_optimize(x);
+        return x;
+    });
+    EXPECT_EQ(cheap.samples, 5u);
+    EXPECT_GT(cheap.iterations_per_sample, 100u);
+
+    // setup耗时约200微秒，被测部分几乎为空
+    auto with_setup = runner.run_with_setup(
+        "setup",
+        [] {
+            auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+            while (std::chrono::steady_clock::now() < end) {}
+            return 0;
+        },
+        [](int& v) { do_not_optimize(v); },
+        [](int&) {});
+    EXPECT_LT(with_setup.median_ns, 50000.0);
+}
+
+// 测试JSON结果可以读回并保留原始样本
+TEST(BenchmarkReportTest, JsonRoundTrip) {
+    BenchmarkReport report(BenchmarkMetadata{"gcc", "-O2", "cpu \"x\"", "abc123", "2024-01-01T00:00:00Z"});
+    report.add(compute_stats("sort, small", {3.0, 1.0, 2.0}, 100));
+
+    std::ostringstream json;
+    report.write_json(json);
+    auto loaded = BenchmarkReport::from_json(json.str());
+    EXPECT_EQ(loaded.metadata().cpu_model, "cpu \"x\"");
+    EXPECT_EQ(loaded.metadata().git_sha, "abc123");
+    ASSERT_EQ(loaded.results().size(), 1u);
+    const BenchmarkStats* stats = loaded.find("sort, small");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->iterations_per_sample, 100u);
+    EXPECT_DOUBLE_EQ(stats->median_ns, 2.0);
+    EXPECT_EQ(stats->sample_ns.size(), 3u);
+
+    std::ostringstream csv;
+    report.write_csv(csv);
+    EXPECT_NE(csv.str().find("\"sort, small\",3,100"), std::string::npos);
+
+    EXPECT_THROW(BenchmarkReport::from_json("{\"benchmarks\": [}"), std::runtime_error);
+
+    // JSON中没有NaN：不是有限值的数字写成null，读回时当作缺失
+    BenchmarkStats undefined = compute_stats("one sample", {5.0});
+    undefined.stddev_ns = std::numeric_limits<double>::quiet_NaN();
+    undefined.ci_high_ns = std::numeric_limits<double>::infinity();
+    BenchmarkReport partial(BenchmarkMetadata{});
+    partial.add(undefined);
+    std::ostringstream with_nan;
+    partial.write_json(with_nan);
+    EXPECT_EQ(with_nan.str().find("nan"), std::string::npos);
+    EXPECT_EQ(with_nan.str().find("inf"), std::string::npos);
+    EXPECT_NE(with_nan.str().find("\"stddev_ns\": null"), std::string::npos);
+    EXPECT_NO_THROW(BenchmarkReport::from_json(with_nan.str()));
+}
+
+// 测试只有显著且超过阈值的变化才判定为回归
+TEST(BenchmarkReportTest, DetectsRegressions) {
+    std::vector<double> base, same, slower;
+    for (int i = 0; i < 20; ++i) {
+        base.push_back(100.0 + i % 5);
+        same.push_back(101.0 + i % 5);
+        slower.push_back(130.0 + i % 5);
+    }
+    BenchmarkMetadata metadata;
+    BenchmarkReport baseline(metadata), current(metadata);
+    baseline.add(compute_stats("stable", base));
+    baseline.add(compute_stats("slow", base));
+    baseline.add(compute_stats("gone", base));
+    current.add(compute_stats("stable", same));
+    current.add(compute_stats("slow", slower));
+    current.add(compute_stats("new", base));
+
+    EXPECT_LT(mann_whitney_p_value(base, slower), 0.001);
+    EXPECT_GT(mann_whitney_p_value(base, base), 0.5);
+
+    auto comparisons = compare_reports(baseline, current);
+    ASSERT_EQ(comparisons.size(), 4u);
+    using Verdict = BaselineComparison::Verdict;
+    EXPECT_EQ(comparisons[0].verdict, Verdict::Unchanged);
+    EXPECT_EQ(comparisons[1].verdict, Verdict::Regressed);
+    EXPECT_EQ(comparisons[2].verdict, Verdict::Added);
+    EXPECT_EQ(comparisons[3].verdict, Verdict::Removed);
+
+    std::ostringstream out;
+    EXPECT_EQ(print_comparison(out, comparisons), 1);
+}
+
+// 测试硬件计数器不可用时安静地退化为只计时
+TEST(PerfCounterTest, FallsBackWhenUnavailable) {
+    PerfCounterGroup group;
+    group.start();
+    auto values = group.stop();
+    EXPECT_EQ(values.valid(), group.available());
+
+    BenchmarkOptions options;
+    options.min_sample_time = std::chrono::microseconds(200);
+    options.warmup_time = std::chrono::microseconds(0);
+    options.samples = 3;
+    options.perf_counters = true;
+    auto stats = BenchmarkRunner(options).run("counted", [] { return 1; });
+    EXPECT_EQ(stats.samples, 3u);
+    EXPECT_EQ(stats.counters.valid(), group.available());
+
+    PerfCounterValues a;
+    a.values[static_cast<size_t>(PerfCounter::Cycles)] = 200;
+    a.values[static_cast<size_t>(PerfCounter::Instructions)] = 300;
+    a.available[static_cast<size_t>(PerfCounter::Cycles)] = true;
+    a.available[static_cast<size_t>(PerfCounter::Instructions)] = true;
+    a += a;
+    EXPECT_DOUBLE_EQ(a.scaled(0.5)[PerfCounter::Cycles], 200.0);
+    EXPECT_DOUBLE_EQ(a.ipc(), 1.5);
+}
+
+// 测试环形缓冲区覆盖最旧事件，以及Chrome trace导出格式
+TEST(TraceTest, RingBufferAndChromeExport) {
+    TraceBuffer buffer(7, 4);
+    for (std::uint64_t i = 0; i < 6; ++i) {
+        buffer.record("e", TraceEvent::Phase::Instant, i);
+    }
+    auto events = buffer.snapshot();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events.front().start, 2u);
+    EXPECT_EQ(events.back().start, 5u);
+    EXPECT_EQ(buffer.dropped(), 2u);
+
+    Tracer& tracer = Tracer::instance();
+    tracer.clear();
+    std::thread worker([] {
+        {
+            TraceScope scope("worker scope");
+        }
+        trace_instant("worker instant");
+        Tracer::instance().local_buffer().set_thread_name("test \"worker\"");
+    });
+    worker.join();
+
+    std::ostringstream out;
+    EXPECT_GE(tracer.write_chrome_trace(out), 2u);
+    auto root = report_detail::JsonParser(out.str()).parse();
+    const auto* trace_events = root.find("traceEvents");
+    ASSERT_NE(trace_events, nullptr);
+    bool found_scope = false, found_name = false;
+    for (const auto& e : trace_events->array) {
+        if (e.string_or("name", "") == "worker scope") {
+            found_scope = true;
+            EXPECT_EQ(e.string_or("ph", ""), "X");
+            EXPECT_GE(e.number_or("dur", -1), 0.0);
+        }
+        if (e.string_or("ph", "") == "M") {
+            const auto* args = e.find("args");
+            found_name = found_name || (args && args->string_or("name", "") == "test \"worker\"");
+        }
+    }
+    EXPECT_TRUE(found_scope);
+    EXPECT_TRUE(found_name);
+}
+
+// 测试导出与写入线程并发时只得到完整的事件，清空不影响写入；退出线程的缓冲区被新线程复用
+TEST(TraceTest, ConcurrentSnapshotAndBufferReuse) {
+    TraceBuffer buffer(1, 64);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint64_t i = 0; i < 200000; ++i) {
+            buffer.record("w", TraceEvent::Phase::Complete, i, i * 2);
+        }
+        done = true;
+    });
+    std::size_t snapshots = 0;
+    std::size_t torn = 0;
+    while (!done) {
+        for (const TraceEvent& e : buffer.snapshot()) {
+            if (e.duration != e.start * 2 || e.phase != TraceEvent::Phase::Complete) ++torn;
+        }
+        if (++snapshots % 16 == 0) buffer.clear();
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0u);
+    buffer.clear();
+    EXPECT_TRUE(buffer.snapshot().empty());
+    EXPECT_EQ(buffer.dropped(), 0u);
+
+    Tracer& tracer = Tracer::instance();
+    std::thread([] { trace_instant("first thread"); }).join();
+    const std::size_t buffers = tracer.buffer_count();
+    std::uint32_t reused_id = 0;
+    std::thread([&reused_id] {
+        trace_instant("second thread");
+        reused_id = Tracer::instance().local_buffer().thread_id();
+    }).join();
+    EXPECT_EQ(tracer.buffer_count(), buffers);
+
+    std::ostringstream out;
+    tracer.write_chrome_trace(out);
+    auto root = report_detail::JsonParser(out.str()).parse();
+    bool found_first = false, found_second = false;
+    for (const auto& e : root.find("traceEvents")->array) {
+        found_first = found_first || e.string_or("name", "") == "first thread";
+        if (e.string_or("name", "") == "second thread") {
+            found_second = true;
+            EXPECT_EQ(e.number_or("tid", 0), static_cast<double>(reused_id));
+        }
+    }
+    EXPECT_FALSE(found_first);
+    EXPECT_TRUE(found_second);
+}
+
+// 测试参数扫描和按类型扫描
+TEST(BenchmarkFixtureTest, SweepsParametersAndTypes) {
+    EXPECT_EQ(power_of_two_range(10, 14, 2), (std::vector<std::size_t>{1024, 4096, 16384}));
+
+    BenchmarkOptions options;
+    options.min_sample_time = std::chrono::microseconds(200);
+    options.warmup_time = std::chrono::microseconds(0);
+    options.samples = 3;
+    BenchmarkRunner runner(options);
+
+    std::vector<std::size_t> constructed;
+    auto results = runner.run_sweep("sum", std::vector<std::size_t>{16, 256}, [&](std::size_t n) {
+        constructed.push_back(n);
+        return [data = std::vector<int>(n, 1)] { return std::accumulate(data.begin(), data.end(), 0); };
+    });
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].name, "sum/16");
+    EXPECT_EQ(results[1].name, "sum/256");
+    EXPECT_EQ(constructed, (std::vector<std::size_t>{16, 256}));
+
+    std::vector<std::size_t> sizes;
+    for_each_type<char, int, double>([&](auto tag) { sizes.push_back(sizeof(typename decltype(tag)::type)); });
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{1, sizeof(int), sizeof(double)}));
+}
+
+// 测试多线程基准测试：每个线程都参与，并给出逐线程和汇总结果
+TEST(BenchmarkFixtureTest, RunsAcrossThreads) {
+    BenchmarkOptions options;
+    options.min_sample_time = std::chrono::microseconds(500);
+    options.warmup_time = std::chrono::microseconds(0);
+    options.samples = 4;
+    BenchmarkRunner runner(options);
+
+    // 每个线程在第一次调用时登记自己(按调用计数抽样可能在单核上漏掉某个线程)
+    std::mutex mutex;
+    std::set<std::thread::id> seen;
+    auto stats = runner.run_threads("counter", 3, [&](size_t index) {
+        thread_local bool recorded = false;
+        if (!recorded) {
+            recorded = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            seen.insert(std::this_thread::get_id());
+        }
+        return index;
+    });
+    EXPECT_EQ(stats.threads, 3u);
+    ASSERT_EQ(stats.per_thread.size(), 3u);
+    EXPECT_EQ(stats.aggregate.samples, 4u);
+    EXPECT_EQ(stats.aggregate.name, "counter/threads:3");
+    EXPECT_GT(stats.ops_per_second(), 0.0);
+    EXPECT_EQ(seen.size(), 3u);
+}
+
+// 测试重复执行的多线程基准测试在报告中合并为一条结果，样本来自所有重复
+TEST(BenchmarkFixtureTest, MergesRepeatedThreadedRuns) {
+    BenchmarkConfig config;
+    config.options.min_sample_time = std::chrono::microseconds(200);
+    config.options.warmup_time = std::chrono::microseconds(0);
+    config.options.samples = 2;
+    config.repetitions = 3;
+    BenchmarkReport report;
+    std::ostringstream out;
+    BenchmarkContext context(config, report, out);
+
+    context.run_threads("counter", 2, [](size_t index) { return index; });
+    context.run("single", [] { return 1; });
+    ASSERT_EQ(report.results().size(), 2u);
+    EXPECT_EQ(report.results()[0].name, "counter/threads:2");
+    EXPECT_EQ(report.results()[0].samples, 6u);
+    EXPECT_EQ(report.results()[1].name, "single");
+    EXPECT_EQ(report.results()[1].samples, 6u);
+    EXPECT_NE(out.str().find("counter/threads:2/repeat:2"), std::string::npos);
+}
+
+#if defined(__linux__)
+namespace {
+    int allowed_cpus() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        return CPU_COUNT(&set);
+    }
+}
+
+// 测试--cpu只在单线程测量期间固定测量线程：结束后恢复原来的掩码，unpinned()和run_threads不固定
+TEST(BenchmarkFixtureTest, PinsOnlySingleThreadedMeasurements) {
+    cpu_set_t original;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(original), &original), 0);
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &original)) ++cpu;
+    const int all = allowed_cpus();
+
+    BenchmarkConfig config;
+    config.options.min_sample_time = std::chrono::microseconds(200);
+    config.options.warmup_time = std::chrono::microseconds(0);
+    config.options.samples = 2;
+    config.cpu = cpu;
+    BenchmarkReport report;
+    std::ostringstream out;
+    BenchmarkContext context(config, report, out);
+
+    std::atomic<int> pinned_run{0}, spawned{0}, unpinned_run{0}, threaded{0};
+    context.run("pinned", [&] {
+        pinned_run = allowed_cpus();
+        do_not_optimize(sched_getcpu());
+    });
+    context.run_sweep("spawn", std::vector<int>{1}, [&](int) {
+        return [&] { std::thread([&] { spawned = allowed_cpus(); }).join(); };
+    });
+    {
+        auto unpinned = context.unpinned();
+        context.run("unpinned", [&] { unpinned_run = allowed_cpus(); });
+    }
+    context.run_threads("threads", 2, [&](size_t) { threaded = allowed_cpus(); });
+
+    EXPECT_EQ(pinned_run, 1);
+    EXPECT_EQ(spawned, 1);
+    EXPECT_EQ(unpinned_run, all);
+    EXPECT_EQ(threaded, all);
+    EXPECT_EQ(allowed_cpus(), all);
+    std::thread([&] { EXPECT_EQ(allowed_cpus(), all); }).join();
+}
+#endif
+
+// 测试分配统计：作用域计数、峰值，以及在单线程和多线程基准测试结果中的报告
+TEST(AllocationTrackerTest, CountsAllocationsPerScopeAndBenchmark) {
+    if (!allocation_tracking_available()) GTEST_SKIP() << "allocation hooks are not installed on this platform";
+
+    AllocationScope scope;
+    scope.begin();
+    int* array = new int[16];
+    do_not_optimize(array);
+    void* raw = std::malloc(100);
+    do_not_optimize(raw);
+    std::free(raw);
+    delete[] array;
+    AllocationDelta delta = scope.end();
+    EXPECT_EQ(delta.allocations, 2u);
+    EXPECT_EQ(delta.deallocations, 2u);
+    EXPECT_EQ(delta.bytes_allocated, 16 * sizeof(int) + 100);
+    EXPECT_GE(delta.peak_live_bytes, static_cast<std::int64_t>(16 * sizeof(int) + 100));
+
+    BenchmarkOptions options;
+    options.min_sample_time = std::chrono::microseconds(200);
+    options.warmup_time = std::chrono::microseconds(0);
+    options.samples = 3;
+    BenchmarkRunner runner(options);
+    auto stats = runner.run("reserve", [] {
+        std::vector<int> v;
+        v.reserve(100);
+        v.push_back(1);
+        do_not_optimize(v.data());
+    });
+    ASSERT_TRUE(stats.allocations.valid);
+    EXPECT_DOUBLE_EQ(stats.allocations.allocations, 1.0);
+    EXPECT_DOUBLE_EQ(stats.allocations.bytes, 100.0 * sizeof(int));
+
+    auto threaded = runner.run_threads("allocate", 2, [](size_t) {
+        auto p = std::make_unique<long>(42);
+        do_not_optimize(p.get());
+    });
+    ASSERT_TRUE(threaded.aggregate.allocations.valid);
+    EXPECT_DOUBLE_EQ(threaded.aggregate.allocations.allocations, 1.0);
+    for (const auto& t : threaded.per_thread) {
+        EXPECT_DOUBLE_EQ(t.allocations.allocations, 1.0);
+    }
+
+    // 分配统计随报告写出并能读回
+    BenchmarkReport report;
+    report.add(stats);
+    std::stringstream json;
+    report.write_json(json);
+    auto loaded = BenchmarkReport::from_json(json.str());
+    ASSERT_NE(loaded.find("reserve"), nullptr);
+    EXPECT_TRUE(loaded.find("reserve")->allocations.valid);
+    EXPECT_DOUBLE_EQ(loaded.find("reserve")->allocations.allocations, 1.0);
+}
@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include "../network/connection_pool.h"
+#include "../network/tcp_server.h"
+#include "../network/http_server.h"
+#include "../network/http_client.h"
+
+#if defined(__linux__)
+#include <poll.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace network_demo;
+
+namespace {
+    // 回显服务器；收到"bye"时关闭连接
+    TCPServerCallbacks echo_callbacks() {
+        TCPServerCallbacks callbacks;
+        callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+            if (input.view() == "bye") connection.close();
+            else connection.send(input.data(), input.size());
+            input.consume(input.size());
+        };
+        return callbacks;
+    }
+
+    // 在借出的(非阻塞)连接上发送message并等待回显
+    std::string round_trip(const PooledConnection& connection, const std::string& message) {
+        EXPECT_EQ(::send(connection.fd(), message.data(), message.size(), MSG_NOSIGNAL),
+                  static_cast<ssize_t>(message.size()));
+        std::string reply(message.size(), '\0');
+        std::size_t received = 0;
+        while (received < reply.size()) {
+            pollfd entry{connection.fd(), POLLIN, 0};
+            if (::poll(&entry, 1, 5000) <= 0) break;
+            ssize_t n = ::recv(connection.fd(), reply.data() + received, reply.size() - received, 0);
+            if (n <= 0) break;
+            received += static_cast<std::size_t>(n);
+        }
+        reply.resize(received);
+        return reply;
+    }
+}
+
+// 归还的连接被复用；对端已关闭的连接在健康检查时丢弃，空闲超时的连接被清理
+TEST(ConnectionPoolTest, ReusesHealthyIdleConnections) {
+    TCPServer server(TCPServerOptions{}, echo_callbacks());
+    server.start();
+    ConnectionPoolOptions options;
+    options.idle_timeout = std::chrono::milliseconds(50);
+    ConnectionPool pool(options);
+
+    PooledConnection connection = pool.acquire("127.0.0.1", server.port());
+    EXPECT_FALSE(connection.reused());
+    EXPECT_EQ(round_trip(connection, "ping"), "ping");
+    const int fd = connection.fd();
+    connection.release();
+    EXPECT_FALSE(connection);
+    EXPECT_EQ(pool.idle_connections(), 1u);
+
+    connection = pool.acquire("127.0.0.1", server.port());
+    EXPECT_TRUE(connection.reused());
+    EXPECT_EQ(connection.fd(), fd);
+    EXPECT_EQ(round_trip(connection, "pong"), "pong");
+
+    // 服务器关闭连接后才归还：下一次acquire的健康检查发现并换一个新连接
+    ASSERT_EQ(::send(connection.fd(), "bye", 3, MSG_NOSIGNAL), 3);
+    pollfd entry{connection.fd(), POLLRDHUP, 0};
+    ASSERT_EQ(::poll(&entry, 1, 5000), 1);
+    connection.release();
+    connection = pool.acquire("127.0.0.1", server.port());
+    EXPECT_FALSE(connection.reused());
+    EXPECT_EQ(round_trip(connection, "again"), "again");
+    connection.release();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_EQ(pool.prune(), 1u);
+    EXPECT_EQ(pool.idle_connections(), 0u);
+
+    ConnectionPoolStats stats = pool.stats();
+    EXPECT_EQ(stats.opened, 2u);
+    EXPECT_EQ(stats.reused, 1u);
+    EXPECT_EQ(stats.unhealthy, 1u);
+    EXPECT_EQ(stats.expired, 1u);
+    server.stop();
+}
+
+// 达到每个主机的上限时：try_acquire立即返回空，acquire排队直到连接归还(或者超时)，关闭的连接让出名额
+TEST(ConnectionPoolTest, MaxPerHostQueuesAcquirers) {
+    TCPServer server(TCPServerOptions{}, echo_callbacks());
+    server.start();
+    ConnectionPoolOptions options;
+    options.max_per_host = 1;
+    ConnectionPool pool(options);
+
+    PooledConnection first = pool.acquire("127.0.0.1", server.port());
+    const int fd = first.fd();
+    EXPECT_FALSE(pool.try_acquire("127.0.0.1", server.port()));
+    EXPECT_THROW(pool.acquire("127.0.0.1", server.port(), std::chrono::milliseconds(20)), std::runtime_error);
+
+    PooledConnection handed;
+    std::thread waiter([&] { handed = pool.acquire("127.0.0.1", server.port()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    first.release();
+    waiter.join();
+    EXPECT_TRUE(handed.reused());
+    EXPECT_EQ(handed.fd(), fd);
+
+    PooledConnection replacement;
+    waiter = std::thread([&] { replacement = pool.acquire("127.0.0.1", server.port()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    handed.close();
+    waiter.join();
+    EXPECT_FALSE(replacement.reused());
+    EXPECT_EQ(round_trip(replacement, "ok"), "ok");
+    replacement.release();
+
+    ConnectionPoolStats stats = pool.stats();
+    EXPECT_EQ(stats.opened, 2u);
+    EXPECT_EQ(stats.waits, 3u);
+    server.stop();
+}
+
+// try_acquire不等待connect完成；调用方等待可写后检查结果，失败的连接让出名额
+TEST(ConnectionPoolTest, TryAcquireConnectsInBackground) {
+    TCPServer server(TCPServerOptions{}, echo_callbacks());
+    server.start();
+    ConnectionPoolOptions options;
+    options.max_per_host = 1;
+    ConnectionPool pool(options);
+
+    std::optional<PooledConnection> connection = pool.try_acquire("127.0.0.1", server.port());
+    ASSERT_TRUE(connection);
+    if (connection->connecting()) {
+        pollfd entry{connection->fd(), POLLOUT, 0};
+        ASSERT_EQ(::poll(&entry, 1, 5000), 1);
+        connection->finish_connect();
+    }
+    EXPECT_EQ(round_trip(*connection, "async"), "async");
+    connection->release();
+    connection = pool.try_acquire("127.0.0.1", server.port());
+    ASSERT_TRUE(connection);
+    EXPECT_TRUE(connection->reused());
+    connection.reset();
+
+    // 绑定了端口但没有监听的套接字：连接被拒绝
+    int unused = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address = make_address("127.0.0.1", 0);
+    ASSERT_EQ(::bind(unused, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    socklen_t length = sizeof(address);
+    ::getsockname(unused, reinterpret_cast<sockaddr*>(&address), &length);
+    const std::uint16_t refused = ntohs(address.sin_port);
+    auto connect_refused = [&pool, refused] {
+        std::optional<PooledConnection> failed = pool.try_acquire("127.0.0.1", refused);
+        ASSERT_TRUE(failed);
+        pollfd entry{failed->fd(), POLLOUT, 0};
+        ::poll(&entry, 1, 5000);
+        failed->finish_connect();
+    };
+    for (int attempt = 0; attempt < 2; ++attempt) EXPECT_THROW(connect_refused(), std::system_error);
+    EXPECT_THROW(pool.acquire("127.0.0.1", refused), std::system_error);
+    ::close(unused);
+    server.stop();
+}
+
+// Reactor上的协程共享两个连接：排队的协程挂起，归还的连接直接交给它们
+TEST(ConnectionPoolTest, AsyncAcquireOnReactor) {
+    TCPServer server(TCPServerOptions{}, echo_callbacks());
+    server.start();
+    ConnectionPoolOptions options;
+    options.max_per_host = 2;
+    ConnectionPool pool(options);
+    Reactor reactor;
+    const std::uint16_t port = server.port();
+
+    int done = 0;
+    auto worker = [](Reactor& reactor, ConnectionPool& pool, std::uint16_t port, int id, int& done) -> Task<void> {
+        PooledConnection connection = co_await pool.async_acquire(reactor, "127.0.0.1", port);
+        const std::string message = "task-" + std::to_string(id);
+        co_await async_write_all(connection.socket(), message.data(), message.size());
+        std::string reply(message.size(), '\0');
+        std::size_t received = 0;
+        while (received < reply.size()) {
+            std::size_t n = co_await async_read(connection.socket(), reply.data() + received, reply.size() - received);
+            if (n == 0) break;
+            received += n;
+        }
+        EXPECT_EQ(reply, message);
+        co_await reactor.sleep_for(std::chrono::milliseconds(1));
+        connection.release();
+        ++done;
+    };
+    auto main_task = [&]() -> Task<void> {
+        for (int i = 0; i < 8; ++i) reactor.spawn(worker(reactor, pool, port, i, done));
+        while (done < 8) co_await reactor.sleep_for(std::chrono::milliseconds(1));
+    };
+    reactor.run_until_complete(main_task());
+
+    EXPECT_EQ(done, 8);
+    ConnectionPoolStats stats = pool.stats();
+    EXPECT_EQ(stats.opened, 2u);
+    EXPECT_EQ(stats.reused, 6u);
+    EXPECT_EQ(stats.waits, 6u);
+    EXPECT_EQ(pool.idle_connections(), 2u);
+    server.stop();
+}
+
+// 协程帧在async_acquire的connect期间被销毁(Reactor析构)时，新连接的名额归还给连接池
+TEST(ConnectionPoolTest, DestroyedAsyncAcquireReturnsSlot) {
+    // backlog为0的监听套接字接受队列已满后不再回应SYN，之后的connect一直处于进行中
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(address);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), size), 0);
+    ASSERT_EQ(::listen(listener, 0), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &size), 0);
+    const std::uint16_t port = ntohs(address.sin_port);
+    std::vector<int> backlog;
+    for (int i = 0; i < 2; ++i) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        backlog.push_back(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    ConnectionPoolOptions options;
+    options.max_per_host = 1;
+    ConnectionPool pool(options);
+    bool acquired = false;
+    {
+        Reactor reactor;
+        auto acquire = [](Reactor& reactor, ConnectionPool& pool, std::uint16_t port, bool& acquired) -> Task<void> {
+            PooledConnection connection = co_await pool.async_acquire(reactor, "127.0.0.1", port);
+            acquired = true;
+        };
+        reactor.spawn(acquire(reactor, pool, port, acquired));
+        auto wait = [&reactor]() -> Task<void> {
+            co_await reactor.sleep_for(std::chrono::milliseconds(20));
+        };
+        reactor.run_until_complete(wait());
+    }
+    EXPECT_FALSE(acquired);
+    EXPECT_TRUE(pool.try_acquire("127.0.0.1", port).has_value());
+
+    for (int fd : backlog) ::close(fd);
+    ::close(listener);
+}
+
+// 共享连接池的HTTP客户端复用同一个连接；不复用的连接池每次请求都建立新连接并要求服务器关闭
+TEST(ConnectionPoolTest, HttpClientsSharePool) {
+    HTTPServer server(HTTPServerOptions{}, [](const HTTPRequest& request, HTTPResponse& response) {
+        response.body_buffer().assign(request.target);
+    });
+    server.start();
+    const std::string base = "http://127.0.0.1:" + std::to_string(server.port());
+
+    auto pool = std::make_shared<ConnectionPool>();
+    HTTPClient first(pool);
+    HTTPClient second(pool);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(first.get(base + "/first").body, "/first");
+        EXPECT_EQ(second.get(base + "/second").body, "/second");
+    }
+    EXPECT_EQ(pool->stats().opened, 1u);
+    EXPECT_EQ(first.connections_opened() + second.connections_opened(), 1u);
+
+    ConnectionPoolOptions options;
+    options.max_idle_per_host = 0;
+    HTTPClient unpooled(std::make_shared<ConnectionPool>(options));
+    for (int i = 0; i < 3; ++i) {
+        HTTPClientResponse response = unpooled.get(base + "/once");
+        EXPECT_EQ(response.body, "/once");
+        EXPECT_EQ(response.header("Connection"), "close");
+    }
+    EXPECT_EQ(unpooled.connections_opened(), 3u);
+    EXPECT_EQ(unpooled.pool().idle_connections(), 0u);
+    EXPECT_EQ(server.total_accepted(), 4u);
+    server.stop();
+}
+#endif
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "../advanced-concurrency/future.h"
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace advanced_concurrency_demo;
+
+// 测试continuation链在线程池上执行并传递结果
+TEST(FutureTest, ThenChainsOnPool) {
+    ThreadPool pool(2);
+    auto result = async(pool, [] { return 20; })
+        .then(pool, [](int x) { return x + 1; })
+        .then(pool, [](int x) { return std::to_string(x * 2); });
+    EXPECT_EQ(result.get(), "42");
+}
+
+// 测试void结果和内联continuation
+TEST(FutureTest, VoidContinuation) {
+    Promise<void> promise;
+    int observed = 0;
+    auto next = promise.get_future().then([&observed] { observed = 7; return observed; });
+    EXPECT_FALSE(next.is_ready());
+    promise.set_value();
+    EXPECT_EQ(next.get(), 7);
+    EXPECT_EQ(observed, 7);
+}
+
+// 测试异常跳过后续continuation并传播到最终结果
+TEST(FutureTest, ExceptionPropagatesThroughThen) {
+    ThreadPool pool(2);
+    bool ran = false;
+    auto result = async(pool, []() -> int { throw std::runtime_error("boom"); })
+        .then(pool, [&ran](int x) { ran = true; return x; });
+    EXPECT_THROW(result.get(), std::runtime_error);
+    EXPECT_FALSE(ran);
+}
+
+// 测试线程池析构时上游才完成：投递continuation失败，下游Future以异常结束而不是终止进程
+TEST(FutureTest, PoolContinuationAfterPoolStops) {
+    Future<int> downstream;
+    bool ran = false;
+    {
+        ThreadPool pool(1);
+        auto upstream = async(pool, [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return 1;
+        });
+        downstream = upstream.then(pool, [&ran](int x) { ran = true; return x + 1; })
+            .then([](int x) { return x * 2; });
+    }
+    EXPECT_THROW(downstream.get(), std::runtime_error);
+    EXPECT_FALSE(ran);
+}
+
+// 测试when_all保持输入顺序
+TEST(FutureTest, WhenAllKeepsOrder) {
+    ThreadPool pool(4);
+    std::vector<Future<int>> futures;
+    for (int i = 0; i < 16; ++i) {
+        futures.push_back(async(pool, [i] { return i; }));
+    }
+    auto values = when_all(std::move(futures)).get();
+    ASSERT_EQ(values.size(), 16u);
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(values[i], i);
+    }
+
+    EXPECT_TRUE(when_all(std::vector<Future<int>>{}).get().empty());
+}
+
+// 测试when_all在任一输入失败时失败
+TEST(FutureTest, WhenAllFailsOnFirstError) {
+    std::vector<Future<int>> futures;
+    futures.push_back(make_ready_future(1));
+    Promise<int> failing;
+    futures.push_back(failing.get_future());
+    auto all = when_all(std::move(futures));
+    failing.set_exception(std::make_exception_ptr(std::logic_error("bad")));
+    EXPECT_THROW(all.get(), std::logic_error);
+}
+
+// 测试不同类型的when_all_of
+TEST(FutureTest, WhenAllOfTuple) {
+    auto combined = when_all_of(make_ready_future(1), make_ready_future(std::string("two")));
+    auto [a, b] = combined.get();
+    EXPECT_EQ(a, 1);
+    EXPECT_EQ(b, "two");
+}
+
+// 测试when_any返回第一个完成的结果
+TEST(FutureTest, WhenAnyReturnsFirst) {
+    Promise<int> slow;
+    Promise<int> fast;
+    std::vector<Future<int>> futures;
+    futures.push_back(slow.get_future());
+    futures.push_back(fast.get_future());
+    auto any = when_any(std::move(futures));
+    fast.set_value(5);
+    slow.set_value(9);
+    auto first = any.get();
+    EXPECT_EQ(first.index, 1u);
+    EXPECT_EQ(first.value, 5);
+}
+
+// 测试Promise的最后一个副本没有设置结果就销毁：等待方和continuation得到broken_promise；
+// 无效的Future上的操作抛出no_state
+TEST(FutureTest, BrokenPromiseAndInvalidFuture) {
+    Future<int> future;
+    Future<int> chained;
+    {
+        Promise<int> promise;
+        Promise<int> copy = promise;
+        future = promise.get_future();
+        chained = copy.get_future().then([](int x) { return x; });
+    }
+    try {
+        future.get();
+        FAIL() << "expected broken_promise";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::future_errc::broken_promise);
+    }
+    EXPECT_THROW(chained.get(), std::future_error);
+
+    Future<int> invalid;
+    for (auto operation : {+[](Future<int>& f) { (void)f.is_ready(); }, +[](Future<int>& f) { f.wait(); },
+                           +[](Future<int>& f) { (void)f.get(); }}) {
+        try {
+            operation(invalid);
+            FAIL() << "expected no_state";
+        } catch (const std::future_error& e) {
+            EXPECT_EQ(e.code(), std::future_errc::no_state);
+        }
+    }
+}
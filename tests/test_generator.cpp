@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace coroutines_base;
+
+namespace {
+    // 记录复制和移动次数的元素类型
+    struct Counted {
+        static inline int copies = 0;
+        static inline int moves = 0;
+        int id;
+
+        explicit Counted(int i) : id(i) {}
+        Counted(const Counted& other) : id(other.id) { ++copies; }
+        Counted(Counted&& other) noexcept : id(other.id) { ++moves; }
+    };
+
+    Generator<Counted> make_counted(int n, std::vector<const Counted*>& addresses) {
+        for (int i = 0; i < n; ++i) {
+            Counted item(i);
+            addresses.push_back(&item);
+            co_yield item;
+        }
+    }
+
+    Generator<std::unique_ptr<int>> make_unique_values(int n) {
+        for (int i = 0; i < n; ++i) co_yield std::make_unique<int>(i);
+    }
+
+    Generator<const std::string&> borrow_all(const std::vector<std::string>& items) {
+        for (const auto& item : items) co_yield item;
+    }
+
+    Generator<int> fail_after(int n) {
+        for (int i = 0; i < n; ++i) co_yield i;
+        throw std::runtime_error("generator failed");
+    }
+
+    Generator<int> naturals() {
+        for (int i = 0;; ++i) co_yield i;
+    }
+
+    struct TreeNode {
+        int value;
+        std::vector<TreeNode> children;
+    };
+
+    // 前序遍历：子树通过elements_of嵌套产出，不逐层转发元素
+    Generator<const int&> preorder(const TreeNode& node) {
+        co_yield node.value;
+        for (const auto& child : node.children) co_yield elements_of(preorder(child));
+    }
+
+    // 深度为depth的链，每一层产出一个元素后嵌套下一层
+    Generator<int> chain(int depth) {
+        co_yield depth;
+        if (depth > 0) co_yield elements_of(chain(depth - 1));
+    }
+
+    Generator<int> mixed_sources(const std::vector<int>& values) {
+        co_yield -1;
+        co_yield elements_of(values);
+        co_yield elements_of(std::views::iota(10, 13));
+        co_yield elements_of(Generator<int>{});
+        co_yield -2;
+    }
+
+    // 内层抛出的异常可以在外层的co_yield处捕获
+    Generator<int> recover_from_nested() {
+        bool failed = false;
+        try {
+            co_yield elements_of(fail_after(2));
+        } catch (const std::runtime_error&) {
+            failed = true;
+        }
+        if (failed) co_yield 100;
+        co_yield elements_of(fail_after(1));
+    }
+
+    // 嵌套元素类型不同的Generator：const char*构造std::string，int转换为long
+    Generator<const char*> literals() {
+        co_yield "alpha";
+        co_yield "beta";
+    }
+
+    Generator<std::string> convert_nested(const std::vector<std::string>& items) {
+        co_yield elements_of(literals());
+        co_yield elements_of(borrow_all(items));
+        co_yield "end";
+    }
+
+    Generator<long> widen_nested() {
+        co_yield elements_of(fail_after(2));
+    }
+
+    Generator<std::string> convert_and_copy() {
+        const std::string constant = "const";
+        co_yield "literal";
+        co_yield constant;
+        co_yield std::string(3, 'x');
+    }
+}
+
+static_assert(std::ranges::input_range<Generator<int>>);
+static_assert(std::ranges::view<Generator<std::string>>);
+static_assert(std::is_same_v<std::ranges::range_reference_t<Generator<std::string>>, std::string&>);
+static_assert(std::is_same_v<std::ranges::range_reference_t<Generator<const std::string&>>, const std::string&>);
+
+// 迭代器直接引用协程帧中的对象：产出和读取都不复制
+TEST(GeneratorTest, YieldsByAddressWithoutCopies) {
+    Counted::copies = Counted::moves = 0;
+    std::vector<const Counted*> addresses;
+    int index = 0;
+    for (const Counted& item : make_counted(5, addresses)) {
+        EXPECT_EQ(item.id, index);
+        EXPECT_EQ(&item, addresses[static_cast<std::size_t>(index)]);
+        ++index;
+    }
+    EXPECT_EQ(index, 5);
+    EXPECT_EQ(Counted::copies, 0);
+    EXPECT_EQ(Counted::moves, 0);
+}
+
+TEST(GeneratorTest, MoveOnlyAndReferenceElements) {
+    std::vector<std::unique_ptr<int>> taken;
+    for (auto& value : make_unique_values(3)) taken.push_back(std::move(value));
+    ASSERT_EQ(taken.size(), 3u);
+    EXPECT_EQ(*taken[2], 2);
+
+    const std::vector<std::string> items = {"a", "bb", "ccc"};
+    std::size_t i = 0;
+    for (const std::string& item : borrow_all(items)) {
+        EXPECT_EQ(&item, &items[i++]);
+    }
+    EXPECT_EQ(i, items.size());
+
+    // 字符串字面量转换为临时对象、const左值复制一次，都在协程恢复前保持有效
+    std::vector<std::string> converted;
+    for (const auto& s : convert_and_copy()) converted.push_back(s);
+    EXPECT_EQ(converted, (std::vector<std::string>{"literal", "const", "xxx"}));
+}
+
+TEST(GeneratorTest, PropagatesExceptions) {
+    std::vector<int> seen;
+    auto gen = fail_after(2);
+    EXPECT_THROW(
+        {
+            for (int v : gen) seen.push_back(v);
+        },
+        std::runtime_error);
+    EXPECT_EQ(seen, (std::vector<int>{0, 1}));
+
+    EXPECT_THROW(fail_after(0).begin(), std::runtime_error);
+}
+
+// 无限生成器与std::views组合，只计算需要的元素
+TEST(GeneratorTest, ComposesWithViews) {
+    std::vector<int> result;
+    auto squares_of_odds = naturals()
+                         | std::views::filter([](int x) { return x % 2 == 1; })
+                         | std::views::transform([](int x) { return x * x; })
+                         | std::views::take(4);
+    for (int v : squares_of_odds) result.push_back(v);
+    EXPECT_EQ(result, (std::vector<int>{1, 9, 25, 49}));
+}
+
+TEST(GeneratorTest, NestedYieldTraversesTree) {
+    TreeNode tree{1, {{2, {{3, {}}, {4, {}}}}, {5, {}}, {6, {{7, {{8, {}}}}}}}};
+    std::vector<int> visited;
+    for (int v : preorder(tree)) visited.push_back(v);
+    EXPECT_EQ(visited, (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    // 引用直接指向树中的节点
+    auto gen = preorder(tree);
+    auto it = gen.begin();
+    ++it;
+    ++it;
+    EXPECT_EQ(&*it, &tree.children[0].children[0].value);
+
+    const std::vector<int> values = {1, 2};
+    std::vector<int> mixed;
+    for (int v : mixed_sources(values)) mixed.push_back(v);
+    EXPECT_EQ(mixed, (std::vector<int>{-1, 1, 2, 10, 11, 12, -2}));
+}
+
+// 消费者直接恢复最内层的生成器：进入和退出每一层都是对等转移，栈深度不随嵌套增长
+TEST(GeneratorTest, DeepNestingKeepsStackFlat) {
+#if defined(__OPTIMIZE__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    const int depth = 200000;
+#else
+    const int depth = 2000;
+#endif
+    long sum = 0;
+    int count = 0;
+    for (int v : chain(depth)) {
+        sum += v;
+        ++count;
+    }
+    EXPECT_EQ(count, depth + 1);
+    EXPECT_EQ(sum, static_cast<long>(depth) * (depth + 1) / 2);
+
+    // 在最内层挂起时销毁整条链
+    auto partial = chain(100);
+    auto it = partial.begin();
+    for (int i = 0; i < 50; ++i) ++it;
+    EXPECT_EQ(*it, 50);
+}
+
+TEST(GeneratorTest, NestedGeneratorsOfConvertibleTypes) {
+    const std::vector<std::string> items = {"x", "y"};
+    std::vector<std::string> seen;
+    for (auto& s : convert_nested(items)) seen.push_back(std::move(s));
+    EXPECT_EQ(seen, (std::vector<std::string>{"alpha", "beta", "x", "y", "end"}));
+    // 转换出的是副本，移走它们不影响原来的元素
+    EXPECT_EQ(items, (std::vector<std::string>{"x", "y"}));
+
+    // 内层的异常同样在外层的co_yield处重新抛出
+    std::vector<long> widened;
+    EXPECT_THROW(
+        {
+            for (long v : widen_nested()) widened.push_back(v);
+        },
+        std::runtime_error);
+    EXPECT_EQ(widened, (std::vector<long>{0, 1}));
+}
+
+TEST(GeneratorTest, NestedExceptionsReachTheOuterGenerator) {
+    std::vector<int> seen;
+    EXPECT_THROW(
+        {
+            for (int v : recover_from_nested()) seen.push_back(v);
+        },
+        std::runtime_error);
+    EXPECT_EQ(seen, (std::vector<int>{0, 1, 100, 0}));
+}
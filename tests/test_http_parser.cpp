@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "../network/http_parser.h"
+#include <string>
+
+using namespace network_demo;
+
+namespace {
+    bool points_into(std::string_view view, const std::string& buffer) {
+        return view.data() >= buffer.data() && view.data() + view.size() <= buffer.data() + buffer.size();
+    }
+}
+
+// 逐字节到达：完成之前一直返回incomplete，完成后所有字段都指向接收缓冲区
+TEST(HttpParserTest, ParsesRequestIncrementallyWithoutCopying) {
+    const std::string wire =
+        "POST /api/users?id=7 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "content-type: application/json\r\n"
+        "Content-Length:  11 \r\n"
+        "\r\n"
+        "{\"id\": 123}";
+    std::string buffer;
+    HTTPRequestParser parser;
+    for (std::size_t i = 0; i + 1 < wire.size(); ++i) {
+        buffer.push_back(wire[i]);
+        ASSERT_EQ(parser.parse(buffer.data(), buffer.size()), HTTPParseStatus::incomplete) << i;
+    }
+    buffer.push_back(wire.back());
+    ASSERT_EQ(parser.parse(buffer.data(), buffer.size()), HTTPParseStatus::complete);
+
+    const HTTPRequest& request = parser.message();
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.target, "/api/users?id=7");
+    EXPECT_EQ(request.version_minor, 1);
+    EXPECT_TRUE(request.keep_alive);
+    EXPECT_EQ(request.headers().size(), 3u);
+    EXPECT_EQ(request.header("Content-Type"), "application/json");
+    EXPECT_EQ(request.header("content-length"), "11");
+    EXPECT_FALSE(request.has_header("Transfer-Encoding"));
+    EXPECT_EQ(request.body, "{\"id\": 123}");
+    EXPECT_EQ(parser.consumed(), wire.size());
+    for (const HTTPHeader& header : request.headers()) {
+        EXPECT_TRUE(points_into(header.name, buffer));
+        EXPECT_TRUE(points_into(header.value, buffer));
+    }
+    EXPECT_TRUE(points_into(request.target, buffer));
+    EXPECT_TRUE(points_into(request.body, buffer));
+}
+
+// 流水线中的多条请求依次解析；HTTP/1.0和Connection头决定是否保持连接
+TEST(HttpParserTest, PipelinedRequestsAndKeepAlive) {
+    std::string buffer =
+        "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+        "GET /b HTTP/1.0\r\n\r\n"
+        "GET /c HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n"
+        "GET /d HTTP/1.1\r\nConnection: foo, close\r\n\r\n"
+        "GET /e HTTP/1.1\r\n";
+    HTTPRequestParser parser;
+    std::size_t offset = 0;
+    std::vector<std::pair<std::string, bool>> parsed;
+    while (parser.parse(buffer.data() + offset, buffer.size() - offset) == HTTPParseStatus::complete) {
+        parsed.emplace_back(std::string(parser.message().target), parser.message().keep_alive);
+        offset += parser.consumed();
+    }
+    EXPECT_EQ(parsed, (std::vector<std::pair<std::string, bool>>{
+                          {"/a", true}, {"/b", false}, {"/c", true}, {"/d", false}}));
+
+    // 最后一条请求不完整，剩下的字节留给下一次调用
+    buffer += "\r\n";
+    ASSERT_EQ(parser.parse(buffer.data() + offset, buffer.size() - offset), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().target, "/e");
+    EXPECT_EQ(offset + parser.consumed(), buffer.size());
+}
+
+// 分块的消息体在缓冲区内原地拼接；数据分两次到达，中间缓冲区换了位置
+TEST(HttpParserTest, DecodesChunkedBodyInPlace) {
+    const std::string first =
+        "PUT /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\nHello\r\n"
+        "7;ext=1\r\n, chu";
+    const std::string second =
+        "nk\r\n"
+        "A\r\ned world!!\r\n"
+        "0\r\n"
+        "Trailer: value\r\n"
+        "\r\n"
+        "GET /next HTTP/1.1\r\n\r\n";
+    std::string buffer = first;
+    HTTPRequestParser parser;
+    ASSERT_EQ(parser.parse(buffer.data(), buffer.size()), HTTPParseStatus::incomplete);
+
+    std::string moved = buffer + second;
+    ASSERT_EQ(parser.parse(moved.data(), moved.size()), HTTPParseStatus::complete);
+    const HTTPRequest& request = parser.message();
+    EXPECT_TRUE(request.chunked);
+    EXPECT_EQ(request.method, "PUT");
+    EXPECT_EQ(request.header("Transfer-Encoding"), "chunked");
+    EXPECT_EQ(request.body, "Hello, chunked world!!");
+    EXPECT_TRUE(points_into(request.body, moved));
+    EXPECT_TRUE(points_into(request.method, moved));
+
+    const std::size_t consumed = parser.consumed();
+    ASSERT_EQ(parser.parse(moved.data() + consumed, moved.size() - consumed), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().target, "/next");
+}
+
+TEST(HttpParserTest, RejectsMalformedRequests) {
+    auto status_of = [](std::string wire, HTTPLimits limits = {}) {
+        HTTPRequestParser parser(limits);
+        HTTPParseStatus status = parser.parse(wire.data(), wire.size());
+        return status == HTTPParseStatus::error ? parser.error_status() : status == HTTPParseStatus::complete ? 0 : -1;
+    };
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\n\r\n"), 0);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\n"), -1);
+    EXPECT_EQ(status_of("GET /\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/2.0\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("G(T / HTTP/1.1\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nBad Header: x\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nNoColon\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nX: a\rb\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab"), 400);
+    // 同时带Content-Length和chunked可能被用来走私请求
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"), 501);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"), 400);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcX\r\n"), 400);
+
+    HTTPLimits small;
+    small.max_header_bytes = 64;
+    small.max_body = 16;
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nX: " + std::string(100, 'a'), small), 431);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n", small), 413);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n10\r\n" + std::string(16, 'a') +
+                        "\r\n1\r\n", small), 413);
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (std::size_t i = 0; i <= kMaxHTTPHeaders; ++i) many += "H" + std::to_string(i) + ": v\r\n";
+    EXPECT_EQ(status_of(many + "\r\n"), 431);
+}
+
+// 响应的三种分帧方式：Content-Length、分块、读到连接关闭；HEAD和204没有消息体
+TEST(HttpParserTest, ParsesResponseFraming) {
+    HTTPResponseParser parser;
+    std::string wire = "HTTP/1.1 404 Not Found\r\nContent-Length: 4\r\n\r\nnope";
+    ASSERT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().status, 404);
+    EXPECT_EQ(parser.message().reason, "Not Found");
+    EXPECT_EQ(parser.message().body, "nope");
+
+    wire = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n";
+    ASSERT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().body, "abcde");
+
+    wire = "HTTP/1.0 200 OK\r\n\r\nuntil close";
+    ASSERT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::incomplete);
+    ASSERT_EQ(parser.finish(wire.data(), wire.size()), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().body, "until close");
+    EXPECT_FALSE(parser.message().keep_alive);
+
+    wire = "HTTP/1.1 200 OK\r\nX: a\rb\r\nContent-Length: 0\r\n\r\n";
+    EXPECT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::error);
+
+    wire = "HTTP/1.1 204 No Content\r\n\r\n";
+    ASSERT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::complete);
+    EXPECT_TRUE(parser.message().body.empty());
+
+    parser.expect_no_body(true);
+    wire = "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n";
+    ASSERT_EQ(parser.parse(wire.data(), wire.size()), HTTPParseStatus::complete);
+    EXPECT_EQ(parser.message().header("Content-Length"), "100");
+    EXPECT_EQ(parser.consumed(), wire.size());
+}
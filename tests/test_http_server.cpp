@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include "../network/http_server.h"
+#include "../network/http_client.h"
+#include "../network/load_generator.h"
+
+#if defined(__linux__)
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace network_demo;
+
+namespace {
+    // /echo返回请求体(零拷贝)，/chunked用分块编码，/close要求关闭连接，其他路径返回目标本身
+    void test_handler(const HTTPRequest& request, HTTPResponse& response) {
+        if (request.target == "/echo") {
+            response.add_header("Content-Type", request.header("Content-Type"));
+            response.set_body(request.body);
+        } else if (request.target == "/chunked") {
+            response.set_chunked(true);
+            response.body_buffer().assign(10000, 'c');
+        } else if (request.target == "/missing") {
+            response.set_status(404);
+            response.set_body("not here");
+        } else if (request.target == "/throw") {
+            throw std::runtime_error("handler failed");
+        } else {
+            if (request.target == "/close") response.close_connection();
+            response.body_buffer().append(request.method).append(" ").append(request.target);
+        }
+    }
+
+    // 原始套接字，用来构造客户端类不会发出的请求
+    class RawConnection {
+    private:
+        int fd_;
+
+    public:
+        explicit RawConnection(std::uint16_t port) : fd_(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) {
+            sockaddr_in address = make_address("127.0.0.1", port);
+            if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                throw_errno(errno, "connect");
+            }
+        }
+
+        ~RawConnection() {
+            ::close(fd_);
+        }
+
+        void send(const std::string& data) {
+            ASSERT_EQ(::send(fd_, data.data(), data.size(), MSG_NOSIGNAL), static_cast<ssize_t>(data.size()));
+        }
+
+        // 读到对端关闭为止
+        std::string receive_all() {
+            std::string data;
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::read(fd_, buffer, sizeof(buffer))) > 0) data.append(buffer, static_cast<std::size_t>(n));
+            return data;
+        }
+    };
+}
+
+// 同一个连接上的多次请求、分块响应、HEAD、错误状态，以及一次写出的流水线请求
+TEST(HttpServerTest, ClientKeepAliveAndPipelining) {
+    HTTPServerOptions options;
+    options.tcp.threads = 2;
+    HTTPServer server(options, test_handler);
+    server.start();
+    const std::string base = "http://127.0.0.1:" + std::to_string(server.port());
+
+    HTTPClient client;
+    HTTPClientResponse response = client.get(base + "/hello?x=1");
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.reason, "OK");
+    EXPECT_EQ(response.body, "GET /hello?x=1");
+    EXPECT_EQ(response.header("content-length"), "14");
+
+    response = client.post(base + "/echo", "{\"name\": \"demo\"}");
+    EXPECT_EQ(response.body, "{\"name\": \"demo\"}");
+    EXPECT_EQ(response.header("Content-Type"), "application/json");
+
+    response = client.get(base + "/chunked");
+    EXPECT_EQ(response.header("Transfer-Encoding"), "chunked");
+    EXPECT_EQ(response.body, std::string(10000, 'c'));
+
+    response = client.request("HEAD", base + "/head");
+    EXPECT_EQ(response.header("Content-Length"), "10");
+    EXPECT_TRUE(response.body.empty());
+
+    EXPECT_EQ(client.get(base + "/missing").status, 404);
+    EXPECT_EQ(client.get(base + "/throw").status, 500);
+
+    std::vector<std::string> urls;
+    for (int i = 0; i < 200; ++i) urls.push_back(base + "/p" + std::to_string(i));
+    std::vector<HTTPClientResponse> responses = client.get_pipelined(urls);
+    ASSERT_EQ(responses.size(), urls.size());
+    for (int i = 0; i < 200; ++i) EXPECT_EQ(responses[static_cast<std::size_t>(i)].body, "GET /p" + std::to_string(i));
+
+    // 以上请求都走同一个连接；服务器要求关闭后下一次请求重新连接
+    EXPECT_EQ(client.connections_opened(), 1u);
+    EXPECT_EQ(client.get(base + "/close").header("Connection"), "close");
+    EXPECT_EQ(client.get(base + "/again").body, "GET /again");
+    EXPECT_EQ(client.connections_opened(), 2u);
+    EXPECT_EQ(server.total_requests(), 208u);
+    server.stop();
+}
+
+// 分块上传的请求体原样回显；HTTP/1.0请求和格式错误的请求之后连接关闭，之后的流水线请求不再处理
+TEST(HttpServerTest, ChunkedRequestsAndConnectionClose) {
+    HTTPServer server(HTTPServerOptions{}, test_handler);
+    server.start();
+
+    {
+        RawConnection raw(server.port());
+        raw.send("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Type: text/plain\r\n\r\n"
+                 "4\r\nWiki\r\n");
+        raw.send("6\r\npedia \r\nE\r\nin \r\n\r\nchunks.\r\n0\r\n\r\n"
+                 "GET /bye HTTP/1.0\r\n\r\n"
+                 "GET /ignored HTTP/1.1\r\n\r\n");
+        EXPECT_EQ(raw.receive_all(),
+                  "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 24\r\n\r\n"
+                  "Wikipedia in \r\n\r\nchunks."
+                  "HTTP/1.1 200 OK\r\nContent-Length: 8\r\nConnection: close\r\n\r\nGET /bye");
+    }
+    {
+        RawConnection raw(server.port());
+        raw.send("GET / HTTP/1.1\r\nBroken header\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+        EXPECT_EQ(raw.receive_all(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 11\r\nConnection: close\r\n\r\nBad Request");
+    }
+    EXPECT_EQ(server.total_requests(), 2u);
+    server.stop();
+    EXPECT_EQ(server.connections(), 0u);
+}
+
+// 关闭的连接把解析状态放回空闲列表：新连接复用它时从头解析，不受上一个连接未完成的请求影响
+TEST(HttpServerTest, ReusedSessionsStartFresh) {
+    HTTPServer server(HTTPServerOptions{}, test_handler);
+    server.start();
+    {
+        RawConnection partial(server.port());
+        partial.send("POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 100\r\n\r\nhalf");
+        while (server.total_accepted() < 1) std::this_thread::yield();
+    }
+    while (server.connections() > 0) std::this_thread::yield();
+    for (int i = 0; i < 3; ++i) {
+        RawConnection next(server.port());
+        next.send("GET /fresh-" + std::to_string(i) + " HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+        std::string reply = next.receive_all();
+        EXPECT_EQ(reply.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << reply;
+        EXPECT_NE(reply.find("GET /fresh-" + std::to_string(i)), std::string::npos) << reply;
+    }
+    EXPECT_EQ(server.total_accepted(), 4u);
+    server.stop();
+}
+
+// 客户端跳过100 Continue；复用的连接被服务器关闭时只重发幂等的请求，POST可能已被执行，直接报错
+TEST(HttpServerTest, ClientSkipsInterimResponsesAndRetriesOnlyIdempotent) {
+    std::map<std::uint64_t, int> requests;
+    std::atomic<int> posts{0};
+    TCPServerCallbacks callbacks;
+    callbacks.on_message = [&](TCPConnection& connection, ByteBuffer& input) {
+        std::size_t end;
+        while ((end = input.view().find("\r\n\r\n")) != std::string_view::npos) {
+            if (input.view().rfind("POST", 0) == 0) ++posts;
+            input.consume(end + 4);
+            // 每个连接的第二个请求不回复，直接关闭连接
+            if (++requests[connection.id()] == 2) {
+                input.consume(input.size());
+                connection.close();
+                return;
+            }
+            connection.send("HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+        }
+    };
+    TCPServer server(TCPServerOptions{}, callbacks);
+    server.start();
+    const std::string url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    HTTPClient client(std::chrono::seconds(5));
+    HTTPClientResponse response = client.get(url);
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "ok");
+    EXPECT_THROW(client.post(url, "{}"), std::runtime_error);
+    EXPECT_EQ(posts.load(), 1);
+    EXPECT_EQ(client.get(url).body, "ok");
+    EXPECT_EQ(client.get(url).body, "ok");
+    EXPECT_EQ(client.connections_opened(), 3u);
+    server.stop();
+}
+
+// 负载生成器发送固定的请求，每个响应的大小固定，可以直接用于HTTP服务器
+TEST(HttpServerTest, LoadGeneratorDrivesKeepAliveConnections) {
+    HTTPServer server(HTTPServerOptions{}, [](const HTTPRequest&, HTTPResponse& response) {
+        response.set_body("Hello, World!");
+    });
+    server.start();
+
+    const std::string expected = "HTTP/1.1 200 OK\r\nContent-Length: 13\r\n\r\nHello, World!";
+    LoadGeneratorOptions load;
+    load.port = server.port();
+    load.connections = 64;
+    load.request = "GET /plaintext HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    load.response_size = expected.size();
+    {
+        LoadGenerator generator(load);
+        LoadReport report = generator.run(5000);
+        EXPECT_EQ(report.requests, 5000u);
+        EXPECT_EQ(report.bytes, 5000u * (load.request.size() + expected.size()));
+    }
+    EXPECT_EQ(server.total_requests(), 5000u);
+    EXPECT_EQ(server.total_accepted(), 64u);
+    server.stop();
+}
+#endif
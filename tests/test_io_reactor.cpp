@@ -0,0 +1,387 @@
+#include <gtest/gtest.h>
+#include "../network/io_reactor.h"
+
+#if defined(__linux__)
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace network_demo;
+using coroutines_base::Task;
+
+namespace {
+    // 内核支持io_uring时，use_io_uring的Reactor必须真的走io_uring分支，而不是悄悄回退
+    bool kernel_has_io_uring(bool sockets = false) {
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+        auto ring = IoUring::create();
+        return ring && (!sockets || (ring->supports(IORING_OP_RECV) && ring->supports(IORING_OP_SEND)));
+#else
+        (void)sockets;
+        return false;
+#endif
+    }
+
+    // 回显一个连接上的所有数据，直到对端关闭
+    Task<void> echo_connection(AsyncFd connection) {
+        char buffer[4096];
+        for (;;) {
+            std::size_t n = co_await async_read(connection, buffer, sizeof(buffer));
+            if (n == 0) co_return;
+            co_await async_write_all(connection, buffer, n);
+        }
+    }
+
+    Task<void> echo_server(AsyncFd& listener, int connections) {
+        for (int i = 0; i < connections; ++i) {
+            listener.reactor().spawn(echo_connection(co_await async_accept(listener)));
+        }
+    }
+
+    Task<std::string> echo_client(Reactor& reactor, std::uint16_t port, std::string message) {
+        AsyncFd socket = co_await tcp_connect(reactor, make_address("127.0.0.1", port));
+        co_await async_write_all(socket, message.data(), message.size());
+        std::string reply(message.size(), '\0');
+        std::size_t received = 0;
+        while (received < reply.size()) {
+            std::size_t n = co_await async_read(socket, reply.data() + received, reply.size() - received);
+            if (n == 0) break;
+            received += n;
+        }
+        reply.resize(received);
+        co_return reply;
+    }
+
+    Task<std::vector<std::string>> run_clients(Reactor& reactor, std::uint16_t port, int clients) {
+        std::vector<Task<std::string>> tasks;
+        for (int i = 0; i < clients; ++i) {
+            // 大于套接字缓冲区的消息，覆盖部分写入和等待可写
+            std::string message(i == 0 ? 1 << 20 : 64, static_cast<char>('a' + i % 26));
+            tasks.push_back(echo_client(reactor, port, std::move(message)));
+        }
+        co_return co_await coroutines_base::when_all(std::move(tasks));
+    }
+
+    // 用queue_depth个协程并发读取整个文件，拼回原来的顺序
+    Task<std::string> read_whole_file(Reactor& reactor, int fd, std::size_t file_size, std::size_t chunk,
+                                      int queue_depth) {
+        std::string contents(file_size, '\0');
+        std::size_t next_offset = 0;
+        auto worker = [](Reactor& r, int file, std::string& out, std::size_t& next, std::size_t size) -> Task<void> {
+            while (next < out.size()) {
+                std::size_t offset = next;
+                next += size;
+                std::size_t n = co_await async_read_at(r, file, out.data() + offset,
+                                                       std::min(size, out.size() - offset), offset);
+                if (n == 0) throw std::runtime_error("unexpected end of file");
+            }
+        };
+        std::vector<Task<void>> workers;
+        for (int i = 0; i < queue_depth; ++i) workers.push_back(worker(reactor, fd, contents, next_offset, chunk));
+        co_await coroutines_base::when_all(std::move(workers));
+        co_return contents;
+    }
+
+    // 测试用的临时文件，析构时删除
+    struct TempFile {
+        std::string path;
+        int fd = -1;
+
+        explicit TempFile(const std::string& contents) {
+            char name[] = "/tmp/io_reactor_test_XXXXXX";
+            fd = ::mkstemp(name);
+            path = name;
+            ssize_t written = ::write(fd, contents.data(), contents.size());
+            EXPECT_EQ(written, static_cast<ssize_t>(contents.size()));
+        }
+
+        ~TempFile() {
+            ::close(fd);
+            std::remove(path.c_str());
+        }
+    };
+
+    std::string test_pattern(std::size_t size) {
+        std::string data(size, '\0');
+        for (std::size_t i = 0; i < size; ++i) data[i] = static_cast<char>('A' + (i * 7 + i / 4096) % 26);
+        return data;
+    }
+
+    Task<std::vector<int>> timer_order(Reactor& reactor) {
+        std::vector<int> order;
+        auto sleeper = [](Reactor& r, std::vector<int>& out, int ms) -> Task<void> {
+            co_await r.sleep_for(std::chrono::milliseconds(ms));
+            out.push_back(ms);
+        };
+        std::vector<Task<void>> tasks;
+        for (int ms : {30, 10, 20, 0}) tasks.push_back(sleeper(reactor, order, ms));
+        co_await coroutines_base::when_all(std::move(tasks));
+        co_return order;
+    }
+}
+
+TEST(IoReactorTest, EchoesManyConnectionsOnOneThread) {
+    Reactor reactor;
+    AsyncFd listener = tcp_listen(reactor, ListenOptions{});
+    const std::uint16_t port = local_port(listener);
+    constexpr int kClients = 50;
+    reactor.spawn(echo_server(listener, kClients));
+
+    auto replies = reactor.run_until_complete(run_clients(reactor, port, kClients));
+    ASSERT_EQ(replies.size(), static_cast<std::size_t>(kClients));
+    EXPECT_EQ(replies[0], std::string(1 << 20, 'a'));
+    for (int i = 1; i < kClients; ++i) {
+        EXPECT_EQ(replies[i], std::string(64, static_cast<char>('a' + i % 26)));
+    }
+}
+
+TEST(IoReactorTest, TimersFireInDeadlineOrder) {
+    Reactor reactor;
+    auto start = Reactor::Clock::now();
+    auto order = reactor.run_until_complete(timer_order(reactor));
+    EXPECT_EQ(order, (std::vector<int>{0, 10, 20, 30}));
+    EXPECT_GE(Reactor::Clock::now() - start, std::chrono::milliseconds(30));
+}
+
+TEST(IoReactorTest, ReportsConnectErrors) {
+    Reactor reactor;
+    // 先绑定再关闭，得到一个没有人监听的端口
+    std::uint16_t port;
+    {
+        AsyncFd listener = tcp_listen(reactor, ListenOptions{});
+        port = local_port(listener);
+    }
+    auto connect = [](Reactor& r, std::uint16_t p) -> Task<void> {
+        co_await tcp_connect(r, make_address("127.0.0.1", p));
+    };
+    try {
+        reactor.run_until_complete(connect(reactor, port));
+        FAIL() << "connect to a closed port should fail";
+    } catch (const std::system_error& e) {
+        EXPECT_EQ(e.code().value(), ECONNREFUSED);
+    }
+}
+
+TEST(IoReactorTest, ReusePortReactorsShareTheLoad) {
+    // 每个Reactor各自监听同一端口；先用端口0确定一个可用端口
+    std::uint16_t port;
+    {
+        Reactor probe;
+        ListenOptions options;
+        options.reuse_port = true;
+        AsyncFd listener = tcp_listen(probe, options);
+        port = local_port(listener);
+    }
+
+    constexpr int kClients = 40;
+    std::atomic<int> accepted{0};
+    // 监听套接字归接受循环所有，随Reactor一起销毁
+    auto accept_loop = [](AsyncFd listener, std::atomic<int>& count) -> Task<void> {
+        for (;;) {
+            AsyncFd connection = co_await async_accept(listener);
+            count.fetch_add(1);
+            listener.reactor().spawn(echo_connection(std::move(connection)));
+        }
+    };
+    ReactorThreads servers(2, [&](Reactor& reactor, std::size_t) {
+        ListenOptions options;
+        options.port = port;
+        options.reuse_port = true;
+        reactor.spawn(accept_loop(tcp_listen(reactor, options), accepted));
+    });
+
+    Reactor client;
+    auto replies = client.run_until_complete(run_clients(client, port, kClients));
+    EXPECT_EQ(replies.size(), static_cast<std::size_t>(kClients));
+    EXPECT_EQ(accepted.load(), kClients);
+    servers.stop();
+}
+
+TEST(IoReactorTest, FileReadsMatchWithAndWithoutIoUring) {
+    const std::string expected = test_pattern(1 << 20);
+    TempFile file(expected);
+
+    for (bool use_io_uring : {true, false}) {
+        ReactorOptions options;
+        options.use_io_uring = use_io_uring;
+        Reactor reactor(options);
+        EXPECT_EQ(reactor.uses_io_uring(), use_io_uring && kernel_has_io_uring());
+        auto contents = reactor.run_until_complete(read_whole_file(reactor, file.fd, expected.size(), 4096, 8));
+        EXPECT_TRUE(contents == expected) << "use_io_uring=" << use_io_uring;
+    }
+}
+
+TEST(IoReactorTest, FixedReadsUseRegisteredFilesAndBuffers) {
+    const std::string expected = test_pattern(3 * 8192 + 100);
+    TempFile file(expected);
+
+    for (bool use_io_uring : {true, false}) {
+        ReactorOptions options;
+        options.use_io_uring = use_io_uring;
+        Reactor reactor(options);
+        EXPECT_EQ(reactor.uses_io_uring(), use_io_uring && kernel_has_io_uring());
+        std::vector<char> storage(2 * 8192);
+        reactor.register_files({file.fd});
+        reactor.register_buffers({iovec{storage.data(), 8192}, iovec{storage.data() + 8192, 8192}});
+
+        auto read_all = [](Reactor& r, const std::vector<char>& buffers, std::size_t size) -> Task<std::string> {
+            std::string out;
+            for (std::uint64_t offset = 0; offset < size; offset += 8192) {
+                unsigned index = static_cast<unsigned>(offset / 8192 % 2);
+                std::size_t n = co_await async_read_fixed(r, 0, index, 8192, offset);
+                out.append(buffers.data() + index * 8192, n);
+            }
+            co_return out;
+        };
+        EXPECT_TRUE(reactor.run_until_complete(read_all(reactor, storage, expected.size())) == expected)
+            << "use_io_uring=" << use_io_uring;
+    }
+}
+
+TEST(IoReactorTest, SocketRecvAndSendThroughEitherBackend) {
+    for (bool use_io_uring : {true, false}) {
+        ReactorOptions options;
+        options.use_io_uring = use_io_uring;
+        Reactor reactor(options);
+        EXPECT_EQ(reactor.uses_io_uring_for_sockets(), use_io_uring && kernel_has_io_uring(true));
+        int fds[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        AsyncFd a(reactor, fds[0]);
+        AsyncFd b(reactor, fds[1]);
+
+        auto exchange = [](AsyncFd& left, AsyncFd& right) -> Task<std::string> {
+            const std::string message = "hello over io_uring";
+            std::size_t sent = co_await async_send(left, message.data(), message.size());
+            std::string received(message.size(), '\0');
+            std::size_t n = co_await async_recv(right, received.data(), received.size());
+            received.resize(n);
+            co_return received.size() == sent ? received : std::string();
+        };
+        EXPECT_EQ(reactor.run_until_complete(exchange(a, b)), "hello over io_uring");
+    }
+}
+
+#if defined(CPP_LEARNING_HAVE_IO_URING)
+// 测试填写的SQE多于提交队列的容量：队列满时先提交，已填写的请求一个也不丢
+TEST(IoReactorTest, IoUringQueuesMoreRequestsThanEntries) {
+    auto ring = IoUring::create(4);
+    if (!ring) GTEST_SKIP() << "io_uring is not available";
+    constexpr std::uint64_t kRequests = 8;
+    for (std::uint64_t i = 0; i < kRequests; ++i) {
+        io_uring_sqe& sqe = ring->next_sqe();
+        sqe.opcode = IORING_OP_NOP;
+        sqe.fd = -1;
+        sqe.user_data = i + 1;
+    }
+    std::uint64_t sum = 0;
+    std::size_t completed = 0;
+    ring->drain([&](const io_uring_cqe& cqe) {
+        sum += cqe.user_data;
+        ++completed;
+    });
+    EXPECT_EQ(completed, kRequests);
+    EXPECT_EQ(sum, kRequests * (kRequests + 1) / 2);
+}
+#endif
+
+// 测试关闭描述符时挂起在它上面的读和写(对端既不发送也不接收)以ECANCELED结束，而不是永远挂起
+TEST(IoReactorTest, CloseResumesPendingOperations) {
+    for (bool use_io_uring : {true, false}) {
+        ReactorOptions options;
+        options.use_io_uring = use_io_uring;
+        Reactor reactor(options);
+        int fds[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        AsyncFd a(reactor, fds[0]);
+        AsyncFd b(reactor, fds[1]);
+        int recv_error = 0;
+        int write_error = 0;
+
+        reactor.spawn([](AsyncFd& socket, int& error) -> Task<void> {
+            char byte;
+            try {
+                co_await async_recv(socket, &byte, 1);
+            } catch (const std::system_error& e) {
+                error = e.code().value();
+            }
+        }(a, recv_error));
+        // 对端不读，写满套接字缓冲区后挂起
+        reactor.spawn([](AsyncFd& socket, int& error) -> Task<void> {
+            std::vector<char> chunk(1 << 16, 'x');
+            try {
+                for (;;) co_await async_write(socket, chunk.data(), chunk.size());
+            } catch (const std::system_error& e) {
+                error = e.code().value();
+            }
+        }(a, write_error));
+        reactor.spawn([](Reactor& reactor, AsyncFd& socket) -> Task<void> {
+            co_await reactor.sleep_for(std::chrono::milliseconds(10));
+            socket.close();
+            co_await reactor.sleep_for(std::chrono::milliseconds(10));
+            reactor.stop();
+        }(reactor, a));
+        reactor.run();
+        EXPECT_EQ(recv_error, ECANCELED) << "use_io_uring=" << use_io_uring;
+        EXPECT_EQ(write_error, ECANCELED) << "use_io_uring=" << use_io_uring;
+    }
+}
+
+// 测试Reactor析构时取消挂起在空闲套接字上的io_uring recv，而不是永远等它完成
+TEST(IoReactorTest, DestroysReactorWithPendingRecv) {
+    std::atomic<bool> destroyed{false};
+    std::thread destroyer([&destroyed] {
+        auto reactor = std::make_unique<Reactor>();
+        EXPECT_EQ(reactor->uses_io_uring_for_sockets(), kernel_has_io_uring(true));
+        int fds[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        {
+            // 对端保持打开：recv既收不到数据也收不到EOF；关闭这一端时提交的取消请求要等到~Reactor才被处理
+            AsyncFd b(*reactor, fds[1]);
+            reactor->spawn([](AsyncFd& socket) -> Task<void> {
+                char byte;
+                co_await async_recv(socket, &byte, 1);
+                ADD_FAILURE() << "recv on an idle socket completed";
+            }(b));
+            reactor->spawn([](Reactor& reactor) -> Task<void> {
+                co_await reactor.sleep_for(std::chrono::milliseconds(10));
+                reactor.stop();
+            }(*reactor));
+            reactor->run();
+        }
+        reactor.reset();
+        ::close(fds[0]);
+        destroyed = true;
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!destroyed && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!destroyed) {
+        destroyer.detach();
+        FAIL() << "~Reactor hung on a pending recv";
+    }
+    destroyer.join();
+}
+
+TEST(IoReactorTest, ScheduleMovesCoroutineOntoReactorThread) {
+    Reactor reactor;
+    std::thread::id reactor_thread;
+    std::thread runner([&] {
+        reactor_thread = std::this_thread::get_id();
+        reactor.run();
+    });
+
+    auto hop = [](Reactor& r) -> Task<std::thread::id> {
+        co_await r.schedule();
+        co_return std::this_thread::get_id();
+    };
+    std::thread::id resumed_on = coroutines_base::sync_wait(hop(reactor));
+    reactor.stop();
+    runner.join();
+    EXPECT_EQ(resumed_on, reactor_thread);
+}
+#endif
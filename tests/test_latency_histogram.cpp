@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "../performance-benchmarking/latency_histogram.h"
+#include "../advanced-concurrency/thread_pool.h"
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace performance_benchmarking_demo;
+
+// 小于2^P的值精确记录，更大的值相对误差不超过1/2^(P-1)
+TEST(LatencyHistogramTest, BucketsBoundRelativeError) {
+    LatencyHistogram histogram(7);
+    for (std::uint64_t v : {0ull, 1ull, 127ull, 128ull, 1000ull, 123456789ull, (1ull << 40) - 1}) {
+        histogram.reset();
+        histogram.record(v);
+        EXPECT_EQ(histogram.min(), v);
+        EXPECT_EQ(histogram.max(), v);
+        EXPECT_EQ(histogram.percentile(50), v);
+    }
+
+    for (std::uint64_t v = 1; v < (1ull << 30); v = v * 3 + 1) {
+        std::size_t index = histogram_detail::bucket_index(v, 7);
+        std::uint64_t low = histogram_detail::bucket_lowest(index, 7);
+        std::uint64_t high = histogram_detail::bucket_highest(index, 7);
+        ASSERT_LE(low, v);
+        ASSERT_GE(high, v);
+        EXPECT_LE(static_cast<double>(high - low), static_cast<double>(v) / 64.0);
+    }
+
+    // 超出范围的值计入最后一个桶，max仍然精确
+    LatencyHistogram small(5, 1000);
+    small.record(5000);
+    EXPECT_EQ(small.max(), 5000u);
+    EXPECT_EQ(small.count(), 1u);
+}
+
+TEST(LatencyHistogramTest, PercentilesAndMerge) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for (std::uint64_t v = 1; v <= 5000; ++v) a.record(v);
+    for (std::uint64_t v = 5001; v <= 10000; ++v) b.record(v);
+    a.merge(b);
+
+    EXPECT_EQ(a.count(), 10000u);
+    EXPECT_EQ(a.min(), 1u);
+    EXPECT_EQ(a.max(), 10000u);
+    EXPECT_DOUBLE_EQ(a.mean(), 5000.5);
+    EXPECT_NEAR(static_cast<double>(a.percentile(50)), 5000.0, 5000.0 / 64);
+    EXPECT_NEAR(static_cast<double>(a.percentile(99)), 9900.0, 9900.0 / 64);
+    EXPECT_NEAR(static_cast<double>(a.percentile(99.9)), 9990.0, 9990.0 / 64);
+    EXPECT_EQ(a.percentile(100), 10000u);
+
+    std::ostringstream json;
+    a.write_json(json);
+    EXPECT_NE(json.str().find("\"count\": 10000"), std::string::npos);
+    EXPECT_NE(json.str().find("\"buckets\": [[1, 1, 1]"), std::string::npos);
+
+    LatencyHistogram other_layout(8);
+    EXPECT_THROW(a.merge(other_layout), std::invalid_argument);
+}
+
+// 多个线程分别写自己的分片，快照合并后计数完整
+TEST(LatencyHistogramTest, RecorderMergesThreads) {
+    LatencyRecorder recorder;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&recorder, t] {
+            for (int i = 0; i < 10000; ++i) recorder.record(static_cast<std::uint64_t>(t * 1000 + i % 1000));
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    LatencyHistogram merged = recorder.snapshot();
+    EXPECT_EQ(merged.count(), 40000u);
+    EXPECT_EQ(merged.min(), 0u);
+    EXPECT_EQ(merged.max(), 3999u);
+
+    recorder.reset();
+    EXPECT_EQ(recorder.snapshot().count(), 0u);
+}
+
+// 一个线程轮流写的recorder比线程局部缓存多，每个recorder仍然只有这个线程的一个分片
+TEST(LatencyHistogramTest, RecorderKeepsOneShardPerThread) {
+    std::vector<std::unique_ptr<LatencyRecorder>> recorders;
+    for (int i = 0; i < 10; ++i) recorders.push_back(std::make_unique<LatencyRecorder>());
+    for (int round = 0; round < 100; ++round) {
+        for (auto& recorder : recorders) recorder->record(static_cast<std::uint64_t>(round));
+    }
+    for (auto& recorder : recorders) {
+        EXPECT_EQ(recorder->shard_count(), 1u);
+        EXPECT_EQ(recorder->snapshot().count(), 100u);
+    }
+
+    // 反复创建和销毁recorder：每个新recorder都从空的分片开始
+    for (int i = 0; i < 1000; ++i) {
+        LatencyRecorder temporary;
+        temporary.record(std::uint64_t{1});
+        temporary.record(std::uint64_t{2});
+        ASSERT_EQ(temporary.snapshot().count(), 2u);
+    }
+
+    std::thread([&] { recorders[0]->record(std::uint64_t{7}); }).join();
+    EXPECT_EQ(recorders[0]->shard_count(), 2u);
+    EXPECT_EQ(recorders[0]->snapshot().count(), 101u);
+}
+
+TEST(LatencyHistogramTest, ThreadPoolRecordsWaitAndRunTime) {
+    advanced_concurrency_demo::ThreadPool pool(2);
+    pool.enqueue([] {}).get();
+    EXPECT_EQ(pool.latency_stats().run.count(), 0u);
+
+    pool.set_latency_tracking(true);
+    std::vector<std::future<void>> done;
+    for (int i = 0; i < 100; ++i) {
+        done.push_back(pool.enqueue([] { std::this_thread::sleep_for(std::chrono::microseconds(50)); }));
+    }
+    for (auto& f : done) f.get();
+    pool.shutdown_now();
+
+    auto stats = pool.latency_stats();
+    EXPECT_EQ(stats.queue_wait.count(), 100u);
+    EXPECT_EQ(stats.run.count(), 100u);
+    EXPECT_GE(stats.run.min(), 50000u);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "../multithreading/sharded_counter.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int kThreads = 8;
+    constexpr int kIncrements = 100000;
+}
+
+// 测试所有写者停止后的总数是精确的
+TEST(ShardedCounterTest, ExactTotalAfterWritersStop) {
+    multithreading_demo::ShardedCounter counter(4);
+    EXPECT_EQ(counter.shard_count(), 4u);
+    EXPECT_EQ(counter.value(), 0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < kIncrements; ++i) ++counter;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(counter.value(), static_cast<std::int64_t>(kThreads) * kIncrements);
+
+    counter += -5;
+    counter.add(2);
+    EXPECT_EQ(counter.value(), static_cast<std::int64_t>(kThreads) * kIncrements - 3);
+    // 分片数向上取整到2的幂
+    EXPECT_EQ(multithreading_demo::ShardedCounter(3).shard_count(), 4u);
+}
+
+// 测试写者运行期间的读取和清零：读到的值单调不减，清零不丢失并发的递增
+TEST(ShardedCounterTest, ValueAndResetWhileWriting) {
+    multithreading_demo::ShardedCounter counter;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < kIncrements; ++i) counter.increment();
+        });
+    }
+
+    std::int64_t drained = 0;
+    std::thread reader([&] {
+        std::int64_t last = 0;
+        while (!stop.load()) {
+            std::int64_t current = counter.value();
+            // 两次读取之间没有清零，只有递增
+            EXPECT_GE(current, last);
+            EXPECT_LE(current, static_cast<std::int64_t>(kThreads) * kIncrements);
+            std::int64_t taken = counter.exchange_reset();
+            EXPECT_GE(taken, 0);
+            drained += taken;
+            last = counter.value();
+        }
+    });
+
+    for (auto& thread : threads) thread.join();
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(drained + counter.exchange_reset(), static_cast<std::int64_t>(kThreads) * kIncrements);
+    EXPECT_EQ(counter.value(), 0);
+}
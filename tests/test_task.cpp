@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include "../advanced-concurrency/thread_pool.h"
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace coroutines_base;
+using advanced_concurrency_demo::ThreadPool;
+
+namespace {
+    Task<int> value_of(int x) {
+        co_return x;
+    }
+
+    Task<long> sum_chain(int n) {
+        long sum = 0;
+        for (int i = 0; i < n; ++i) sum += co_await value_of(i);
+        co_return sum;
+    }
+
+    Task<void> fail() {
+        throw std::runtime_error("task failed");
+        co_return;
+    }
+
+    Generator<int> count_to(int n) {
+        for (int i = 0; i < n; ++i) co_yield i;
+    }
+
+    // 只记录分配次数的最小内存池
+    struct CountingArena {
+        std::vector<std::max_align_t> buffer = std::vector<std::max_align_t>(4096);
+        std::size_t offset = 0;
+        int allocations = 0;
+
+        void* allocate(std::size_t size) {
+            ++allocations;
+            void* ptr = buffer.data() + offset;
+            offset += (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            return ptr;
+        }
+    };
+
+    Task<std::thread::id> thread_of(ThreadPool& pool) {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+}
+
+// Task在被等待之前不执行
+TEST(TaskTest, IsLazy) {
+    // 协程lambda不能有捕获：惰性Task开始执行时lambda对象已经销毁，状态通过参数传入
+    bool started = false;
+    auto task = [](bool& flag) -> Task<int> {
+        flag = true;
+        co_return 42;
+    }(started);
+    EXPECT_FALSE(started);
+    EXPECT_EQ(sync_wait(task), 42);
+    EXPECT_TRUE(started);
+}
+
+// 大量同步完成的co_await：对等转移使调用栈深度保持不变
+TEST(TaskTest, SymmetricTransferKeepsStackFlat) {
+#if defined(__OPTIMIZE__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    const int depth = 1000000;
+#else
+    const int depth = 10000;
+#endif
+    EXPECT_EQ(sync_wait(sum_chain(depth)), static_cast<long>(depth) * (depth - 1) / 2);
+}
+
+TEST(TaskTest, PropagatesExceptionsAndReferences) {
+    EXPECT_THROW(sync_wait(fail()), std::runtime_error);
+
+    int target = 7;
+    auto ref = [](int& t) -> Task<int&> { co_return t; }(target);
+    int& result = sync_wait(ref);
+    EXPECT_EQ(&result, &target);
+
+    auto move_only = []() -> Task<std::unique_ptr<int>> { co_return std::make_unique<int>(3); }();
+    EXPECT_EQ(*sync_wait(move_only), 3);
+}
+
+// schedule()之后在线程池的工作线程上继续；when_all同时运行所有任务并按顺序返回结果
+TEST(TaskTest, SchedulesOntoThreadPool) {
+    ThreadPool pool(3);
+    EXPECT_NE(sync_wait(thread_of(pool)), std::this_thread::get_id());
+
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 1000; ++i) {
+        tasks.push_back([](ThreadPool& p, int x) -> Task<int> {
+            co_await p.schedule();
+            co_return x * 2;
+        }(pool, i));
+    }
+    auto results = sync_wait(when_all(std::move(tasks)));
+    ASSERT_EQ(results.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) EXPECT_EQ(results[i], i * 2);
+
+    std::vector<Task<void>> failing;
+    failing.push_back(fail());
+    failing.push_back([](ThreadPool& p) -> Task<void> { co_await p.schedule(); }(pool));
+    EXPECT_THROW(sync_wait(when_all(std::move(failing))), std::runtime_error);
+}
+
+TEST(TaskTest, CoroutineFramesComeFromPoolOrArena) {
+    // 释放的帧进入线程局部空闲链表，下一个同样大小的协程直接复用
+    { auto g = count_to(3); for (int v : g) (void)v; }
+    std::size_t cached = cached_frame_count();
+    EXPECT_GE(cached, 1u);
+    int sum = 0;
+    for (int v : count_to(4)) sum += v;
+    EXPECT_EQ(sum, 6);
+    EXPECT_EQ(cached_frame_count(), cached);
+
+    CountingArena arena;
+    {
+        FrameArenaScope scope(arena);
+        EXPECT_EQ(sync_wait(sum_chain(10)), 45);
+        for (int v : count_to(2)) sum += v;
+    }
+    // sum_chain + 10个value_of + sync_wait包装协程 + count_to
+    EXPECT_EQ(arena.allocations, 13);
+    // arena中的帧释放时不进入空闲链表
+    EXPECT_EQ(cached_frame_count(), cached);
+
+    {
+        FrameHeapScope heap;
+        EXPECT_EQ(sync_wait(value_of(7)), 7);
+    }
+    EXPECT_EQ(cached_frame_count(), cached);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "../advanced-concurrency/task_graph.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace advanced_concurrency_demo;
+
+// 测试节点只在所有依赖完成后执行，且图可以重复执行
+TEST(TaskGraphTest, RespectsDependenciesAcrossRuns) {
+    ThreadPool pool(4);
+    TaskGraphExecutor executor(pool);
+
+    std::atomic<int> clock{0};
+    std::vector<int> finished(4, -1);
+    auto stamp = [&](int node) { return [&, node] { finished[node] = clock.fetch_add(1); }; };
+
+    TaskGraph graph;
+    auto a = graph.add_node("a", stamp(0));
+    auto b = graph.add_node("b", stamp(1), {a});
+    auto c = graph.add_node("c", stamp(2), {a});
+    graph.add_node("d", stamp(3), {b, c});
+
+    for (int run = 0; run < 3; ++run) {
+        TaskGraphReport report = executor.run(graph);
+        EXPECT_LT(finished[0], finished[1]);
+        EXPECT_LT(finished[0], finished[2]);
+        EXPECT_LT(finished[1], finished[3]);
+        EXPECT_LT(finished[2], finished[3]);
+        ASSERT_EQ(report.critical_path.size(), 3u);
+        EXPECT_EQ(report.critical_path.front(), a);
+        EXPECT_EQ(report.critical_path.back(), 3u);
+        (void)b;
+        (void)c;
+    }
+}
+
+// 测试环检测
+TEST(TaskGraphTest, DetectsCycles) {
+    TaskGraph graph;
+    auto a = graph.add_node("a", [] {});
+    auto b = graph.add_node("b", [] {}, {a});
+    auto c = graph.add_node("c", [] {}, {b});
+    graph.add_dependency(c, a);
+    EXPECT_THROW(graph.prepare(), std::logic_error);
+}
+
+// 测试节点异常传回run()的调用者，且失败后的下游节点不执行
+TEST(TaskGraphTest, PropagatesFirstException) {
+    ThreadPool pool(2);
+    TaskGraphExecutor executor(pool);
+    bool downstream_ran = false;
+
+    TaskGraph graph;
+    auto failing = graph.add_node("failing", [] { throw std::runtime_error("node failed"); });
+    graph.add_node("downstream", [&downstream_ran] { downstream_ran = true; }, {failing});
+
+    EXPECT_THROW(executor.run(graph), std::runtime_error);
+    EXPECT_FALSE(downstream_ran);
+}
+
+// 测试线程池停止后run()以异常结束：投递失败的节点和它们的下游都不执行，已投递的节点结束后才返回
+TEST(TaskGraphTest, FailsWhenPoolStops) {
+    ThreadPool pool(2);
+    TaskGraphExecutor executor(pool);
+    std::atomic<int> ran{0};
+
+    TaskGraph graph;
+    auto slow = graph.add_node("slow", [&ran] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        ++ran;
+    });
+    graph.add_node("left", [&ran] { ++ran; }, {slow});
+    graph.add_node("right", [&ran] { ++ran; }, {slow});
+
+    // slow运行期间线程池停止：它的两个后继一个无法投递，另一个在同一线程上继续时已经处于失败状态
+    std::thread stopper([&pool] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pool.shutdown_now();
+    });
+    EXPECT_THROW(executor.run(graph), std::runtime_error);
+    stopper.join();
+    EXPECT_EQ(ran.load(), 1);
+
+    // 已经停止的线程池：根节点都无法投递
+    TaskGraph roots;
+    roots.add_node("a", [&ran] { ++ran; });
+    roots.add_node("b", [&ran] { ++ran; });
+    EXPECT_THROW(executor.run(roots), std::runtime_error);
+    EXPECT_EQ(ran.load(), 1);
+}
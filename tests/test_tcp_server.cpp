@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include "../network/tcp_server.h"
+#include "../network/load_generator.h"
+
+#if defined(__linux__)
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace network_demo;
+
+namespace {
+    TCPServerCallbacks echo_callbacks() {
+        TCPServerCallbacks callbacks;
+        callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+            connection.send(input.data(), input.size());
+            input.consume(input.size());
+        };
+        return callbacks;
+    }
+
+    // 阻塞的测试客户端
+    class BlockingClient {
+    private:
+        int fd_;
+
+    public:
+        explicit BlockingClient(std::uint16_t port) : fd_(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) {
+            sockaddr_in address = make_address("127.0.0.1", port);
+            if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                throw_errno(errno, "connect");
+            }
+        }
+
+        ~BlockingClient() {
+            ::close(fd_);
+        }
+
+        void send(const std::string& data) {
+            std::size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) throw_errno(errno, "send");
+                sent += static_cast<std::size_t>(n);
+            }
+        }
+
+        // 读到size字节或对端关闭为止
+        std::string receive(std::size_t size) {
+            std::string data(size, '\0');
+            std::size_t received = 0;
+            while (received < size) {
+                ssize_t n = ::read(fd_, data.data() + received, size - received);
+                if (n <= 0) break;
+                received += static_cast<std::size_t>(n);
+            }
+            data.resize(received);
+            return data;
+        }
+
+        void shutdown_write() {
+            ::shutdown(fd_, SHUT_WR);
+        }
+    };
+}
+
+// 多个事件循环线程，负载生成器在回环地址上完成所有往返
+TEST(TcpServerTest, EchoesLoadOnLoopback) {
+    TCPServerOptions options;
+    options.threads = 2;
+    TCPServer server(options, echo_callbacks());
+    server.start();
+    ASSERT_NE(server.port(), 0);
+
+    LoadGeneratorOptions load;
+    load.port = server.port();
+    load.connections = 8;
+    load.threads = 2;
+    load.message_size = 100;
+    {
+        LoadGenerator generator(load);
+        auto report = generator.run(2000);
+        EXPECT_EQ(report.requests, 2000u);
+        EXPECT_EQ(report.bytes, 2000u * 100 * 2);
+        EXPECT_EQ(report.latency.count(), 2000u);
+        // 连接保持，可以再运行一轮
+        EXPECT_EQ(generator.run(100).requests, 100u);
+        EXPECT_EQ(server.total_accepted(), 8u);
+    }
+    server.stop();
+    EXPECT_EQ(server.connections(), 0u);
+}
+
+// 按行分帧：不完整的行留在输入缓冲区中；大于套接字缓冲区的响应经过输出缓冲区发出
+TEST(TcpServerTest, BuffersPartialInputAndLargeOutput) {
+    TCPServerCallbacks callbacks;
+    callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+        std::string_view data = input.view();
+        std::size_t end;
+        while ((end = data.find('\n')) != std::string_view::npos) {
+            std::string_view line = data.substr(0, end);
+            if (line == "big") {
+                connection.send(std::string(4 << 20, 'x'));
+            } else {
+                std::string upper(line);
+                for (char& c : upper) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                connection.send(upper + "\n");
+            }
+            input.consume(end + 1);
+            data = input.view();
+        }
+    };
+    TCPServer server(TCPServerOptions{}, callbacks);
+    server.start();
+
+    BlockingClient client(server.port());
+    client.send("hel");
+    client.send("lo\nwor");
+    EXPECT_EQ(client.receive(6), "HELLO\n");
+    client.send("ld\nbig\n");
+    EXPECT_EQ(client.receive(6), "WORLD\n");
+    std::string big = client.receive(4 << 20);
+    EXPECT_EQ(big.size(), static_cast<std::size_t>(4 << 20));
+    EXPECT_TRUE(std::all_of(big.begin(), big.end(), [](char c) { return c == 'x'; }));
+
+    // 对端关闭写方向后，服务器仍然发完排队的响应再关闭
+    client.send("last\nbig\n");
+    client.shutdown_write();
+    EXPECT_EQ(client.receive(5), "LAST\n");
+    EXPECT_EQ(client.receive(4 << 20).size(), static_cast<std::size_t>(4 << 20));
+    EXPECT_EQ(client.receive(1), "");
+}
+
+// 生命周期回调各调用一次；服务器主动close()时先发完输出
+TEST(TcpServerTest, LifecycleCallbacksAndServerClose) {
+    std::atomic<int> opened{0};
+    std::atomic<int> closed{0};
+    TCPServerCallbacks callbacks;
+    callbacks.on_open = [&](TCPConnection& connection) {
+        opened.fetch_add(1);
+        connection.send("welcome\n");
+    };
+    callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+        if (input.view().find("quit") != std::string_view::npos) {
+            connection.send("bye\n");
+            connection.close();
+        }
+        input.consume(input.size());
+    };
+    callbacks.on_close = [&](TCPConnection&) { closed.fetch_add(1); };
+    TCPServer server(TCPServerOptions{}, callbacks);
+    server.start();
+
+    for (int round = 0; round < 3; ++round) {
+        BlockingClient client(server.port());
+        EXPECT_EQ(client.receive(8), "welcome\n");
+        client.send("quit\n");
+        EXPECT_EQ(client.receive(4), "bye\n");
+        EXPECT_EQ(client.receive(1), "");
+    }
+    // 仍然打开的连接在stop()时关闭
+    BlockingClient idle(server.port());
+    EXPECT_EQ(idle.receive(8), "welcome\n");
+    server.stop();
+    EXPECT_EQ(opened.load(), 4);
+    EXPECT_EQ(closed.load(), 4);
+    EXPECT_EQ(server.connections(), 0u);
+    EXPECT_EQ(idle.receive(1), "");
+}
+// 输入缓冲区满时先交给on_message再继续读，放不下一条消息时关闭连接；输出排队超过上限时关闭连接
+TEST(TcpServerTest, BoundsInputAndOutputBuffers) {
+    TCPServerCallbacks callbacks;
+    callbacks.on_message = [](TCPConnection& connection, ByteBuffer& input) {
+        std::string_view data = input.view();
+        std::size_t end;
+        while ((end = data.find('\n')) != std::string_view::npos) {
+            if (data.substr(0, end) == "flood") connection.send(std::string(16 << 20, 'x'));
+            else connection.send(data.substr(0, end + 1));
+            input.consume(end + 1);
+            data = input.view();
+        }
+    };
+    std::atomic<int> closed{0};
+    callbacks.on_close = [&](TCPConnection&) { closed.fetch_add(1); };
+    TCPServerOptions options;
+    options.max_input_buffer = 64;
+    options.max_output_buffer = 64 * 1024;
+    TCPServer server(options, callbacks);
+    server.start();
+
+    // 一次发出的数据远超输入上限，但每一行都放得下
+    std::string lines;
+    for (int i = 0; i < 100; ++i) lines += "line-" + std::to_string(i) + "\n";
+    BlockingClient client(server.port());
+    client.send(lines);
+    EXPECT_EQ(client.receive(lines.size()), lines);
+
+    client.send(std::string(100, 'y'));
+    EXPECT_EQ(client.receive(1), "");
+    while (closed.load() < 1) std::this_thread::yield();
+
+    // 不读取响应：超过输出上限后连接被关闭，收到的数据少于完整响应
+    BlockingClient slow(server.port());
+    slow.send("flood\n");
+    while (closed.load() < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_LT(slow.receive(16 << 20).size(), static_cast<std::size_t>(16 << 20));
+    server.stop();
+}
+
+// 多线程必须开启reuse_port；回调抛出的异常交给on_error并停止服务器，而不是终止进程
+TEST(TcpServerTest, ReusePortOptionAndCallbackExceptions) {
+    TCPServerOptions options;
+    options.threads = 2;
+    options.reuse_port = false;
+    TCPServer invalid(options, echo_callbacks());
+    EXPECT_THROW(invalid.start(), std::invalid_argument);
+
+    std::atomic<int> errors{0};
+    TCPServerCallbacks callbacks;
+    callbacks.on_message = [](TCPConnection&, ByteBuffer&) { throw std::runtime_error("bad message"); };
+    callbacks.on_error = [&errors](std::exception_ptr error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::runtime_error& e) {
+            if (std::string(e.what()) == "bad message") errors.fetch_add(1);
+        }
+    };
+    options.threads = 1;
+    TCPServer server(options, callbacks);
+    server.start();
+    EXPECT_TRUE(server.running());
+    BlockingClient client(server.port());
+    client.send("boom");
+    EXPECT_EQ(client.receive(1), "");
+    EXPECT_EQ(errors.load(), 1);
+    EXPECT_FALSE(server.running());
+    server.stop();
+    EXPECT_EQ(server.connections(), 0u);
+}
+#endif
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "../advanced-concurrency/thread_pool.h"
+#include "../advanced-concurrency/future.h"
+#include "../meta-programming/coroutines/coroutines_base.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stop_token>
+#include <thread>
+
+using namespace advanced_concurrency_demo;
+
+namespace {
+    // 占住线程池唯一的工作线程，直到收到停止请求或者release被置位
+    TaskHandle<void> occupy(ThreadPool& pool, std::atomic<bool>& started, std::atomic<bool>& release) {
+        auto handle = pool.enqueue_cancellable([&started, &release](std::stop_token token) {
+            started = true;
+            while (!token.stop_requested() && !release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        while (!started) std::this_thread::yield();
+        return handle;
+    }
+
+    template<typename R>
+    bool cancelled_with(TaskHandle<R>& handle, bool timed_out) {
+        try {
+            handle.get();
+        } catch (const TaskCancelled& e) {
+            return e.timed_out() == timed_out;
+        }
+        return false;
+    }
+}
+
+// 测试排队中的任务被取消后不再执行；运行中的任务只收到停止请求，仍然正常结束
+TEST(ThreadPoolTest, CancelQueuedAndRunningTasks) {
+    ThreadPool pool(1);
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    auto running = occupy(pool, started, release);
+
+    std::atomic<bool> ran{false};
+    auto queued = pool.enqueue_cancellable([&ran](std::stop_token, int x) { ran = true; return x; }, 42);
+    EXPECT_TRUE(queued.cancel());
+    EXPECT_TRUE(queued.stop_requested());
+    EXPECT_TRUE(cancelled_with(queued, false));
+
+    EXPECT_FALSE(running.cancel());
+    EXPECT_TRUE(running.stop_requested());
+    EXPECT_NO_THROW(running.get());
+
+    auto after = pool.enqueue_cancellable([](std::stop_token, int x) { return x * 2; }, 21);
+    EXPECT_EQ(after.get(), 42);
+    EXPECT_FALSE(ran);
+}
+
+// 测试看门狗在截止时间到达时：运行中的任务收到停止请求，排队中的任务以超时结束
+TEST(ThreadPoolTest, WatchdogTimesOutTasks) {
+    ThreadPool pool(1);
+    auto running = pool.enqueue_with_timeout(std::chrono::milliseconds(20), [](std::stop_token token) {
+        while (!token.stop_requested()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return true;
+    });
+    auto queued = pool.enqueue_with_timeout(std::chrono::milliseconds(20), [](std::stop_token) { return false; });
+
+    EXPECT_TRUE(running.get());
+    EXPECT_TRUE(running.stop_requested());
+    EXPECT_TRUE(cancelled_with(queued, true));
+
+    // 截止时间之前完成的任务不受影响
+    auto quick = pool.enqueue_with_timeout(std::chrono::seconds(10), [](std::stop_token) { return 7; });
+    EXPECT_EQ(quick.get(), 7);
+}
+
+// 测试shutdown_now()返回丢弃的任务数，每种被丢弃任务的结果都不会永远等待
+TEST(ThreadPoolTest, ShutdownNowFailsDroppedTasks) {
+    ThreadPool pool(1);
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    auto running = occupy(pool, started, release);
+
+    std::atomic<int> ran{0};
+    std::future<int> packaged = pool.enqueue([&ran] { ++ran; return 1; });
+    auto cancellable = pool.enqueue_cancellable([&ran](std::stop_token) { ++ran; });
+    Future<int> async_future = async(pool, [&ran] { ++ran; return 2; });
+    Future<int> continuation = make_ready_future(3).then(pool, [&ran](int x) { ++ran; return x; });
+    pool.post([&ran] { ++ran; });
+
+    // 在schedule()处挂起的协程，等它的恢复任务排进队列后再关闭
+    std::atomic<bool> suspending{false};
+    auto coroutine = [](ThreadPool& pool, std::atomic<bool>& suspending, std::atomic<int>& ran)
+        -> coroutines_base::Task<void> {
+        suspending = true;
+        co_await pool.schedule();
+        ++ran;
+    };
+    std::thread waiter([&] {
+        EXPECT_THROW(coroutines_base::sync_wait(coroutine(pool, suspending, ran)), TaskCancelled);
+    });
+    while (!suspending) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(pool.shutdown_now(), 6u);
+    waiter.join();
+
+    EXPECT_TRUE(running.stop_requested());
+    EXPECT_NO_THROW(running.get());
+    EXPECT_THROW(packaged.get(), std::future_error);
+    EXPECT_TRUE(cancelled_with(cancellable, false));
+    EXPECT_THROW(async_future.get(), TaskCancelled);
+    EXPECT_THROW(continuation.get(), TaskCancelled);
+    EXPECT_EQ(ran, 0);
+    EXPECT_THROW(pool.post([] {}), std::runtime_error);
+}
+
+// 测试被取消的排队任务立即出队，不再计入shutdown_now()的丢弃数
+TEST(ThreadPoolTest, CancelledTasksLeaveTheQueue) {
+    ThreadPool pool(1);
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    auto running = occupy(pool, started, release);
+
+    auto cancelled = pool.enqueue_cancellable([](std::stop_token) {});
+    auto timed = pool.enqueue_with_timeout(std::chrono::seconds(10), [](std::stop_token) {});
+    auto kept = pool.enqueue_cancellable([](std::stop_token) {});
+    EXPECT_TRUE(cancelled.cancel());
+    EXPECT_TRUE(timed.cancel());
+
+    EXPECT_EQ(pool.shutdown_now(), 1u);
+    EXPECT_TRUE(cancelled_with(cancelled, false));
+    EXPECT_TRUE(cancelled_with(timed, false));
+    EXPECT_TRUE(cancelled_with(kept, false));
+}
+
+// 测试工作线程上的任务可以关闭自己所在的线程池
+TEST(ThreadPoolTest, ShutdownNowFromWorker) {
+    ThreadPool pool(1);
+    std::atomic<bool> go{false};
+    std::future<size_t> dropped = pool.enqueue([&pool, &go] {
+        while (!go) std::this_thread::yield();
+        return pool.shutdown_now();
+    });
+    std::atomic<int> ran{0};
+    auto cancellable = pool.enqueue_cancellable([&ran](std::stop_token) { ++ran; });
+    pool.post([&ran] { ++ran; });
+    go = true;
+
+    EXPECT_EQ(dropped.get(), 2u);
+    EXPECT_TRUE(cancelled_with(cancellable, false));
+    EXPECT_EQ(ran, 0);
+    EXPECT_THROW(pool.post([] {}), std::runtime_error);
+}